@@ -33,6 +33,7 @@
             [--httpd-version=<version>] [--httpd-whitelist=<version>]
             [--config-file=<file>] [--ssl-cert=<file>]
             [--exclusive-wc-locks] [--memcached-server=<url:port>]
+            [--http2]
             [--fsfs-compression=<type>] [--fsfs-dir-deltification=<true|false>]
             <abs_srcdir> <abs_builddir>
             <prog ...>
@@ -274,6 +275,8 @@ class TestHarness:
       cmdline.append('--httpd-whitelist=%s' % self.opts.httpd_whitelist)
     if self.opts.exclusive_wc_locks is not None:
       cmdline.append('--exclusive-wc-locks')
+    if self.opts.http2 is not None:
+      cmdline.append('--http2')
     if self.opts.memcached_server is not None:
       cmdline.append('--memcached-server=%s' % self.opts.memcached_server)
     if self.opts.fsfs_compression is not None:
@@ -1026,6 +1029,8 @@ def create_parser():
                     help='Assume HTTPD whitelist is this version.')
   parser.add_option('--exclusive-wc-locks', action='store_true',
                     help='Use sqlite exclusive locking for working copies')
+  parser.add_option('--http2', action='store_true',
+                    help='Offer HTTP/2 to https servers')
   parser.add_option('--memcached-server', action='store',
                     help='Use memcached server at specified URL (FSFS only)')
   parser.add_option('--fsfs-compression', action='store', type='str',
@@ -30,6 +30,7 @@
 
 #include "svn_types.h"
 #include "svn_io.h"
+#include "svn_diff.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -148,6 +149,74 @@ svn_diff_hunk__create_deletes_single_line(svn_diff_hunk_t **hunk,
 svn_linenum_t
 svn_diff_hunk__get_fuzz_penalty(const svn_diff_hunk_t *hunk);
 
+/** A line map for computing blame.
+ *
+ * Attributes every line (diff-token) of a file to an opaque baton,
+ * typically describing the revision that last changed it, and keeps the
+ * attribution up to date as the diffs to successive versions of the file
+ * are applied.  All lines after the last one the map knows about belong
+ * to the baton passed to the latest svn_diff__blame_reset().
+ *
+ * Finding, inserting and deleting a range of lines takes time logarithmic
+ * in the number of distinct runs of lines.
+ */
+typedef struct svn_diff__blame_t svn_diff__blame_t;
+
+/** A run of lines attributed to the same baton, as returned by
+ * svn_diff__blame_chunks().
+ */
+typedef struct svn_diff__blame_chunk_t
+{
+  /** The baton the lines are attributed to. */
+  const void *baton;
+
+  /** The first line of the run, counting from 0.  The run extends up to
+   * the start of the next chunk, or to the end of the file. */
+  apr_off_t start;
+} svn_diff__blame_chunk_t;
+
+/** Return a new, empty line map allocated in @a result_pool. */
+svn_diff__blame_t *
+svn_diff__blame_create(apr_pool_t *result_pool);
+
+/** Return TRUE if @a blame has not been reset or updated yet. */
+svn_boolean_t
+svn_diff__blame_is_empty(const svn_diff__blame_t *blame);
+
+/** Attribute all lines in @a blame to @a baton. */
+void
+svn_diff__blame_reset(svn_diff__blame_t *blame,
+                      const void *baton);
+
+/** Update @a blame for the changes in @a diff, attributing all lines that
+ * @a diff adds or modifies to @a baton.  The original of @a diff must be
+ * the version of the file @a blame describes.  Use @a cancel_func with
+ * @a cancel_baton to allow cancellation.
+ */
+svn_error_t *
+svn_diff__blame_update(svn_diff__blame_t *blame,
+                       svn_diff_t *diff,
+                       const void *baton,
+                       svn_cancel_func_t cancel_func,
+                       void *cancel_baton);
+
+/** Return the attribution in @a blame as an array of
+ * #svn_diff__blame_chunk_t in file order, allocated in @a result_pool.
+ * Neighbouring chunks have different batons and the array holds at least
+ * one chunk.
+ */
+apr_array_header_t *
+svn_diff__blame_chunks(const svn_diff__blame_t *blame,
+                       apr_pool_t *result_pool);
+
+/** Replace the attribution in @a blame with that in @a chunks, an array
+ * of #svn_diff__blame_chunk_t as returned by svn_diff__blame_chunks().
+ * @a chunks must not be empty.
+ */
+void
+svn_diff__blame_set_chunks(svn_diff__blame_t *blame,
+                           const apr_array_header_t *chunks);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
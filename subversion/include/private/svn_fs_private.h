@@ -211,6 +211,20 @@ svn_fs__get_deleted_node(svn_fs_root_t **node_root,
                          apr_pool_t *result_pool,
                          apr_pool_t *scratch_pool);
 
+/** Set @a *instance_id to a string that tells @a fs apart from other
+ * filesystems with the same UUID, e.g. from its hotcopies.  Backends and
+ * formats without a per-instance ID return the UUID here.
+ *
+ * Caches shared between filesystems should use it in their namespace.
+ * Allocate @a *instance_id in @a result_pool.
+ *
+ * @since New in 1.11.
+ */
+svn_error_t *
+svn_fs__get_instance_id(const char **instance_id,
+                        svn_fs_t *fs,
+                        apr_pool_t *result_pool);
+
 
 /** @} */
 
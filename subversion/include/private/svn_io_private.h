@@ -84,6 +84,38 @@ svn_error_t *
 svn_io__file_lock_autocreate(const char *lock_file,
                              apr_pool_t *pool);
 
+/**
+ * Create @a to_path as an additional hard link to the existing file
+ * @a from_path.  @a to_path must not exist yet.
+ *
+ * Return an error wrapping the APR status if the file system can't do
+ * that, e.g. APR_EXDEV if both paths are on different devices or
+ * APR_ENOTIMPL on platforms without hard links.  Use @a pool for
+ * temporary allocations.
+ */
+svn_error_t *
+svn_io__file_link(const char *from_path,
+                  const char *to_path,
+                  apr_pool_t *pool);
+
+/**
+ * Copy the whole contents of @a from_file to @a to_file.  Both files must
+ * be at their start position and @a to_file must be empty.  The file
+ * positions are undefined afterwards.
+ *
+ * Where the platform and the file system(s) support it, the data blocks
+ * get shared between both files (copy-on-write) or copied by the kernel
+ * without passing them through user space.  Otherwise, fall back to a
+ * plain read/write loop, calling @a cancel_func with @a cancel_baton
+ * between chunks.  Use @a scratch_pool for temporary allocations.
+ */
+svn_error_t *
+svn_io__file_copy_contents(apr_file_t *to_file,
+                           apr_file_t *from_file,
+                           svn_cancel_func_t cancel_func,
+                           void *cancel_baton,
+                           apr_pool_t *scratch_pool);
+
 
 /** Return the underlying file, if any, associated with the stream, or
  * NULL if not available.  Accessing the file bypasses the stream.
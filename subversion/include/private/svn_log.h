@@ -198,6 +198,15 @@ svn_log__get_file_revs(const char *path, svn_revnum_t start, svn_revnum_t end,
                        svn_boolean_t include_merged_revisions,
                        apr_pool_t *pool);
 
+/**
+ * Return a log string for a get-blame action.
+ *
+ * @since New in 1.11.
+ */
+const char *
+svn_log__get_blame(const char *path, svn_revnum_t start, svn_revnum_t end,
+                   apr_pool_t *pool);
+
 /**
  * Return a log string for a lock action.
  *
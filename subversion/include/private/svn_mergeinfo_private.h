@@ -287,6 +287,74 @@ svn_rangelist__merge_many(svn_rangelist_t *merged_rangelist,
                           apr_pool_t *result_pool,
                           apr_pool_t *scratch_pool);
 
+/* A rangelist whose ranges are stored by value in one contiguous array,
+ * rather than as an array of pointers to separately allocated
+ * svn_merge_range_t objects like svn_rangelist_t.
+ *
+ * The rangelist set operations work on this representation internally;
+ * svn_rangelist__flat_import() and svn_rangelist__flat_export() convert
+ * at the svn_rangelist_t API boundary.  The same invariants as for
+ * svn_rangelist_t apply to RANGES. */
+typedef struct svn_rangelist__flat_t
+{
+  /* The ranges, oldest first. */
+  svn_merge_range_t *ranges;
+
+  /* Number of ranges in RANGES. */
+  int nelts;
+
+  /* Number of ranges allocated for RANGES. */
+  int nalloc;
+
+  /* The pool RANGES gets reallocated in when it needs to grow. */
+  apr_pool_t *pool;
+} svn_rangelist__flat_t;
+
+/* Return a new, empty flat rangelist with room for NALLOC ranges,
+ * allocated in RESULT_POOL. */
+svn_rangelist__flat_t *
+svn_rangelist__flat_create(int nalloc,
+                           apr_pool_t *result_pool);
+
+/* Return a flat copy of RANGELIST, allocated in RESULT_POOL.  RANGELIST
+ * is copied as is, i.e. it is not canonicalized. */
+svn_rangelist__flat_t *
+svn_rangelist__flat_import(const svn_rangelist_t *rangelist,
+                           apr_pool_t *result_pool);
+
+/* Return a deep copy of FLAT as a svn_rangelist_t, allocated in
+ * RESULT_POOL. */
+svn_rangelist_t *
+svn_rangelist__flat_export(const svn_rangelist__flat_t *flat,
+                           apr_pool_t *result_pool);
+
+/* Set *OUTPUT to the union of the canonical flat rangelists RANGELIST and
+ * CHANGES, allocated in RESULT_POOL.  The result is canonical.  See
+ * svn_rangelist_merge2() for details of inheritability etc. */
+svn_error_t *
+svn_rangelist__flat_merge(svn_rangelist__flat_t **output,
+                          const svn_rangelist__flat_t *rangelist,
+                          const svn_rangelist__flat_t *changes,
+                          apr_pool_t *result_pool);
+
+/* Like svn_rangelist_intersect() but for flat rangelists.  Allocate
+ * *OUTPUT in RESULT_POOL. */
+svn_error_t *
+svn_rangelist__flat_intersect(svn_rangelist__flat_t **output,
+                              const svn_rangelist__flat_t *rangelist1,
+                              const svn_rangelist__flat_t *rangelist2,
+                              svn_boolean_t consider_inheritance,
+                              apr_pool_t *result_pool);
+
+/* Like svn_rangelist_remove() but for flat rangelists.  Allocate *OUTPUT
+ * in RESULT_POOL. */
+svn_error_t *
+svn_rangelist__flat_remove(svn_rangelist__flat_t **output,
+                           const svn_rangelist__flat_t *eraser,
+                           const svn_rangelist__flat_t *whiteboard,
+                           svn_boolean_t consider_inheritance,
+                           apr_pool_t *result_pool);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,134 @@
+/**
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ *
+ * @file svn_thread_pool.h
+ * @brief Execute independent tasks on a process-wide worker pool
+ */
+
+#ifndef SVN_THREAD_POOL_H
+#define SVN_THREAD_POOL_H
+
+#include <apr_pools.h>
+
+#include "svn_types.h"
+#include "svn_error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * This is a thin layer on top of @c apr_thread_pool_t.  All task groups
+ * share a single, lazily created thread pool per process.  Each group
+ * limits the number of its tasks that may be in flight at any time,
+ * which gives callers a simple means to bound the memory used by
+ * pending results.
+ *
+ * If APR does not support threading or the group's concurrency is 1 or
+ * less, tasks get executed synchronously by svn_thread_pool__run().
+ *
+ * Tasks must not wait for other tasks.  They must only use the pool
+ * handed to them and data that their submitter does not modify until
+ * the task has completed.
+ */
+
+/** A set of tasks that can be waited for as a whole. */
+typedef struct svn_thread_pool__group_t svn_thread_pool__group_t;
+
+/** Handle to a single task that the submitter wants to wait for. */
+typedef struct svn_thread_pool__task_t svn_thread_pool__task_t;
+
+/** Callback type for tasks.  Execute the task described by @a baton
+ * and use @a result_pool for all allocations.  @a result_pool is private
+ * to the task and remains valid until the submitter calls
+ * svn_thread_pool__task_destroy(), i.e. results may be allocated in it.
+ */
+typedef svn_error_t *
+(*svn_thread_pool__func_t)(void *baton,
+                           apr_pool_t *result_pool);
+
+/** Set @a *group_p to a new task group allocated in @a result_pool.
+ * At most @a concurrency of its tasks will be executed at the same time.
+ *
+ * The group must not be used after @a result_pool got cleared and
+ * svn_thread_pool__group_wait() must have returned before that happens.
+ */
+svn_error_t *
+svn_thread_pool__group_create(svn_thread_pool__group_t **group_p,
+                              int concurrency,
+                              apr_pool_t *result_pool);
+
+/** Return TRUE if tasks added to @a group will actually be executed by
+ * worker threads instead of the calling thread.
+ */
+svn_boolean_t
+svn_thread_pool__group_is_parallel(svn_thread_pool__group_t *group);
+
+/** Schedule @a func with @a baton for execution within @a group.  If the
+ * maximum number of tasks are already in flight for @a group, block until
+ * one of them completed.
+ *
+ * If @a task_p is not @c NULL, set @a *task_p to a handle for the new task
+ * and the caller must eventually call svn_thread_pool__task_destroy() on
+ * it.  Otherwise, the task's error will be returned by
+ * svn_thread_pool__group_wait() and its pool gets released as soon as
+ * the task completed.
+ */
+svn_error_t *
+svn_thread_pool__run(svn_thread_pool__task_t **task_p,
+                     svn_thread_pool__group_t *group,
+                     svn_thread_pool__func_t func,
+                     void *baton);
+
+/** Set @a *done to TRUE, if @a task completed already, and to FALSE
+ * otherwise.  This will never block.
+ */
+svn_error_t *
+svn_thread_pool__task_done(svn_boolean_t *done,
+                           svn_thread_pool__task_t *task);
+
+/** Wait for @a task to complete and return its error.  Only the first
+ * call for a given @a task returns the error; later calls return
+ * #SVN_NO_ERROR.
+ */
+svn_error_t *
+svn_thread_pool__task_wait(svn_thread_pool__task_t *task);
+
+/** Wait for @a task to complete and release all resources held by it,
+ * including the pool passed to its function.  An error not yet collected
+ * by svn_thread_pool__task_wait() will be cleared.  @a task becomes
+ * invalid.
+ */
+void
+svn_thread_pool__task_destroy(svn_thread_pool__task_t *task);
+
+/** Wait for all tasks of @a group to complete and return the combined
+ * errors of those tasks that had no handle.
+ */
+svn_error_t *
+svn_thread_pool__group_wait(svn_thread_pool__group_t *group);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_THREAD_POOL_H */
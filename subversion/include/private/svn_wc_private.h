@@ -988,6 +988,128 @@ svn_wc__node_get_commit_status(svn_boolean_t *added,
                                apr_pool_t *result_pool,
                                apr_pool_t *scratch_pool);
 
+/* A text delta of a committed file, computed ahead of its transmission.
+   See svn_wc__text_delta_prepare(). */
+typedef struct svn_wc__text_delta_t svn_wc__text_delta_t;
+
+/* Return the number of worker threads that the working copy configuration
+   allows operations on WC_CTX to use.  The result is at least 1.  */
+int
+svn_wc__get_worker_threads(svn_wc_context_t *wc_ctx);
+
+/* Split svn_wc_transmit_text_deltas3() into three steps, so that callers
+   can compute the deltas of upcoming files while transmitting others.
+
+   Set *DELTA to the state needed to compute the text delta of the working
+   file LOCAL_ABSPATH against its pristine, or against the empty text if
+   FULLTEXT is TRUE.  This does all working copy database accesses needed
+   up front.  Allocate *DELTA in RESULT_POOL and don't use RESULT_POOL for
+   anything else until svn_wc__text_delta_transmit() returned.  The
+   computation allocates from RESULT_POOL, so if it runs on another thread,
+   RESULT_POOL must not share its allocator with pools that are in use
+   elsewhere at the same time.
+
+   svn_wc__text_delta_compute() then translates the working file, reads it
+   and the pristine, calculates the checksums, spools the delta and writes
+   the new pristine to a temporary file.  It implements
+   svn_thread_pool__func_t with DELTA as baton and does not access any
+   working copy state, i.e. it may be called on any thread.  It may only
+   be called once and must have completed successfully before DELTA can
+   be transmitted.
+
+   svn_wc__text_delta_transmit() sends the spooled delta through EDITOR and
+   FILE_BATON, installs the new pristine and closes FILE_BATON.  It sets
+   *NEW_TEXT_BASE_MD5_CHECKSUM and *NEW_TEXT_BASE_SHA1_CHECKSUM like
+   svn_wc_transmit_text_deltas3() does.
+ */
+svn_error_t *
+svn_wc__text_delta_prepare(svn_wc__text_delta_t **delta,
+                           svn_wc_context_t *wc_ctx,
+                           const char *local_abspath,
+                           svn_boolean_t fulltext,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool);
+
+svn_error_t *
+svn_wc__text_delta_compute(void *delta,
+                           apr_pool_t *scratch_pool);
+
+svn_error_t *
+svn_wc__text_delta_transmit(const svn_checksum_t **new_text_base_md5_checksum,
+                            const svn_checksum_t **new_text_base_sha1_checksum,
+                            svn_wc__text_delta_t *delta,
+                            const svn_delta_editor_t *editor,
+                            void *file_baton,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool);
+
+/* A merge into a working file whose text may be merged ahead of storing
+   the result.  See svn_wc__merge_file_prepare(). */
+typedef struct svn_wc__file_merge_t svn_wc__file_merge_t;
+
+/* Split svn_wc_merge5() into three steps, so that callers can run the
+   three-way merges of several files at the same time.
+
+   Set *MERGE to the state needed to merge the changes between LEFT_ABSPATH
+   and RIGHT_ABSPATH into TARGET_ABSPATH.  The arguments are the same as for
+   svn_wc_merge5(), with MERGE_PROPS corresponding to a non-NULL
+   MERGE_PROPS_OUTCOME.  This does all working copy database accesses
+   needed up front, merges the properties and handles trivial merges as
+   well as merges of binary files right away.  ORIGINAL_PROPS and PROP_DIFF
+   are not used after this function returned.  If COPY_INPUTS is TRUE,
+   LEFT_ABSPATH and RIGHT_ABSPATH are copied if they will be needed later,
+   so that the caller may remove them right away.  Otherwise they must
+   remain until svn_wc__merge_file_install() returned.  Allocate *MERGE in
+   RESULT_POOL.
+
+   svn_wc__merge_file_compute() then runs the three-way merge of the text
+   into a temporary file, if one is needed.  It implements
+   svn_thread_pool__func_t with MERGE as baton and does not access any
+   working copy state, i.e. it may be called on any thread.  It may only
+   be called once and must have completed successfully before MERGE can
+   be installed.
+
+   svn_wc__merge_file_install() records the outcome in the working copy,
+   installs the merged text and invokes CONFLICT_FUNC like svn_wc_merge5()
+   does.  It sets *MERGE_CONTENT_OUTCOME and, if not NULL,
+   *MERGE_PROPS_OUTCOME.  The write lock for TARGET_ABSPATH must be held
+   from svn_wc__merge_file_prepare() until this function returned.
+ */
+svn_error_t *
+svn_wc__merge_file_prepare(svn_wc__file_merge_t **merge,
+                           svn_wc_context_t *wc_ctx,
+                           const char *left_abspath,
+                           const char *right_abspath,
+                           const char *target_abspath,
+                           const char *left_label,
+                           const char *right_label,
+                           const char *target_label,
+                           const svn_wc_conflict_version_t *left_version,
+                           const svn_wc_conflict_version_t *right_version,
+                           svn_boolean_t dry_run,
+                           const char *diff3_cmd,
+                           const apr_array_header_t *merge_options,
+                           apr_hash_t *original_props,
+                           const apr_array_header_t *prop_diff,
+                           svn_boolean_t merge_props,
+                           svn_boolean_t copy_inputs,
+                           svn_cancel_func_t cancel_func,
+                           void *cancel_baton,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool);
+
+svn_error_t *
+svn_wc__merge_file_compute(void *merge,
+                           apr_pool_t *scratch_pool);
+
+svn_error_t *
+svn_wc__merge_file_install(enum svn_wc_merge_outcome_t *merge_content_outcome,
+                           enum svn_wc_notify_state_t *merge_props_outcome,
+                           svn_wc__file_merge_t *merge,
+                           svn_wc_conflict_resolver_func2_t conflict_func,
+                           void *conflict_baton,
+                           apr_pool_t *scratch_pool);
+
 /* Gets the md5 checksum for the pristine file identified by a sha1_checksum in the
    working copy identified by wri_abspath.
 
@@ -2102,6 +2224,45 @@ svn_wc__translated_stream(svn_stream_t **stream,
                           apr_pool_t *result_pool,
                           apr_pool_t *scratch_pool);
 
+/* Watch the working copy rooted at LOCAL_ABSPATH for changes on disk and
+   record the directories they affect in a change journal in the working
+   copy's administrative area, until CANCEL_FUNC returns an error.
+
+   While the journal is maintained, svn_wc__walk_status_journaled() skips
+   reading directories that are known to match the working copy DB.
+
+   Return SVN_ERR_WC_LOCKED if the working copy is already being watched
+   and SVN_ERR_UNSUPPORTED_FEATURE if the platform provides no suitable
+   change notification mechanism.  Use SCRATCH_POOL for all allocations. */
+svn_error_t *
+svn_wc__watch_changes(svn_wc_context_t *wc_ctx,
+                      const char *local_abspath,
+                      svn_cancel_func_t cancel_func,
+                      void *cancel_baton,
+                      apr_pool_t *scratch_pool);
+
+/* Like svn_wc_walk_status(), but meant for showing the status of a tree
+   to the user.  If DEPTH is not svn_depth_empty and svn_wc__watch_changes()
+   keeps a change journal for the working copy, don't read the directories
+   that the journal lists as unchanged.
+
+   Consulting the journal means waiting for the watcher to catch up with
+   all changes made so far, so other callers should stick with
+   svn_wc_walk_status(). */
+svn_error_t *
+svn_wc__walk_status_journaled(svn_wc_context_t *wc_ctx,
+                              const char *local_abspath,
+                              svn_depth_t depth,
+                              svn_boolean_t get_all,
+                              svn_boolean_t no_ignore,
+                              svn_boolean_t ignore_text_mods,
+                              const apr_array_header_t *ignore_patterns,
+                              svn_wc_status_func4_t status_func,
+                              void *status_baton,
+                              svn_cancel_func_t cancel_func,
+                              void *cancel_baton,
+                              apr_pool_t *scratch_pool);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -2926,6 +2926,12 @@ svn_client_log(const apr_array_header_t *targets,
  * If @a include_merged_revisions is TRUE, also return data based upon
  * revisions which have been merged to @a path_or_url.
  *
+ * If the #SVN_CONFIG_OPTION_BLAME_CACHE_DIR option is set in @a ctx->config,
+ * blame computed from @a start towards a younger @a end is stored in that
+ * directory, and a later blame of a younger revision of the same file
+ * starts from it rather than from @a start.  Blame including merged
+ * revisions is never cached.  (Since 1.11.)
+ *
  * Use @a pool for any temporary allocation.
  *
  * @since New in 1.7.
@@ -6414,10 +6420,38 @@ svn_client_revprop_list(apr_hash_t **props,
  * @a depth is #svn_depth_empty, then export exactly @a
  * from_path_or_url and none of its children.
  *
+ * If @a jobs is greater than 1, up to that many files of an export from
+ * a repository are translated and written to disk in parallel while
+ * further data is being received.  Notifications for files may then be
+ * delayed a little, but they are still sent in order and from the calling
+ * thread.
+ *
  * All allocations are done in @a pool.
  *
+ * @since New in 1.11.
+ */
+svn_error_t *
+svn_client_export6(svn_revnum_t *result_rev,
+                   const char *from_path_or_url,
+                   const char *to_path,
+                   const svn_opt_revision_t *peg_revision,
+                   const svn_opt_revision_t *revision,
+                   svn_boolean_t overwrite,
+                   svn_boolean_t ignore_externals,
+                   svn_boolean_t ignore_keywords,
+                   svn_depth_t depth,
+                   const char *native_eol,
+                   int jobs,
+                   svn_client_ctx_t *ctx,
+                   apr_pool_t *pool);
+
+/**
+ * Similar to svn_client_export6(), but with @a jobs set to 1.
+ *
+ * @deprecated Provided for backward compatibility with the 1.10 API.
  * @since New in 1.7.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_client_export5(svn_revnum_t *result_rev,
                    const char *from_path_or_url,
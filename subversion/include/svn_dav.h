@@ -422,6 +422,15 @@ extern "C" {
 #define SVN_DAV_NS_DAV_SVN_PUT_RESULT_CHECKSUM\
             SVN_DAV_PROP_NS_DAV "svn/put-result-checksum"
 
+/** Presence of this in a DAV header in an OPTIONS response indicates
+ * that the transmitter (in this case, the server) knows how to handle
+ * 'blame-report' requests.
+ *
+ * @since New in 1.11.
+ */
+#define SVN_DAV_NS_DAV_SVN_SERVER_BLAME\
+            SVN_DAV_PROP_NS_DAV "svn/server-blame"
+
 /** @} */
 
 /** @} */
@@ -455,6 +455,26 @@ typedef enum svn_diff_file_ignore_space_t
   svn_diff_file_ignore_space_all
 } svn_diff_file_ignore_space_t;
 
+/** The algorithm used to find the differences between two texts.
+ *
+ * @since New in 1.11.
+ */
+typedef enum svn_diff_file_algorithm_t
+{
+  /** Find a minimal set of differences, using the O(NP) longest common
+   * subsequence algorithm. */
+  svn_diff_file_algorithm_lcs,
+
+  /** Recursively match the texts on their least frequent common lines,
+   * like the "histogram" algorithm of git.  This is usually much faster
+   * than @c svn_diff_file_algorithm_lcs on large texts with many
+   * differences, and tends to keep moved blocks of code together, but the
+   * result is not guaranteed to be minimal.  Only used for two-way diffs;
+   * three- and four-way diffs always use @c svn_diff_file_algorithm_lcs.
+   */
+  svn_diff_file_algorithm_histogram
+} svn_diff_file_algorithm_t;
+
 /** Options to control the behaviour of the file diff routines.
  *
  * @since New in 1.4.
@@ -487,6 +507,29 @@ typedef struct svn_diff_file_options_t
    *
    * @since New in 1.9 */
   int context_size;
+
+  /** The algorithm used to compare the texts.  The default is
+   * @c svn_diff_file_algorithm_lcs.
+   *
+   * @since New in 1.11 */
+  svn_diff_file_algorithm_t algorithm;
+
+  /** The maximum number of threads used to find the differences of a
+   * three-way diff.  Values of 1 or less, the default, make the diff run
+   * on the calling thread only.  Callers that already run several diffs
+   * on worker threads should leave this at its default.
+   *
+   * @since New in 1.11 */
+  int diff3_threads;
+
+  /** Whether three-way diffs of large texts may be split into sections
+   * at lines that are identical in all texts and compare these sections
+   * independently of each other.  This is much faster on large texts
+   * with few changes and gives a valid diff, albeit not necessarily the
+   * minimal one.  The default is @c FALSE.
+   *
+   * @since New in 1.11 */
+  svn_boolean_t diff3_chunked;
 } svn_diff_file_options_t;
 
 /** Allocate a @c svn_diff_file_options_t structure in @a pool, initializing
@@ -510,6 +553,8 @@ svn_diff_file_options_create(apr_pool_t *pool);
  * - --ignore-eol-style
  * - --show-c-function, -p @since New in 1.5.
  * - --context, -U ARG @since New in 1.9.
+ * - --histogram @since New in 1.11.
+ * - --chunked (sets @c diff3_chunked) @since New in 1.11.
  * - --unified, -u (for compatibility, does nothing).
  */
 svn_error_t *
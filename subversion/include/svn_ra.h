@@ -1872,6 +1872,55 @@ svn_ra_get_file_revs2(svn_ra_session_t *session,
                       void *handler_baton,
                       apr_pool_t *pool);
 
+/**
+ * Callback type for svn_ra_get_blame().  The lines of the blamed file
+ * from @a start_line (counting from 0) up to the @a start_line of the next
+ * invocation, or up to the end of the file, were last changed in
+ * @a revision, whose revision properties are @a rev_props.  For lines that
+ * were last changed before the start of the blamed range, @a revision is
+ * #SVN_INVALID_REVNUM and @a rev_props is @c NULL.  The range of the last
+ * invocation may start at the end of the file and be empty.
+ *
+ * @a rev_props may be @c NULL if the same @a revision has been reported
+ * before.  Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.11.
+ */
+typedef svn_error_t *(*svn_ra_blame_receiver_t)(void *baton,
+                                                apr_int64_t start_line,
+                                                svn_revnum_t revision,
+                                                apr_hash_t *rev_props,
+                                                apr_pool_t *scratch_pool);
+
+/**
+ * Let the server compute the blame of the file at @a path (relative to
+ * @a session's URL) as seen in revision @a end, attributing each line to
+ * the last revision between @a start and @a end that changed it, and
+ * report the result to @a receiver with @a receiver_baton, in file order.
+ *
+ * This is what a client gets from svn_ra_get_file_revs2() with
+ * @a include_merged_revisions set to @c FALSE and by diffing successive
+ * fulltexts with the default #svn_diff_file_options_t, but without
+ * transferring all these fulltexts.  @a start must not be younger than
+ * @a end.
+ *
+ * If the server doesn't support server-side blame, return
+ * #SVN_ERR_UNSUPPORTED_FEATURE in preference to any other error that
+ * might otherwise be returned.
+ *
+ * Use @a scratch_pool for temporary memory allocation.
+ *
+ * @since New in 1.11.
+ */
+svn_error_t *
+svn_ra_get_blame(svn_ra_session_t *session,
+                 const char *path,
+                 svn_revnum_t start,
+                 svn_revnum_t end,
+                 svn_ra_blame_receiver_t receiver,
+                 void *receiver_baton,
+                 apr_pool_t *scratch_pool);
+
 /**
  * Similar to svn_ra_get_file_revs2(), but with @a include_merged_revisions
  * set to FALSE.
@@ -2239,6 +2288,13 @@ svn_ra_has_capability(svn_ra_session_t *session,
  */
 #define SVN_RA_CAPABILITY_LIST "list"
 
+/**
+ * The capability of a server to compute blame with svn_ra_get_blame().
+ *
+ * @since New in 1.11.
+ */
+#define SVN_RA_CAPABILITY_SERVER_BLAME "server-blame"
+
 
 /*       *** PLEASE READ THIS IF YOU ADD A NEW CAPABILITY ***
  *
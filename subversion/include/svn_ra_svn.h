@@ -71,6 +71,8 @@ extern "C" {
 #define SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE "file-revs-reverse"
 /* maps to SVN_RA_CAPABILITY_LIST */
 #define SVN_RA_SVN_CAP_LIST "list"
+/* maps to SVN_RA_CAPABILITY_SERVER_BLAME */
+#define SVN_RA_SVN_CAP_SERVER_BLAME "server-blame"
 
 
 /** ra_svn passes @c svn_dirent_t fields over the wire as a list of
@@ -2457,6 +2457,59 @@ svn_repos_get_file_revs(svn_repos_t *repos,
                         void *handler_baton,
                         apr_pool_t *pool);
 
+/**
+ * Callback type for svn_repos_get_blame().  The lines of the blamed file
+ * from @a start_line (counting from 0) up to the @a start_line of the next
+ * invocation, or up to the end of the file, were last changed in
+ * @a revision, whose revision properties are @a rev_props.  For lines that
+ * have not changed since the start of the blamed range, @a revision is
+ * #SVN_INVALID_REVNUM and @a rev_props is @c NULL.  The range of the last
+ * invocation may start at the end of the file and be empty.
+ *
+ * @since New in 1.11.
+ */
+typedef svn_error_t *(*svn_repos_blame_receiver_t)(void *baton,
+                                                   apr_int64_t start_line,
+                                                   svn_revnum_t revision,
+                                                   apr_hash_t *rev_props,
+                                                   apr_pool_t *scratch_pool);
+
+/**
+ * Compute blame for the file @a path in @a repos as seen in revision
+ * @a end, attributing every line to the revision that last changed it,
+ * but to none before @a start, which must not be younger than @a end.
+ * Invoke @a receiver with @a receiver_baton for each run of lines
+ * attributed to the same revision, in file order.
+ *
+ * The revisions are compared with svn_diff_file_diff_2() and default
+ * options, so the result matches what a client computes from the
+ * revisions returned by svn_repos_get_file_revs2().
+ *
+ * @a authz_read_func and @a authz_read_baton are used as for
+ * svn_repos_get_file_revs2(), and also to read the revision properties
+ * passed to @a receiver.  Blame computed without @a authz_read_func is
+ * kept in the process-wide membuffer cache, keyed by @a path, the
+ * revision in which the file last changed and @a start, so that blaming
+ * the same file again costs next to nothing.
+ *
+ * Use @a cancel_func and @a cancel_baton to allow cancellation, and
+ * @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.11.
+ */
+svn_error_t *
+svn_repos_get_blame(svn_repos_t *repos,
+                    const char *path,
+                    svn_revnum_t start,
+                    svn_revnum_t end,
+                    svn_repos_authz_func_t authz_read_func,
+                    void *authz_read_baton,
+                    svn_repos_blame_receiver_t receiver,
+                    void *receiver_baton,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *scratch_pool);
+
 
 /* ---------------------------------------------------------------*/
 
@@ -213,6 +213,52 @@ svn_error_t *
 svn_wc_context_destroy(svn_wc_context_t *wc_ctx);
 
 
+/** A long-lived working copy session.
+ *
+ * Creating a context with svn_wc_context_create() for every operation
+ * means opening the working copy database, locating the working copy
+ * root and preparing the SQL statements over and over again.  Contexts
+ * created within a session share all of that instead.  Before a working
+ * copy known to the session is used by a new context, the session checks
+ * that its database is still the same file in the same format, so working
+ * copies that get deleted, re-created or upgraded by other processes are
+ * picked up again.  The same goes for directories that became working
+ * copies of their own.
+ *
+ * The contexts of a session must not be used concurrently, i.e. an
+ * application that runs operations on several threads at once needs one
+ * session per thread.
+ *
+ * @since New in 1.11.
+ */
+typedef struct svn_wc_session_t svn_wc_session_t;
+
+/** Create a working copy session in @a *session, using @a config like
+ * svn_wc_context_create() does.  The session will be allocated in
+ * @a result_pool and will be closed when that pool gets cleared or
+ * destroyed.  Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.11.
+ */
+svn_error_t *
+svn_wc_session_create(svn_wc_session_t **session,
+                      const svn_config_t *config,
+                      apr_pool_t *result_pool,
+                      apr_pool_t *scratch_pool);
+
+/** Create a context for one or more operations within @a session and
+ * return it in @a *wc_ctx.  The context is allocated in @a result_pool,
+ * which must not outlive the pool of @a session.  Destroying the context
+ * leaves the working copy databases of @a session open.
+ *
+ * @since New in 1.11.
+ */
+svn_error_t *
+svn_wc_session_context_create(svn_wc_context_t **wc_ctx,
+                              svn_wc_session_t *session,
+                              apr_pool_t *result_pool);
+
+
 /** @} */
 
 
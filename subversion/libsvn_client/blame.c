@@ -36,13 +36,15 @@
 #include "svn_props.h"
 #include "svn_hash.h"
 #include "svn_sorts.h"
+#include "svn_checksum.h"
+#include "svn_config.h"
 
+#include "private/svn_diff_private.h"
+#include "private/svn_fspath.h"
 #include "private/svn_wc_private.h"
 
 #include "svn_private_config.h"
 
-#include <assert.h>
-
 /* The metadata associated with a particular revision. */
 struct rev
 {
@@ -52,28 +54,6 @@ struct rev
   const char *path;      /* the absolute repository path */
 };
 
-/* One chunk of blame */
-struct blame
-{
-  const struct rev *rev;    /* the responsible revision */
-  apr_off_t start;          /* the starting diff-token (line) */
-  struct blame *next;       /* the next chunk */
-};
-
-/* A chain of blame chunks */
-struct blame_chain
-{
-  struct blame *blame;      /* linked list of blame chunks */
-  struct blame *avail;      /* linked list of free blame chunks */
-  struct apr_pool_t *pool;  /* Allocate members from this pool. */
-};
-
-/* The baton use for the diff output routine. */
-struct diff_baton {
-  struct blame_chain *chain;
-  const struct rev *rev;
-};
-
 /* The baton used for a file revision. Lives the entire operation */
 struct file_rev_baton {
   svn_revnum_t start_rev, end_rev;
@@ -84,7 +64,7 @@ struct file_rev_baton {
   /* name of file containing the previous revision of the file */
   const char *last_filename;
   struct rev *last_rev;   /* the rev of the last modification */
-  struct blame_chain *chain;      /* the original blame chain. */
+  svn_diff__blame_t *chain;      /* the original blame chain. */
   const char *repos_root_url;    /* To construct a url */
   apr_pool_t *mainpool;  /* lives during the whole sequence of calls */
   apr_pool_t *lastpool;  /* pool used during previous call */
@@ -92,7 +72,7 @@ struct file_rev_baton {
 
   /* These are used for tracking merged revisions. */
   svn_boolean_t include_merged_revisions;
-  struct blame_chain *merged_chain;  /* the merged blame chain. */
+  svn_diff__blame_t *merged_chain;  /* the merged blame chain. */
   /* name of file containing the previous merged revision of the file */
   const char *last_original_filename;
   /* pools for files which may need to persist for more than one rev. */
@@ -106,6 +86,10 @@ struct file_rev_baton {
      happens when we move to the previous revision */
   svn_revnum_t last_revnum;
   apr_hash_t *last_props;
+
+  /* CHAIN was loaded from the blame cache and is up to date as of this
+     revision, or SVN_INVALID_REVNUM. */
+  svn_revnum_t cached_revnum;
 };
 
 /* The baton used by the txdelta window handler. Allocated per revision */
@@ -117,178 +101,20 @@ struct delta_baton {
   svn_stream_t *source_stream;  /* the delta source */
   const char *filename;
   svn_boolean_t is_merged_revision;
+  svn_boolean_t is_cached;  /* blame for this revision is already known */
   struct rev *rev;     /* the rev struct for the current revision */
 };
 
 
 
 
-/* Return a blame chunk associated with REV for a change starting
-   at token START, and allocated in CHAIN->mainpool. */
-static struct blame *
-blame_create(struct blame_chain *chain,
-             const struct rev *rev,
-             apr_off_t start)
-{
-  struct blame *blame;
-  if (chain->avail)
-    {
-      blame = chain->avail;
-      chain->avail = blame->next;
-    }
-  else
-    blame = apr_palloc(chain->pool, sizeof(*blame));
-  blame->rev = rev;
-  blame->start = start;
-  blame->next = NULL;
-  return blame;
-}
-
-/* Destroy a blame chunk. */
-static void
-blame_destroy(struct blame_chain *chain,
-              struct blame *blame)
-{
-  blame->next = chain->avail;
-  chain->avail = blame;
-}
-
-/* Return the blame chunk that contains token OFF, starting the search at
-   BLAME. */
-static struct blame *
-blame_find(struct blame *blame, apr_off_t off)
-{
-  struct blame *prev = NULL;
-  while (blame)
-    {
-      if (blame->start > off) break;
-      prev = blame;
-      blame = blame->next;
-    }
-  return prev;
-}
-
-/* Shift the start-point of BLAME and all subsequence blame-chunks
-   by ADJUST tokens */
-static void
-blame_adjust(struct blame *blame, apr_off_t adjust)
-{
-  while (blame)
-    {
-      blame->start += adjust;
-      blame = blame->next;
-    }
-}
-
-/* Delete the blame associated with the region from token START to
-   START + LENGTH */
-static svn_error_t *
-blame_delete_range(struct blame_chain *chain,
-                   apr_off_t start,
-                   apr_off_t length)
-{
-  struct blame *first = blame_find(chain->blame, start);
-  struct blame *last = blame_find(chain->blame, start + length);
-  struct blame *tail = last->next;
-
-  if (first != last)
-    {
-      struct blame *walk = first->next;
-      while (walk != last)
-        {
-          struct blame *next = walk->next;
-          blame_destroy(chain, walk);
-          walk = next;
-        }
-      first->next = last;
-      last->start = start;
-      if (first->start == start)
-        {
-          *first = *last;
-          blame_destroy(chain, last);
-          last = first;
-        }
-    }
-
-  if (tail && tail->start == last->start + length)
-    {
-      *last = *tail;
-      blame_destroy(chain, tail);
-      tail = last->next;
-    }
-
-  blame_adjust(tail, -length);
-
-  return SVN_NO_ERROR;
-}
-
-/* Insert a chunk of blame associated with REV starting
-   at token START and continuing for LENGTH tokens */
-static svn_error_t *
-blame_insert_range(struct blame_chain *chain,
-                   const struct rev *rev,
-                   apr_off_t start,
-                   apr_off_t length)
-{
-  struct blame *head = chain->blame;
-  struct blame *point = blame_find(head, start);
-  struct blame *insert;
-
-  if (point->start == start)
-    {
-      insert = blame_create(chain, point->rev, point->start + length);
-      point->rev = rev;
-      insert->next = point->next;
-      point->next = insert;
-    }
-  else
-    {
-      struct blame *middle;
-      middle = blame_create(chain, rev, start);
-      insert = blame_create(chain, point->rev, start + length);
-      middle->next = insert;
-      insert->next = point->next;
-      point->next = middle;
-    }
-  blame_adjust(insert->next, length);
-
-  return SVN_NO_ERROR;
-}
-
-/* Callback for diff between subsequent revisions */
-static svn_error_t *
-output_diff_modified(void *baton,
-                     apr_off_t original_start,
-                     apr_off_t original_length,
-                     apr_off_t modified_start,
-                     apr_off_t modified_length,
-                     apr_off_t latest_start,
-                     apr_off_t latest_length)
-{
-  struct diff_baton *db = baton;
-
-  if (original_length)
-    SVN_ERR(blame_delete_range(db->chain, modified_start, original_length));
-
-  if (modified_length)
-    SVN_ERR(blame_insert_range(db->chain, db->rev, modified_start,
-                               modified_length));
-
-  return SVN_NO_ERROR;
-}
-
-static const svn_diff_output_fns_t output_fns = {
-        NULL,
-        output_diff_modified
-};
-
 /* Add the blame for the diffs between LAST_FILE and CUR_FILE to CHAIN,
    for revision REV.  LAST_FILE may be NULL in which
    case blame is added for every line of CUR_FILE. */
 static svn_error_t *
 add_file_blame(const char *last_file,
                const char *cur_file,
-               struct blame_chain *chain,
+               svn_diff__blame_t *chain,
                struct rev *rev,
                const svn_diff_file_options_t *diff_options,
                svn_cancel_func_t cancel_func,
@@ -297,22 +123,18 @@ add_file_blame(const char *last_file,
 {
   if (!last_file)
     {
-      SVN_ERR_ASSERT(chain->blame == NULL);
-      chain->blame = blame_create(chain, rev, 0);
+      SVN_ERR_ASSERT(svn_diff__blame_is_empty(chain));
+      svn_diff__blame_reset(chain, rev);
     }
   else
     {
       svn_diff_t *diff;
-      struct diff_baton diff_baton;
-
-      diff_baton.chain = chain;
-      diff_baton.rev = rev;
 
       /* We have a previous file.  Get the diff and adjust blame info. */
       SVN_ERR(svn_diff_file_diff_2(&diff, last_file, cur_file,
                                    diff_options, pool));
-      SVN_ERR(svn_diff_output2(diff, &diff_baton, &output_fns,
-                               cancel_func, cancel_baton));
+      SVN_ERR(svn_diff__blame_update(chain, diff, rev,
+                                     cancel_func, cancel_baton));
     }
 
   return SVN_NO_ERROR;
@@ -325,7 +147,7 @@ update_blame(void *baton)
 {
   struct delta_baton *dbaton = baton;
   struct file_rev_baton *frb = dbaton->file_rev_baton;
-  struct blame_chain *chain;
+  svn_diff__blame_t *chain;
 
   /* Close the source file used for the delta.
      It is important to do this early, since otherwise, they will be deleted
@@ -341,12 +163,13 @@ update_blame(void *baton)
   else
     chain = frb->chain;
 
-  /* Process this file. */
-  SVN_ERR(add_file_blame(frb->last_filename,
-                         dbaton->filename, chain, dbaton->rev,
-                         frb->diff_options,
-                         frb->ctx->cancel_func, frb->ctx->cancel_baton,
-                         frb->currpool));
+  /* Process this file, unless the cached blame already covers it. */
+  if (!dbaton->is_cached)
+    SVN_ERR(add_file_blame(frb->last_filename,
+                           dbaton->filename, chain, dbaton->rev,
+                           frb->diff_options,
+                           frb->ctx->cancel_func, frb->ctx->cancel_baton,
+                           frb->currpool));
 
   /* If we are including merged revisions, and the current revision is not a
      merged one, we need to add its blame info to the chain for the original
@@ -515,6 +338,8 @@ file_rev_handler(void *baton, const char *path, svn_revnum_t revnum,
   /* Wrap the window handler with our own. */
   delta_baton->file_rev_baton = frb;
   delta_baton->is_merged_revision = merged_revision;
+  delta_baton->is_cached = (SVN_IS_VALID_REVNUM(frb->cached_revnum)
+                            && revnum <= frb->cached_revnum);
 
   /* Create the rev structure. */
   delta_baton->rev = apr_pcalloc(frb->mainpool, sizeof(struct rev));
@@ -591,68 +416,478 @@ file_rev_handler(void *baton, const char *path, svn_revnum_t revnum,
   return SVN_NO_ERROR;
 }
 
-/* Ensure that CHAIN_ORIG and CHAIN_MERGED have the same number of chunks,
-   and that for every chunk C, CHAIN_ORIG[C] and CHAIN_MERGED[C] have the
-   same starting value.  Both CHAIN_ORIG and CHAIN_MERGED should not be
-   NULL.  */
-static void
-normalize_blames(struct blame_chain *chain,
-                 struct blame_chain *chain_merged,
-                 apr_pool_t *pool)
+/* The on-disk blame cache.
+
+   If the blame-cache-dir option is set, the blame computed for a file up
+   to revision R is saved in that directory, keyed by the repository, the
+   path of the file in R, the start revision and the diff options.  When
+   a younger revision of the same line of history is blamed later, that
+   blame is loaded and only the revisions after R are fetched and diffed.
+
+   Each entry holds the format line, R, the revisions referenced by the
+   blame and the blame chunks as (revision index, starting token) pairs.
+   Revision properties can change at any time, so they are not cached but
+   fetched again whenever an entry is used. */
+#define BLAME_CACHE_FORMAT "SVN-BLAME-CACHE 2"
+
+/* Set *CACHE_PATH to the blame cache entry for blaming LOC starting at
+   START_REV with DIFF_OPTIONS, or to NULL if CTX does not configure a
+   blame cache.  Allocate *CACHE_PATH in RESULT_POOL. */
+static svn_error_t *
+get_blame_cache_path(const char **cache_path,
+                     const svn_client__pathrev_t *loc,
+                     svn_revnum_t start_rev,
+                     const svn_diff_file_options_t *diff_options,
+                     svn_client_ctx_t *ctx,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
 {
-  struct blame *walk, *walk_merged;
+  svn_config_t *cfg = ctx->config
+                      ? svn_hash_gets(ctx->config, SVN_CONFIG_CATEGORY_CONFIG)
+                      : NULL;
+  const char *cache_dir;
+  const char *key;
+  svn_checksum_t *checksum;
+
+  svn_config_get(cfg, &cache_dir, SVN_CONFIG_SECTION_MISCELLANY,
+                 SVN_CONFIG_OPTION_BLAME_CACHE_DIR, NULL);
+  if (!cache_dir || !*cache_dir)
+    {
+      *cache_path = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(svn_path_cstring_to_utf8(&cache_dir, cache_dir, scratch_pool));
+  SVN_ERR(svn_dirent_get_absolute(&cache_dir,
+                                  svn_dirent_internal_style(cache_dir,
+                                                            scratch_pool),
+                                  scratch_pool));
+
+  key = apr_psprintf(scratch_pool, "%s\n%s\n%ld\n%d %d %d",
+                     loc->repos_uuid,
+                     svn_uri_skip_ancestor(loc->repos_root_url, loc->url,
+                                           scratch_pool),
+                     start_rev,
+                     diff_options ? (int)diff_options->ignore_space : 0,
+                     diff_options ? diff_options->ignore_eol_style : 0,
+                     diff_options ? (int)diff_options->algorithm : 0);
+  SVN_ERR(svn_checksum(&checksum, svn_checksum_sha1, key, strlen(key),
+                       scratch_pool));
+
+  *cache_path = svn_dirent_join(cache_dir,
+                                svn_checksum_to_cstring_display(checksum,
+                                                                scratch_pool),
+                                result_pool);
+  return SVN_NO_ERROR;
+}
+
+/* Read a line of up to two space separated numbers from STREAM into
+   *FIRST and, if SECOND is not NULL, *SECOND. */
+static svn_error_t *
+read_cache_numbers(apr_int64_t *first,
+                   apr_int64_t *second,
+                   svn_stream_t *stream,
+                   apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *line;
+  svn_boolean_t eof;
+  char *sep;
+
+  SVN_ERR(svn_stream_readline(stream, &line, "\n", &eof, scratch_pool));
+  sep = strchr(line->data, ' ');
+  if (eof || (second != NULL) != (sep != NULL))
+    return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL, NULL);
 
-  /* Walk over the CHAIN's blame chunks and CHAIN_MERGED's blame chunks,
-     creating new chunks as needed. */
-  for (walk = chain->blame, walk_merged = chain_merged->blame;
-       walk->next && walk_merged->next;
-       walk = walk->next, walk_merged = walk_merged->next)
+  if (second)
     {
-      /* The current chunks should always be starting at the same offset. */
-      assert(walk->start == walk_merged->start);
+      *sep = '\0';
+      SVN_ERR(svn_cstring_atoi64(second, sep + 1));
+    }
+  return svn_error_trace(svn_cstring_atoi64(first, line->data));
+}
 
-      if (walk->next->start < walk_merged->next->start)
-        {
-          /* insert a new chunk in CHAIN_MERGED. */
-          struct blame *tmp = blame_create(chain_merged, walk_merged->rev,
-                                           walk->next->start);
-          tmp->next = walk_merged->next;
-          walk_merged->next = tmp;
-        }
+/* Open the blame cache entry CACHE_PATH as *STREAM and read the revision
+   it is up to date as of into *REVISION.  If there is no entry, set
+   *STREAM to NULL and *REVISION to SVN_INVALID_REVNUM. */
+static svn_error_t *
+open_blame_cache(svn_stream_t **stream,
+                 svn_revnum_t *revision,
+                 const char *cache_path,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *line;
+  svn_boolean_t eof;
+  apr_int64_t value;
+  svn_error_t *err;
+
+  *revision = SVN_INVALID_REVNUM;
+
+  err = svn_stream_open_readonly(stream, cache_path, result_pool,
+                                 scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      *stream = NULL;
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  SVN_ERR(svn_stream_readline(*stream, &line, "\n", &eof, scratch_pool));
+  if (strcmp(line->data, BLAME_CACHE_FORMAT) != 0)
+    return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL, NULL);
+
+  SVN_ERR(read_cache_numbers(&value, NULL, *stream, scratch_pool));
+  *revision = (svn_revnum_t)value;
+  return SVN_NO_ERROR;
+}
+
+/* Write the blame in CHAIN, which is up to date as of REVISION, to the
+   blame cache entry CACHE_PATH, unless that entry is already up to date
+   as of REVISION or a younger revision. */
+static svn_error_t *
+write_blame_cache(const char *cache_path,
+                  svn_revnum_t revision,
+                  const svn_diff__blame_t *chain,
+                  apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *buf = svn_stringbuf_create_empty(scratch_pool);
+  svn_stream_t *stream;
+  apr_array_header_t *chunks;
+  apr_array_header_t *revs;
+  apr_hash_t *rev_index = apr_hash_make(scratch_pool);
+  svn_revnum_t cached_revision;
+  svn_error_t *err;
+  int i;
+
+  /* Don't replace the blame of a younger revision, which blaming an older
+     one can't make use of, with that of an older one. */
+  err = open_blame_cache(&stream, &cached_revision, cache_path,
+                         scratch_pool, scratch_pool);
+  if (err)
+    svn_error_clear(err);
+  else if (stream)
+    {
+      SVN_ERR(svn_stream_close(stream));
+      if (cached_revision >= revision)
+        return SVN_NO_ERROR;
+    }
+
+  stream = svn_stream_from_stringbuf(buf, scratch_pool);
+  chunks = svn_diff__blame_chunks(chain, scratch_pool);
+  revs = apr_array_make(scratch_pool, chunks->nelts,
+                        sizeof(const struct rev *));
 
-      if (walk->next->start > walk_merged->next->start)
+  /* Number the distinct revisions in order of their first use. */
+  for (i = 0; i < chunks->nelts; i++)
+    {
+      svn_diff__blame_chunk_t *chunk
+        = &APR_ARRAY_IDX(chunks, i, svn_diff__blame_chunk_t);
+
+      if (chunk->baton
+          && !apr_hash_get(rev_index, &chunk->baton, sizeof(chunk->baton)))
         {
-          /* insert a new chunk in CHAIN. */
-          struct blame *tmp = blame_create(chain, walk->rev,
-                                           walk_merged->next->start);
-          tmp->next = walk->next;
-          walk->next = tmp;
+          APR_ARRAY_PUSH(revs, const struct rev *) = chunk->baton;
+          apr_hash_set(rev_index, &chunk->baton, sizeof(chunk->baton),
+                       apr_pmemdup(scratch_pool, &revs->nelts,
+                                   sizeof(revs->nelts)));
         }
     }
 
-  /* If both NEXT pointers are null, the lists are equally long, otherwise
-     we need to extend one of them.  If CHAIN is longer, append new chunks
-     to CHAIN_MERGED until its length matches that of CHAIN. */
-  while (walk->next != NULL)
+  SVN_ERR(svn_stream_printf(stream, scratch_pool, BLAME_CACHE_FORMAT "\n"
+                            "%ld\n%d\n", revision, revs->nelts));
+  for (i = 0; i < revs->nelts; i++)
+    {
+      const struct rev *rev = APR_ARRAY_IDX(revs, i, const struct rev *);
+
+      SVN_ERR(svn_stream_printf(stream, scratch_pool, "%ld\n",
+                                rev->revision));
+    }
+
+  SVN_ERR(svn_stream_printf(stream, scratch_pool, "%d\n", chunks->nelts));
+  for (i = 0; i < chunks->nelts; i++)
     {
-      struct blame *tmp = blame_create(chain_merged, walk_merged->rev,
-                                       walk->next->start);
-      walk_merged->next = tmp;
+      svn_diff__blame_chunk_t *chunk
+        = &APR_ARRAY_IDX(chunks, i, svn_diff__blame_chunk_t);
+      int index = 0;
+
+      if (chunk->baton)
+        index = *(int *)apr_hash_get(rev_index, &chunk->baton,
+                                     sizeof(chunk->baton));
+
+      SVN_ERR(svn_stream_printf(stream, scratch_pool,
+                                "%d %" APR_OFF_T_FMT "\n",
+                                index - 1, chunk->start));
+    }
+
+  SVN_ERR(svn_io_make_dir_recursively(svn_dirent_dirname(cache_path,
+                                                         scratch_pool),
+                                      scratch_pool));
+  return svn_error_trace(svn_io_write_atomic2(cache_path, buf->data, buf->len,
+                                              NULL, FALSE, scratch_pool));
+}
+
+/* Read the blame cache entry CACHE_PATH.  Set *REVISION to the revision
+   it is up to date as of, *REVS to the revisions it references, as
+   struct rev * without revision properties, and *CHUNKS to its chunks in
+   file order, as svn_diff__blame_chunk_t, all allocated in RESULT_POOL.
+   If there is no entry, set *REVISION to SVN_INVALID_REVNUM. */
+static svn_error_t *
+read_blame_cache(svn_revnum_t *revision,
+                 apr_array_header_t **revs,
+                 apr_array_header_t **chunks,
+                 const char *cache_path,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  svn_stream_t *stream;
+  svn_revnum_t value;
+  apr_int64_t count, index, start;
+  int i;
+
+  *revision = SVN_INVALID_REVNUM;
+
+  SVN_ERR(open_blame_cache(&stream, &value, cache_path, scratch_pool,
+                           scratch_pool));
+  if (!stream)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(read_cache_numbers(&count, NULL, stream, scratch_pool));
+  *revs = apr_array_make(result_pool, (int)count, sizeof(struct rev *));
+  for (i = 0; i < count; i++)
+    {
+      struct rev *rev = apr_pcalloc(result_pool, sizeof(*rev));
+
+      SVN_ERR(read_cache_numbers(&index, NULL, stream, scratch_pool));
+      rev->revision = (svn_revnum_t)index;
+      APR_ARRAY_PUSH(*revs, struct rev *) = rev;
+    }
+
+  SVN_ERR(read_cache_numbers(&count, NULL, stream, scratch_pool));
+  *chunks = apr_array_make(result_pool, (int)count,
+                           sizeof(svn_diff__blame_chunk_t));
+  for (i = 0; i < count; i++)
+    {
+      svn_diff__blame_chunk_t chunk;
+
+      SVN_ERR(read_cache_numbers(&index, &start, stream, scratch_pool));
+      if (index < -1 || index >= (*revs)->nelts
+          || start < (i ? APR_ARRAY_IDX(*chunks, i - 1,
+                                        svn_diff__blame_chunk_t).start : 0))
+        return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL, NULL);
+
+      chunk.baton = index >= 0 ? APR_ARRAY_IDX(*revs, index, struct rev *)
+                               : NULL;
+      chunk.start = (apr_off_t)start;
+      APR_ARRAY_PUSH(*chunks, svn_diff__blame_chunk_t) = chunk;
+    }
+  if (count == 0)
+    return svn_error_create(SVN_ERR_MALFORMED_FILE, NULL, NULL);
+
+  SVN_ERR(svn_stream_close(stream));
+
+  *revision = value;
+  return SVN_NO_ERROR;
+}
+
+/* Look for a blame cache entry at CACHE_PATH that can stand in for
+   blaming the file LOC, which RA_SESSION points to, from START_REV up to
+   some revision R between START_REV and LOC->rev.  If there is one, load it
+   into CHAIN, with its revisions and their current revision properties
+   allocated in RESULT_POOL, and set *CACHED_REVNUM to R; otherwise set
+   *CACHED_REVNUM to SVN_INVALID_REVNUM.  An unusable entry is ignored. */
+static svn_error_t *
+load_blame_cache(svn_revnum_t *cached_revnum,
+                 svn_diff__blame_t *chain,
+                 const char *cache_path,
+                 const svn_client__pathrev_t *loc,
+                 svn_ra_session_t *ra_session,
+                 svn_revnum_t start_rev,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  svn_revnum_t revision;
+  apr_array_header_t *revs;
+  apr_array_header_t *chunks;
+  apr_array_header_t *location_revs;
+  apr_hash_t *locations;
+  const char *fspath;
+  svn_error_t *err;
+  int i;
+
+  *cached_revnum = SVN_INVALID_REVNUM;
+
+  err = read_blame_cache(&revision, &revs, &chunks, cache_path, result_pool,
+                         scratch_pool);
+  if (err)
+    {
+      /* A damaged entry is simply recomputed and overwritten. */
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+
+  if (!SVN_IS_VALID_REVNUM(revision)
+      || revision < start_rev || revision > loc->rev)
+    return SVN_NO_ERROR;
+
+  /* The entry is keyed by path, so make sure the file we are blaming
+     really is the node that lived at that path in REVISION. */
+  location_revs = apr_array_make(scratch_pool, 1, sizeof(svn_revnum_t));
+  APR_ARRAY_PUSH(location_revs, svn_revnum_t) = revision;
+  SVN_ERR(svn_ra_get_locations(ra_session, &locations, "", loc->rev,
+                               location_revs, scratch_pool));
+  fspath = apr_hash_get(locations, &revision, sizeof(revision));
+  if (!fspath
+      || strcmp(fspath,
+                svn_fspath__canonicalize(
+                  svn_uri_skip_ancestor(loc->repos_root_url, loc->url,
+                                        scratch_pool),
+                  scratch_pool)) != 0)
+    return SVN_NO_ERROR;
+
+  /* The revision properties may have been changed since the entry was
+     written, so get them from the repository. */
+  for (i = 0; i < revs->nelts; i++)
+    {
+      struct rev *rev = APR_ARRAY_IDX(revs, i, struct rev *);
+
+      SVN_ERR(svn_ra_rev_proplist(ra_session, rev->revision, &rev->rev_props,
+                                  result_pool));
+    }
 
-      walk_merged = walk_merged->next;
-      walk = walk->next;
+  svn_diff__blame_set_chunks(chain, chunks);
+
+  *cached_revnum = revision;
+  return SVN_NO_ERROR;
+}
+
+/* Return TRUE if DIFF_OPTIONS, which may be NULL, compare lines the way
+   server-side blame does. */
+static svn_boolean_t
+diff_options_are_default(const svn_diff_file_options_t *diff_options)
+{
+  return !diff_options
+         || (diff_options->ignore_space == svn_diff_file_ignore_space_none
+             && !diff_options->ignore_eol_style
+             && diff_options->algorithm == svn_diff_file_algorithm_lcs);
+}
+
+/* The baton used by server_blame_receiver(). */
+struct server_blame_baton
+{
+  struct file_rev_baton *frb;
+  const char *url;             /* of the blamed file, for notifications */
+  const char *fspath;          /* ditto */
+  apr_hash_t *revs;            /* svn_revnum_t -> struct rev * */
+  apr_array_header_t *chunks;  /* of svn_diff__blame_chunk_t */
+};
+
+/* Add a chunk reported by the server to the blame in BATON, a
+   struct server_blame_baton.  Implements svn_ra_blame_receiver_t. */
+static svn_error_t *
+server_blame_receiver(void *baton,
+                      apr_int64_t start_line,
+                      svn_revnum_t revision,
+                      apr_hash_t *rev_props,
+                      apr_pool_t *scratch_pool)
+{
+  struct server_blame_baton *sbb = baton;
+  struct file_rev_baton *frb = sbb->frb;
+  svn_diff__blame_chunk_t *chunk;
+  struct rev *rev = NULL;
+
+  if (frb->ctx->cancel_func)
+    SVN_ERR(frb->ctx->cancel_func(frb->ctx->cancel_baton));
+
+  if (SVN_IS_VALID_REVNUM(revision))
+    {
+      rev = apr_hash_get(sbb->revs, &revision, sizeof(revision));
+      if (!rev)
+        {
+          rev = apr_pcalloc(frb->mainpool, sizeof(*rev));
+          rev->revision = revision;
+          rev->rev_props = rev_props
+                         ? svn_prop_hash_dup(rev_props, frb->mainpool)
+                         : apr_hash_make(frb->mainpool);
+          apr_hash_set(sbb->revs, &rev->revision, sizeof(rev->revision),
+                       rev);
+
+          if (frb->ctx->notify_func2)
+            {
+              svn_wc_notify_t *notify
+                = svn_wc_create_notify_url(sbb->url,
+                                           svn_wc_notify_blame_revision,
+                                           scratch_pool);
+              notify->path = sbb->fspath;
+              notify->kind = svn_node_none;
+              notify->content_state = notify->prop_state
+                = svn_wc_notify_state_inapplicable;
+              notify->lock_state = svn_wc_notify_lock_state_inapplicable;
+              notify->revision = revision;
+              notify->rev_props = rev->rev_props;
+              frb->ctx->notify_func2(frb->ctx->notify_baton2, notify,
+                                     scratch_pool);
+            }
+        }
     }
 
-  /* Same as above, only extend CHAIN to match CHAIN_MERGED. */
-  while (walk_merged->next != NULL)
+  chunk = apr_array_push(sbb->chunks);
+  chunk->baton = rev;
+  chunk->start = start_line;
+
+  return SVN_NO_ERROR;
+}
+
+/* Let the server behind RA_SESSION, which points to LOC, compute the blame
+   for FRB and fetch the file's text at FRB->end_rev as FRB->last_filename.
+   Set *SERVER_BLAMED to FALSE if the server can't do it. */
+static svn_error_t *
+get_server_blame(svn_boolean_t *server_blamed,
+                 struct file_rev_baton *frb,
+                 const svn_client__pathrev_t *loc,
+                 svn_ra_session_t *ra_session,
+                 apr_pool_t *scratch_pool)
+{
+  struct server_blame_baton sbb;
+  svn_stream_t *stream;
+  svn_error_t *err;
+
+  sbb.frb = frb;
+  sbb.url = loc->url;
+  sbb.fspath = svn_fspath__canonicalize(
+                 svn_uri_skip_ancestor(loc->repos_root_url, loc->url,
+                                       scratch_pool),
+                 scratch_pool);
+  sbb.revs = apr_hash_make(scratch_pool);
+  sbb.chunks = apr_array_make(scratch_pool, 16,
+                              sizeof(svn_diff__blame_chunk_t));
+
+  err = svn_ra_get_blame(ra_session, "", frb->start_rev, frb->end_rev,
+                         server_blame_receiver, &sbb, scratch_pool);
+  if (err && err->apr_err == SVN_ERR_UNSUPPORTED_FEATURE)
     {
-      struct blame *tmp = blame_create(chain, walk->rev,
-                                       walk_merged->next->start);
-      walk->next = tmp;
+      svn_error_clear(err);
+      *server_blamed = FALSE;
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
 
-      walk = walk->next;
-      walk_merged = walk_merged->next;
+  if (sbb.chunks->nelts == 0)
+    {
+      *server_blamed = FALSE;
+      return SVN_NO_ERROR;
     }
+  svn_diff__blame_set_chunks(frb->chain, sbb.chunks);
+
+  SVN_ERR(svn_stream_open_unique(&stream, &frb->last_filename, NULL,
+                                 svn_io_file_del_on_pool_cleanup,
+                                 frb->mainpool, scratch_pool));
+  SVN_ERR(svn_ra_get_file(ra_session, "", frb->end_rev, stream, NULL, NULL,
+                          scratch_pool));
+  SVN_ERR(svn_stream_close(stream));
+
+  *server_blamed = TRUE;
+  return SVN_NO_ERROR;
 }
 
 svn_error_t *
@@ -671,7 +906,12 @@ svn_client_blame5(const char *target,
   struct file_rev_baton frb;
   svn_ra_session_t *ra_session;
   svn_revnum_t start_revnum, end_revnum;
-  struct blame *walk, *walk_merged = NULL;
+  svn_client__pathrev_t *loc;
+  const char *cache_path = NULL;
+  svn_boolean_t server_blamed = FALSE;
+  apr_array_header_t *chunks, *merged_chunks = NULL;
+  int chunk_idx = 0, merged_idx = 0;
+  apr_off_t line_no;
   apr_pool_t *iterpool;
   svn_stream_t *last_stream;
   svn_stream_t *stream;
@@ -702,7 +942,6 @@ svn_client_blame5(const char *target,
                                           end, pool));
 
   {
-    svn_client__pathrev_t *loc;
     svn_opt_revision_t younger_end;
     younger_end.kind = svn_opt_revision_number;
     younger_end.value.number = MAX(start_revnum, end_revnum);
@@ -776,21 +1015,14 @@ svn_client_blame5(const char *target,
   frb.last_filename = NULL;
   frb.last_rev = NULL;
   frb.last_original_filename = NULL;
-  frb.chain = apr_palloc(pool, sizeof(*frb.chain));
-  frb.chain->blame = NULL;
-  frb.chain->avail = NULL;
-  frb.chain->pool = pool;
+  frb.chain = svn_diff__blame_create(pool);
   if (include_merged_revisions)
-    {
-      frb.merged_chain = apr_palloc(pool, sizeof(*frb.merged_chain));
-      frb.merged_chain->blame = NULL;
-      frb.merged_chain->avail = NULL;
-      frb.merged_chain->pool = pool;
-    }
+    frb.merged_chain = svn_diff__blame_create(pool);
   frb.backwards = (frb.start_rev > frb.end_rev);
   frb.last_revnum = SVN_INVALID_REVNUM;
   frb.last_props = NULL;
   frb.check_mime_type = (frb.backwards && !ignore_mime_type);
+  frb.cached_revnum = SVN_INVALID_REVNUM;
 
   SVN_ERR(svn_ra_get_repos_root2(ra_session, &frb.repos_root_url, pool));
 
@@ -806,16 +1038,46 @@ svn_client_blame5(const char *target,
       frb.prevfilepool = svn_pool_create(pool);
     }
 
-  /* Collect all blame information.
-     We need to ensure that we get one revision before the start_rev,
-     if available so that we can know what was actually changed in the start
-     revision. */
-  SVN_ERR(svn_ra_get_file_revs2(ra_session, "",
-                                frb.backwards ? start_revnum
-                                              : MAX(0, start_revnum-1),
-                                end_revnum,
-                                include_merged_revisions,
-                                file_rev_handler, &frb, pool));
+  /* Plain forward blames don't need all the file's revisions here, if
+     the server can compute them itself. */
+  if (!include_merged_revisions && !frb.backwards
+      && diff_options_are_default(diff_options))
+    SVN_ERR(get_server_blame(&server_blamed, &frb, loc, ra_session, pool));
+
+  if (!server_blamed)
+    {
+      /* Pick up where an earlier blame of this file left off, if we can.
+         Merged revisions and backward blames are not cached. */
+      if (!include_merged_revisions && !frb.backwards)
+        SVN_ERR(get_blame_cache_path(&cache_path, loc, start_revnum,
+                                     diff_options, ctx, pool, pool));
+      if (cache_path)
+        SVN_ERR(load_blame_cache(&frb.cached_revnum, frb.chain, cache_path,
+                                 loc, ra_session, start_revnum, pool, pool));
+
+      /* Collect all blame information.
+         We need to ensure that we get one revision before the start_rev,
+         if available so that we can know what was actually changed in the
+         start revision.  With cached blame, we start at the cached
+         revision, whose content the first revision we receive
+         reproduces. */
+      SVN_ERR(svn_ra_get_file_revs2(ra_session, "",
+                                    SVN_IS_VALID_REVNUM(frb.cached_revnum)
+                                      ? frb.cached_revnum
+                                      : frb.backwards
+                                          ? start_revnum
+                                          : MAX(0, start_revnum-1),
+                                    end_revnum,
+                                    include_merged_revisions,
+                                    file_rev_handler, &frb, pool));
+
+      /* Update the blame cache.  Failing to do so doesn't affect the blame
+         we are about to report, so just move on. */
+      if (cache_path && !svn_diff__blame_is_empty(frb.chain)
+          && frb.cached_revnum != end_revnum)
+        svn_error_clear(write_blame_cache(cache_path, end_revnum, frb.chain,
+                                          pool));
+    }
 
   if (end->kind == svn_opt_revision_working)
     {
@@ -891,7 +1153,7 @@ svn_client_blame5(const char *target,
   stream = svn_subst_stream_translated(last_stream,
                                        "\n", TRUE, NULL, FALSE, pool);
 
-  /* Perform optional merged chain normalization. */
+  /* Get the chunks of the merged chain, if any. */
   if (include_merged_revisions)
     {
       /* If we never created any blame for the original chain, create it now,
@@ -900,65 +1162,68 @@ svn_client_blame5(const char *target,
          semanticly a copy, and we want to use the revision on the branch as
          the most recently changed revision.  ### Is this really what we want
          to do here?  Do the sematics of copy change? */
-      if (!frb.chain->blame)
-        frb.chain->blame = blame_create(frb.chain, frb.last_rev, 0);
+      if (svn_diff__blame_is_empty(frb.chain))
+        svn_diff__blame_reset(frb.chain, frb.last_rev);
 
-      normalize_blames(frb.chain, frb.merged_chain, pool);
-      walk_merged = frb.merged_chain->blame;
+      merged_chunks = svn_diff__blame_chunks(frb.merged_chain, pool);
     }
+  chunks = svn_diff__blame_chunks(frb.chain, pool);
 
-  /* Process each blame item. */
-  for (walk = frb.chain->blame; walk; walk = walk->next)
+  /* Process each line, moving along both chunk lists as we go. */
+  for (line_no = 0; ; ++line_no)
     {
-      apr_off_t line_no;
-      svn_revnum_t merged_rev;
-      const char *merged_path;
-      apr_hash_t *merged_rev_props;
-
-      if (walk_merged)
-        {
-          merged_rev = walk_merged->rev->revision;
-          merged_rev_props = walk_merged->rev->rev_props;
-          merged_path = walk_merged->rev->path;
-        }
-      else
+      const struct rev *rev;
+      svn_revnum_t merged_rev = SVN_INVALID_REVNUM;
+      const char *merged_path = NULL;
+      apr_hash_t *merged_rev_props = NULL;
+      svn_boolean_t eof;
+      svn_stringbuf_t *sb;
+
+      while (chunk_idx + 1 < chunks->nelts
+             && APR_ARRAY_IDX(chunks, chunk_idx + 1,
+                              svn_diff__blame_chunk_t).start <= line_no)
+        chunk_idx++;
+      rev = APR_ARRAY_IDX(chunks, chunk_idx, svn_diff__blame_chunk_t).baton;
+
+      if (merged_chunks)
         {
-          merged_rev = SVN_INVALID_REVNUM;
-          merged_rev_props = NULL;
-          merged_path = NULL;
-        }
+          const struct rev *merged;
 
-      for (line_no = walk->start;
-           !walk->next || line_no < walk->next->start;
-           ++line_no)
-        {
-          svn_boolean_t eof;
-          svn_stringbuf_t *sb;
-
-          svn_pool_clear(iterpool);
-          SVN_ERR(svn_stream_readline(stream, &sb, "\n", &eof, iterpool));
-          if (ctx->cancel_func)
-            SVN_ERR(ctx->cancel_func(ctx->cancel_baton));
-          if (!eof || sb->len)
+          while (merged_idx + 1 < merged_chunks->nelts
+                 && APR_ARRAY_IDX(merged_chunks, merged_idx + 1,
+                                  svn_diff__blame_chunk_t).start <= line_no)
+            merged_idx++;
+          merged = APR_ARRAY_IDX(merged_chunks, merged_idx,
+                                 svn_diff__blame_chunk_t).baton;
+
+          if (merged)
             {
-              if (walk->rev)
-                SVN_ERR(receiver(receiver_baton, start_revnum, end_revnum,
-                                 line_no, walk->rev->revision,
-                                 walk->rev->rev_props, merged_rev,
-                                 merged_rev_props, merged_path,
-                                 sb->data, FALSE, iterpool));
-              else
-                SVN_ERR(receiver(receiver_baton, start_revnum, end_revnum,
-                                 line_no, SVN_INVALID_REVNUM,
-                                 NULL, SVN_INVALID_REVNUM,
-                                 NULL, NULL,
-                                 sb->data, TRUE, iterpool));
+              merged_rev = merged->revision;
+              merged_rev_props = merged->rev_props;
+              merged_path = merged->path;
             }
-          if (eof) break;
         }
 
-      if (walk_merged)
-        walk_merged = walk_merged->next;
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_stream_readline(stream, &sb, "\n", &eof, iterpool));
+      if (ctx->cancel_func)
+        SVN_ERR(ctx->cancel_func(ctx->cancel_baton));
+      if (!eof || sb->len)
+        {
+          if (rev)
+            SVN_ERR(receiver(receiver_baton, start_revnum, end_revnum,
+                             line_no, rev->revision,
+                             rev->rev_props, merged_rev,
+                             merged_rev_props, merged_path,
+                             sb->data, FALSE, iterpool));
+          else
+            SVN_ERR(receiver(receiver_baton, start_revnum, end_revnum,
+                             line_no, SVN_INVALID_REVNUM,
+                             NULL, SVN_INVALID_REVNUM,
+                             NULL, NULL,
+                             sb->data, TRUE, iterpool));
+        }
+      if (eof) break;
     }
 
   SVN_ERR(svn_stream_close(stream));
@@ -994,6 +994,8 @@ svn_client__handle_externals(apr_hash_t *externals_new,
 
    NATIVE_EOL is the value passed as NATIVE_EOL when exporting.
 
+   JOBS is the value passed as JOBS when exporting.
+
    Use POOL for temporary allocation. */
 svn_error_t *
 svn_client__export_externals(apr_hash_t *externals,
@@ -1003,6 +1005,7 @@ svn_client__export_externals(apr_hash_t *externals,
                              svn_depth_t requested_depth,
                              const char *native_eol,
                              svn_boolean_t ignore_keywords,
+                             int jobs,
                              svn_client_ctx_t *ctx,
                              apr_pool_t *pool);
 
@@ -45,6 +45,7 @@
 #include "private/svn_wc_private.h"
 #include "private/svn_client_private.h"
 #include "private/svn_sorts_private.h"
+#include "private/svn_thread_pool.h"
 
 /*** Uncomment this to turn on commit driver debugging. ***/
 /*
@@ -1834,6 +1835,172 @@ fixup_error:
                                             err, ctx, pool));
 }
 
+/* Send the svn_wc_notify_commit_postfix_txdelta notification for ITEM. */
+static void
+notify_postfix_txdelta(const svn_client_commit_item3_t *item,
+                       const char *notify_path_prefix,
+                       svn_client_ctx_t *ctx,
+                       apr_pool_t *scratch_pool)
+{
+  if (ctx->notify_func2)
+    {
+      svn_wc_notify_t *notify;
+      notify = svn_wc_create_notify(item->path,
+                                    svn_wc_notify_commit_postfix_txdelta,
+                                    scratch_pool);
+      notify->kind = svn_node_file;
+      notify->path_prefix = notify_path_prefix;
+      ctx->notify_func2(ctx->notify_baton2, notify, scratch_pool);
+    }
+}
+
+/* If the node of ITEM has no history, we must transmit its full text. */
+static svn_boolean_t
+needs_fulltext(const svn_client_commit_item3_t *item)
+{
+  return ((item->state_flags & SVN_CLIENT_COMMIT_ITEM_ADD)
+          && ! (item->state_flags & SVN_CLIENT_COMMIT_ITEM_IS_COPY));
+}
+
+/* The text delta of a file that is being computed by a worker thread
+   while we are still transmitting the ones before it. */
+typedef struct pending_delta_t
+{
+  struct file_mod_t *mod;
+
+  /* Holds DELTA.  The streams, spill buffer and checksums in DELTA
+     allocate from it while a worker computes the delta, so it must not
+     share its allocator with any pool used by this thread meanwhile. */
+  apr_pool_t *pool;
+  svn_wc__text_delta_t *delta;
+
+  /* The worker task computing DELTA, or the error that prevented it from
+     being started. */
+  svn_thread_pool__task_t *task;
+  svn_error_t *err;
+} pending_delta_t;
+
+/* Prepare the text delta for MOD in PENDING and let a worker of GROUP
+   compute it.  Any error will be stored in PENDING. */
+static void
+start_text_delta(pending_delta_t *pending,
+                 struct file_mod_t *mod,
+                 svn_thread_pool__group_t *group,
+                 svn_client_ctx_t *ctx,
+                 apr_pool_t *scratch_pool)
+{
+  pending->mod = mod;
+  pending->pool = apr_allocator_owner_get(svn_pool_create_allocator(TRUE));
+  pending->err = svn_wc__text_delta_prepare(&pending->delta, ctx->wc_ctx,
+                                            mod->item->path,
+                                            needs_fulltext(mod->item),
+                                            pending->pool, scratch_pool);
+  if (! pending->err)
+    pending->err = svn_thread_pool__run(&pending->task, group,
+                                        svn_wc__text_delta_compute,
+                                        pending->delta);
+}
+
+/* Wait for the task of PENDING, if any, and release its resources. */
+static void
+finish_text_delta(pending_delta_t *pending)
+{
+  if (pending->task)
+    svn_thread_pool__task_destroy(pending->task);
+  svn_error_clear(pending->err);
+  svn_pool_destroy(pending->pool);
+}
+
+/* Like the delta transmission loop in svn_client__do_commit() but for the
+   files in FILE_MODS, an array of struct file_mod_t *.  While a file is
+   being transmitted, the workers of GROUP compute the deltas of the files
+   that follow it, such that at most LOOKAHEAD deltas including the current
+   one have been started. */
+static svn_error_t *
+transmit_text_deltas_pipelined(apr_array_header_t *file_mods,
+                               svn_thread_pool__group_t *group,
+                               int lookahead,
+                               const char *base_url,
+                               const svn_delta_editor_t *editor,
+                               const char *notify_path_prefix,
+                               apr_hash_t *sha1_checksums,
+                               svn_client_ctx_t *ctx,
+                               apr_pool_t *result_pool,
+                               apr_pool_t *scratch_pool)
+{
+  pending_delta_t *pending = apr_pcalloc(scratch_pool,
+                                         file_mods->nelts * sizeof(*pending));
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_error_t *err = SVN_NO_ERROR;
+  int started = 0;
+  int i;
+
+  for (i = 0; i < file_mods->nelts; i++)
+    {
+      pending_delta_t *current = &pending[i];
+      const svn_client_commit_item3_t *item;
+      const svn_checksum_t *new_text_base_md5_checksum;
+      const svn_checksum_t *new_text_base_sha1_checksum;
+
+      svn_pool_clear(iterpool);
+
+      /* Keep the workers busy with the files to come. */
+      for (; started < file_mods->nelts && started < i + lookahead;
+           started++)
+        start_text_delta(&pending[started],
+                         APR_ARRAY_IDX(file_mods, started,
+                                       struct file_mod_t *),
+                         group, ctx, iterpool);
+
+      item = current->mod->item;
+
+      /* Transmit the entry. */
+      if (ctx->cancel_func)
+        {
+          err = ctx->cancel_func(ctx->cancel_baton);
+          if (err)
+            break;
+        }
+
+      notify_postfix_txdelta(item, notify_path_prefix, ctx, iterpool);
+
+      err = current->err;
+      current->err = SVN_NO_ERROR;
+      if (! err)
+        err = svn_thread_pool__task_wait(current->task);
+      if (! err)
+        err = svn_wc__text_delta_transmit(&new_text_base_md5_checksum,
+                                          &new_text_base_sha1_checksum,
+                                          current->delta, editor,
+                                          current->mod->file_baton,
+                                          result_pool, iterpool);
+
+      if (err)
+        {
+          err = fixup_commit_error(item->path, base_url,
+                                   item->session_relpath, svn_node_file,
+                                   err, ctx, scratch_pool);
+          break;
+        }
+
+      if (sha1_checksums)
+        svn_hash_sets(sha1_checksums, item->path, new_text_base_sha1_checksum);
+
+      finish_text_delta(current);
+      svn_pool_destroy(current->mod->file_pool);
+    }
+
+  /* After an error, wait for the workers still busy with the files that
+     we did not get to. */
+  for (; i < started; i++)
+    finish_text_delta(&pending[i]);
+
+  err = svn_error_compose_create(err, svn_thread_pool__group_wait(group));
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(err);
+}
+
 svn_error_t *
 svn_client__do_commit(const char *base_url,
                       const apr_array_header_t *commit_items,
@@ -1853,6 +2020,7 @@ svn_client__do_commit(const char *base_url,
   struct item_commit_baton cb_baton;
   apr_array_header_t *paths =
     apr_array_make(scratch_pool, commit_items->nelts, sizeof(const char *));
+  int worker_threads;
 
   /* Ditto for the checksums. */
   if (sha1_checksums)
@@ -1883,7 +2051,38 @@ svn_client__do_commit(const char *base_url,
   SVN_ERR(svn_delta_path_driver2(editor, edit_baton, paths, TRUE,
                                  do_item_commit, &cb_baton, scratch_pool));
 
-  /* Transmit outstanding text deltas. */
+  /* Transmit outstanding text deltas.  If we may use worker threads,
+     let them compute the deltas of the next files while we are sending
+     the current one. */
+  worker_threads = svn_wc__get_worker_threads(ctx->wc_ctx);
+  if (worker_threads > 1 && apr_hash_count(file_mods) > 1)
+    {
+      svn_thread_pool__group_t *group;
+
+      SVN_ERR(svn_thread_pool__group_create(&group, worker_threads,
+                                            scratch_pool));
+      if (svn_thread_pool__group_is_parallel(group))
+        {
+          apr_array_header_t *mods
+            = apr_array_make(scratch_pool, apr_hash_count(file_mods),
+                             sizeof(struct file_mod_t *));
+
+          for (hi = apr_hash_first(scratch_pool, file_mods);
+               hi;
+               hi = apr_hash_next(hi))
+            APR_ARRAY_PUSH(mods, struct file_mod_t *) = apr_hash_this_val(hi);
+
+          SVN_ERR(transmit_text_deltas_pipelined(
+                    mods, group, worker_threads, base_url, editor,
+                    notify_path_prefix,
+                    sha1_checksums ? *sha1_checksums : NULL,
+                    ctx, result_pool, scratch_pool));
+
+          /* All deltas are out. */
+          file_mods = apr_hash_make(scratch_pool);
+        }
+    }
+
   for (hi = apr_hash_first(scratch_pool, file_mods);
        hi;
        hi = apr_hash_next(hi))
@@ -1901,21 +2100,10 @@ svn_client__do_commit(const char *base_url,
       if (ctx->cancel_func)
         SVN_ERR(ctx->cancel_func(ctx->cancel_baton));
 
-      if (ctx->notify_func2)
-        {
-          svn_wc_notify_t *notify;
-          notify = svn_wc_create_notify(item->path,
-                                        svn_wc_notify_commit_postfix_txdelta,
-                                        iterpool);
-          notify->kind = svn_node_file;
-          notify->path_prefix = notify_path_prefix;
-          ctx->notify_func2(ctx->notify_baton2, notify, iterpool);
-        }
+      notify_postfix_txdelta(item, notify_path_prefix, ctx, iterpool);
 
       /* If the node has no history, transmit full text */
-      if ((item->state_flags & SVN_CLIENT_COMMIT_ITEM_ADD)
-          && ! (item->state_flags & SVN_CLIENT_COMMIT_ITEM_IS_COPY))
-        fulltext = TRUE;
+      fulltext = needs_fulltext(item);
 
       err = svn_wc_transmit_text_deltas3(&new_text_base_md5_checksum,
                                          &new_text_base_sha1_checksum,
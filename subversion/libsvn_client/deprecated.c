@@ -1341,6 +1341,25 @@ svn_client_diff_summarize_peg(const char *path,
 }
 
 /*** From export.c ***/
+svn_error_t *
+svn_client_export5(svn_revnum_t *result_rev,
+                   const char *from_path_or_url,
+                   const char *to_path,
+                   const svn_opt_revision_t *peg_revision,
+                   const svn_opt_revision_t *revision,
+                   svn_boolean_t overwrite,
+                   svn_boolean_t ignore_externals,
+                   svn_boolean_t ignore_keywords,
+                   svn_depth_t depth,
+                   const char *native_eol,
+                   svn_client_ctx_t *ctx,
+                   apr_pool_t *pool)
+{
+  return svn_client_export6(result_rev, from_path_or_url, to_path,
+                            peg_revision, revision, overwrite, ignore_externals,
+                            ignore_keywords, depth, native_eol, 1, ctx, pool);
+}
+
 svn_error_t *
 svn_client_export4(svn_revnum_t *result_rev,
                    const char *from_path_or_url,
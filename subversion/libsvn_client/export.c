@@ -46,6 +46,7 @@
 #include "private/svn_subr_private.h"
 #include "private/svn_delta_private.h"
 #include "private/svn_wc_private.h"
+#include "private/svn_thread_pool.h"
 
 #ifndef ENABLE_EV2_IMPL
 #define ENABLE_EV2_IMPL 0
@@ -495,6 +496,9 @@ open_root_internal(const char *path,
 
 /*** A dedicated 'export' editor, which does no .svn/ accounting.  ***/
 
+/* Number of nodes that we let the workers write before we wait for them
+   and send the notifications for those nodes. */
+#define EXPORT_BATCH_SIZE 256
 
 struct edit_baton
 {
@@ -511,6 +515,18 @@ struct edit_baton
   void *cancel_baton;
   svn_wc_notify_func2_t notify_func;
   void *notify_baton;
+
+  /* Maximum number of files to write in parallel. */
+  int jobs;
+
+  /* If not NULL, close_file() hands the files to the workers of this
+     group instead of writing them itself.  The batons of these files
+     live in BATCH_POOL and BATCH_NOTIFY lists the svn_wc_notify_t * for
+     them and the directories added in between, in order, to be sent once
+     the files are done.  See flush_files(). */
+  svn_thread_pool__group_t *group;
+  apr_pool_t *batch_pool;
+  apr_array_header_t *batch_notify;
 };
 
 
@@ -554,6 +570,25 @@ struct file_baton
 };
 
 
+/* Everything needed to put a received file into place, independent of
+   the editor's pools. */
+typedef struct finish_file_baton_t
+{
+  const char *path;
+  const char *tmppath;
+
+  /* Whether TMPPATH must be translated, and how. */
+  svn_boolean_t translate;
+  const char *eol;
+  svn_boolean_t repair;
+  apr_hash_t *keywords;
+  svn_boolean_t special;
+
+  svn_boolean_t executable;
+  apr_time_t date;
+} finish_file_baton_t;
+
+
 struct handler_baton
 {
   svn_txdelta_window_handler_t apply_handler;
@@ -577,6 +612,34 @@ set_target_revision(void *edit_baton,
 
 
 
+/* Send the notification for the exported node PATH of kind KIND.  While
+   the workers of EB->GROUP are writing files, queue it behind those of
+   the files instead.  Use POOL for temporary allocations. */
+static void
+notify_added(struct edit_baton *eb,
+             const char *path,
+             svn_node_kind_t kind,
+             apr_pool_t *pool)
+{
+  svn_wc_notify_t *notify;
+
+  if (eb->group)
+    {
+      notify = svn_wc_create_notify(apr_pstrdup(eb->batch_pool, path),
+                                    svn_wc_notify_update_add,
+                                    eb->batch_pool);
+      notify->kind = kind;
+      APR_ARRAY_PUSH(eb->batch_notify, svn_wc_notify_t *) = notify;
+    }
+  else if (eb->notify_func)
+    {
+      notify = svn_wc_create_notify(path, svn_wc_notify_update_add, pool);
+      notify->kind = kind;
+      (*eb->notify_func)(eb->notify_baton, notify, pool);
+    }
+}
+
+
 /* Just ensure that the main export directory exists. */
 static svn_error_t *
 open_root(void *edit_baton,
@@ -613,27 +676,28 @@ add_directory(const char *path,
   struct edit_baton *eb = pb->edit_baton;
   const char *full_path = svn_dirent_join(eb->root_path, path, pool);
   svn_node_kind_t kind;
+  svn_error_t *err;
 
-  SVN_ERR(svn_io_check_path(full_path, &kind, pool));
-  if (kind == svn_node_none)
-    SVN_ERR(svn_io_dir_make(full_path, APR_OS_DEFAULT, pool));
-  else if (kind == svn_node_file)
-    return svn_error_createf(SVN_ERR_WC_NOT_WORKING_COPY, NULL,
-                             _("'%s' exists and is not a directory"),
-                             svn_dirent_local_style(full_path, pool));
-  else if (! (kind == svn_node_dir && eb->overwrite))
-    return svn_error_createf(SVN_ERR_WC_OBSTRUCTED_UPDATE, NULL,
-                             _("'%s' already exists"),
-                             svn_dirent_local_style(full_path, pool));
-
-  if (eb->notify_func)
+  /* Exports usually go into new directories, so try to create it right
+     away and look at what is there only if that fails. */
+  err = svn_io_dir_make(full_path, APR_OS_DEFAULT, pool);
+  if (err && APR_STATUS_IS_EEXIST(err->apr_err))
     {
-      svn_wc_notify_t *notify = svn_wc_create_notify(full_path,
-                                                     svn_wc_notify_update_add,
-                                                     pool);
-      notify->kind = svn_node_dir;
-      (*eb->notify_func)(eb->notify_baton, notify, pool);
+      svn_error_clear(err);
+      SVN_ERR(svn_io_check_path(full_path, &kind, pool));
+      if (kind == svn_node_file)
+        return svn_error_createf(SVN_ERR_WC_NOT_WORKING_COPY, NULL,
+                                 _("'%s' exists and is not a directory"),
+                                 svn_dirent_local_style(full_path, pool));
+      else if (! (kind == svn_node_dir && eb->overwrite))
+        return svn_error_createf(SVN_ERR_WC_OBSTRUCTED_UPDATE, NULL,
+                                 _("'%s' already exists"),
+                                 svn_dirent_local_style(full_path, pool));
     }
+  else
+    SVN_ERR(err);
+
+  notify_added(eb, full_path, svn_node_dir, pool);
 
   /* Build our dir baton. */
   db->path = full_path;
@@ -785,6 +849,75 @@ change_dir_prop(void *dir_baton,
 }
 
 
+/* Translate FFB->TMPPATH into FFB->PATH, or just move it there, and set
+   the attributes of the file.  Use SCRATCH_POOL for temporary allocations.
+   This does not access any editor state and may run on any thread. */
+static svn_error_t *
+finish_file(const finish_file_baton_t *ffb,
+            svn_cancel_func_t cancel_func,
+            void *cancel_baton,
+            apr_pool_t *scratch_pool)
+{
+  if (! ffb->translate)
+    {
+      SVN_ERR(svn_io_file_rename2(ffb->tmppath, ffb->path, FALSE,
+                                  scratch_pool));
+    }
+  else
+    {
+      SVN_ERR(svn_subst_copy_and_translate4(ffb->tmppath, ffb->path,
+                                            ffb->eol, ffb->repair,
+                                            ffb->keywords,
+                                            TRUE, /* expand */
+                                            ffb->special,
+                                            cancel_func, cancel_baton,
+                                            scratch_pool));
+
+      SVN_ERR(svn_io_remove_file2(ffb->tmppath, FALSE, scratch_pool));
+    }
+
+  if (ffb->executable)
+    SVN_ERR(svn_io_set_file_executable(ffb->path, TRUE, FALSE,
+                                       scratch_pool));
+
+  if (ffb->date && (! ffb->special))
+    SVN_ERR(svn_io_set_file_affected_time(ffb->date, ffb->path,
+                                          scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_thread_pool__func_t for finish_file(). */
+static svn_error_t *
+finish_file_task(void *baton,
+                 apr_pool_t *result_pool)
+{
+  return svn_error_trace(finish_file(baton, NULL, NULL, result_pool));
+}
+
+/* Wait for the workers of EB->GROUP to write all files handed to them,
+   send the queued notifications and start a new batch. */
+static svn_error_t *
+flush_files(struct edit_baton *eb)
+{
+  int i;
+
+  SVN_ERR(svn_thread_pool__group_wait(eb->group));
+
+  if (eb->notify_func)
+    for (i = 0; i < eb->batch_notify->nelts; i++)
+      (*eb->notify_func)(eb->notify_baton,
+                         APR_ARRAY_IDX(eb->batch_notify, i,
+                                       svn_wc_notify_t *),
+                         eb->batch_pool);
+
+  svn_pool_clear(eb->batch_pool);
+  eb->batch_notify = apr_array_make(eb->batch_pool, EXPORT_BATCH_SIZE,
+                                    sizeof(svn_wc_notify_t *));
+
+  return SVN_NO_ERROR;
+}
+
 /* Move the tmpfile to file, and send feedback. */
 static svn_error_t *
 close_file(void *file_baton,
@@ -795,6 +928,8 @@ close_file(void *file_baton,
   struct edit_baton *eb = fb->edit_baton;
   svn_checksum_t *text_checksum;
   svn_checksum_t *actual_checksum;
+  finish_file_baton_t *ffb;
+  apr_pool_t *ffb_pool;
 
   /* Was a txdelta even sent? */
   if (! fb->tmppath)
@@ -814,55 +949,45 @@ close_file(void *file_baton,
                                      _("Checksum mismatch for '%s'"),
                                      svn_dirent_local_style(fb->path, pool));
 
-  if ((! fb->eol_style_val) && (! fb->keywords_val) && (! fb->special))
-    {
-      SVN_ERR(svn_io_file_rename2(fb->tmppath, fb->path, FALSE, pool));
-    }
-  else
+  /* The file's data must survive this call if a worker is to write it. */
+  ffb_pool = eb->group ? eb->batch_pool : pool;
+  ffb = apr_pcalloc(ffb_pool, sizeof(*ffb));
+  ffb->path = apr_pstrdup(ffb_pool, fb->path);
+  ffb->tmppath = apr_pstrdup(ffb_pool, fb->tmppath);
+  ffb->translate = fb->eol_style_val || fb->keywords_val || fb->special;
+  ffb->special = fb->special;
+  ffb->executable = (fb->executable_val != NULL);
+  ffb->date = fb->date;
+
+  if (fb->eol_style_val)
     {
       svn_subst_eol_style_t style;
-      const char *eol = NULL;
-      svn_boolean_t repair = FALSE;
-      apr_hash_t *final_kw = NULL;
 
-      if (fb->eol_style_val)
-        {
-          SVN_ERR(get_eol_style(&style, &eol, fb->eol_style_val->data,
-                                eb->native_eol));
-          repair = TRUE;
-        }
+      SVN_ERR(get_eol_style(&style, &ffb->eol, fb->eol_style_val->data,
+                            eb->native_eol));
+      ffb->repair = TRUE;
+    }
 
-      if (fb->keywords_val)
-        SVN_ERR(svn_subst_build_keywords3(&final_kw, fb->keywords_val->data,
-                                          fb->revision, fb->url,
-                                          fb->repos_root_url, fb->date,
-                                          fb->author, pool));
+  if (fb->keywords_val)
+    SVN_ERR(svn_subst_build_keywords3(&ffb->keywords, fb->keywords_val->data,
+                                      fb->revision, fb->url,
+                                      fb->repos_root_url, fb->date,
+                                      fb->author, ffb_pool));
 
-      SVN_ERR(svn_subst_copy_and_translate4(fb->tmppath, fb->path,
-                                            eol, repair, final_kw,
-                                            TRUE, /* expand */
-                                            fb->special,
-                                            eb->cancel_func, eb->cancel_baton,
-                                            pool));
+  if (! eb->group)
+    {
+      SVN_ERR(finish_file(ffb, eb->cancel_func, eb->cancel_baton, pool));
+      notify_added(eb, fb->path, svn_node_file, pool);
 
-      SVN_ERR(svn_io_remove_file2(fb->tmppath, FALSE, pool));
+      return SVN_NO_ERROR;
     }
 
-  if (fb->executable_val)
-    SVN_ERR(svn_io_set_file_executable(fb->path, TRUE, FALSE, pool));
-
-  if (fb->date && (! fb->special))
-    SVN_ERR(svn_io_set_file_affected_time(fb->date, fb->path, pool));
+  /* Let a worker write the file while we receive the next ones. */
+  SVN_ERR(svn_thread_pool__run(NULL, eb->group, finish_file_task, ffb));
+  notify_added(eb, ffb->path, svn_node_file, pool);
 
-  if (fb->edit_baton->notify_func)
-    {
-      svn_wc_notify_t *notify = svn_wc_create_notify(fb->path,
-                                                     svn_wc_notify_update_add,
-                                                     pool);
-      notify->kind = svn_node_file;
-      (*fb->edit_baton->notify_func)(fb->edit_baton->notify_baton, notify,
-                                     pool);
-    }
+  if (eb->batch_notify->nelts >= EXPORT_BATCH_SIZE)
+    SVN_ERR(flush_files(eb));
 
   return SVN_NO_ERROR;
 }
@@ -1299,9 +1424,25 @@ export_directory(const char *from_url,
   const svn_ra_reporter3_t *reporter;
   void *report_baton;
   svn_node_kind_t kind;
+  svn_error_t *err;
 
   SVN_ERR_ASSERT(svn_path_is_url(from_url));
 
+  if (eb->jobs > 1)
+    {
+      SVN_ERR(svn_thread_pool__group_create(&eb->group, eb->jobs,
+                                            scratch_pool));
+      if (svn_thread_pool__group_is_parallel(eb->group))
+        {
+          eb->batch_pool = svn_pool_create(scratch_pool);
+          eb->batch_notify = apr_array_make(eb->batch_pool,
+                                            EXPORT_BATCH_SIZE,
+                                            sizeof(svn_wc_notify_t *));
+        }
+      else
+        eb->group = NULL;
+    }
+
   if (!ENABLE_EV2_IMPL)
     SVN_ERR(get_editor_ev1(&export_editor, &edit_baton, eb, ctx,
                            scratch_pool, scratch_pool));
@@ -1327,7 +1468,20 @@ export_directory(const char *from_url,
                              TRUE, /* "help, my dir is empty!" */
                              NULL, scratch_pool));
 
-  SVN_ERR(reporter->finish_report(report_baton, scratch_pool));
+  err = reporter->finish_report(report_baton, scratch_pool);
+
+  /* The workers may still be writing files, even if the edit failed. */
+  if (eb->group)
+    {
+      if (err)
+        err = svn_error_compose_create(
+                err, svn_thread_pool__group_wait(eb->group));
+      else
+        err = flush_files(eb);
+
+      eb->group = NULL;
+    }
+  SVN_ERR(err);
 
   /* Special case: Due to our sly export/checkout method of updating an
    * empty directory, no target will have been created if the exported
@@ -1353,7 +1507,7 @@ export_directory(const char *from_url,
                                            from_url,
                                            to_abspath, eb->repos_root_url,
                                            depth, native_eol,
-                                           ignore_keywords,
+                                           ignore_keywords, eb->jobs,
                                            ctx, scratch_pool));
     }
 
@@ -1365,7 +1519,7 @@ export_directory(const char *from_url,
 /*** Public Interfaces ***/
 
 svn_error_t *
-svn_client_export5(svn_revnum_t *result_rev,
+svn_client_export6(svn_revnum_t *result_rev,
                    const char *from_path_or_url,
                    const char *to_path,
                    const svn_opt_revision_t *peg_revision,
@@ -1375,6 +1529,7 @@ svn_client_export5(svn_revnum_t *result_rev,
                    svn_boolean_t ignore_keywords,
                    svn_depth_t depth,
                    const char *native_eol,
+                   int jobs,
                    svn_client_ctx_t *ctx,
                    apr_pool_t *pool)
 {
@@ -1421,6 +1576,7 @@ svn_client_export5(svn_revnum_t *result_rev,
       eb->cancel_baton = ctx->cancel_baton;
       eb->notify_func = ctx->notify_func2;
       eb->notify_baton = ctx->notify_baton2;
+      eb->jobs = jobs;
 
       SVN_ERR(svn_ra_check_path(ra_session, "", loc->rev, &kind, pool));
 
@@ -1466,7 +1622,7 @@ svn_client_export5(svn_revnum_t *result_rev,
       /* ### [JAF] If something already exists on disk at the destination path,
        * the behaviour depends on the node kinds of the source and destination
        * and on the FORCE flag.  The intention (I guess) is to follow the
-       * semantics of svn_client_export5(), semantics that are not fully
+       * semantics of svn_client_export6(), semantics that are not fully
        * documented but would be something like:
        *
        * -----------+---------------------------------------------------------
@@ -1558,7 +1714,7 @@ svn_client_export5(svn_revnum_t *result_rev,
                             svn_dirent_dirname(target_abspath, iterpool),
                             iterpool));
 
-              SVN_ERR(svn_client_export5(NULL,
+              SVN_ERR(svn_client_export6(NULL,
                                          svn_dirent_join(from_path_or_url,
                                                          relpath,
                                                          iterpool),
@@ -1566,7 +1722,7 @@ svn_client_export5(svn_revnum_t *result_rev,
                                          peg_revision, revision,
                                          TRUE, ignore_externals,
                                          ignore_keywords, depth, native_eol,
-                                         ctx, iterpool));
+                                         jobs, ctx, iterpool));
             }
 
           svn_pool_destroy(iterpool);
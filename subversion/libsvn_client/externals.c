@@ -1179,6 +1179,7 @@ svn_client__export_externals(apr_hash_t *externals,
                              svn_depth_t requested_depth,
                              const char *native_eol,
                              svn_boolean_t ignore_keywords,
+                             int jobs,
                              svn_client_ctx_t *ctx,
                              apr_pool_t *scratch_pool)
 {
@@ -1262,12 +1263,12 @@ svn_client__export_externals(apr_hash_t *externals,
 
           SVN_ERR(wrap_external_error(
                           ctx, item_abspath,
-                          svn_client_export5(NULL, new_url, item_abspath,
+                          svn_client_export6(NULL, new_url, item_abspath,
                                              &item->peg_revision,
                                              &item->revision,
                                              TRUE, FALSE, ignore_keywords,
                                              svn_depth_infinity,
-                                             native_eol,
+                                             native_eol, jobs,
                                              ctx, sub_iterpool),
                           sub_iterpool));
         }
@@ -59,6 +59,7 @@
 #include "private/svn_client_private.h"
 #include "private/svn_sorts_private.h"
 #include "private/svn_subr_private.h"
+#include "private/svn_thread_pool.h"
 #include "private/svn_wc_private.h"
 
 #include "svn_private_config.h"
@@ -215,6 +216,10 @@
 
 /*** Repos-Diff Editor Callbacks ***/
 
+/* Number of text merges that we let the workers run before we wait for
+   them and record their outcome. */
+#define TEXT_MERGE_BATCH_SIZE 256
+
 typedef struct merge_cmd_baton_t {
   svn_boolean_t force_delete;         /* Delete a file/dir even if modified */
   svn_boolean_t dry_run;
@@ -320,6 +325,13 @@ typedef struct merge_cmd_baton_t {
   apr_pool_t *pool;
 
 
+  /* While drive_merge_report_editor() lets worker threads run the text
+     merges, the group of those workers and the pending_text_merge_t * of
+     the merges whose outcome has not been recorded yet, in the order in
+     which merge_file_changed() started them.  Both are NULL otherwise. */
+  svn_thread_pool__group_t *text_merge_group;
+  apr_array_header_t *pending_text_merges;
+
   /* State for notify_merge_begin() */
   struct notify_begin_state_t
   {
@@ -1233,6 +1245,11 @@ notify_merge_begin(merge_cmd_baton_t *merge_b,
                    svn_boolean_t delete_action,
                    apr_pool_t *scratch_pool);
 
+/* Forward declaration */
+static svn_error_t *
+flush_text_merges(merge_cmd_baton_t *merge_b,
+                  apr_pool_t *scratch_pool);
+
 /* Record the skip for future processing and (later) produce the
    skip notification */
 static svn_error_t *
@@ -1556,6 +1573,8 @@ handle_pending_notifications(merge_cmd_baton_t *merge_b,
     {
       apr_hash_index_t *hi;
 
+      SVN_ERR(flush_text_merges(merge_b, scratch_pool));
+
       for (hi = apr_hash_first(scratch_pool, db->pending_deletes);
            hi;
            hi = apr_hash_next(hi))
@@ -1993,6 +2012,204 @@ merge_file_opened(void **new_file_baton,
   return SVN_NO_ERROR;
 }
 
+/* Record the conflicts that the merge of LOCAL_ABSPATH with the outcome
+ * CONTENT_OUTCOME and PROPERTY_STATE raised and return the notification
+ * state for its text.  HAS_LOCAL_MODS tells whether the text was modified
+ * before the merge.
+ */
+static svn_wc_notify_state_t
+text_merge_state(merge_cmd_baton_t *merge_b,
+                 const char *local_abspath,
+                 svn_boolean_t has_local_mods,
+                 enum svn_wc_merge_outcome_t content_outcome,
+                 svn_wc_notify_state_t property_state)
+{
+  if (content_outcome == svn_wc_merge_conflict
+      || property_state == svn_wc_notify_state_conflicted)
+    {
+      alloc_and_store_path(&merge_b->conflicted_paths, local_abspath,
+                           merge_b->pool);
+    }
+
+  if (content_outcome == svn_wc_merge_conflict)
+    return svn_wc_notify_state_conflicted;
+  else if (has_local_mods
+           && content_outcome != svn_wc_merge_unchanged)
+    return svn_wc_notify_state_merged;
+  else if (content_outcome == svn_wc_merge_merged)
+    return svn_wc_notify_state_changed;
+  else if (content_outcome == svn_wc_merge_no_merge)
+    return svn_wc_notify_state_missing;
+  else /* merge_outcome == svn_wc_merge_unchanged */
+    return svn_wc_notify_state_unchanged;
+}
+
+/* Record the update of the file LOCAL_ABSPATH with TEXT_STATE and
+ * PROPERTY_STATE, if the merge changed it at all.
+ */
+static svn_error_t *
+record_file_changed(merge_cmd_baton_t *merge_b,
+                    const char *local_abspath,
+                    svn_wc_notify_state_t text_state,
+                    svn_wc_notify_state_t property_state,
+                    apr_pool_t *scratch_pool)
+{
+  if (text_state == svn_wc_notify_state_conflicted
+      || text_state == svn_wc_notify_state_merged
+      || text_state == svn_wc_notify_state_changed
+      || property_state == svn_wc_notify_state_conflicted
+      || property_state == svn_wc_notify_state_merged
+      || property_state == svn_wc_notify_state_changed)
+    {
+      SVN_ERR(record_update_update(merge_b, local_abspath, svn_node_file,
+                                   text_state, property_state,
+                                   scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* A merge into a file whose text is being merged by a worker thread,
+   while we continue with the next files. */
+typedef struct pending_text_merge_t
+{
+  const char *local_abspath;
+  svn_boolean_t has_local_mods;
+
+  /* Holds everything else. */
+  apr_pool_t *pool;
+  svn_wc__file_merge_t *merge;
+
+  /* The worker task running svn_wc__merge_file_compute() on MERGE. */
+  svn_thread_pool__task_t *task;
+} pending_text_merge_t;
+
+/* Like the svn_wc_merge5() call in merge_file_changed() but let a worker
+ * of MERGE_B->TEXT_MERGE_GROUP run the text merge.  The outcome will be
+ * recorded and notified by flush_text_merges().
+ */
+static svn_error_t *
+queue_text_merge(merge_cmd_baton_t *merge_b,
+                 const char *local_abspath,
+                 svn_boolean_t has_local_mods,
+                 const char *left_file,
+                 const char *right_file,
+                 const char *left_label,
+                 const char *right_label,
+                 const char *target_label,
+                 const svn_wc_conflict_version_t *left,
+                 const svn_wc_conflict_version_t *right,
+                 apr_hash_t *left_props,
+                 const apr_array_header_t *prop_changes,
+                 apr_pool_t *scratch_pool)
+{
+  svn_client_ctx_t *ctx = merge_b->ctx;
+  apr_pool_t *pool;
+  pending_text_merge_t *pending;
+  svn_error_t *err;
+
+  if (merge_b->pending_text_merges->nelts >= TEXT_MERGE_BATCH_SIZE)
+    SVN_ERR(flush_text_merges(merge_b, scratch_pool));
+
+  pool = svn_pool_create(merge_b->pool);
+  pending = apr_pcalloc(pool, sizeof(*pending));
+  pending->local_abspath = apr_pstrdup(pool, local_abspath);
+  pending->has_local_mods = has_local_mods;
+  pending->pool = pool;
+
+  /* The diff editor removes LEFT_FILE and RIGHT_FILE when we return,
+     so let svn_wc__merge_file_prepare() copy them as needed. */
+  err = svn_wc__merge_file_prepare(&pending->merge, ctx->wc_ctx,
+                                   left_file, right_file, local_abspath,
+                                   left_label, right_label, target_label,
+                                   left, right,
+                                   merge_b->dry_run, merge_b->diff3_cmd,
+                                   merge_b->merge_options,
+                                   left_props, prop_changes,
+                                   TRUE /* merge_props */,
+                                   TRUE /* copy_inputs */,
+                                   ctx->cancel_func, ctx->cancel_baton,
+                                   pool, scratch_pool);
+  if (! err)
+    err = svn_thread_pool__run(&pending->task, merge_b->text_merge_group,
+                               svn_wc__merge_file_compute, pending->merge);
+
+  if (err)
+    {
+      svn_pool_destroy(pool);
+
+      /* Still record the merges that were started before this one. */
+      return svn_error_compose_create(err,
+                                      flush_text_merges(merge_b,
+                                                        scratch_pool));
+    }
+
+  APR_ARRAY_PUSH(merge_b->pending_text_merges, pending_text_merge_t *)
+    = pending;
+
+  return SVN_NO_ERROR;
+}
+
+/* Wait for the text merges that queue_text_merge() started for MERGE_B
+ * and record their outcome in the working copy, in the order in which
+ * they were started.  After an error, just wait for the remaining ones.
+ */
+static svn_error_t *
+flush_text_merges(merge_cmd_baton_t *merge_b,
+                  apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *pending;
+  apr_pool_t *iterpool;
+  svn_error_t *err = SVN_NO_ERROR;
+  int i;
+
+  if (! merge_b->pending_text_merges
+      || ! merge_b->pending_text_merges->nelts)
+    return SVN_NO_ERROR;
+
+  /* Recording the outcome notifies, which brings us back here. */
+  pending = apr_array_copy(scratch_pool, merge_b->pending_text_merges);
+  apr_array_clear(merge_b->pending_text_merges);
+
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < pending->nelts; i++)
+    {
+      pending_text_merge_t *current
+        = APR_ARRAY_IDX(pending, i, pending_text_merge_t *);
+
+      svn_pool_clear(iterpool);
+
+      if (! err)
+        err = svn_thread_pool__task_wait(current->task);
+
+      if (! err)
+        {
+          enum svn_wc_merge_outcome_t content_outcome;
+          svn_wc_notify_state_t property_state;
+          svn_wc_notify_state_t text_state;
+
+          err = svn_wc__merge_file_install(&content_outcome, &property_state,
+                                           current->merge, NULL, NULL,
+                                           iterpool);
+          if (! err)
+            {
+              text_state = text_merge_state(merge_b, current->local_abspath,
+                                            current->has_local_mods,
+                                            content_outcome, property_state);
+              err = record_file_changed(merge_b, current->local_abspath,
+                                        text_state, property_state,
+                                        iterpool);
+            }
+        }
+
+      svn_thread_pool__task_destroy(current->task);
+      svn_pool_destroy(current->pool);
+    }
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(err);
+}
+
 /* An svn_diff_tree_processor_t function.
  *
  * Called after merge_file_opened() when a node receives only text and/or
@@ -2122,6 +2339,15 @@ merge_file_changed(const char *relpath,
       SVN_ERR(svn_wc_text_modified_p2(&has_local_mods, ctx->wc_ctx,
                                       local_abspath, FALSE, scratch_pool));
 
+      if (merge_b->pending_text_merges)
+        return svn_error_trace(queue_text_merge(merge_b, local_abspath,
+                                                has_local_mods,
+                                                left_file, right_file,
+                                                left_label, right_label,
+                                                target_label, left, right,
+                                                left_props, prop_changes,
+                                                scratch_pool));
+
       /* Do property merge and text merge in one step so that keyword expansion
          takes into account the new property values. */
       SVN_ERR(svn_wc_merge5(&content_outcome, &property_state, ctx->wc_ctx,
@@ -2136,39 +2362,13 @@ merge_file_changed(const char *relpath,
                             ctx->cancel_baton,
                             scratch_pool));
 
-      if (content_outcome == svn_wc_merge_conflict
-          || property_state == svn_wc_notify_state_conflicted)
-        {
-          alloc_and_store_path(&merge_b->conflicted_paths, local_abspath,
-                               merge_b->pool);
-        }
-
-      if (content_outcome == svn_wc_merge_conflict)
-        text_state = svn_wc_notify_state_conflicted;
-      else if (has_local_mods
-               && content_outcome != svn_wc_merge_unchanged)
-        text_state = svn_wc_notify_state_merged;
-      else if (content_outcome == svn_wc_merge_merged)
-        text_state = svn_wc_notify_state_changed;
-      else if (content_outcome == svn_wc_merge_no_merge)
-        text_state = svn_wc_notify_state_missing;
-      else /* merge_outcome == svn_wc_merge_unchanged */
-        text_state = svn_wc_notify_state_unchanged;
+      text_state = text_merge_state(merge_b, local_abspath, has_local_mods,
+                                    content_outcome, property_state);
     }
 
-  if (text_state == svn_wc_notify_state_conflicted
-      || text_state == svn_wc_notify_state_merged
-      || text_state == svn_wc_notify_state_changed
-      || property_state == svn_wc_notify_state_conflicted
-      || property_state == svn_wc_notify_state_merged
-      || property_state == svn_wc_notify_state_changed)
-    {
-      SVN_ERR(record_update_update(merge_b, local_abspath, svn_node_file,
-                                   text_state, property_state,
-                                   scratch_pool));
-    }
-
-  return SVN_NO_ERROR;
+  return svn_error_trace(record_file_changed(merge_b, local_abspath,
+                                             text_state, property_state,
+                                             scratch_pool));
 }
 
 /* An svn_diff_tree_processor_t function.
@@ -3667,6 +3867,10 @@ notify_merge_begin(merge_cmd_baton_t *merge_b,
     {SVN_INVALID_REVNUM, SVN_INVALID_REVNUM, TRUE};
   const char *notify_abspath;
 
+  /* Text merges that are still pending were started before whatever we
+     are about to notify, so record and notify them first. */
+  SVN_ERR(flush_text_merges(merge_b, scratch_pool));
+
   if (! merge_b->ctx->notify_func2)
     return SVN_NO_ERROR;
 
@@ -5693,6 +5897,8 @@ drive_merge_report_editor(const char *target_abspath,
   svn_boolean_t honor_mergeinfo = HONOR_MERGEINFO(merge_b);
   const char *old_sess1_url, *old_sess2_url;
   svn_boolean_t is_rollback = source->loc1->rev > source->loc2->rev;
+  int worker_threads;
+  svn_error_t *err;
 
   /* Start with a safe default starting revision for the editor and the
      merge target. */
@@ -5875,7 +6081,34 @@ drive_merge_report_editor(const char *target_abspath,
         }
       svn_pool_destroy(iterpool);
     }
-  SVN_ERR(reporter->finish_report(report_baton, scratch_pool));
+
+  /* If we may use worker threads, let them run the three-way text merges
+     while the editor drive continues with the next files.  Working copy
+     updates and notifications still happen on this thread. */
+  worker_threads = svn_wc__get_worker_threads(merge_b->ctx->wc_ctx);
+  if (worker_threads > 1 && ! merge_b->record_only)
+    {
+      SVN_ERR(svn_thread_pool__group_create(&merge_b->text_merge_group,
+                                            worker_threads, scratch_pool));
+      if (svn_thread_pool__group_is_parallel(merge_b->text_merge_group))
+        merge_b->pending_text_merges
+          = apr_array_make(scratch_pool, TEXT_MERGE_BATCH_SIZE,
+                           sizeof(pending_text_merge_t *));
+    }
+
+  err = reporter->finish_report(report_baton, scratch_pool);
+
+  if (merge_b->text_merge_group)
+    {
+      err = svn_error_compose_create(err,
+                                     flush_text_merges(merge_b,
+                                                       scratch_pool));
+      err = svn_error_compose_create(
+              err, svn_thread_pool__group_wait(merge_b->text_merge_group));
+      merge_b->text_merge_group = NULL;
+      merge_b->pending_text_merges = NULL;
+    }
+  SVN_ERR(err);
 
   /* Point the merge baton's RA sessions back where they were. */
   SVN_ERR(svn_ra_reparent(merge_b->ra_session1, old_sess1_url, scratch_pool));
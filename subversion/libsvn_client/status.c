@@ -586,11 +586,11 @@ svn_client_status6(svn_revnum_t *result_rev,
     }
   else
     {
-      err = svn_wc_walk_status(ctx->wc_ctx, target_abspath,
-                               depth, get_all, no_ignore, FALSE, ignores,
-                               tweak_status, &sb,
-                               ctx->cancel_func, ctx->cancel_baton,
-                               pool);
+      err = svn_wc__walk_status_journaled(ctx->wc_ctx, target_abspath,
+                                          depth, get_all, no_ignore, FALSE,
+                                          ignores, tweak_status, &sb,
+                                          ctx->cancel_func,
+                                          ctx->cancel_baton, pool);
 
       if (err && err->apr_err == SVN_ERR_WC_MISSING)
         {
@@ -0,0 +1,389 @@
+/*
+ * blame.c :  attributing the lines of a file across a series of diffs
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+
+#include <apr_pools.h>
+#include <apr_tables.h>
+
+#include "svn_diff.h"
+#include "svn_error.h"
+
+#include "private/svn_diff_private.h"
+
+
+/* One chunk of blame: a run of LENGTH consecutive tokens attributed to
+   BATON.
+
+   The chunks of a file are kept in a treap ordered by their position in
+   the file, in which every node also knows the number of tokens in its
+   subtree.  Token offsets are therefore implicit, and finding, inserting
+   or deleting a range of tokens costs time logarithmic in the number of
+   chunks rather than linear, which matters for files with a long history
+   of small changes. */
+typedef struct blame_node_t
+{
+  const void *baton;          /* the attribution */
+  apr_off_t length;           /* the number of tokens in this chunk */
+  apr_off_t total;            /* the number of tokens in this subtree */
+  apr_uint32_t priority;      /* treap priority, never less than children's */
+  struct blame_node_t *left;  /* chunks before this one */
+  struct blame_node_t *right; /* chunks after this one */
+} blame_node_t;
+
+struct svn_diff__blame_t
+{
+  blame_node_t *root;         /* treap of blame chunks */
+  svn_boolean_t started;      /* TRUE once any blame has been recorded */
+  const void *tail_baton;     /* attribution of all tokens after ROOT */
+  blame_node_t *avail;        /* free blame chunks, linked through RIGHT */
+  apr_uint32_t seed;          /* state of the priority generator */
+  apr_pool_t *pool;           /* Allocate members from this pool. */
+};
+
+/* Return the number of tokens in the subtree rooted at NODE. */
+#define NODE_TOTAL(node) ((node) ? (node)->total : 0)
+
+/* Recalculate the token count of NODE from its own and its children's. */
+static void
+node_update(blame_node_t *node)
+{
+  node->total = node->length + NODE_TOTAL(node->left)
+                + NODE_TOTAL(node->right);
+}
+
+/* Return a blame chunk attributed to BATON for LENGTH tokens, allocated
+   in BLAME->pool. */
+static blame_node_t *
+node_create(svn_diff__blame_t *blame,
+            const void *baton,
+            apr_off_t length)
+{
+  blame_node_t *node;
+  if (blame->avail)
+    {
+      node = blame->avail;
+      blame->avail = node->right;
+    }
+  else
+    node = apr_palloc(blame->pool, sizeof(*node));
+
+  /* xorshift32; any reasonably random sequence keeps the treap balanced. */
+  blame->seed ^= blame->seed << 13;
+  blame->seed ^= blame->seed >> 17;
+  blame->seed ^= blame->seed << 5;
+
+  node->baton = baton;
+  node->length = length;
+  node->total = length;
+  node->priority = blame->seed;
+  node->left = NULL;
+  node->right = NULL;
+  return node;
+}
+
+/* Destroy NODE and all chunks below it. */
+static void
+node_destroy(svn_diff__blame_t *blame,
+             blame_node_t *node)
+{
+  while (node)
+    {
+      blame_node_t *right = node->right;
+
+      node_destroy(blame, node->left);
+      node->right = blame->avail;
+      blame->avail = node;
+      node = right;
+    }
+}
+
+/* Return the concatenation of the chunks of treaps LEFT and RIGHT. */
+static blame_node_t *
+node_merge(blame_node_t *left, blame_node_t *right)
+{
+  if (!left)
+    return right;
+  if (!right)
+    return left;
+
+  if (left->priority >= right->priority)
+    {
+      left->right = node_merge(left->right, right);
+      node_update(left);
+      return left;
+    }
+  else
+    {
+      right->left = node_merge(left, right->left);
+      node_update(right);
+      return right;
+    }
+}
+
+/* Split the treap NODE into *LEFT, holding its first OFF tokens, and
+   *RIGHT, holding the rest.  A chunk that straddles OFF is cut in two. */
+static void
+node_split(svn_diff__blame_t *blame,
+           blame_node_t *node,
+           apr_off_t off,
+           blame_node_t **left,
+           blame_node_t **right)
+{
+  apr_off_t left_total;
+
+  if (!node)
+    {
+      *left = *right = NULL;
+      return;
+    }
+
+  left_total = NODE_TOTAL(node->left);
+  if (off <= left_total)
+    {
+      node_split(blame, node->left, off, left, &node->left);
+      node_update(node);
+      *right = node;
+    }
+  else if (off >= left_total + node->length)
+    {
+      node_split(blame, node->right, off - left_total - node->length,
+                 &node->right, right);
+      node_update(node);
+      *left = node;
+    }
+  else
+    {
+      /* The second half inherits NODE's priority and right subtree, so
+         both halves still satisfy the heap order. */
+      blame_node_t *rest = node_create(blame, node->baton,
+                                       left_total + node->length - off);
+      rest->priority = node->priority;
+      rest->right = node->right;
+      node_update(rest);
+
+      node->length = off - left_total;
+      node->right = NULL;
+      node_update(node);
+
+      *left = node;
+      *right = rest;
+    }
+}
+
+/* Make sure BLAME covers at least END tokens, attributing any tokens
+   added at the end to BLAME->tail_baton. */
+static void
+blame_extend(svn_diff__blame_t *blame, apr_off_t end)
+{
+  apr_off_t total = NODE_TOTAL(blame->root);
+
+  if (total < end)
+    blame->root = node_merge(blame->root,
+                             node_create(blame, blame->tail_baton,
+                                         end - total));
+}
+
+/* Delete the blame associated with the region from token START to
+   START + LENGTH */
+static void
+blame_delete_range(svn_diff__blame_t *blame,
+                   apr_off_t start,
+                   apr_off_t length)
+{
+  blame_node_t *head, *middle, *tail;
+
+  blame_extend(blame, start + length);
+  node_split(blame, blame->root, start, &head, &tail);
+  node_split(blame, tail, length, &middle, &tail);
+  node_destroy(blame, middle);
+  blame->root = node_merge(head, tail);
+}
+
+/* Insert a chunk of blame associated with BATON starting
+   at token START and continuing for LENGTH tokens */
+static void
+blame_insert_range(svn_diff__blame_t *blame,
+                   const void *baton,
+                   apr_off_t start,
+                   apr_off_t length)
+{
+  blame_node_t *head, *tail;
+
+  blame_extend(blame, start);
+  node_split(blame, blame->root, start, &head, &tail);
+  head = node_merge(head, node_create(blame, baton, length));
+  blame->root = node_merge(head, tail);
+}
+
+/* Append a chunk attributed to BATON and starting at token START to
+   CHUNKS, unless it just continues the last chunk there. */
+static void
+append_chunk(apr_array_header_t *chunks,
+             const void *baton,
+             apr_off_t start)
+{
+  svn_diff__blame_chunk_t *chunk;
+
+  if (chunks->nelts
+      && APR_ARRAY_IDX(chunks, chunks->nelts - 1,
+                       svn_diff__blame_chunk_t).baton == baton)
+    return;
+
+  chunk = apr_array_push(chunks);
+  chunk->baton = baton;
+  chunk->start = start;
+}
+
+/* Append the chunks below NODE, which start at token START, to CHUNKS. */
+static void
+collect_chunks(apr_array_header_t *chunks,
+               const blame_node_t *node,
+               apr_off_t start)
+{
+  while (node)
+    {
+      collect_chunks(chunks, node->left, start);
+      start += NODE_TOTAL(node->left);
+
+      append_chunk(chunks, node->baton, start);
+
+      start += node->length;
+      node = node->right;
+    }
+}
+
+/* Baton for output_diff_modified(). */
+typedef struct update_baton_t
+{
+  svn_diff__blame_t *blame;
+  const void *baton;
+} update_baton_t;
+
+/* Callback for diff between subsequent versions.
+   Implements svn_diff_output_fns_t.output_diff_modified. */
+static svn_error_t *
+output_diff_modified(void *baton,
+                     apr_off_t original_start,
+                     apr_off_t original_length,
+                     apr_off_t modified_start,
+                     apr_off_t modified_length,
+                     apr_off_t latest_start,
+                     apr_off_t latest_length)
+{
+  update_baton_t *ub = baton;
+
+  if (original_length)
+    blame_delete_range(ub->blame, modified_start, original_length);
+
+  if (modified_length)
+    blame_insert_range(ub->blame, ub->baton, modified_start,
+                       modified_length);
+
+  return SVN_NO_ERROR;
+}
+
+static const svn_diff_output_fns_t update_output_fns = {
+        NULL,
+        output_diff_modified
+};
+
+svn_diff__blame_t *
+svn_diff__blame_create(apr_pool_t *result_pool)
+{
+  svn_diff__blame_t *blame = apr_pcalloc(result_pool, sizeof(*blame));
+
+  blame->seed = 0x2545F491;
+  blame->pool = result_pool;
+  return blame;
+}
+
+svn_boolean_t
+svn_diff__blame_is_empty(const svn_diff__blame_t *blame)
+{
+  return !blame->started;
+}
+
+void
+svn_diff__blame_reset(svn_diff__blame_t *blame,
+                      const void *baton)
+{
+  node_destroy(blame, blame->root);
+  blame->root = NULL;
+  blame->tail_baton = baton;
+  blame->started = TRUE;
+}
+
+svn_error_t *
+svn_diff__blame_update(svn_diff__blame_t *blame,
+                       svn_diff_t *diff,
+                       const void *baton,
+                       svn_cancel_func_t cancel_func,
+                       void *cancel_baton)
+{
+  update_baton_t ub;
+
+  ub.blame = blame;
+  ub.baton = baton;
+  blame->started = TRUE;
+
+  return svn_error_trace(svn_diff_output2(diff, &ub, &update_output_fns,
+                                          cancel_func, cancel_baton));
+}
+
+apr_array_header_t *
+svn_diff__blame_chunks(const svn_diff__blame_t *blame,
+                       apr_pool_t *result_pool)
+{
+  apr_array_header_t *chunks
+    = apr_array_make(result_pool, 16, sizeof(svn_diff__blame_chunk_t));
+
+  collect_chunks(chunks, blame->root, 0);
+  append_chunk(chunks, blame->tail_baton, NODE_TOTAL(blame->root));
+
+  return chunks;
+}
+
+void
+svn_diff__blame_set_chunks(svn_diff__blame_t *blame,
+                           const apr_array_header_t *chunks)
+{
+  int i;
+
+  svn_diff__blame_reset(blame,
+                        APR_ARRAY_IDX(chunks, chunks->nelts - 1,
+                                      svn_diff__blame_chunk_t).baton);
+
+  /* The last chunk extends to the end of the file. */
+  for (i = 0; i + 1 < chunks->nelts; i++)
+    {
+      const svn_diff__blame_chunk_t *chunk
+        = &APR_ARRAY_IDX(chunks, i, svn_diff__blame_chunk_t);
+      apr_off_t length = APR_ARRAY_IDX(chunks, i + 1,
+                                       svn_diff__blame_chunk_t).start
+                         - chunk->start;
+
+      if (length > 0)
+        blame->root = node_merge(blame->root,
+                                 node_create(blame, chunk->baton, length));
+    }
+}
@@ -115,6 +115,26 @@ svn_diff__lcs(svn_diff__position_t *position_list1, /* pointer to tail (ring) */
               apr_pool_t *pool);
 
 
+/*
+ * Like svn_diff__lcs(), but find the common subsequence with the histogram
+ * algorithm: recursively split both sequences at the longest match that
+ * contains the least frequent common tokens.  Regions that only have
+ * frequent tokens in common are handed to svn_diff__lcs().
+ *
+ * The result is not necessarily the longest common subsequence, but it
+ * has the same structure as that of svn_diff__lcs() and may be passed to
+ * svn_diff__diff().  The position lists will be restored on return.
+ * Allocations will be made from POOL.
+ */
+svn_diff__lcs_t *
+svn_diff__histogram(svn_diff__position_t *position_list1, /* tail (ring) */
+                    svn_diff__position_t *position_list2, /* tail (ring) */
+                    svn_diff__token_index_t num_tokens,
+                    apr_off_t prefix_lines,
+                    apr_off_t suffix_lines,
+                    apr_pool_t *pool);
+
+
 /*
  * Returns number of tokens in a tree
  */
@@ -122,7 +142,8 @@ svn_diff__token_index_t
 svn_diff__get_node_count(svn_diff__tree_t *tree);
 
 /*
- * Support functions to build a tree of token positions
+ * Support functions to build a tree of token positions.  Despite its name,
+ * the "tree" is an open addressing hash table of the unique tokens.
  */
 void
 svn_diff__tree_create(svn_diff__tree_t **tree, apr_pool_t *pool);
@@ -151,6 +172,25 @@ svn_diff__get_token_counts(svn_diff__position_t *loop_start,
                            svn_diff__token_index_t num_tokens,
                            apr_pool_t *pool);
 
+/* Like svn_diff_diff_2(), but find the differences using ALGORITHM. */
+svn_error_t *
+svn_diff__diff_2(svn_diff_t **diff,
+                 void *diff_baton,
+                 const svn_diff_fns2_t *vtable,
+                 svn_diff_file_algorithm_t algorithm,
+                 apr_pool_t *pool);
+
+/* Like svn_diff_diff3_2(), but find the differences with up to
+ * CONCURRENCY threads.  If CHUNKED is TRUE, large texts may be split
+ * into sections that get compared independently of each other. */
+svn_error_t *
+svn_diff__diff3(svn_diff_t **diff,
+                void *diff_baton,
+                const svn_diff_fns2_t *vtable,
+                int concurrency,
+                svn_boolean_t chunked,
+                apr_pool_t *pool);
+
 /* Morph a svn_lcs_t into a svn_diff_t. */
 svn_diff_t *
 svn_diff__diff(svn_diff__lcs_t *lcs,
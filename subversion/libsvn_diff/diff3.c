@@ -32,6 +32,8 @@
 #include "svn_sorts.h"
 #include "svn_types.h"
 
+#include "private/svn_thread_pool.h"
+
 #include "diff.h"
 
 
@@ -247,11 +249,441 @@ svn_diff__resolve_conflict(svn_diff_t *hunk,
 }
 
 
+/* Minimum number of lines of the original text per chunk. */
+#define CHUNK_MIN_LINES 4096
+
+/* Upper limit to the number of chunks per pairwise comparison. */
+#define CHUNK_MAX_COUNT 64
+
+/* Number of consecutive lines that must be identical in both texts to
+ * split them at this point.  The first of them must also be unique to
+ * both texts. */
+#define ANCHOR_LINES 4
+
+/* The computation of the common subsequence of one region of two texts,
+ * to be executed by svn_thread_pool__run(). */
+typedef struct lcs_task_t
+{
+  /* The first and the last position of the region in each of the two
+   * texts.  Neither part of the region may be empty. */
+  svn_diff__position_t *head[2];
+  svn_diff__position_t *tail[2];
+
+  /* If not NULL, the token counts for the texts, which then must consist
+   * of the region only.  Otherwise, the region is a part of the texts
+   * and the task will count its tokens itself. */
+  svn_diff__token_index_t *token_counts[2];
+  svn_diff__token_index_t num_tokens;
+
+  /* The result, without the prefix, suffix and EOF links.  Allocated in
+   * the task's pool. */
+  svn_diff__lcs_t *lcs;
+
+  /* Handle for the running task. */
+  svn_thread_pool__task_t *task;
+} lcs_task_t;
+
+/* Find the common subsequence of the region described by the
+ * lcs_task_t BATON and store it in BATON.
+ * Implements svn_thread_pool__func_t. */
+static svn_error_t *
+lcs_task_func(void *baton,
+              apr_pool_t *result_pool)
+{
+  lcs_task_t *task = baton;
+  svn_diff__position_t *saved_next[2];
+  svn_diff__token_index_t *token_counts[2];
+  apr_pool_t *scratch_pool = svn_pool_create(result_pool);
+  int i;
+
+  for (i = 0; i < 2; i++)
+    {
+      /* Turn the region into a ring of its own.  Only the nodes of the
+       * region get touched, so other tasks may work on other regions of
+       * the same texts in the meantime. */
+      saved_next[i] = task->tail[i]->next;
+      task->tail[i]->next = task->head[i];
+
+      if (task->token_counts[i])
+        token_counts[i] = task->token_counts[i];
+      else
+        token_counts[i] = svn_diff__get_token_counts(task->tail[i],
+                                                     task->num_tokens,
+                                                     scratch_pool);
+    }
+
+  task->lcs = svn_diff__lcs(task->tail[0], task->tail[1],
+                            token_counts[0], token_counts[1],
+                            task->num_tokens, 0, 0, result_pool);
+
+  for (i = 0; i < 2; i++)
+    task->tail[i]->next = saved_next[i];
+
+  svn_pool_destroy(scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Return a copy of the ring of positions whose tail is TAIL, allocated
+ * in POOL. */
+static svn_diff__position_t *
+copy_ring(svn_diff__position_t *tail,
+          apr_pool_t *pool)
+{
+  svn_diff__position_t *position = tail->next;
+  apr_off_t length = tail->offset - position->offset + 1;
+  svn_diff__position_t *copy = apr_palloc(pool, length * sizeof(*copy));
+  apr_off_t i;
+
+  for (i = 0; i < length; i++)
+    {
+      copy[i].token_index = position->token_index;
+      copy[i].offset = position->offset;
+      copy[i].next = &copy[(i + 1) % length];
+      position = position->next;
+    }
+
+  return &copy[length - 1];
+}
+
+/* Return a new lcs task for the whole rings TAIL1 and TAIL2 with the
+ * TOKEN_COUNTS1 and TOKEN_COUNTS2.  Allocate it in POOL. */
+static lcs_task_t *
+create_lcs_task(svn_diff__position_t *tail1,
+                svn_diff__position_t *tail2,
+                svn_diff__token_index_t *token_counts1,
+                svn_diff__token_index_t *token_counts2,
+                svn_diff__token_index_t num_tokens,
+                apr_pool_t *pool)
+{
+  lcs_task_t *task = apr_pcalloc(pool, sizeof(*task));
+
+  task->head[0] = tail1->next;
+  task->head[1] = tail2->next;
+  task->tail[0] = tail1;
+  task->tail[1] = tail2;
+  task->token_counts[0] = token_counts1;
+  task->token_counts[1] = token_counts2;
+  task->num_tokens = num_tokens;
+
+  return task;
+}
+
+/* Append lcs tasks to TASKS that compare the rings TAIL1 and TAIL2 with
+ * the TOKEN_COUNTS1 and TOKEN_COUNTS2 chunk by chunk.  Chunks end right
+ * before ANCHOR_LINES identical lines in both rings, so the chunks'
+ * common subsequences usually add up to that of the whole rings.
+ * Allocate the tasks in POOL. */
+static void
+create_chunk_tasks(apr_array_header_t *tasks,
+                   svn_diff__position_t *tail1,
+                   svn_diff__position_t *tail2,
+                   svn_diff__token_index_t *token_counts1,
+                   svn_diff__token_index_t *token_counts2,
+                   svn_diff__token_index_t num_tokens,
+                   apr_pool_t *pool)
+{
+  apr_pool_t *scratch_pool = svn_pool_create(pool);
+  svn_diff__position_t **positions[2];
+  apr_off_t length[2];
+  apr_off_t *unique_line;
+  apr_off_t chunk_count, chunk, line, other_line = 0;
+  apr_off_t start[2] = { 0, 0 };
+  lcs_task_t *task;
+  int i;
+
+  length[0] = tail1->offset - tail1->next->offset + 1;
+  length[1] = tail2->offset - tail2->next->offset + 1;
+  chunk_count = MIN(length[0] / CHUNK_MIN_LINES, CHUNK_MAX_COUNT);
+  if (chunk_count < 2)
+    {
+      APR_ARRAY_PUSH(tasks, lcs_task_t *)
+        = create_lcs_task(tail1, tail2, token_counts1, token_counts2,
+                          num_tokens, pool);
+      svn_pool_destroy(scratch_pool);
+      return;
+    }
+
+  /* Index both rings by line number and find the lines of the second
+   * ring whose tokens are unique to both of them. */
+  for (i = 0; i < 2; i++)
+    {
+      svn_diff__position_t *position = i ? tail2->next : tail1->next;
+
+      positions[i] = apr_palloc(scratch_pool,
+                                length[i] * sizeof(*positions[i]));
+      for (line = 0; line < length[i]; line++)
+        {
+          positions[i][line] = position;
+          position = position->next;
+        }
+    }
+
+  unique_line = apr_palloc(scratch_pool, num_tokens * sizeof(*unique_line));
+  for (line = 0; line < length[1]; line++)
+    {
+      svn_diff__token_index_t token = positions[1][line]->token_index;
+
+      if (token_counts1[token] == 1 && token_counts2[token] == 1)
+        unique_line[token] = line;
+    }
+
+  /* Look for an anchor at or after each chunk's nominal end. */
+  for (chunk = 1; chunk < chunk_count; chunk++)
+    {
+      apr_off_t limit = MIN((chunk + 1) * length[0] / chunk_count,
+                            length[0] - ANCHOR_LINES);
+
+      for (line = MAX(chunk * length[0] / chunk_count, start[0] + 1);
+           line < limit;
+           line++)
+        {
+          svn_diff__token_index_t token = positions[0][line]->token_index;
+          apr_off_t k;
+
+          if (token_counts1[token] != 1 || token_counts2[token] != 1)
+            continue;
+
+          other_line = unique_line[token];
+          if (other_line <= start[1] || other_line + ANCHOR_LINES > length[1])
+            continue;
+
+          for (k = 1; k < ANCHOR_LINES; k++)
+            if (positions[0][line + k]->token_index
+                != positions[1][other_line + k]->token_index)
+              break;
+
+          if (k == ANCHOR_LINES)
+            break;
+        }
+
+      if (line >= limit)
+        continue;
+
+      task = apr_pcalloc(pool, sizeof(*task));
+      task->head[0] = positions[0][start[0]];
+      task->head[1] = positions[1][start[1]];
+      task->tail[0] = positions[0][line - 1];
+      task->tail[1] = positions[1][other_line - 1];
+      task->num_tokens = num_tokens;
+      APR_ARRAY_PUSH(tasks, lcs_task_t *) = task;
+
+      start[0] = line;
+      start[1] = other_line;
+    }
+
+  task = apr_pcalloc(pool, sizeof(*task));
+  task->head[0] = positions[0][start[0]];
+  task->head[1] = positions[1][start[1]];
+  task->tail[0] = tail1;
+  task->tail[1] = tail2;
+  task->token_counts[0] = start[0] ? NULL : token_counts1;
+  task->token_counts[1] = start[1] ? NULL : token_counts2;
+  task->num_tokens = num_tokens;
+  APR_ARRAY_PUSH(tasks, lcs_task_t *) = task;
+
+  svn_pool_destroy(scratch_pool);
+}
+
+/* Return a new lcs link of LENGTH lines at the line numbers OFFSET0 and
+ * OFFSET1, allocated in POOL. */
+static svn_diff__lcs_t *
+new_lcs(apr_off_t offset0,
+        apr_off_t offset1,
+        apr_off_t length,
+        apr_pool_t *pool)
+{
+  svn_diff__lcs_t *lcs = apr_palloc(pool, sizeof(*lcs));
+
+  lcs->position[0] = apr_pcalloc(pool, sizeof(*lcs->position[0]));
+  lcs->position[0]->offset = offset0;
+  lcs->position[1] = apr_pcalloc(pool, sizeof(*lcs->position[1]));
+  lcs->position[1]->offset = offset1;
+  lcs->length = length;
+  lcs->refcount = 1;
+  lcs->next = NULL;
+
+  return lcs;
+}
+
+/* Concatenate the results of the COUNT lcs TASKS, which must cover the
+ * rings TAIL1 and TAIL2 in order, and add the links for PREFIX_LINES,
+ * SUFFIX_LINES and EOF, such that the result is the same as that of
+ * svn_diff__lcs() for the whole rings.  Allocate the result in POOL. */
+static svn_diff__lcs_t *
+join_lcs_tasks(lcs_task_t **tasks,
+               int count,
+               svn_diff__position_t *tail1,
+               svn_diff__position_t *tail2,
+               apr_off_t prefix_lines,
+               apr_off_t suffix_lines,
+               apr_pool_t *pool)
+{
+  svn_diff__lcs_t *result = NULL;
+  svn_diff__lcs_t **result_ref = &result;
+  svn_diff__lcs_t *last = NULL;
+  apr_off_t eof[2];
+  int i;
+
+  if (prefix_lines)
+    {
+      *result_ref = new_lcs(1, 1, prefix_lines, pool);
+      result_ref = &(*result_ref)->next;
+    }
+
+  for (i = 0; i < count; i++)
+    {
+      svn_diff__lcs_t *lcs;
+
+      for (lcs = tasks[i]->lcs; lcs->length; lcs = lcs->next)
+        {
+          /* Matches may continue across chunk boundaries. */
+          if (lcs == tasks[i]->lcs && last
+              && last->position[0]->offset + last->length
+                   == lcs->position[0]->offset
+              && last->position[1]->offset + last->length
+                   == lcs->position[1]->offset)
+            {
+              last->length += lcs->length;
+              continue;
+            }
+
+          last = apr_palloc(pool, sizeof(*last));
+          *last = *lcs;
+          last->next = NULL;
+          *result_ref = last;
+          result_ref = &last->next;
+        }
+    }
+
+  eof[0] = (tail1 ? tail1->offset : prefix_lines) + suffix_lines + 1;
+  eof[1] = (tail2 ? tail2->offset : prefix_lines) + suffix_lines + 1;
+
+  if (suffix_lines)
+    {
+      *result_ref = new_lcs(eof[0] - suffix_lines, eof[1] - suffix_lines,
+                            suffix_lines, pool);
+      result_ref = &(*result_ref)->next;
+    }
+
+  *result_ref = new_lcs(eof[0], eof[1], 0, pool);
+
+  return result;
+}
+
+/* Set *LCS_OM and *LCS_OL to the common subsequences of the original
+ * and the modified resp. latest text, given by POSITION_LIST and
+ * TOKEN_COUNTS, with up to CONCURRENCY threads.  If CHUNKED is TRUE,
+ * split the texts into chunks that are compared independently of each
+ * other.  The other parameters are the same as for svn_diff__lcs().
+ *
+ * Return FALSE in *DONE if there is nothing to be gained from threading
+ * or chunking and the caller shall use svn_diff__lcs() directly.
+ * Allocate the results in POOL. */
+static svn_error_t *
+parallel_lcs(svn_boolean_t *done,
+             svn_diff__lcs_t **lcs_om,
+             svn_diff__lcs_t **lcs_ol,
+             svn_diff__position_t *position_list[3],
+             svn_diff__token_index_t *token_counts[3],
+             svn_diff__token_index_t num_tokens,
+             apr_off_t prefix_lines,
+             apr_off_t suffix_lines,
+             int concurrency,
+             svn_boolean_t chunked,
+             apr_pool_t *pool)
+{
+  svn_thread_pool__group_t *group;
+  apr_array_header_t *tasks[2];
+  svn_diff__position_t *original[2];
+  svn_error_t *err = SVN_NO_ERROR;
+  int started = 0;
+  int i, k;
+
+  *done = FALSE;
+  if (position_list[0] == NULL)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_thread_pool__group_create(&group, concurrency, pool));
+  if (!chunked && !svn_thread_pool__group_is_parallel(group))
+    return SVN_NO_ERROR;
+
+  /* svn_diff__lcs() temporarily modifies its input rings, so each of
+   * the two comparisons gets its own copy of the original. */
+  original[0] = copy_ring(position_list[0], pool);
+  original[1] = position_list[0];
+
+  for (i = 0; i < 2; i++)
+    {
+      tasks[i] = apr_array_make(pool, 1, sizeof(lcs_task_t *));
+      if (position_list[i + 1] == NULL)
+        continue;
+
+      if (chunked)
+        create_chunk_tasks(tasks[i], original[i], position_list[i + 1],
+                           token_counts[0], token_counts[i + 1],
+                           num_tokens, pool);
+      else
+        APR_ARRAY_PUSH(tasks[i], lcs_task_t *)
+          = create_lcs_task(original[i], position_list[i + 1],
+                            token_counts[0], token_counts[i + 1],
+                            num_tokens, pool);
+    }
+
+  for (i = 0; i < 2 && !err; i++)
+    for (k = 0; k < tasks[i]->nelts && !err; k++)
+      {
+        lcs_task_t *task = APR_ARRAY_IDX(tasks[i], k, lcs_task_t *);
+
+        err = svn_thread_pool__run(&task->task, group, lcs_task_func, task);
+        if (!err)
+          started++;
+      }
+
+  /* Wait for all tasks that we started and collect their results. */
+  for (i = 0; i < 2; i++)
+    for (k = 0; k < tasks[i]->nelts && started; k++, started--)
+      {
+        lcs_task_t *task = APR_ARRAY_IDX(tasks[i], k, lcs_task_t *);
+
+        err = svn_error_compose_create(err,
+                                       svn_thread_pool__task_wait(task->task));
+      }
+
+  if (!err)
+    {
+      *lcs_om = join_lcs_tasks((lcs_task_t **)tasks[0]->elts,
+                               tasks[0]->nelts, position_list[0],
+                               position_list[1], prefix_lines, suffix_lines,
+                               pool);
+      *lcs_ol = join_lcs_tasks((lcs_task_t **)tasks[1]->elts,
+                               tasks[1]->nelts, position_list[0],
+                               position_list[2], prefix_lines, suffix_lines,
+                               pool);
+      *done = TRUE;
+    }
+
+  for (i = 0; i < 2; i++)
+    for (k = 0; k < tasks[i]->nelts; k++)
+      {
+        lcs_task_t *task = APR_ARRAY_IDX(tasks[i], k, lcs_task_t *);
+
+        if (task->task)
+          svn_thread_pool__task_destroy(task->task);
+      }
+
+  return svn_error_trace(
+           svn_error_compose_create(err, svn_thread_pool__group_wait(group)));
+}
+
+
 svn_error_t *
-svn_diff_diff3_2(svn_diff_t **diff,
-                 void *diff_baton,
-                 const svn_diff_fns2_t *vtable,
-                 apr_pool_t *pool)
+svn_diff__diff3(svn_diff_t **diff,
+                void *diff_baton,
+                const svn_diff_fns2_t *vtable,
+                int concurrency,
+                svn_boolean_t chunked,
+                apr_pool_t *pool)
 {
   svn_diff__tree_t *tree;
   svn_diff__position_t *position_list[3];
@@ -262,6 +694,7 @@ svn_diff_diff3_2(svn_diff_t **diff,
                                         svn_diff_datasource_latest};
   svn_diff__lcs_t *lcs_om;
   svn_diff__lcs_t *lcs_ol;
+  svn_boolean_t lcs_done;
   apr_pool_t *subpool;
   apr_pool_t *treepool;
   apr_off_t prefix_lines = 0;
@@ -314,13 +747,23 @@ svn_diff_diff3_2(svn_diff_t **diff,
   token_counts[2] = svn_diff__get_token_counts(position_list[2], num_tokens,
                                                subpool);
 
-  /* Get the lcs for original-modified and original-latest */
-  lcs_om = svn_diff__lcs(position_list[0], position_list[1], token_counts[0],
-                         token_counts[1], num_tokens, prefix_lines,
-                         suffix_lines, subpool);
-  lcs_ol = svn_diff__lcs(position_list[0], position_list[2], token_counts[0],
-                         token_counts[2], num_tokens, prefix_lines,
-                         suffix_lines, subpool);
+  /* Get the lcs for original-modified and original-latest.  These are
+   * independent of each other, so let other threads help if allowed. */
+  lcs_done = FALSE;
+  if (concurrency > 1 || chunked)
+    SVN_ERR(parallel_lcs(&lcs_done, &lcs_om, &lcs_ol, position_list,
+                         token_counts, num_tokens, prefix_lines, suffix_lines,
+                         concurrency, chunked, subpool));
+
+  if (!lcs_done)
+    {
+      lcs_om = svn_diff__lcs(position_list[0], position_list[1],
+                             token_counts[0], token_counts[1], num_tokens,
+                             prefix_lines, suffix_lines, subpool);
+      lcs_ol = svn_diff__lcs(position_list[0], position_list[2],
+                             token_counts[0], token_counts[2], num_tokens,
+                             prefix_lines, suffix_lines, subpool);
+    }
 
   /* Produce a merged diff */
   {
@@ -530,3 +973,13 @@ svn_diff_diff3_2(svn_diff_t **diff,
 
   return SVN_NO_ERROR;
 }
+
+svn_error_t *
+svn_diff_diff3_2(svn_diff_t **diff,
+                 void *diff_baton,
+                 const svn_diff_fns2_t *vtable,
+                 apr_pool_t *pool)
+{
+  return svn_error_trace(svn_diff__diff3(diff, diff_baton, vtable, 1, FALSE,
+                                         pool));
+}
@@ -52,6 +52,10 @@
 #include "private/svn_adler32.h"
 #include "private/svn_diff_private.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 /* A token, i.e. a line read from a file. */
 typedef struct svn_diff__file_token_t
 {
@@ -80,7 +84,9 @@ typedef struct svn_diff__file_baton_t
     apr_file_t *file;  /* handle of this file */
     apr_off_t size;    /* total raw size in bytes of this file */
 
-    /* The current chunk: CHUNK_SIZE bytes except for the last chunk. */
+    /* The current chunk: 2^CHUNK_SHIFT bytes except for the last chunk.
+       Files mapped into memory as a whole consist of a single chunk. */
+    int chunk_shift;
     int chunk;     /* the current chunk number, zero-based */
     char *buffer;  /* a buffer containing the current chunk */
     char *curp;    /* current position in the current chunk */
@@ -130,9 +136,24 @@ datasource_to_index(svn_diff_datasource_e datasource)
 #define CHUNK_SHIFT 17
 #define CHUNK_SIZE (1 << CHUNK_SHIFT)
 
-#define chunk_to_offset(chunk) ((chunk) << CHUNK_SHIFT)
-#define offset_to_chunk(offset) ((offset) >> CHUNK_SHIFT)
-#define offset_in_chunk(offset) ((offset) & (CHUNK_SIZE - 1))
+#define chunk_size(file) ((apr_off_t)1 << (file)->chunk_shift)
+#define chunk_to_offset(file, chunk) \
+  ((apr_off_t)(chunk) << (file)->chunk_shift)
+#define offset_to_chunk(file, offset) ((offset) >> (file)->chunk_shift)
+#define offset_in_chunk(file, offset) ((offset) & (chunk_size(file) - 1))
+
+/* Files of at least MAP_WHOLE_FILE_MIN and at most MAP_WHOLE_FILE_MAX
+ * bytes are mapped into memory as a whole, if the platform supports it
+ * and the diff options don't require the lines to be normalized (which is
+ * done in place).  Their tokens then point straight into the mapping and
+ * the prefix and suffix scanning does not have to deal with chunks.
+ */
+#ifndef MAP_WHOLE_FILE_MIN
+#define MAP_WHOLE_FILE_MIN (1024 * 1024)
+#endif
+#ifndef MAP_WHOLE_FILE_MAX
+#define MAP_WHOLE_FILE_MAX (256 * 1024 * 1024)
+#endif
 
 
 /* Read a chunk from a FILE into BUFFER, starting from OFFSET, going for
@@ -228,6 +249,31 @@ map_or_read_file(apr_file_t **file,
 }
 
 
+/* Try to map the open FILE into memory as a whole, allocating from POOL.
+ * On success, make it a single chunk and return TRUE; otherwise leave
+ * FILE untouched and return FALSE.
+ */
+static svn_boolean_t
+map_whole_file(struct file_info *file, apr_pool_t *pool)
+{
+#if APR_HAS_MMAP
+  apr_mmap_t *mm;
+
+  if (apr_mmap_create(&mm, file->file, 0, (apr_size_t) file->size,
+                      APR_MMAP_READ, pool) != APR_SUCCESS)
+    return FALSE;
+
+  file->buffer = mm->mm;
+  while (chunk_size(file) <= file->size)
+    file->chunk_shift++;
+
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
+
 /* For all files in the FILE array, increment the curp pointer.  If a file
  * points before the beginning of file, let it point at the first byte again.
  * If the end of the current chunk is reached, read the next chunk in the
@@ -269,7 +315,7 @@ static svn_error_t *
 increment_chunk(struct file_info *file, apr_pool_t *pool)
 {
   apr_off_t length;
-  apr_off_t last_chunk = offset_to_chunk(file->size);
+  apr_off_t last_chunk = offset_to_chunk(file, file->size);
 
   if (file->chunk == -1)
     {
@@ -287,9 +333,9 @@ increment_chunk(struct file_info *file, apr_pool_t *pool)
       /* There are still chunks left. Read next chunk and reset pointers. */
       file->chunk++;
       length = file->chunk == last_chunk ?
-        offset_in_chunk(file->size) : CHUNK_SIZE;
+        offset_in_chunk(file, file->size) : chunk_size(file);
       SVN_ERR(read_chunk(file->file, file->buffer,
-                         length, chunk_to_offset(file->chunk),
+                         length, chunk_to_offset(file, file->chunk),
                          pool));
       file->endp = file->buffer + length;
       file->curp = file->buffer;
@@ -316,9 +362,9 @@ decrement_chunk(struct file_info *file, apr_pool_t *pool)
       /* Read previous chunk and reset pointers. */
       file->chunk--;
       SVN_ERR(read_chunk(file->file, file->buffer,
-                         CHUNK_SIZE, chunk_to_offset(file->chunk),
+                         chunk_size(file), chunk_to_offset(file, file->chunk),
                          pool));
-      file->endp = file->buffer + CHUNK_SIZE;
+      file->endp = file->buffer + chunk_size(file);
       file->curp = file->endp - 1;
     }
 
@@ -372,6 +418,42 @@ static svn_boolean_t contains_eol(apr_uintptr_t chunk)
 }
 #endif
 
+#if defined(__SSE2__)
+/* Return the number of bits set in the 16 bit MASK. */
+static APR_INLINE int
+count_bits16(unsigned int mask)
+{
+  mask = mask - ((mask >> 1) & 0x5555);
+  mask = (mask & 0x3333) + ((mask >> 2) & 0x3333);
+  mask = (mask + (mask >> 4)) & 0x0f0f;
+  return (mask + (mask >> 8)) & 0x1f;
+}
+
+/* Return TRUE if the 16 bytes at each of the FILE_LEN pointers in P are
+ * identical to those at P[0].  Return the CR and LF positions in the
+ * first block as bit masks in *CR and *LF. */
+static APR_INLINE svn_boolean_t
+blocks_match(unsigned int *cr, unsigned int *lf,
+             const char *p[], apr_size_t file_len)
+{
+  __m128i block = _mm_loadu_si128((const __m128i *)p[0]);
+  apr_size_t i;
+
+  for (i = 1; i < file_len; i++)
+    {
+      __m128i other = _mm_loadu_si128((const __m128i *)p[i]);
+
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(block, other)) != 0xffff)
+        return FALSE;
+    }
+
+  *cr = _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8('\r')));
+  *lf = _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8('\n')));
+
+  return TRUE;
+}
+#endif
+
 /* Find the prefix which is identical between all elements of the FILE array.
  * Return the number of prefix lines in PREFIX_LINES.  REACHED_ONE_EOF will be
  * set to TRUE if one of the FILEs reached its end while scanning prefix,
@@ -419,6 +501,35 @@ find_identical_prefix(svn_boolean_t *reached_one_eof, apr_off_t *prefix_lines,
 
       INCREMENT_POINTERS(file, file_len, pool);
 
+#if defined(__SSE2__)
+      /* Skip blocks of 16 identical bytes, counting the lines in them.  For
+       * files mapped as a whole, this covers all of the prefix.  Like the
+       * INCREMENT_POINTERS, leave curp before endp within the chunk. */
+      while (1)
+        {
+          const char *p[4];
+          unsigned int cr, lf;
+
+          for (i = 0; i < file_len; i++)
+            {
+              if (file[i].endp - file[i].curp <= (apr_ssize_t)sizeof(__m128i))
+                break;
+              p[i] = file[i].curp;
+            }
+
+          if (i < file_len || !blocks_match(&cr, &lf, p, file_len))
+            break;
+
+          /* Count every CR and every LF that doesn't complete a CRLF. */
+          lines += count_bits16(cr)
+                   + count_bits16(lf & ~((cr << 1) | (had_cr ? 1 : 0)));
+          had_cr = (cr & 0x8000) != 0;
+
+          for (i = 0; i < file_len; i++)
+            file[i].curp += sizeof(__m128i);
+        }
+#endif
+
 #if SVN_UNALIGNED_ACCESS_IS_OK
 
       /* Try to advance as far as possible with machine-word granularity.
@@ -554,14 +665,17 @@ find_identical_suffix(apr_off_t *suffix_lines, struct file_info file[],
       file_for_suffix[i].path = file[i].path;
       file_for_suffix[i].file = file[i].file;
       file_for_suffix[i].size = file[i].size;
+      file_for_suffix[i].chunk_shift = file[i].chunk_shift;
       file_for_suffix[i].chunk =
-        (int) offset_to_chunk(file_for_suffix[i].size); /* last chunk */
-      length[i] = offset_in_chunk(file_for_suffix[i].size);
+        (int) offset_to_chunk(&file_for_suffix[i],
+                              file_for_suffix[i].size); /* last chunk */
+      length[i] = offset_in_chunk(&file_for_suffix[i],
+                                  file_for_suffix[i].size);
       if (length[i] == 0)
         {
           /* last chunk is an empty chunk -> start at next-to-last chunk */
           file_for_suffix[i].chunk = file_for_suffix[i].chunk - 1;
-          length[i] = CHUNK_SIZE;
+          length[i] = chunk_size(&file_for_suffix[i]);
         }
 
       if (file_for_suffix[i].chunk == file[i].chunk)
@@ -573,10 +687,12 @@ find_identical_suffix(apr_off_t *suffix_lines, struct file_info file[],
         {
           /* There is at least more than 1 chunk,
              so allocate full chunk size buffer */
-          file_for_suffix[i].buffer = apr_palloc(pool, CHUNK_SIZE);
+          file_for_suffix[i].buffer
+            = apr_palloc(pool, (apr_size_t) chunk_size(&file_for_suffix[i]));
           SVN_ERR(read_chunk(file_for_suffix[i].file,
                              file_for_suffix[i].buffer, length[i],
-                             chunk_to_offset(file_for_suffix[i].chunk),
+                             chunk_to_offset(&file_for_suffix[i],
+                                             file_for_suffix[i].chunk),
                              pool));
         }
       file_for_suffix[i].endp = file_for_suffix[i].buffer + length[i];
@@ -594,8 +710,10 @@ find_identical_suffix(apr_off_t *suffix_lines, struct file_info file[],
       min_file_size = file[i].size;
   if (file[0].size > min_file_size)
     {
-      suffix_min_chunk0 += (file[0].size - min_file_size) / CHUNK_SIZE;
-      suffix_min_offset0 += (file[0].size - min_file_size) % CHUNK_SIZE;
+      suffix_min_chunk0 += (file[0].size - min_file_size)
+                           / chunk_size(&file[0]);
+      suffix_min_offset0 += (file[0].size - min_file_size)
+                            % chunk_size(&file[0]);
     }
 
   /* Scan backwards until mismatch or until we reach the prefix. */
@@ -646,6 +764,35 @@ find_identical_suffix(apr_off_t *suffix_lines, struct file_info file[],
       if (file_for_suffix[0].chunk == suffix_min_chunk0)
         min_curp[0] += suffix_min_offset0;
 
+#if defined(__SSE2__)
+      /* Skip blocks of 16 identical bytes ending at curp, counting the
+         lines in them. */
+      while (1)
+        {
+          const char *p[4];
+          unsigned int cr, lf;
+
+          for (i = 0; i < file_len; i++)
+            {
+              p[i] = file_for_suffix[i].curp + 1 - sizeof(__m128i);
+              if (p[i] <= min_curp[i])
+                break;
+            }
+
+          if (i < file_len || !blocks_match(&cr, &lf, p, file_len))
+            break;
+
+          /* Going backwards, count every LF and every CR that doesn't
+             start a CRLF. */
+          lines += count_bits16(lf)
+                   + count_bits16(cr & ~((lf >> 1) | (had_nl ? 0x8000 : 0)));
+          had_nl = (lf & 1) != 0;
+
+          for (i = 0; i < file_len; i++)
+            file_for_suffix[i].curp -= sizeof(__m128i);
+        }
+#endif
+
       /* Scan quickly by reading with machine-word granularity. */
       for (i = 0, can_read_word = TRUE; can_read_word && i < file_len; i++)
         can_read_word = ((file_for_suffix[i].curp + 1 - sizeof(apr_uintptr_t))
@@ -798,10 +945,23 @@ datasources_open(void *baton,
                                APR_READ, APR_OS_DEFAULT, file_baton->pool));
       SVN_ERR(svn_io_file_size_get(&filesize, file->file, file_baton->pool));
       file->size = filesize;
-      length[i] = filesize > CHUNK_SIZE ? CHUNK_SIZE : filesize;
-      file->buffer = apr_palloc(file_baton->pool, (apr_size_t) length[i]);
-      SVN_ERR(read_chunk(file->file, file->buffer,
-                         length[i], 0, file_baton->pool));
+      file->chunk_shift = CHUNK_SHIFT;
+      file->chunk = 0;
+
+      if (filesize >= MAP_WHOLE_FILE_MIN && filesize <= MAP_WHOLE_FILE_MAX
+          && ! file_baton->options->ignore_space
+          && ! file_baton->options->ignore_eol_style
+          && map_whole_file(file, file_baton->pool))
+        {
+          length[i] = filesize;
+        }
+      else
+        {
+          length[i] = filesize > CHUNK_SIZE ? CHUNK_SIZE : filesize;
+          file->buffer = apr_palloc(file_baton->pool, (apr_size_t) length[i]);
+          SVN_ERR(read_chunk(file->file, file->buffer,
+                             length[i], 0, file_baton->pool));
+        }
       file->endp = file->buffer + length[i];
       file->curp = file->buffer;
       /* Set suffix_start_chunk to a guard value, so if suffix scanning is
@@ -872,7 +1032,7 @@ datasource_get_next_token(apr_uint32_t *hash, void **token, void *baton,
   curp = file->curp;
   endp = file->endp;
 
-  last_chunk = offset_to_chunk(file->size);
+  last_chunk = offset_to_chunk(file, file->size);
 
   /* Are we already at the end of a chunk? */
   if (curp == endp)
@@ -906,7 +1066,7 @@ datasource_get_next_token(apr_uint32_t *hash, void **token, void *baton,
     }
 
   file_token->datasource = datasource;
-  file_token->offset = chunk_to_offset(file->chunk)
+  file_token->offset = chunk_to_offset(file, file->chunk)
                        + (curp - file->buffer);
   file_token->norm_offset = file_token->offset;
   file_token->raw_length = 0;
@@ -956,7 +1116,7 @@ datasource_get_next_token(apr_uint32_t *hash, void **token, void *baton,
       curp = endp = file->buffer;
       file->chunk++;
       length = file->chunk == last_chunk ?
-        offset_in_chunk(file->size) : CHUNK_SIZE;
+        offset_in_chunk(file, file->size) : chunk_size(file);
       endp += length;
       file->endp = endp;
 
@@ -970,7 +1130,7 @@ datasource_get_next_token(apr_uint32_t *hash, void **token, void *baton,
          boundary. */
       SVN_ERR(read_chunk(file->file,
                          curp, length,
-                         chunk_to_offset(file->chunk),
+                         chunk_to_offset(file, file->chunk),
                          file_baton->pool));
 
       /* If the last chunk ended in a CR, we're done. */
@@ -1062,13 +1222,13 @@ token_compare(void *baton, void *token1, void *token2, int *compare)
       offset[i] = file_token[i]->norm_offset;
       state[i] = svn_diff__normalize_state_normal;
 
-      if (offset_to_chunk(offset[i]) == file[i]->chunk)
+      if (offset_to_chunk(file[i], offset[i]) == file[i]->chunk)
         {
           /* If the start of the token is in memory, the entire token is
            * in memory.
            */
           bufp[i] = file[i]->buffer;
-          bufp[i] += offset_in_chunk(offset[i]);
+          bufp[i] += offset_in_chunk(file[i], offset[i]);
 
           length[i] = total_length;
           raw_length[i] = 0;
@@ -1182,6 +1342,12 @@ static const svn_diff_fns2_t svn_diff__file_vtable =
 /* Id for the --ignore-eol-style option, which doesn't have a short name. */
 #define SVN_DIFF__OPT_IGNORE_EOL_STYLE 256
 
+/* Id for the --histogram option, which doesn't have a short name. */
+#define SVN_DIFF__OPT_HISTOGRAM 257
+
+/* Id for the --chunked option, which doesn't have a short name. */
+#define SVN_DIFF__OPT_CHUNKED 258
+
 /* Options supported by svn_diff_file_options_parse(). */
 static const apr_getopt_option_t diff_options[] =
 {
@@ -1193,6 +1359,8 @@ static const apr_getopt_option_t diff_options[] =
    * ### we don't have optional argument support. */
   { "unified", 'u', 0, NULL },
   { "context", 'U', 1, NULL },
+  { "histogram", SVN_DIFF__OPT_HISTOGRAM, 0, NULL },
+  { "chunked", SVN_DIFF__OPT_CHUNKED, 0, NULL },
   { NULL, 0, 0, NULL }
 };
 
@@ -1292,6 +1460,12 @@ svn_diff_file_options_parse(svn_diff_file_options_t *options,
         case SVN_DIFF__OPT_IGNORE_EOL_STYLE:
           options->ignore_eol_style = TRUE;
           break;
+        case SVN_DIFF__OPT_HISTOGRAM:
+          options->algorithm = svn_diff_file_algorithm_histogram;
+          break;
+        case SVN_DIFF__OPT_CHUNKED:
+          options->diff3_chunked = TRUE;
+          break;
         case 'p':
           options->show_c_function = TRUE;
           break;
@@ -1326,7 +1500,8 @@ svn_diff_file_diff_2(svn_diff_t **diff,
   baton.files[1].path = modified;
   baton.pool = svn_pool_create(pool);
 
-  SVN_ERR(svn_diff_diff_2(diff, &baton, &svn_diff__file_vtable, pool));
+  SVN_ERR(svn_diff__diff_2(diff, &baton, &svn_diff__file_vtable,
+                           options->algorithm, pool));
 
   svn_pool_destroy(baton.pool);
   return SVN_NO_ERROR;
@@ -1348,7 +1523,9 @@ svn_diff_file_diff3_2(svn_diff_t **diff,
   baton.files[2].path = latest;
   baton.pool = svn_pool_create(pool);
 
-  SVN_ERR(svn_diff_diff3_2(diff, &baton, &svn_diff__file_vtable, pool));
+  SVN_ERR(svn_diff__diff3(diff, &baton, &svn_diff__file_vtable,
+                          options->diff3_threads, options->diff3_chunked,
+                          pool));
 
   svn_pool_destroy(baton.pool);
   return SVN_NO_ERROR;
@@ -0,0 +1,464 @@
+/*
+ * histogram.c :  routines for creating an lcs with the histogram algorithm
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+
+#include <apr.h>
+#include <apr_pools.h>
+#include <apr_general.h>
+
+#include "svn_pools.h"
+
+#include "diff.h"
+
+
+/*
+ * The histogram algorithm is an extension of Bram Cohen's "patience diff",
+ * as found in JGit and git.  Instead of searching for the shortest edit
+ * script, it looks for the region of the first ("A") sequence whose lines
+ * are least frequent, matches it against the second ("B") sequence, and
+ * recurses into the regions before and after that match.  Lines that are
+ * unique to a region make excellent anchors, so the typical cost is close
+ * to linear, independent of the number of differences.
+ *
+ * Only lines that occur at most MAX_CHAIN_LENGTH times within the A
+ * region are used as anchors.  If two regions only have more frequent
+ * lines in common, we fall back to svn_diff__lcs() for that region.
+ */
+
+/* Lines that occur more often than this in a region are not used as
+ * anchors. */
+#define MAX_CHAIN_LENGTH 64
+
+/* Per-diff state. */
+typedef struct histogram_t
+{
+  /* The positions of the two sequences, indexed by their line number
+   * relative to the first position, and their number of lines. */
+  svn_diff__position_t **positions[2];
+  apr_off_t length[2];
+
+  /* The index over the current A region:  For every token, the number of
+   * times it occurs in the region and the first line it occurs at.  For
+   * every line of A, the next line in the region with the same token.
+   * All counts are zero outside of find_split(). */
+  svn_diff__token_index_t *count;
+  apr_off_t *head;
+  apr_off_t *next;
+
+  /* Token counts of the regions passed to svn_diff__lcs().  These are
+   * all zero outside of lcs_region(). */
+  svn_diff__token_index_t *region_counts[2];
+  svn_diff__token_index_t num_tokens;
+
+  /* The matches found so far, in reverse order. */
+  svn_diff__lcs_t *lcs;
+
+  /* Where to allocate the result. */
+  apr_pool_t *pool;
+} histogram_t;
+
+/* A region still to process, or a match to emit once everything before it
+ * has been processed. */
+typedef struct work_item_t
+{
+  /* If LENGTH is 0, the region [A_LO, A_HI) x [B_LO, B_HI).  Otherwise the
+   * match of LENGTH lines at A_LO and B_LO. */
+  apr_off_t a_lo, a_hi;
+  apr_off_t b_lo, b_hi;
+  apr_off_t length;
+} work_item_t;
+
+#define TOKEN(h, i, line) ((h)->positions[i][line]->token_index)
+
+
+/* Append the match of LENGTH lines at A and B to the result in H, merging
+ * it with the previous match if the two are adjacent. */
+static void
+emit_match(histogram_t *h, apr_off_t a, apr_off_t b, apr_off_t length)
+{
+  svn_diff__lcs_t *lcs = h->lcs;
+
+  if (length == 0)
+    return;
+
+  if (lcs
+      && lcs->position[0]->offset + lcs->length
+           == h->positions[0][a]->offset
+      && lcs->position[1]->offset + lcs->length
+           == h->positions[1][b]->offset)
+    {
+      lcs->length += length;
+      return;
+    }
+
+  lcs = apr_palloc(h->pool, sizeof(*lcs));
+  lcs->position[0] = h->positions[0][a];
+  lcs->position[1] = h->positions[1][b];
+  lcs->length = length;
+  lcs->refcount = 1;
+  lcs->next = h->lcs;
+  h->lcs = lcs;
+}
+
+/* Find the longest match within the region [A_LO, A_HI) x [B_LO, B_HI)
+ * of H that has the lowest number of occurrences of any of its lines in
+ * the A region.  Return its start in *SPLIT_A and *SPLIT_B and its length
+ * in *SPLIT_LENGTH, or set *SPLIT_LENGTH to 0 if there is none.  Set
+ * *HAS_COMMON to whether the two regions have any line in common. */
+static void
+find_split(apr_off_t *split_a,
+           apr_off_t *split_b,
+           apr_off_t *split_length,
+           svn_boolean_t *has_common,
+           histogram_t *h,
+           apr_off_t a_lo, apr_off_t a_hi,
+           apr_off_t b_lo, apr_off_t b_hi)
+{
+  svn_diff__token_index_t best_count = MAX_CHAIN_LENGTH;
+  apr_off_t best_length = 0;
+  apr_off_t a, b, b_next;
+
+  *has_common = FALSE;
+  *split_length = 0;
+
+  /* Index A, back to front so that the chains are in ascending order. */
+  for (a = a_hi - 1; a >= a_lo; a--)
+    {
+      svn_diff__token_index_t token = TOKEN(h, 0, a);
+
+      h->next[a] = h->count[token] ? h->head[token] : -1;
+      h->head[token] = a;
+      h->count[token]++;
+    }
+
+  for (b = b_lo; b < b_hi; b = b_next)
+    {
+      svn_diff__token_index_t token = TOKEN(h, 1, b);
+
+      b_next = b + 1;
+      if (h->count[token] == 0)
+        continue;
+
+      *has_common = TRUE;
+      if (h->count[token] > best_count)
+        continue;
+
+      for (a = h->head[token]; a >= 0; a = h->next[a])
+        {
+          apr_off_t a_start = a, b_start = b;
+          apr_off_t a_end = a + 1, b_end = b + 1;
+          svn_diff__token_index_t count = h->count[token];
+
+          while (a_start > a_lo && b_start > b_lo
+                 && TOKEN(h, 0, a_start - 1) == TOKEN(h, 1, b_start - 1))
+            {
+              a_start--;
+              b_start--;
+              if (h->count[TOKEN(h, 0, a_start)] < count)
+                count = h->count[TOKEN(h, 0, a_start)];
+            }
+
+          while (a_end < a_hi && b_end < b_hi
+                 && TOKEN(h, 0, a_end) == TOKEN(h, 1, b_end))
+            {
+              if (h->count[TOKEN(h, 0, a_end)] < count)
+                count = h->count[TOKEN(h, 0, a_end)];
+              a_end++;
+              b_end++;
+            }
+
+          /* Don't look for matches starting within this one again. */
+          if (b_next < b_end)
+            b_next = b_end;
+
+          if (count < best_count
+              || (count == best_count && a_end - a_start > best_length))
+            {
+              best_count = count;
+              best_length = a_end - a_start;
+              *split_a = a_start;
+              *split_b = b_start;
+              *split_length = best_length;
+            }
+        }
+    }
+
+  /* Reset the index. */
+  for (a = a_lo; a < a_hi; a++)
+    h->count[TOKEN(h, 0, a)] = 0;
+}
+
+/* Find the common subsequence of the region [A_LO, A_HI) x [B_LO, B_HI)
+ * of H with svn_diff__lcs() and emit its matches.  Both parts of the
+ * region must not be empty.  Use SCRATCH_POOL for temporary allocations. */
+static void
+lcs_region(histogram_t *h,
+           apr_off_t a_lo, apr_off_t a_hi,
+           apr_off_t b_lo, apr_off_t b_hi,
+           apr_pool_t *scratch_pool)
+{
+  svn_diff__position_t *tail[2];
+  svn_diff__position_t *saved_next[2];
+  svn_diff__lcs_t *lcs;
+  apr_off_t line;
+
+  /* Temporarily turn both parts of the region into rings of their own. */
+  tail[0] = h->positions[0][a_hi - 1];
+  tail[1] = h->positions[1][b_hi - 1];
+  saved_next[0] = tail[0]->next;
+  saved_next[1] = tail[1]->next;
+  tail[0]->next = h->positions[0][a_lo];
+  tail[1]->next = h->positions[1][b_lo];
+
+  for (line = a_lo; line < a_hi; line++)
+    h->region_counts[0][TOKEN(h, 0, line)]++;
+  for (line = b_lo; line < b_hi; line++)
+    h->region_counts[1][TOKEN(h, 1, line)]++;
+
+  lcs = svn_diff__lcs(tail[0], tail[1],
+                      h->region_counts[0], h->region_counts[1],
+                      h->num_tokens, 0, 0, scratch_pool);
+
+  for (; lcs->length; lcs = lcs->next)
+    emit_match(h,
+               lcs->position[0]->offset - h->positions[0][0]->offset,
+               lcs->position[1]->offset - h->positions[1][0]->offset,
+               lcs->length);
+
+  for (line = a_lo; line < a_hi; line++)
+    h->region_counts[0][TOKEN(h, 0, line)] = 0;
+  for (line = b_lo; line < b_hi; line++)
+    h->region_counts[1][TOKEN(h, 1, line)] = 0;
+
+  tail[0]->next = saved_next[0];
+  tail[1]->next = saved_next[1];
+}
+
+/* Emit all matches of H, processing the regions on STACK until it is
+ * empty.  Use SCRATCH_POOL for temporary allocations. */
+static void
+process_regions(histogram_t *h,
+                apr_array_header_t *stack,
+                apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+
+  while (stack->nelts)
+    {
+      work_item_t item = *(work_item_t *)apr_array_pop(stack);
+      apr_off_t prefix, suffix;
+      apr_off_t split_a = 0, split_b = 0, split_length;
+      svn_boolean_t has_common;
+      work_item_t *pushed;
+
+      if (item.length)
+        {
+          emit_match(h, item.a_lo, item.b_lo, item.length);
+          continue;
+        }
+
+      /* Everything before this region has been emitted, so the identical
+       * prefix can go out right away. */
+      for (prefix = 0;
+           item.a_lo + prefix < item.a_hi && item.b_lo + prefix < item.b_hi
+           && TOKEN(h, 0, item.a_lo + prefix)
+                == TOKEN(h, 1, item.b_lo + prefix);
+           prefix++)
+        ;
+      emit_match(h, item.a_lo, item.b_lo, prefix);
+      item.a_lo += prefix;
+      item.b_lo += prefix;
+
+      for (suffix = 0;
+           item.a_hi - suffix > item.a_lo && item.b_hi - suffix > item.b_lo
+           && TOKEN(h, 0, item.a_hi - suffix - 1)
+                == TOKEN(h, 1, item.b_hi - suffix - 1);
+           suffix++)
+        ;
+      item.a_hi -= suffix;
+      item.b_hi -= suffix;
+
+      if (suffix)
+        {
+          pushed = apr_array_push(stack);
+          pushed->a_lo = item.a_hi;
+          pushed->b_lo = item.b_hi;
+          pushed->a_hi = pushed->b_hi = 0;
+          pushed->length = suffix;
+        }
+
+      /* A pure insertion or deletion. */
+      if (item.a_lo == item.a_hi || item.b_lo == item.b_hi)
+        continue;
+
+      find_split(&split_a, &split_b, &split_length, &has_common, h,
+                 item.a_lo, item.a_hi, item.b_lo, item.b_hi);
+
+      if (split_length == 0)
+        {
+          /* Either there is nothing to match at all, or only lines that
+           * are too frequent to serve as anchors. */
+          if (has_common)
+            {
+              svn_pool_clear(iterpool);
+              lcs_region(h, item.a_lo, item.a_hi, item.b_lo, item.b_hi,
+                         iterpool);
+            }
+          continue;
+        }
+
+      /* Process the region before the split, then the split itself and
+       * then the region after it. */
+      pushed = apr_array_push(stack);
+      pushed->a_lo = split_a + split_length;
+      pushed->a_hi = item.a_hi;
+      pushed->b_lo = split_b + split_length;
+      pushed->b_hi = item.b_hi;
+      pushed->length = 0;
+
+      pushed = apr_array_push(stack);
+      pushed->a_lo = split_a;
+      pushed->b_lo = split_b;
+      pushed->a_hi = pushed->b_hi = 0;
+      pushed->length = split_length;
+
+      pushed = apr_array_push(stack);
+      pushed->a_lo = item.a_lo;
+      pushed->a_hi = split_a;
+      pushed->b_lo = item.b_lo;
+      pushed->b_hi = split_b;
+      pushed->length = 0;
+    }
+
+  svn_pool_destroy(iterpool);
+}
+
+/* Return a new lcs node of LENGTH lines at the line numbers OFFSET0 and
+ * OFFSET1, followed by NEXT, allocated in POOL. */
+static svn_diff__lcs_t *
+new_lcs(apr_off_t offset0, apr_off_t offset1, apr_off_t length,
+        svn_diff__lcs_t *next, apr_pool_t *pool)
+{
+  svn_diff__lcs_t *lcs = apr_palloc(pool, sizeof(*lcs));
+
+  lcs->position[0] = apr_pcalloc(pool, sizeof(*lcs->position[0]));
+  lcs->position[0]->offset = offset0;
+  lcs->position[1] = apr_pcalloc(pool, sizeof(*lcs->position[1]));
+  lcs->position[1]->offset = offset1;
+  lcs->length = length;
+  lcs->refcount = 1;
+  lcs->next = next;
+
+  return lcs;
+}
+
+
+svn_diff__lcs_t *
+svn_diff__histogram(svn_diff__position_t *position_list1,
+                    svn_diff__position_t *position_list2,
+                    svn_diff__token_index_t num_tokens,
+                    apr_off_t prefix_lines,
+                    apr_off_t suffix_lines,
+                    apr_pool_t *pool)
+{
+  histogram_t h = { { 0 } };
+  svn_diff__position_t *position_list[2];
+  svn_diff__lcs_t *lcs, *next, *reversed;
+  apr_array_header_t *stack;
+  work_item_t *item;
+  apr_pool_t *scratch_pool;
+  svn_diff__token_index_t token;
+  apr_off_t line;
+  int i;
+
+  /* svn_diff__lcs() doesn't need any token counts for this trivial case. */
+  if (position_list1 == NULL || position_list2 == NULL)
+    return svn_diff__lcs(position_list1, position_list2, NULL, NULL,
+                         num_tokens, prefix_lines, suffix_lines, pool);
+
+  scratch_pool = svn_pool_create(pool);
+  position_list[0] = position_list1;
+  position_list[1] = position_list2;
+
+  for (i = 0; i < 2; i++)
+    {
+      svn_diff__position_t *position = position_list[i]->next;
+
+      h.length[i] = position_list[i]->offset - position->offset + 1;
+      h.positions[i] = apr_palloc(scratch_pool,
+                                  h.length[i] * sizeof(*h.positions[i]));
+      for (line = 0; line < h.length[i]; line++)
+        {
+          h.positions[i][line] = position;
+          position = position->next;
+        }
+
+      h.region_counts[i] = apr_palloc(scratch_pool,
+                                      num_tokens * sizeof(*h.region_counts[i]));
+    }
+
+  h.count = apr_palloc(scratch_pool, num_tokens * sizeof(*h.count));
+  h.head = apr_palloc(scratch_pool, num_tokens * sizeof(*h.head));
+  h.next = apr_palloc(scratch_pool, h.length[0] * sizeof(*h.next));
+  for (token = 0; token < num_tokens; token++)
+    h.count[token] = h.region_counts[0][token] = h.region_counts[1][token] = 0;
+
+  h.num_tokens = num_tokens;
+  h.pool = pool;
+
+  stack = apr_array_make(scratch_pool, 64, sizeof(work_item_t));
+  item = apr_array_push(stack);
+  item->a_lo = 0;
+  item->a_hi = h.length[0];
+  item->b_lo = 0;
+  item->b_hi = h.length[1];
+  item->length = 0;
+
+  process_regions(&h, stack, scratch_pool);
+
+  /* Since EOF is always a sync point we tack on an EOF link, preceded by
+   * the identical suffix, like svn_diff__lcs() does. */
+  lcs = new_lcs(position_list1->offset + suffix_lines + 1,
+                position_list2->offset + suffix_lines + 1,
+                0, NULL, pool);
+  if (suffix_lines)
+    lcs = new_lcs(position_list1->offset + 1, position_list2->offset + 1,
+                  suffix_lines, lcs, pool);
+
+  /* H.LCS is in reverse order. */
+  reversed = h.lcs;
+  while (reversed)
+    {
+      next = reversed->next;
+      reversed->next = lcs;
+      lcs = reversed;
+      reversed = next;
+    }
+
+  if (prefix_lines)
+    lcs = new_lcs(1, 1, prefix_lines, lcs, pool);
+
+  svn_pool_destroy(scratch_pool);
+
+  return lcs;
+}
@@ -25,6 +25,7 @@
 #include <apr.h>
 #include <apr_pools.h>
 #include <apr_general.h>
+#include <string.h>
 
 #include "svn_error.h"
 #include "svn_diff.h"
@@ -34,30 +35,79 @@
 
 
 /*
- * Prime number to use as the size of the hash table.  This number was
- * not selected by testing of any kind and may need tweaking.
+ * Initial number of slots of the hash table.  Must be a power of two.
+ * The table grows as needed, keeping at least half of the slots free.
  */
-#define SVN_DIFF__HASH_SIZE 127
+#define SVN_DIFF__INITIAL_SLOTS_SHIFT 10
 
+/* A unique token.  Its index in svn_diff__tree_t.nodes is its token index. */
 struct svn_diff__node_t
 {
-  svn_diff__node_t       *parent;
-  svn_diff__node_t       *left;
-  svn_diff__node_t       *right;
-
   apr_uint32_t            hash;
   svn_diff__token_index_t index;
   void                   *token;
 };
 
+/* A slot of the open addressing hash table.  The hash is kept next to
+ * the node reference, so that probing rarely has to touch the nodes. */
+typedef struct svn_diff__slot_t
+{
+  apr_uint32_t            hash;
+  /* Index of the node in svn_diff__tree_t.nodes plus one; 0 if empty. */
+  svn_diff__token_index_t node;
+} svn_diff__slot_t;
+
+/* Despite its name, this is a hash table interning the tokens of all
+ * datasources of a diff.  It uses linear probing over an array of
+ * svn_diff__slot_t, while the nodes themselves are kept in one array in
+ * the order in which they were created. */
 struct svn_diff__tree_t
 {
-  svn_diff__node_t       *root[SVN_DIFF__HASH_SIZE];
+  svn_diff__slot_t       *slots;
+  int                     slots_shift;
+
+  svn_diff__node_t       *nodes;
+  svn_diff__token_index_t nodes_size;
+
   apr_pool_t             *pool;
   svn_diff__token_index_t node_count;
 };
 
 
+/* Return the slot index to start probing at for HASH in TREE.  The
+ * tokens' hashes tend to be weak in some bits, so spread them with
+ * Fibonacci hashing first. */
+static APR_INLINE apr_uint32_t
+first_slot(const svn_diff__tree_t *tree, apr_uint32_t hash)
+{
+  return (apr_uint32_t)(hash * 0x9E3779B1u) >> (32 - tree->slots_shift);
+}
+
+/* Allocate the slots of TREE for a table of 2^SHIFT entries, and
+ * re-insert all nodes, if any. */
+static void
+alloc_slots(svn_diff__tree_t *tree, int shift)
+{
+  apr_uint32_t mask = ((apr_uint32_t)1 << shift) - 1;
+  svn_diff__token_index_t i;
+
+  tree->slots = apr_pcalloc(tree->pool,
+                            ((apr_size_t)mask + 1) * sizeof(*tree->slots));
+  tree->slots_shift = shift;
+
+  for (i = 0; i < tree->node_count; i++)
+    {
+      apr_uint32_t slot = first_slot(tree, tree->nodes[i].hash);
+
+      while (tree->slots[slot].node)
+        slot = (slot + 1) & mask;
+
+      tree->slots[slot].hash = tree->nodes[i].hash;
+      tree->slots[slot].node = i + 1;
+    }
+}
+
+
 /*
  * Returns number of tokens in a tree
  */
@@ -77,32 +127,43 @@ svn_diff__tree_create(svn_diff__tree_t **tree, apr_pool_t *pool)
   *tree = apr_pcalloc(pool, sizeof(**tree));
   (*tree)->pool = pool;
   (*tree)->node_count = 0;
+
+  alloc_slots(*tree, SVN_DIFF__INITIAL_SLOTS_SHIFT);
+
+  (*tree)->nodes_size = (svn_diff__token_index_t)1
+                          << (SVN_DIFF__INITIAL_SLOTS_SHIFT - 1);
+  (*tree)->nodes = apr_palloc(pool, (*tree)->nodes_size
+                                      * sizeof(*(*tree)->nodes));
 }
 
 
+/* Find the node for TOKEN with hash value HASH in TREE, adding a new one
+ * if there is none yet, and return it in *NODE.  *NODE is only valid
+ * until the next call. */
 static svn_error_t *
 tree_insert_token(svn_diff__node_t **node, svn_diff__tree_t *tree,
                   void *diff_baton,
                   const svn_diff_fns2_t *vtable,
                   apr_uint32_t hash, void *token)
 {
+  apr_uint32_t mask = ((apr_uint32_t)1 << tree->slots_shift) - 1;
+  apr_uint32_t slot;
   svn_diff__node_t *new_node;
-  svn_diff__node_t **node_ref;
-  svn_diff__node_t *parent;
   int rv;
 
   SVN_ERR_ASSERT(token);
 
-  parent = NULL;
-  node_ref = &tree->root[hash % SVN_DIFF__HASH_SIZE];
-
-  while (*node_ref != NULL)
+  for (slot = first_slot(tree, hash);
+       tree->slots[slot].node;
+       slot = (slot + 1) & mask)
     {
-      parent = *node_ref;
+      svn_diff__node_t *candidate;
+
+      if (tree->slots[slot].hash != hash)
+        continue;
 
-      rv = hash - parent->hash;
-      if (!rv)
-        SVN_ERR(vtable->token_compare(diff_baton, parent->token, token, &rv));
+      candidate = &tree->nodes[tree->slots[slot].node - 1];
+      SVN_ERR(vtable->token_compare(diff_baton, candidate->token, token, &rv));
 
       if (rv == 0)
         {
@@ -110,33 +171,40 @@ tree_insert_token(svn_diff__node_t **node, svn_diff__tree_t *tree,
            * only recently read tokens are still in memory.
            */
           if (vtable->token_discard != NULL)
-            vtable->token_discard(diff_baton, parent->token);
+            vtable->token_discard(diff_baton, candidate->token);
 
-          parent->token = token;
-          *node = parent;
+          candidate->token = token;
+          *node = candidate;
 
           return SVN_NO_ERROR;
         }
-      else if (rv > 0)
-        {
-          node_ref = &parent->left;
-        }
-      else
-        {
-          node_ref = &parent->right;
-        }
     }
 
-  /* Create a new node */
-  new_node = apr_palloc(tree->pool, sizeof(*new_node));
-  new_node->parent = parent;
-  new_node->left = NULL;
-  new_node->right = NULL;
+  /* Create a new node, making room for it first if necessary. */
+  if (tree->node_count == tree->nodes_size)
+    {
+      svn_diff__node_t *nodes = apr_palloc(tree->pool,
+                                           2 * tree->nodes_size
+                                             * sizeof(*nodes));
+
+      memcpy(nodes, tree->nodes, tree->nodes_size * sizeof(*nodes));
+      tree->nodes = nodes;
+      tree->nodes_size *= 2;
+    }
+
+  new_node = &tree->nodes[tree->node_count];
   new_node->hash = hash;
   new_node->token = token;
   new_node->index = tree->node_count++;
 
-  *node = *node_ref = new_node;
+  tree->slots[slot].hash = hash;
+  tree->slots[slot].node = tree->node_count;
+
+  /* Keep the load factor at 1/2 or below. */
+  if (tree->node_count > (svn_diff__token_index_t)(mask / 2))
+    alloc_slots(tree, tree->slots_shift + 1);
+
+  *node = new_node;
 
   return SVN_NO_ERROR;
 }
@@ -1728,6 +1728,18 @@ svn_fs_get_file_delta_stream(svn_txdelta_stream_t **stream_p,
                            target_root, target_path, pool));
 }
 
+svn_error_t *
+svn_fs__get_instance_id(const char **instance_id,
+                        svn_fs_t *fs,
+                        apr_pool_t *result_pool)
+{
+  if (fs->vtable->get_instance_id)
+    return svn_error_trace(fs->vtable->get_instance_id(instance_id, fs,
+                                                       result_pool));
+
+  return svn_error_trace(svn_fs_get_uuid(fs, instance_id, result_pool));
+}
+
 svn_error_t *
 svn_fs__get_deleted_node(svn_fs_root_t **node_root,
                          const char **node_path,
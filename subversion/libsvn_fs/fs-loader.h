@@ -214,6 +214,9 @@ typedef struct fs_vtable_t
                                   apr_pool_t *pool);
   /* There is no get_uuid(); see svn_fs_t.uuid docstring. */
   svn_error_t *(*set_uuid)(svn_fs_t *fs, const char *uuid, apr_pool_t *pool);
+  /* May be NULL if the instance ID is always the UUID. */
+  svn_error_t *(*get_instance_id)(const char **instance_id, svn_fs_t *fs,
+                                  apr_pool_t *result_pool);
   svn_error_t *(*revision_root)(svn_fs_root_t **root_p, svn_fs_t *fs,
                                 svn_revnum_t rev, apr_pool_t *pool);
   svn_error_t *(*begin_txn)(svn_fs_txn_t **txn_p, svn_fs_t *fs,
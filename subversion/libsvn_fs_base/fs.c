@@ -557,6 +557,7 @@ static fs_vtable_t fs_vtable = {
   svn_fs_base__revision_proplist,
   svn_fs_base__change_rev_prop,
   svn_fs_base__set_uuid,
+  NULL /* get_instance_id */,
   svn_fs_base__revision_root,
   svn_fs_base__begin_txn,
   svn_fs_base__open_txn,
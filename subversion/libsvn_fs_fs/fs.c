@@ -253,6 +253,18 @@ fs_set_uuid(svn_fs_t *fs,
   return svn_error_trace(svn_fs_fs__set_uuid(fs, uuid, NULL, pool));
 }
 
+/* Return the ID that tells this instance of FS apart from its copies. */
+static svn_error_t *
+fs_get_instance_id(const char **instance_id,
+                   svn_fs_t *fs,
+                   apr_pool_t *result_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  *instance_id = apr_pstrdup(result_pool, ffd->instance_id);
+
+  return SVN_NO_ERROR;
+}
+
 
 
 /* The vtable associated with a specific open filesystem. */
@@ -263,6 +275,7 @@ static fs_vtable_t fs_vtable = {
   svn_fs_fs__get_revision_proplist,
   svn_fs_fs__change_rev_prop,
   fs_set_uuid,
+  fs_get_instance_id,
   svn_fs_fs__revision_root,
   svn_fs_fs__begin_txn,
   svn_fs_fs__open_txn,
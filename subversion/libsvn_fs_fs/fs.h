@@ -102,6 +102,8 @@ extern "C" {
 #define CONFIG_OPTION_FAIL_STOP          "fail-stop"
 #define CONFIG_SECTION_REP_SHARING       "rep-sharing"
 #define CONFIG_OPTION_ENABLE_REP_SHARING "enable-rep-sharing"
+#define CONFIG_SECTION_MERGEINFO_INDEX   "mergeinfo-index"
+#define CONFIG_OPTION_ENABLE_MERGEINFO_INDEX "enable-mergeinfo-index"
 #define CONFIG_SECTION_DELTIFICATION     "deltification"
 #define CONFIG_OPTION_ENABLE_DIR_DELTIFICATION   "enable-dir-deltification"
 #define CONFIG_OPTION_ENABLE_PROPS_DELTIFICATION "enable-props-deltification"
@@ -465,6 +467,12 @@ typedef struct fs_fs_data_t
   /* Thread-safe boolean */
   svn_atomic_t rep_cache_db_opened;
 
+  /* The sqlite database used for the mergeinfo index. */
+  svn_sqlite__db_t *mergeinfo_index_db;
+
+  /* Thread-safe boolean */
+  svn_atomic_t mergeinfo_index_db_opened;
+
   /* The oldest revision not in a pack file.  It also applies to revprops
    * if revprop packing has been enabled by the FSFS format version. */
   svn_revnum_t min_unpacked_rev;
@@ -473,6 +481,10 @@ typedef struct fs_fs_data_t
    * and allowed by the configuration. */
   svn_boolean_t rep_sharing_allowed;
 
+  /* Whether the mergeinfo index is supported by the filesystem
+   * and enabled by the configuration. */
+  svn_boolean_t mergeinfo_index_enabled;
+
   /* File size limit in bytes up to which multiple revprops shall be packed
    * into a single file. */
   apr_int64_t revprop_pack_size;
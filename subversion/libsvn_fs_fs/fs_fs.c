@@ -760,6 +760,14 @@ read_config(fs_fs_data_t *ffd,
   else
     ffd->rep_sharing_allowed = FALSE;
 
+  /* Initialize ffd->mergeinfo_index_enabled. */
+  if (ffd->format >= SVN_FS_FS__MIN_MERGEINFO_FORMAT)
+    SVN_ERR(svn_config_get_bool(config, &ffd->mergeinfo_index_enabled,
+                                CONFIG_SECTION_MERGEINFO_INDEX,
+                                CONFIG_OPTION_ENABLE_MERGEINFO_INDEX, FALSE));
+  else
+    ffd->mergeinfo_index_enabled = FALSE;
+
   /* Initialize deltification settings in ffd. */
   if (ffd->format >= SVN_FS_FS__MIN_DELTIFICATION_FORMAT)
     {
@@ -994,6 +1002,17 @@ write_config(svn_fs_t *fs,
 "### rep-sharing is enabled by default."                                     NL
 "# " CONFIG_OPTION_ENABLE_REP_SHARING " = true"                              NL
 ""                                                                           NL
+"[" CONFIG_SECTION_MERGEINFO_INDEX "]"                                       NL
+"### The filesystem can maintain a database of the svn:mergeinfo"            NL
+"### properties of all paths and revisions, which allows mergeinfo"          NL
+"### queries that include descendants (as issued by 'svn merge' and"         NL
+"### 'svn mergeinfo') to be answered without walking the tree.  This"        NL
+"### comes at a slight cost in commit times.  The index is brought up to"    NL
+"### date with all existing revisions by the first commit after it has"      NL
+"### been enabled, which may take a while in large repositories."            NL
+"### The mergeinfo index is disabled by default."                            NL
+"# " CONFIG_OPTION_ENABLE_MERGEINFO_INDEX " = false"                         NL
+""                                                                           NL
 "[" CONFIG_SECTION_DELTIFICATION "]"                                         NL
 "### To conserve space, the filesystem stores data as differences against"   NL
 "### existing representations.  This comes at a slight cost in performance," NL
@@ -29,6 +29,7 @@
 #include "recovery.h"
 #include "revprops.h"
 #include "rep-cache.h"
+#include "mergeinfo-index.h"
 
 #include "../libsvn_fs/fs-loader.h"
 
@@ -990,6 +991,23 @@ hotcopy_body(void *baton, apr_pool_t *pool)
         }
     }
 
+  if (dst_ffd->format >= SVN_FS_FS__MIN_MERGEINFO_FORMAT)
+    {
+      /* Same for the mergeinfo index. */
+      src_subdir = svn_dirent_join(src_fs->path, MERGEINFO_INDEX_DB_NAME,
+                                   pool);
+      dst_subdir = svn_dirent_join(dst_fs->path, MERGEINFO_INDEX_DB_NAME,
+                                   pool);
+      SVN_ERR(svn_io_check_path(src_subdir, &kind, pool));
+      if (kind == svn_node_file)
+        {
+          SVN_ERR(svn_sqlite__hotcopy(src_subdir, dst_subdir, pool));
+          SVN_ERR(svn_io_set_file_read_write(dst_subdir, FALSE, pool));
+          SVN_ERR(svn_fs_fs__truncate_mergeinfo_index(dst_fs, src_youngest,
+                                                      pool));
+        }
+    }
+
   /* Copy the txn-current file. */
   if (dst_ffd->format >= SVN_FS_FS__MIN_TXN_CURRENT_FORMAT)
     SVN_ERR(svn_io_dir_file_copy(src_fs->path, dst_fs->path,
@@ -0,0 +1,96 @@
+/* mergeinfo-index-db.sql -- schema for the FSFS mergeinfo index
+ *   This is intended for use with SQLite 3
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+-- STMT_CREATE_SCHEMA
+/* The svn:mergeinfo value of PATH as of REVISION, up to (but excluding)
+   the next row for the same PATH.  MERGEINFO is NULL from the revision
+   in which PATH lost its mergeinfo, either because the property was
+   removed or because PATH (or one of its parents) was deleted.
+
+   Only revisions that change the mergeinfo of PATH get a row, so the
+   mergeinfo of PATH in revision R is found in the row with the largest
+   REVISION <= R. */
+CREATE TABLE mergeinfo (
+  path TEXT NOT NULL,
+  revision INTEGER NOT NULL,
+  mergeinfo TEXT,
+  PRIMARY KEY (path, revision)
+  );
+
+CREATE INDEX i_revision ON mergeinfo (revision);
+
+/* A single row holding the youngest revision that has been indexed.
+   All revisions up to and including it are fully represented in the
+   mergeinfo table. */
+CREATE TABLE indexed_revision (
+  id INTEGER NOT NULL PRIMARY KEY,
+  revision INTEGER NOT NULL
+  );
+
+INSERT INTO indexed_revision (id, revision) VALUES (0, 0);
+
+PRAGMA USER_VERSION = 1;
+
+-- STMT_GET_INDEXED_REVISION
+SELECT revision
+FROM indexed_revision
+WHERE id = 0
+
+-- STMT_SET_INDEXED_REVISION
+UPDATE indexed_revision
+SET revision = ?1
+WHERE id = 0
+
+-- STMT_SET_MERGEINFO
+INSERT OR REPLACE INTO mergeinfo (path, revision, mergeinfo)
+VALUES (?1, ?2, ?3)
+
+-- STMT_GET_MERGEINFO
+/* The mergeinfo of path ?1 as of revision ?2.  NULL if there is none. */
+SELECT mergeinfo
+FROM mergeinfo
+WHERE path = ?1 AND revision <= ?2
+ORDER BY revision DESC
+LIMIT 1
+
+-- STMT_GET_MERGEINFO_BELOW
+/* The mergeinfo as of revision ?3 of all paths that sort between ?1 and
+   ?2, i.e. of all paths below ?1 when ?1 ends with a '/' and ?2 is ?1
+   with the '/' replaced by the next character, '0'.
+
+   SQLite takes the bare MERGEINFO column from the same row as the
+   MAX(revision) aggregate, i.e. from the latest row per PATH. */
+SELECT path, mergeinfo, MAX(revision)
+FROM mergeinfo
+WHERE path > ?1 AND path < ?2 AND revision <= ?3
+GROUP BY path
+ORDER BY path
+
+-- STMT_DEL_MERGEINFO_YOUNGER_THAN_REV
+DELETE FROM mergeinfo
+WHERE revision > ?1
+
+-- STMT_TRUNCATE_INDEXED_REVISION
+UPDATE indexed_revision
+SET revision = ?1
+WHERE id = 0 AND revision > ?1
@@ -0,0 +1,625 @@
+/* mergeinfo-index.c --- an index of svn:mergeinfo values for fsfs
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include "svn_pools.h"
+#include "svn_hash.h"
+#include "svn_props.h"
+#include "svn_sorts.h"
+#include "svn_mergeinfo.h"
+#include "svn_dirent_uri.h"
+
+#include "svn_private_config.h"
+
+#include "fs_fs.h"
+#include "fs.h"
+#include "mergeinfo-index.h"
+#include "transaction.h"
+#include "tree.h"
+#include "../libsvn_fs/fs-loader.h"
+
+#include "private/svn_fspath.h"
+#include "private/svn_sorts_private.h"
+#include "private/svn_sqlite.h"
+
+#include "mergeinfo-index-db.h"
+
+MERGEINFO_INDEX_DB_SQL_DECLARE_STATEMENTS(statements);
+
+
+
+/** Helper functions. **/
+static APR_INLINE const char *
+path_mergeinfo_index_db(const char *fs_path,
+                        apr_pool_t *result_pool)
+{
+  return svn_dirent_join(fs_path, MERGEINFO_INDEX_DB_NAME, result_pool);
+}
+
+/* A single row of the mergeinfo table as seen at some revision. */
+typedef struct index_entry_t
+{
+  /* The path the mergeinfo is set on. */
+  const char *path;
+
+  /* The unparsed mergeinfo.  Never NULL. */
+  const char *mergeinfo;
+} index_entry_t;
+
+/* Set *LOWER and *UPPER to the exclusive bounds of all paths below the
+   canonical fspath PATH in the path collation used by sqlite, i.e. to
+   "PATH/" and "PATH0".  Allocate the results in RESULT_POOL. */
+static void
+get_bounds_below(const char **lower,
+                 const char **upper,
+                 const char *path,
+                 apr_pool_t *result_pool)
+{
+  if (path[1] == '\0')
+    {
+      *lower = "/";
+      *upper = "0";
+    }
+  else
+    {
+      *lower = apr_pstrcat(result_pool, path, "/", SVN_VA_NULL);
+      *upper = apr_pstrcat(result_pool, path, "0", SVN_VA_NULL);
+    }
+}
+
+/* Set *MERGEINFO to the unparsed mergeinfo that SDB records for PATH as
+   of REVISION, or to NULL if it has none.  Allocate the result in
+   RESULT_POOL. */
+static svn_error_t *
+get_mergeinfo(const char **mergeinfo,
+              svn_sqlite__db_t *sdb,
+              const char *path,
+              svn_revnum_t revision,
+              apr_pool_t *result_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_GET_MERGEINFO));
+  SVN_ERR(svn_sqlite__bindf(stmt, "sr", path, revision));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  *mergeinfo = have_row ? svn_sqlite__column_text(stmt, 0, result_pool)
+                        : NULL;
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+/* Append an index_entry_t * to ENTRIES for each path below PATH that
+   has mergeinfo as of REVISION in SDB.  Entries are appended in path
+   order and allocated in RESULT_POOL. */
+static svn_error_t *
+get_mergeinfo_below(apr_array_header_t *entries,
+                    svn_sqlite__db_t *sdb,
+                    const char *path,
+                    svn_revnum_t revision,
+                    apr_pool_t *result_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  const char *lower, *upper;
+
+  get_bounds_below(&lower, &upper, path, result_pool);
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_GET_MERGEINFO_BELOW));
+  SVN_ERR(svn_sqlite__bindf(stmt, "ssr", lower, upper, revision));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  while (have_row)
+    {
+      /* Skip paths that lost their mergeinfo. */
+      if (!svn_sqlite__column_is_null(stmt, 1))
+        {
+          index_entry_t *entry = apr_palloc(result_pool, sizeof(*entry));
+          entry->path = svn_sqlite__column_text(stmt, 0, result_pool);
+          entry->mergeinfo = svn_sqlite__column_text(stmt, 1, result_pool);
+          APR_ARRAY_PUSH(entries, index_entry_t *) = entry;
+        }
+
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    }
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+/* Set *ENTRIES to an array of index_entry_t * for PATH and all paths
+   below it that have mergeinfo as of REVISION in SDB.  Allocate the
+   result in RESULT_POOL. */
+static svn_error_t *
+get_mergeinfo_tree(apr_array_header_t **entries,
+                   svn_sqlite__db_t *sdb,
+                   const char *path,
+                   svn_revnum_t revision,
+                   apr_pool_t *result_pool)
+{
+  const char *mergeinfo;
+
+  *entries = apr_array_make(result_pool, 4, sizeof(index_entry_t *));
+
+  SVN_ERR(get_mergeinfo(&mergeinfo, sdb, path, revision, result_pool));
+  if (mergeinfo)
+    {
+      index_entry_t *entry = apr_palloc(result_pool, sizeof(*entry));
+      entry->path = path;
+      entry->mergeinfo = mergeinfo;
+      APR_ARRAY_PUSH(*entries, index_entry_t *) = entry;
+    }
+
+  return svn_error_trace(get_mergeinfo_below(*entries, sdb, path, revision,
+                                             result_pool));
+}
+
+/* Record MERGEINFO (NULL for none) as the mergeinfo of PATH as of
+   REVISION in SDB. */
+static svn_error_t *
+set_mergeinfo(svn_sqlite__db_t *sdb,
+              const char *path,
+              svn_revnum_t revision,
+              const char *mergeinfo)
+{
+  svn_sqlite__stmt_t *stmt;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_SET_MERGEINFO));
+  SVN_ERR(svn_sqlite__bindf(stmt, "srs", path, revision, mergeinfo));
+
+  return svn_error_trace(svn_sqlite__insert(NULL, stmt));
+}
+
+/* Record in SDB that PATH and all paths below it have no mergeinfo as
+   of REVISION.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+remove_mergeinfo_tree(svn_sqlite__db_t *sdb,
+                      const char *path,
+                      svn_revnum_t revision,
+                      apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *entries;
+  int i;
+
+  SVN_ERR(get_mergeinfo_tree(&entries, sdb, path, revision, scratch_pool));
+  for (i = 0; i < entries->nelts; ++i)
+    {
+      index_entry_t *entry = APR_ARRAY_IDX(entries, i, index_entry_t *);
+      SVN_ERR(set_mergeinfo(sdb, entry->path, revision, NULL));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Record in SDB that, as of REVISION, PATH and the paths below it have
+   the same mergeinfo that FROM_PATH and the paths below it had in
+   FROM_REVISION.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+copy_mergeinfo_tree(svn_sqlite__db_t *sdb,
+                    const char *path,
+                    svn_revnum_t revision,
+                    const char *from_path,
+                    svn_revnum_t from_revision,
+                    apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *entries;
+  int i;
+
+  SVN_ERR(get_mergeinfo_tree(&entries, sdb, from_path, from_revision,
+                             scratch_pool));
+  for (i = 0; i < entries->nelts; ++i)
+    {
+      index_entry_t *entry = APR_ARRAY_IDX(entries, i, index_entry_t *);
+      const char *relpath = svn_fspath__skip_ancestor(from_path,
+                                                      entry->path);
+
+      SVN_ERR(set_mergeinfo(sdb,
+                            svn_fspath__join(path, relpath, scratch_pool),
+                            revision, entry->mergeinfo));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Add the mergeinfo changes of REVISION in FS to SDB.  All older
+   revisions must already have been indexed.  Use SCRATCH_POOL for
+   temporary allocations. */
+static svn_error_t *
+index_revision(svn_sqlite__db_t *sdb,
+               svn_fs_t *fs,
+               svn_revnum_t revision,
+               apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_fs_root_t *root;
+  apr_hash_t *changes;
+  apr_array_header_t *sorted_changes;
+  int i;
+
+  SVN_ERR(svn_fs_fs__revision_root(&root, fs, revision, scratch_pool));
+  SVN_ERR(svn_fs_fs__paths_changed(&changes, fs, revision, scratch_pool));
+
+  /* Process parents before their children, such that the mergeinfo
+     of a copied or deleted sub-tree is in place before we look at
+     modifications within that sub-tree. */
+  sorted_changes = svn_sort__hash(changes, svn_sort_compare_items_as_paths,
+                                  scratch_pool);
+  for (i = 0; i < sorted_changes->nelts; ++i)
+    {
+      svn_sort__item_t *item = &APR_ARRAY_IDX(sorted_changes, i,
+                                              svn_sort__item_t);
+      const char *path = item->key;
+      svn_fs_path_change2_t *change = item->value;
+
+      svn_pool_clear(iterpool);
+
+      if (   change->change_kind == svn_fs_path_change_delete
+          || change->change_kind == svn_fs_path_change_replace)
+        SVN_ERR(remove_mergeinfo_tree(sdb, path, revision, iterpool));
+
+      if (change->change_kind == svn_fs_path_change_delete)
+        continue;
+
+      if (   change->change_kind == svn_fs_path_change_add
+          || change->change_kind == svn_fs_path_change_replace)
+        {
+          svn_revnum_t copyfrom_rev = change->copyfrom_rev;
+          const char *copyfrom_path = change->copyfrom_path;
+
+          if (!change->copyfrom_known)
+            SVN_ERR(root->vtable->copied_from(&copyfrom_rev, &copyfrom_path,
+                                              root, path, iterpool));
+
+          if (copyfrom_path)
+            SVN_ERR(copy_mergeinfo_tree(sdb, path, revision, copyfrom_path,
+                                        copyfrom_rev, iterpool));
+        }
+
+      if (change->prop_mod && change->mergeinfo_mod != svn_tristate_false)
+        {
+          svn_string_t *value;
+
+          SVN_ERR(root->vtable->node_prop(&value, root, path,
+                                          SVN_PROP_MERGEINFO, iterpool));
+          if (value)
+            {
+              SVN_ERR(set_mergeinfo(sdb, path, revision, value->data));
+            }
+          else
+            {
+              const char *mergeinfo;
+
+              /* Only record the removal if there was anything to remove. */
+              SVN_ERR(get_mergeinfo(&mergeinfo, sdb, path, revision,
+                                    iterpool));
+              if (mergeinfo)
+                SVN_ERR(set_mergeinfo(sdb, path, revision, NULL));
+            }
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *REVISION to the youngest revision covered by the index in SDB. */
+static svn_error_t *
+get_indexed_revision(svn_revnum_t *revision,
+                     svn_sqlite__db_t *sdb)
+{
+  svn_sqlite__stmt_t *stmt;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_GET_INDEXED_REVISION));
+  SVN_ERR(svn_sqlite__step_row(stmt));
+  *revision = svn_sqlite__column_revnum(stmt, 0);
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+/* Add the next revision of FS not covered by the index in SDB to it.
+   Set *DONE to TRUE if the index was already up to date.  Must be
+   called within an immediate sqlite transaction.  Use SCRATCH_POOL for
+   temporary allocations. */
+static svn_error_t *
+index_next_revision(svn_boolean_t *done,
+                    svn_sqlite__db_t *sdb,
+                    svn_fs_t *fs,
+                    apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_revnum_t indexed, youngest;
+
+  SVN_ERR(get_indexed_revision(&indexed, sdb));
+  SVN_ERR(svn_fs_fs__youngest_rev(&youngest, fs, scratch_pool));
+
+  *done = indexed >= youngest;
+  if (*done)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(index_revision(sdb, fs, indexed + 1, scratch_pool));
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_SET_INDEXED_REVISION));
+  SVN_ERR(svn_sqlite__bindf(stmt, "r", indexed + 1));
+
+  return svn_error_trace(svn_sqlite__update(NULL, stmt));
+}
+
+
+/* Remove all entries for revisions younger than REVISION from SDB. */
+static svn_error_t *
+truncate_index(svn_sqlite__db_t *sdb,
+               svn_revnum_t revision)
+{
+  svn_sqlite__stmt_t *stmt;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb,
+                                    STMT_DEL_MERGEINFO_YOUNGER_THAN_REV));
+  SVN_ERR(svn_sqlite__bindf(stmt, "r", revision));
+  SVN_ERR(svn_sqlite__step_done(stmt));
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb,
+                                    STMT_TRUNCATE_INDEXED_REVISION));
+  SVN_ERR(svn_sqlite__bindf(stmt, "r", revision));
+
+  return svn_error_trace(svn_sqlite__step_done(stmt));
+}
+
+
+/** Library-private API's. **/
+
+/* Body of svn_fs_fs__open_mergeinfo_index().
+   Implements svn_atomic__init_once().init_func.
+ */
+static svn_error_t *
+open_mergeinfo_index(void *baton,
+                     apr_pool_t *pool)
+{
+  svn_fs_t *fs = baton;
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_sqlite__db_t *sdb;
+  const char *db_path;
+  int version;
+
+  /* Open (or create) the sqlite database.  It will be automatically
+     closed when fs->pool is destroyed. */
+  db_path = path_mergeinfo_index_db(fs->path, pool);
+#ifndef WIN32
+  {
+    /* We want to extend the permissions that apply to the repository
+       as a whole when creating a new index and not simply default
+       to umask. */
+    svn_boolean_t exists;
+
+    SVN_ERR(svn_fs_fs__exists_mergeinfo_index(&exists, fs, pool));
+    if (!exists)
+      {
+        const char *current = svn_fs_fs__path_current(fs, pool);
+        svn_error_t *err = svn_io_file_create_empty(db_path, pool);
+
+        if (err && !APR_STATUS_IS_EEXIST(err->apr_err))
+          /* A real error. */
+          return svn_error_trace(err);
+        else if (err)
+          /* Some other thread/process created the file. */
+          svn_error_clear(err);
+        else
+          /* We created the file. */
+          SVN_ERR(svn_io_copy_perms(current, db_path, pool));
+      }
+  }
+#endif
+  SVN_ERR(svn_sqlite__open(&sdb, db_path,
+                           svn_sqlite__mode_rwcreate, statements,
+                           0, NULL, 0,
+                           fs->pool, pool));
+
+  SVN_SQLITE__ERR_CLOSE(svn_sqlite__read_schema_version(&version, sdb, pool),
+                        sdb);
+  /* If we have an uninitialized database, go ahead and create the schema. */
+  if (version <= 0)
+    SVN_SQLITE__ERR_CLOSE(svn_sqlite__exec_statements(sdb,
+                                                      STMT_CREATE_SCHEMA),
+                          sdb);
+
+  /* This is used as a flag that the database is available so don't
+     set it earlier. */
+  ffd->mergeinfo_index_db = sdb;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__open_mergeinfo_index(svn_fs_t *fs,
+                                apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_error_t *err = svn_atomic__init_once(&ffd->mergeinfo_index_db_opened,
+                                           open_mergeinfo_index, fs, pool);
+  return svn_error_quick_wrapf(err,
+                               _("Couldn't open mergeinfo index database "
+                                 "'%s'"),
+                               svn_dirent_local_style(
+                                 path_mergeinfo_index_db(fs->path, pool),
+                                 pool));
+}
+
+svn_error_t *
+svn_fs_fs__close_mergeinfo_index(svn_fs_t *fs)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  if (ffd->mergeinfo_index_db)
+    {
+      SVN_ERR(svn_sqlite__close(ffd->mergeinfo_index_db));
+      ffd->mergeinfo_index_db = NULL;
+      ffd->mergeinfo_index_db_opened = 0;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__exists_mergeinfo_index(svn_boolean_t *exists,
+                                  svn_fs_t *fs,
+                                  apr_pool_t *pool)
+{
+  svn_node_kind_t kind;
+
+  SVN_ERR(svn_io_check_path(path_mergeinfo_index_db(fs->path, pool),
+                            &kind, pool));
+
+  *exists = (kind != svn_node_none);
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__update_mergeinfo_index(svn_fs_t *fs,
+                                  apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_boolean_t done = FALSE;
+
+  SVN_ERR_ASSERT(ffd->format >= SVN_FS_FS__MIN_MERGEINFO_FORMAT);
+  if (! ffd->mergeinfo_index_db)
+    SVN_ERR(svn_fs_fs__open_mergeinfo_index(fs, pool));
+
+  /* Catching up with many revisions (e.g. when the index has just been
+     enabled) would block concurrent commits for a long time if done in
+     a single transaction.  So, index one revision at a time. */
+  while (!done)
+    {
+      svn_error_t *err;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_sqlite__begin_immediate_transaction(
+                ffd->mergeinfo_index_db));
+      err = index_next_revision(&done, ffd->mergeinfo_index_db, fs,
+                                iterpool);
+      err = svn_sqlite__finish_transaction(ffd->mergeinfo_index_db, err);
+
+      if (svn_error_find_cause(err, SVN_ERR_SQLITE_ROLLBACK_FAILED))
+        {
+          /* Failed rollback means that our db connection is unusable, and
+             the only thing we can do is close it.  The connection will be
+             reopened during the next operation with the index. */
+          return svn_error_trace(
+              svn_error_compose_create(err,
+                                       svn_fs_fs__close_mergeinfo_index(fs)));
+        }
+      else if (err)
+        return svn_error_trace(err);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__truncate_mergeinfo_index(svn_fs_t *fs,
+                                    svn_revnum_t revision,
+                                    apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  SVN_ERR_ASSERT(ffd->format >= SVN_FS_FS__MIN_MERGEINFO_FORMAT);
+  if (! ffd->mergeinfo_index_db)
+    SVN_ERR(svn_fs_fs__open_mergeinfo_index(fs, pool));
+
+  SVN_SQLITE__WITH_TXN(truncate_index(ffd->mergeinfo_index_db, revision),
+                       ffd->mergeinfo_index_db);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__mergeinfo_index_get_descendants(svn_boolean_t *indexed,
+                                           svn_fs_t *fs,
+                                           svn_revnum_t revision,
+                                           const char *path,
+                                           svn_fs_mergeinfo_receiver_t receiver,
+                                           void *baton,
+                                           apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_pool_t *iterpool;
+  apr_array_header_t *entries;
+  svn_revnum_t indexed_revision;
+  int i;
+
+  *indexed = FALSE;
+  if (!ffd->mergeinfo_index_enabled)
+    return SVN_NO_ERROR;
+
+  /* Don't create the index on behalf of a reader. */
+  if (! ffd->mergeinfo_index_db)
+    {
+      svn_boolean_t exists;
+
+      SVN_ERR(svn_fs_fs__exists_mergeinfo_index(&exists, fs, scratch_pool));
+      if (!exists)
+        return SVN_NO_ERROR;
+
+      SVN_ERR(svn_fs_fs__open_mergeinfo_index(fs, scratch_pool));
+    }
+
+  SVN_ERR(get_indexed_revision(&indexed_revision, ffd->mergeinfo_index_db));
+  if (indexed_revision < revision)
+    return SVN_NO_ERROR;
+
+  /* Read all entries before calling RECEIVER, which may want to access
+     the filesystem itself. */
+  entries = apr_array_make(scratch_pool, 16, sizeof(index_entry_t *));
+  SVN_ERR(get_mergeinfo_below(entries, ffd->mergeinfo_index_db, path,
+                              revision, scratch_pool));
+
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < entries->nelts; ++i)
+    {
+      index_entry_t *entry = APR_ARRAY_IDX(entries, i, index_entry_t *);
+      svn_mergeinfo_t mergeinfo;
+      svn_error_t *err;
+
+      svn_pool_clear(iterpool);
+
+      /* Issue #3896: If a node has syntactically invalid mergeinfo, then
+         treat it as if no mergeinfo is present rather than raising a parse
+         error. */
+      err = svn_mergeinfo_parse(&mergeinfo, entry->mergeinfo, iterpool);
+      if (err)
+        {
+          if (err->apr_err == SVN_ERR_MERGEINFO_PARSE_ERROR)
+            svn_error_clear(err);
+          else
+            return svn_error_trace(err);
+        }
+      else
+        {
+          SVN_ERR(receiver(entry->path, mergeinfo, baton, iterpool));
+        }
+    }
+  svn_pool_destroy(iterpool);
+
+  *indexed = TRUE;
+
+  return SVN_NO_ERROR;
+}
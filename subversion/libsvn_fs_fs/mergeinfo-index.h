@@ -0,0 +1,92 @@
+/* mergeinfo-index.h : interface to the FSFS mergeinfo index
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef SVN_LIBSVN_FS_FS_MERGEINFO_INDEX_H
+#define SVN_LIBSVN_FS_FS_MERGEINFO_INDEX_H
+
+#include "svn_error.h"
+#include "svn_fs.h"
+
+#include "fs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+
+#define MERGEINFO_INDEX_DB_NAME  "mergeinfo-index.db"
+
+/* Open and create, if needed, the mergeinfo index database associated
+   with FS.  Use POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__open_mergeinfo_index(svn_fs_t *fs,
+                                apr_pool_t *pool);
+
+/* Close the mergeinfo index database associated with FS. */
+svn_error_t *
+svn_fs_fs__close_mergeinfo_index(svn_fs_t *fs);
+
+/* Set *EXISTS to TRUE iff the mergeinfo index DB file exists. */
+svn_error_t *
+svn_fs_fs__exists_mergeinfo_index(svn_boolean_t *exists,
+                                  svn_fs_t *fs,
+                                  apr_pool_t *pool);
+
+/* Add all revisions of FS that have not been indexed yet to FS's
+   mergeinfo index.  Each revision is added in a separate sqlite
+   transaction, so concurrent callers will simply share the work.
+   Use POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__update_mergeinfo_index(svn_fs_t *fs,
+                                  apr_pool_t *pool);
+
+/* Remove all entries for revisions younger than REVISION from the
+   mergeinfo index of FS.  Use POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__truncate_mergeinfo_index(svn_fs_t *fs,
+                                    svn_revnum_t revision,
+                                    apr_pool_t *pool);
+
+/* Invoke RECEIVER with BATON for each mergeinfo found on descendants of
+   PATH (but not PATH itself) in REVISION of FS, taking the data from
+   FS's mergeinfo index.  Syntactically invalid mergeinfo is skipped.
+
+   If the index is disabled, does not exist or does not cover REVISION
+   yet, set *INDEXED to FALSE and don't invoke RECEIVER at all.
+   Otherwise, set *INDEXED to TRUE.
+
+   Use SCRATCH_POOL for temporary allocations, including the mergeinfo
+   hashes passed to RECEIVER. */
+svn_error_t *
+svn_fs_fs__mergeinfo_index_get_descendants(svn_boolean_t *indexed,
+                                           svn_fs_t *fs,
+                                           svn_revnum_t revision,
+                                           const char *path,
+                                           svn_fs_mergeinfo_receiver_t receiver,
+                                           void *baton,
+                                           apr_pool_t *scratch_pool);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_LIBSVN_FS_FS_MERGEINFO_INDEX_H */
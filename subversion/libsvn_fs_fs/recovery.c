@@ -29,6 +29,7 @@
 #include "index.h"
 #include "low_level.h"
 #include "rep-cache.h"
+#include "mergeinfo-index.h"
 #include "revprops.h"
 #include "util.h"
 #include "cached_data.h"
@@ -482,6 +483,18 @@ recover_body(void *baton, apr_pool_t *pool)
         SVN_ERR(svn_fs_fs__del_rep_reference(fs, max_rev, pool));
     }
 
+  /* Same for the mergeinfo index.  Do that even if the index is currently
+     disabled, as it would otherwise be inconsistent once re-enabled. */
+  if (ffd->format >= SVN_FS_FS__MIN_MERGEINFO_FORMAT)
+    {
+      svn_boolean_t mergeinfo_index_exists;
+
+      SVN_ERR(svn_fs_fs__exists_mergeinfo_index(&mergeinfo_index_exists, fs,
+                                                pool));
+      if (mergeinfo_index_exists)
+        SVN_ERR(svn_fs_fs__truncate_mergeinfo_index(fs, max_rev, pool));
+    }
+
   /* Now store the discovered youngest revision, and the next IDs if
      relevant, in a new 'current' file. */
   return svn_fs_fs__write_current(fs, max_rev, next_node_id, next_copy_id,
@@ -42,6 +42,7 @@
 #include "cached_data.h"
 #include "lock.h"
 #include "rep-cache.h"
+#include "mergeinfo-index.h"
 
 #include "private/svn_fs_util.h"
 #include "private/svn_fspath.h"
@@ -4016,6 +4017,11 @@ svn_fs_fs__commit(svn_revnum_t *new_rev_p,
         return svn_error_trace(err);
     }
 
+  /* Bring the mergeinfo index up to date, i.e. add the new revision
+     and any older ones that have not been indexed yet. */
+  if (ffd->mergeinfo_index_enabled)
+    SVN_ERR(svn_fs_fs__update_mergeinfo_index(fs, pool));
+
   return SVN_NO_ERROR;
 }
 
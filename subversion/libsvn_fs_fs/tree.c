@@ -55,6 +55,7 @@
 #include "cached_data.h"
 #include "dag.h"
 #include "lock.h"
+#include "mergeinfo-index.h"
 #include "tree.h"
 #include "fs_fs.h"
 #include "id.h"
@@ -4416,6 +4417,20 @@ add_descendant_mergeinfo(svn_fs_root_t *root,
   dag_node_t *this_dag;
   svn_boolean_t go_down;
 
+  /* Revision roots may be answered from the mergeinfo index without
+     walking the tree. */
+  if (!root->is_txn_root)
+    {
+      svn_boolean_t indexed;
+
+      SVN_ERR(svn_fs_fs__mergeinfo_index_get_descendants(&indexed, root->fs,
+                                                         root->rev, path,
+                                                         receiver, baton,
+                                                         scratch_pool));
+      if (indexed)
+        return SVN_NO_ERROR;
+    }
+
   SVN_ERR(get_dag(&this_dag, root, path, scratch_pool));
   SVN_ERR(svn_fs_fs__dag_has_descendants_with_mergeinfo(&go_down,
                                                         this_dag));
@@ -269,6 +269,18 @@ x_set_uuid(svn_fs_t *fs,
                                             scratch_pool));
 }
 
+/* Return the ID that tells this instance of FS apart from its copies. */
+static svn_error_t *
+x_get_instance_id(const char **instance_id,
+                  svn_fs_t *fs,
+                  apr_pool_t *result_pool)
+{
+  svn_fs_x__data_t *ffd = fs->fsap_data;
+  *instance_id = apr_pstrdup(result_pool, ffd->instance_id);
+
+  return SVN_NO_ERROR;
+}
+
 /* Wrapper around svn_fs_x__begin_txn() providing the scratch pool. */
 static svn_error_t *
 x_begin_txn(svn_fs_txn_t **txn_p,
@@ -294,6 +306,7 @@ static fs_vtable_t fs_vtable = {
   x_revision_proplist,
   svn_fs_x__change_rev_prop,
   x_set_uuid,
+  x_get_instance_id,
   svn_fs_x__revision_root,
   x_begin_txn,
   svn_fs_x__open_txn,
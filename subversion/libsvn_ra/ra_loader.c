@@ -668,6 +668,27 @@ svn_ra_list(svn_ra_session_t *session,
                                scratch_pool);
 }
 
+svn_error_t *
+svn_ra_get_blame(svn_ra_session_t *session,
+                 const char *path,
+                 svn_revnum_t start,
+                 svn_revnum_t end,
+                 svn_ra_blame_receiver_t receiver,
+                 void *receiver_baton,
+                 apr_pool_t *scratch_pool)
+{
+  SVN_ERR_ASSERT(svn_relpath_is_canonical(path));
+  if (!session->vtable->get_blame)
+    return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL, NULL);
+
+  SVN_ERR(svn_ra__assert_capable_server(session,
+                                        SVN_RA_CAPABILITY_SERVER_BLAME,
+                                        NULL, scratch_pool));
+
+  return session->vtable->get_blame(session, path, start, end, receiver,
+                                    receiver_baton, scratch_pool);
+}
+
 svn_error_t *svn_ra_get_mergeinfo(svn_ra_session_t *session,
                                   svn_mergeinfo_catalog_t *catalog,
                                   const apr_array_header_t *paths,
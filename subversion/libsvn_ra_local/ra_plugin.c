@@ -1673,6 +1673,7 @@ svn_ra_local__has_capability(svn_ra_session_t *session,
       || strcmp(capability, SVN_RA_CAPABILITY_EPHEMERAL_TXNPROPS) == 0
       || strcmp(capability, SVN_RA_CAPABILITY_GET_FILE_REVS_REVERSE) == 0
       || strcmp(capability, SVN_RA_CAPABILITY_LIST) == 0
+      || strcmp(capability, SVN_RA_CAPABILITY_SERVER_BLAME) == 0
       )
     {
       *has = TRUE;
@@ -1863,6 +1864,27 @@ svn_ra_local__list(svn_ra_session_t *session,
                                         sess->callback_baton, pool));
 }
 
+static svn_error_t *
+svn_ra_local__get_blame(svn_ra_session_t *session,
+                        const char *path,
+                        svn_revnum_t start,
+                        svn_revnum_t end,
+                        svn_ra_blame_receiver_t receiver,
+                        void *receiver_baton,
+                        apr_pool_t *pool)
+{
+  svn_ra_local__session_baton_t *sess = session->priv;
+  const char *abs_path = svn_fspath__join(sess->fs_path->data, path, pool);
+
+  return svn_error_trace(svn_repos_get_blame(sess->repos, abs_path,
+                                             start, end, NULL, NULL,
+                                             receiver, receiver_baton,
+                                             sess->callbacks
+                                               ? sess->callbacks->cancel_func
+                                               : NULL,
+                                             sess->callback_baton, pool));
+}
+
 /*----------------------------------------------------------------*/
 
 static const svn_version_t *
@@ -1913,7 +1935,8 @@ static const svn_ra__vtable_t ra_local_vtable =
   svn_ra_local__get_deleted_rev,
   svn_ra_local__get_inherited_props,
   NULL /* set_svn_ra_open */,
-  svn_ra_local__list ,
+  svn_ra_local__list,
+  svn_ra_local__get_blame,
   svn_ra_local__register_editor_shim_callbacks,
   svn_ra_local__get_commit_ev2,
   NULL /* replay_range_ev2 */
@@ -0,0 +1,229 @@
+/*
+ * get_blame.c :  entry point for the get_blame RA function in ra_serf
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <serf.h>
+
+#include "svn_hash.h"
+#include "svn_base64.h"
+#include "svn_xml.h"
+
+#include "svn_private_config.h"
+
+#include "ra_serf.h"
+#include "../libsvn_ra/ra_loader.h"
+
+
+
+/*
+ * This enum represents the current state of our XML parsing for a REPORT.
+ */
+enum blame_state_e {
+  INITIAL = XML_STATE_INITIAL,
+  REPORT,
+  CHUNK,
+  REV_PROP
+};
+
+typedef struct blame_context_t {
+  /* parameters set by our caller */
+  const char *path;
+  svn_revnum_t start;
+  svn_revnum_t end;
+
+  /* The revprops of the current chunk, if the server sent any, and the
+     pool they live in. */
+  apr_hash_t *rev_props;
+  apr_pool_t *state_pool;
+
+  /* blame receiver function and baton */
+  svn_ra_blame_receiver_t receiver;
+  void *receiver_baton;
+} blame_context_t;
+
+#define S_ SVN_XML_NAMESPACE
+static const svn_ra_serf__xml_transition_t blame_ttable[] = {
+  { INITIAL, S_, "blame-report", REPORT,
+    FALSE, { NULL }, FALSE },
+
+  { REPORT, S_, "blame-chunk", CHUNK,
+    FALSE, { "start-line", "?rev", NULL }, TRUE },
+
+  { CHUNK, S_, "rev-prop", REV_PROP,
+    TRUE, { "name", "?encoding", NULL }, TRUE },
+
+  { 0 }
+};
+
+/* Conforms to svn_ra_serf__xml_opened_t  */
+static svn_error_t *
+blame_opened(svn_ra_serf__xml_estate_t *xes,
+             void *baton,
+             int entered_state,
+             const svn_ra_serf__dav_props_t *tag,
+             apr_pool_t *scratch_pool)
+{
+  blame_context_t *blame_ctx = baton;
+
+  if (entered_state == CHUNK)
+    {
+      blame_ctx->rev_props = NULL;
+      blame_ctx->state_pool = svn_ra_serf__xml_state_pool(xes);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Conforms to svn_ra_serf__xml_closed_t  */
+static svn_error_t *
+blame_closed(svn_ra_serf__xml_estate_t *xes,
+             void *baton,
+             int leaving_state,
+             const svn_string_t *cdata,
+             apr_hash_t *attrs,
+             apr_pool_t *scratch_pool)
+{
+  blame_context_t *blame_ctx = baton;
+
+  if (leaving_state == REV_PROP)
+    {
+      apr_pool_t *state_pool = blame_ctx->state_pool;
+      const char *name = svn_hash_gets(attrs, "name");
+      const char *encoding = svn_hash_gets(attrs, "encoding");
+      const svn_string_t *value;
+
+      if (!blame_ctx->rev_props)
+        blame_ctx->rev_props = apr_hash_make(state_pool);
+
+      if (encoding && strcmp(encoding, "base64") == 0)
+        value = svn_base64_decode_string(cdata, state_pool);
+      else
+        value = svn_string_dup(cdata, state_pool);
+
+      svn_hash_sets(blame_ctx->rev_props, apr_pstrdup(state_pool, name),
+                    value);
+    }
+  else if (leaving_state == CHUNK)
+    {
+      const char *start_line_str = svn_hash_gets(attrs, "start-line");
+      const char *rev_str = svn_hash_gets(attrs, "rev");
+      apr_int64_t start_line;
+      svn_revnum_t rev = SVN_INVALID_REVNUM;
+
+      SVN_ERR(svn_cstring_atoi64(&start_line, start_line_str));
+      if (rev_str)
+        SVN_ERR(svn_revnum_parse(&rev, rev_str, NULL));
+
+      SVN_ERR(blame_ctx->receiver(blame_ctx->receiver_baton, start_line,
+                                  rev, blame_ctx->rev_props,
+                                  scratch_pool));
+      blame_ctx->rev_props = NULL;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra_serf__request_body_delegate_t */
+static svn_error_t *
+create_blame_body(serf_bucket_t **body_bkt,
+                  void *baton,
+                  serf_bucket_alloc_t *alloc,
+                  apr_pool_t *pool /* request pool */,
+                  apr_pool_t *scratch_pool)
+{
+  serf_bucket_t *buckets;
+  blame_context_t *blame_ctx = baton;
+
+  buckets = serf_bucket_aggregate_create(alloc);
+
+  svn_ra_serf__add_open_tag_buckets(buckets, alloc,
+                                    "S:blame-report",
+                                    "xmlns:S", SVN_XML_NAMESPACE,
+                                    SVN_VA_NULL);
+
+  svn_ra_serf__add_tag_buckets(buckets,
+                               "S:start-revision",
+                               apr_ltoa(pool, blame_ctx->start),
+                               alloc);
+  svn_ra_serf__add_tag_buckets(buckets,
+                               "S:end-revision",
+                               apr_ltoa(pool, blame_ctx->end),
+                               alloc);
+  svn_ra_serf__add_tag_buckets(buckets,
+                               "S:path", blame_ctx->path,
+                               alloc);
+
+  svn_ra_serf__add_close_tag_buckets(buckets, alloc,
+                                     "S:blame-report");
+
+  *body_bkt = buckets;
+  return SVN_NO_ERROR;
+}
+
+
+svn_error_t *
+svn_ra_serf__get_blame(svn_ra_session_t *ra_session,
+                       const char *path,
+                       svn_revnum_t start,
+                       svn_revnum_t end,
+                       svn_ra_blame_receiver_t receiver,
+                       void *receiver_baton,
+                       apr_pool_t *scratch_pool)
+{
+  blame_context_t *blame_ctx;
+  svn_ra_serf__session_t *session = ra_session->priv;
+  svn_ra_serf__handler_t *handler;
+  svn_ra_serf__xml_context_t *xmlctx;
+  const char *req_url;
+
+  blame_ctx = apr_pcalloc(scratch_pool, sizeof(*blame_ctx));
+  blame_ctx->path = path;
+  blame_ctx->start = start;
+  blame_ctx->end = end;
+  blame_ctx->receiver = receiver;
+  blame_ctx->receiver_baton = receiver_baton;
+
+  SVN_ERR(svn_ra_serf__get_stable_url(&req_url, NULL /* latest_revnum */,
+                                      session,
+                                      NULL /* url */, end,
+                                      scratch_pool, scratch_pool));
+
+  xmlctx = svn_ra_serf__xml_context_create(blame_ttable,
+                                           blame_opened, blame_closed, NULL,
+                                           blame_ctx,
+                                           scratch_pool);
+  handler = svn_ra_serf__create_expat_handler(session, xmlctx, NULL,
+                                              scratch_pool);
+
+  handler->method = "REPORT";
+  handler->path = req_url;
+  handler->body_delegate = create_blame_body;
+  handler->body_delegate_baton = blame_ctx;
+  handler->body_type = "text/xml";
+
+  SVN_ERR(svn_ra_serf__context_run_one(handler, scratch_pool));
+
+  if (handler->sline.code != 200)
+    SVN_ERR(svn_ra_serf__unexpected_status(handler));
+
+  return SVN_NO_ERROR;
+}
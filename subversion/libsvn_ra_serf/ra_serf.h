@@ -144,6 +144,9 @@ struct svn_ra_serf__session_t {
      requests may come in any order */
   svn_boolean_t http20;
 
+  /* Should we offer http/2 to the server during the TLS handshake? */
+  svn_boolean_t http2_enabled;
+
   /* Should we use Transfer-Encoding: chunked for HTTP/1.1 servers. */
   svn_boolean_t using_chunked_requests;
 
@@ -715,6 +718,18 @@ svn_ra_serf__create_expat_handler(svn_ra_serf__session_t *session,
                                   const int *expected_status,
                                   apr_pool_t *result_pool);
 
+/* Parse the complete XML document of LEN bytes at DATA with XMLCTX, just
+   like a response body handled by svn_ra_serf__create_expat_handler()
+   would be parsed, and finally call svn_ra_serf__xml_context_done().
+
+   This allows to test and benchmark the parser using recorded responses.
+   Temporary allocations will be made in SCRATCH_POOL.  */
+svn_error_t *
+svn_ra_serf__xml_parse_buffer(svn_ra_serf__xml_context_t *xmlctx,
+                              const char *data,
+                              apr_size_t len,
+                              apr_pool_t *scratch_pool);
+
 
 /* Allocated within XES->STATE_POOL. Changes are not allowd (callers
    should make a deep copy if they need to make changes).
@@ -1443,6 +1458,16 @@ svn_ra_serf__list(svn_ra_session_t *ra_session,
                   void *receiver_baton,
                   apr_pool_t *scratch_pool);
 
+/* Implements svn_ra__vtable_t.get_blame(). */
+svn_error_t *
+svn_ra_serf__get_blame(svn_ra_session_t *ra_session,
+                       const char *path,
+                       svn_revnum_t start,
+                       svn_revnum_t end,
+                       svn_ra_blame_receiver_t receiver,
+                       void *receiver_baton,
+                       apr_pool_t *scratch_pool);
+
 /* Request a mergeinfo-report from the URL attached to SESSION,
    and fill in the MERGEINFO hash with the results.
 
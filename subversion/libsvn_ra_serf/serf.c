@@ -251,6 +251,16 @@ load_config(svn_ra_serf__session_t *session,
                                   SVN_CONFIG_OPTION_HTTP_CHUNKED_REQUESTS,
                                   "auto", svn_tristate_unknown));
 
+  /* Should we offer http/2. */
+  SVN_ERR(svn_config_get_bool(config, &session->http2_enabled,
+                              SVN_CONFIG_SECTION_GLOBAL,
+                              SVN_CONFIG_OPTION_HTTP2,
+#ifdef SVN__SERF_TEST_HTTP2
+                              TRUE));
+#else
+                              FALSE));
+#endif
+
 #if SERF_VERSION_AT_LEAST(1, 4, 0) && !defined(SVN_SERF_NO_LOGGING)
   SVN_ERR(svn_config_get_int64(config, &log_components,
                                SVN_CONFIG_SECTION_GLOBAL,
@@ -318,6 +328,12 @@ load_config(svn_ra_serf__session_t *session,
                                       SVN_CONFIG_OPTION_HTTP_CHUNKED_REQUESTS,
                                       "auto", chunked_requests));
 
+      /* Should we offer http/2. */
+      SVN_ERR(svn_config_get_bool(config, &session->http2_enabled,
+                                  server_group,
+                                  SVN_CONFIG_OPTION_HTTP2,
+                                  session->http2_enabled));
+
 #if SERF_VERSION_AT_LEAST(1, 4, 0) && !defined(SVN_SERF_NO_LOGGING)
       SVN_ERR(svn_config_get_int64(config, &log_components,
                                    server_group,
@@ -643,6 +659,7 @@ ra_serf_dup_session(svn_ra_session_t *new_session,
   /* using_compression */
   /* http10 */
   /* http20 */
+  /* http2_enabled */
   /* using_chunked_requests */
   /* detect_chunking */
 
@@ -1064,6 +1081,7 @@ static const svn_ra__vtable_t serf_vtable = {
   svn_ra_serf__get_inherited_props,
   NULL /* set_svn_ra_open */,
   svn_ra_serf__list,
+  svn_ra_serf__get_blame,
   svn_ra_serf__register_editor_shim_callbacks,
   NULL /* commit_ev2 */,
   NULL /* replay_range_ev2 */
@@ -255,6 +255,14 @@ static const svn_ra_serf__xml_transition_t update_ttable[] = {
 #define REQUEST_COUNT_TO_PAUSE 50
 #define REQUEST_COUNT_TO_RESUME 40
 
+/* With http/2, all requests get multiplexed over a single connection and
+   the server processes them concurrently, up to its limit of concurrent
+   streams (100 by default for mod_http2).  Requests beyond that limit
+   would only be queued by serf, so keep just enough of them in flight
+   to use all streams.  Per-stream flow control prevents any single
+   response from starving the others.  */
+#define REQUEST_COUNT_TO_RESUME_HTTP2 100
+
 #define SPILLBUF_BLOCKSIZE 4096
 #define SPILLBUF_MAXBUFFSIZE 131072
 
@@ -445,6 +453,10 @@ struct report_context_t {
   /* number of pending PROPFIND requests */
   unsigned int num_active_propfinds;
 
+  /* Continue processing the REPORT response only while there are fewer
+     than this many GET and PROPFIND requests pending. */
+  unsigned int max_active_requests;
+
   /* Are we done parsing the REPORT response? */
   svn_boolean_t done;
 
@@ -555,6 +567,10 @@ create_file_baton(file_baton_t **new_file,
 static svn_error_t *
 open_connection_if_needed(svn_ra_serf__session_t *sess, int num_active_reqs)
 {
+  /* With http/2, a single connection carries all requests. */
+  if (sess->http20)
+    return SVN_NO_ERROR;
+
   /* For each REQS_PER_CONN outstanding requests open a new connection, with
    * a minimum of 1 extra connection. */
   if (sess->num_conns == 1 ||
@@ -592,6 +608,11 @@ get_best_connection(report_context_t *ctx)
   svn_ra_serf__connection_t *conn;
   int first_conn = 1;
 
+  /* Requests don't block each other with http/2, so simply use the
+     connection that also carries the REPORT response. */
+  if (ctx->sess->http20)
+    return ctx->sess->conns[0];
+
   /* Skip the first connection if the REPORT response hasn't been completely
      received yet or if we're being told to limit our connections to
      2 (because this could be an attempt to ensure that we do all our
@@ -2251,7 +2272,7 @@ update_delay_handler(serf_request_t *request,
         }
 
       while ((udb->report->num_active_fetches + udb->report->num_active_propfinds)
-                 < REQUEST_COUNT_TO_RESUME)
+                 < udb->report->max_active_requests)
         {
           const char *data;
           apr_size_t len;
@@ -2335,7 +2356,7 @@ process_pending(update_delay_baton_t *udb,
   serf_bucket_alloc_t *alloc = NULL;
 
   while ((udb->report->num_active_fetches + udb->report->num_active_propfinds)
-            < REQUEST_COUNT_TO_RESUME)
+            < udb->report->max_active_requests)
     {
       const char *data;
       apr_size_t len;
@@ -2406,6 +2427,10 @@ process_editor_report(report_context_t *ctx,
   handler->response_handler = update_delay_handler;
   handler->response_baton = ud;
 
+  /* The protocol has been negotiated while opening the session. */
+  ctx->max_active_requests = sess->http20 ? REQUEST_COUNT_TO_RESUME_HTTP2
+                                          : REQUEST_COUNT_TO_RESUME;
+
   /* Open the first extra connection. */
   SVN_ERR(open_connection_if_needed(sess, 0));
 
@@ -35,6 +35,7 @@
 #include "svn_config.h"
 #include "svn_delta.h"
 #include "svn_path.h"
+#include "svn_sorts.h"
 
 #include "svn_private_config.h"
 #include "private/svn_string_private.h"
@@ -65,9 +66,14 @@ struct svn_ra_serf__xml_context_t {
   svn_ra_serf__xml_cdata_t cdata_cb;
   void *baton;
 
-  /* Linked list of free states.  */
+  /* Linked list of free states.  They will be reused for new elements,
+     i.e. we need no more state structures and arenas than the maximum
+     nesting depth of the document.  */
   svn_ra_serf__xml_estate_t *free_states;
 
+  /* Pool to allocate state structures and their arenas in.  */
+  apr_pool_t *pool;
+
 #ifdef SVN_DEBUG
   /* Used to verify we are not re-entering a callback, specifically to
      ensure SCRATCH_POOL is not cleared while an outer callback is
@@ -110,9 +116,16 @@ struct svn_ra_serf__xml_estate_t {
      this tag is closed?  */
   svn_boolean_t custom_close;
 
-  /* A pool may be constructed for this state.  */
+  /* A pool may be constructed for this state.  If not NULL, this is
+     either ARENA or, for the initial state, the context's pool.  */
   apr_pool_t *state_pool;
 
+  /* Pool owned by this structure.  It will be cleared when the state gets
+     popped, so allocations for an element are effectively bump-allocated
+     from memory that got used for the previous element at the same
+     nesting level.  NULL for the initial state.  */
+  apr_pool_t *arena;
+
   /* The namespaces extent for this state/element. This will start with
      the parent's NS_LIST, and we will push new namespaces into our
      local list. The parent will be unaffected by our locally-scoped data. */
@@ -442,23 +455,38 @@ void svn_ra_serf__add_tag_buckets(serf_bucket_t *agg_bucket, const char *tag,
   svn_ra_serf__add_close_tag_buckets(agg_bucket, bkt_alloc, tag);
 }
 
-/* Return a pool for XES to use for self-alloc (and other specifics).  */
-static apr_pool_t *
-xes_pool(const svn_ra_serf__xml_estate_t *xes)
-{
-  /* Move up through parent states looking for one with a pool. This
-     will always terminate since the initial state has a pool.  */
-  while (xes->state_pool == NULL)
-    xes = xes->prev;
-  return xes->state_pool;
-}
-
-
 static void
 ensure_pool(svn_ra_serf__xml_estate_t *xes)
 {
+  /* Start using the arena.  Since states get popped in reverse order of
+     being pushed, it has effectively the same lifetime as a sub-pool of
+     the parent state's pool would have.  */
   if (xes->state_pool == NULL)
-    xes->state_pool = svn_pool_create(xes_pool(xes));
+    xes->state_pool = xes->arena;
+}
+
+/* Return a new, zero-initialized state structure for XMLCTX.  Reuse
+   a free state, if available.  */
+static svn_ra_serf__xml_estate_t *
+alloc_state(svn_ra_serf__xml_context_t *xmlctx)
+{
+  svn_ra_serf__xml_estate_t *xes = xmlctx->free_states;
+
+  if (xes)
+    {
+      apr_pool_t *arena = xes->arena;
+
+      xmlctx->free_states = xes->prev;
+      memset(xes, 0, sizeof(*xes));
+      xes->arena = arena;
+    }
+  else
+    {
+      xes = apr_pcalloc(xmlctx->pool, sizeof(*xes));
+      xes->arena = svn_pool_create(xmlctx->pool);
+    }
+
+  return xes;
 }
 
 
@@ -537,6 +565,7 @@ svn_ra_serf__xml_context_create(
   xmlctx->closed_cb = closed_cb;
   xmlctx->cdata_cb = cdata_cb;
   xmlctx->baton = baton;
+  xmlctx->pool = result_pool;
   xmlctx->scratch_pool = svn_pool_create(result_pool);
 
   xes = apr_pcalloc(result_pool, sizeof(*xes));
@@ -639,7 +668,6 @@ xml_cb_start(svn_ra_serf__xml_context_t *xmlctx,
   svn_ra_serf__xml_estate_t *current = xmlctx->current;
   svn_ra_serf__dav_props_t elemname;
   const svn_ra_serf__xml_transition_t *scan;
-  apr_pool_t *new_pool;
   svn_ra_serf__xml_estate_t *new_xes;
 
   /* If we're waiting for an element to close, then just ignore all
@@ -689,23 +717,16 @@ xml_cb_start(svn_ra_serf__xml_context_t *xmlctx,
   SVN_ERR_ASSERT(!scan->collect_cdata || scan->custom_close);
 
   /* Found a transition. Make it happen.  */
+  new_xes = alloc_state(xmlctx);
 
-  /* ### todo. push state  */
-
-  /* ### how to use free states?  */
-  /* This state should be allocated in the extent pool. If we will be
-     collecting information for this state, then construct a subpool.
-
-     ### potentially optimize away the subpool if none of the
-     ### attributes are present. subpools are cheap, tho...  */
-  new_pool = xes_pool(current);
+  /* If we will be collecting information for this state, then we need
+     its pool.  */
   if (scan->collect_cdata || scan->collect_attrs[0])
     {
-      new_pool = svn_pool_create(new_pool);
+      apr_pool_t *new_pool;
 
-      /* Prep the new state.  */
-      new_xes = apr_pcalloc(new_pool, sizeof(*new_xes));
-      new_xes->state_pool = new_pool;
+      ensure_pool(new_xes);
+      new_pool = new_xes->state_pool;
 
       /* If we're supposed to collect cdata, then set up a buffer for
          this. The existence of this buffer will instruct our cdata
@@ -746,19 +767,26 @@ xml_cb_start(svn_ra_serf__xml_context_t *xmlctx,
             }
         }
     }
-  else
-    {
-      /* Prep the new state.  */
-      new_xes = apr_pcalloc(new_pool, sizeof(*new_xes));
-      /* STATE_POOL remains NULL.  */
-    }
 
   /* Some basic copies to set up the new estate.  */
   new_xes->state = scan->to_state;
-  new_xes->tag.name = apr_pstrdup(new_pool, elemname.name);
-  new_xes->tag.xmlns = apr_pstrdup(new_pool, elemname.xmlns);
   new_xes->custom_close = scan->custom_close;
 
+  /* For specific transitions, the tag name is known to be identical to
+     the one in the (static) transition table.  Only wildcard matches
+     need a copy of the name expat gave us.  */
+  if (*scan->name == '*')
+    {
+      ensure_pool(new_xes);
+      new_xes->tag.name = apr_pstrdup(new_xes->state_pool, elemname.name);
+      new_xes->tag.xmlns = apr_pstrdup(new_xes->state_pool, elemname.xmlns);
+    }
+  else
+    {
+      new_xes->tag.name = scan->name;
+      new_xes->tag.xmlns = scan->ns;
+    }
+
   /* Start with the parent's namespace set.  */
   new_xes->ns_list = current->ns_list;
 
@@ -820,17 +848,16 @@ xml_cb_end(svn_ra_serf__xml_context_t *xmlctx,
   /* Pop the state.  */
   xmlctx->current = xes->prev;
 
-  /* ### not everything should go on the free state list. XES may go
-     ### away with the state pool.  */
+  /* If the state used its arena, then reset it.  This will get rid of
+     as much memory as possible while keeping the arena ready to be used
+     by the next element at this nesting level.  */
+  if (xes->state_pool)
+    svn_pool_clear(xes->state_pool);
+
+  /* Recycle the state structure.  */
   xes->prev = xmlctx->free_states;
   xmlctx->free_states = xes;
 
-  /* If there is a STATE_POOL, then toss it. This will get rid of as much
-     memory as possible. Potentially the XES (if we didn't create a pool
-     right away, then XES may be in a parent pool).  */
-  if (xes->state_pool)
-    svn_pool_destroy(xes->state_pool);
-
   return SVN_NO_ERROR;
 }
 
@@ -1028,3 +1055,33 @@ svn_ra_serf__create_expat_handler(svn_ra_serf__session_t *session,
 
   return handler;
 }
+
+svn_error_t *
+svn_ra_serf__xml_parse_buffer(svn_ra_serf__xml_context_t *xmlctx,
+                              const char *data,
+                              apr_size_t len,
+                              apr_pool_t *scratch_pool)
+{
+  struct expat_ctx_t ectx = { 0 };
+  apr_size_t offset = 0;
+
+  ectx.xmlctx = xmlctx;
+  ectx.cleanup_pool = scratch_pool;
+  ectx.parser = svn_xml_make_parser(&ectx, expat_start, expat_end,
+                                    expat_cdata, scratch_pool);
+
+  /* Feed the parser in chunks of the same size that we would read from
+     the response bucket.  Upon error, the parser is freed automatically. */
+  do
+    {
+      apr_size_t chunk = MIN(len - offset, PARSE_CHUNK_SIZE);
+
+      SVN_ERR(parse_xml(&ectx, data + offset, chunk, offset + chunk == len));
+      offset += chunk;
+    }
+  while (offset < len);
+
+  svn_xml_free_parser(ectx.parser);
+
+  return svn_error_trace(svn_ra_serf__xml_context_done(xmlctx));
+}
@@ -3073,6 +3073,7 @@ ra_svn_has_capability(svn_ra_session_t *session,
       {SVN_RA_CAPABILITY_GET_FILE_REVS_REVERSE,
                                        SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE},
       {SVN_RA_CAPABILITY_LIST, SVN_RA_SVN_CAP_LIST},
+      {SVN_RA_CAPABILITY_SERVER_BLAME, SVN_RA_SVN_CAP_SERVER_BLAME},
 
       {NULL, NULL} /* End of list marker */
   };
@@ -3242,6 +3243,59 @@ ra_svn_list(svn_ra_session_t *session,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+ra_svn_get_blame(svn_ra_session_t *session,
+                 const char *path,
+                 svn_revnum_t start,
+                 svn_revnum_t end,
+                 svn_ra_blame_receiver_t receiver,
+                 void *receiver_baton,
+                 apr_pool_t *scratch_pool)
+{
+  svn_ra_svn__session_baton_t *sess_baton = session->priv;
+  svn_ra_svn_conn_t *conn = sess_baton->conn;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+
+  path = reparent_path(session, path, scratch_pool);
+
+  SVN_ERR(svn_ra_svn__write_tuple(conn, scratch_pool, "w(crr)", "get-blame",
+                                  path, start, end));
+
+  /* Handle auth request by server */
+  SVN_ERR(handle_auth_request(sess_baton, scratch_pool));
+
+  /* Read and process the blame entries. */
+  while (1)
+    {
+      svn_ra_svn__item_t *item;
+      svn_ra_svn__list_t *proplist;
+      apr_uint64_t start_line;
+      svn_revnum_t revision;
+      apr_hash_t *rev_props = NULL;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_ra_svn__read_item(conn, iterpool, &item));
+      if (is_done_response(item))
+        break;
+      if (item->kind != SVN_RA_SVN_LIST)
+        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                _("Blame entry not a list"));
+      SVN_ERR(svn_ra_svn__parse_tuple(&item->u.list, "n(?r)l",
+                                      &start_line, &revision, &proplist));
+      if (proplist->nelts)
+        SVN_ERR(svn_ra_svn__parse_proplist(proplist, iterpool, &rev_props));
+
+      SVN_ERR(receiver(receiver_baton, (apr_int64_t) start_line, revision,
+                       rev_props, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  /* Read the actual command response. */
+  SVN_ERR(svn_ra_svn__read_cmd_response(conn, scratch_pool, ""));
+  return SVN_NO_ERROR;
+}
+
 static const svn_ra__vtable_t ra_svn_vtable = {
   svn_ra_svn_version,
   ra_svn_get_description,
@@ -3282,6 +3336,7 @@ static const svn_ra__vtable_t ra_svn_vtable = {
   ra_svn_get_inherited_props,
   NULL /* ra_set_svn_ra_open */,
   ra_svn_list,
+  ra_svn_get_blame,
   ra_svn_register_editor_shim_callbacks,
   NULL /* commit_ev2 */,
   NULL /* replay_range_ev2 */
@@ -0,0 +1,380 @@
+/* blame.c --- computing blame next to the repository
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <string.h>
+
+#include "svn_private_config.h"
+#include "svn_hash.h"
+#include "svn_pools.h"
+#include "svn_error.h"
+#include "svn_fs.h"
+#include "svn_repos.h"
+#include "svn_diff.h"
+#include "svn_io.h"
+#include "svn_sorts.h"
+#include "repos.h"
+#include "private/svn_cache.h"
+#include "private/svn_diff_private.h"
+#include "private/svn_fs_private.h"
+
+
+/* One run of lines in a blame result, as stored in the cache. */
+typedef struct blame_entry_t
+{
+  svn_revnum_t revision;    /* SVN_INVALID_REVNUM before the start rev */
+  apr_int64_t start;        /* the first line of the run */
+} blame_entry_t;
+
+/* Implements svn_cache__serialize_func_t for arrays of blame_entry_t. */
+static svn_error_t *
+serialize_blame(void **data,
+                apr_size_t *data_len,
+                void *in,
+                apr_pool_t *pool)
+{
+  apr_array_header_t *entries = in;
+
+  *data_len = entries->nelts * sizeof(blame_entry_t);
+  *data = apr_pmemdup(pool, entries->elts, *data_len);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_cache__deserialize_func_t for arrays of blame_entry_t. */
+static svn_error_t *
+deserialize_blame(void **out,
+                  void *data,
+                  apr_size_t data_len,
+                  apr_pool_t *pool)
+{
+  int count = (int)(data_len / sizeof(blame_entry_t));
+  apr_array_header_t *entries = apr_array_make(pool, count,
+                                               sizeof(blame_entry_t));
+
+  memcpy(entries->elts, data, count * sizeof(blame_entry_t));
+  entries->nelts = count;
+  *out = entries;
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *CACHE to the cache of blame results for REPOS, or to NULL if the
+   process-wide membuffer cache is disabled. */
+static svn_error_t *
+get_blame_cache(svn_cache__t **cache,
+                svn_repos_t *repos,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  svn_membuffer_t *membuffer = svn_cache__get_global_membuffer_cache();
+  const char *uuid;
+  const char *instance_id;
+
+  if (!membuffer)
+    {
+      *cache = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  /* Hotcopies and dump / load copies share the UUID but may get different
+     revisions committed, which would give different results. */
+  SVN_ERR(svn_fs_get_uuid(repos->fs, &uuid, scratch_pool));
+  SVN_ERR(svn_fs__get_instance_id(&instance_id, repos->fs, scratch_pool));
+  return svn_error_trace(svn_cache__create_membuffer_cache(
+                           cache, membuffer,
+                           serialize_blame, deserialize_blame,
+                           APR_HASH_KEY_STRING,
+                           apr_pstrcat(scratch_pool, "REPOS_BLAME:", uuid,
+                                       ":", instance_id,
+                                       "/", repos->path, ":", SVN_VA_NULL),
+                           SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                           TRUE /* thread_safe */,
+                           FALSE /* short_lived */,
+                           result_pool, scratch_pool));
+}
+
+/* The baton used while receiving the revisions of the blamed file. */
+typedef struct blame_baton_t
+{
+  svn_diff__blame_t *blame;
+  svn_revnum_t start;
+  const svn_diff_file_options_t *diff_options;
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+
+  /* Attribution of lines older than START. */
+  const svn_revnum_t *before_start;
+
+  /* The file holding the previous revision's contents, or NULL. */
+  const char *last_filename;
+
+  apr_pool_t *pool;         /* lives during the whole operation */
+  apr_pool_t *lastpool;     /* pool used during previous revision */
+  apr_pool_t *currpool;     /* pool used during this revision */
+} blame_baton_t;
+
+/* The baton used by blame_window_handler(), one per revision. */
+typedef struct blame_delta_baton_t
+{
+  svn_txdelta_window_handler_t wrapped_handler;
+  void *wrapped_baton;
+  svn_stream_t *source_stream;
+  const char *filename;
+  const svn_revnum_t *revision;
+  blame_baton_t *bb;
+} blame_delta_baton_t;
+
+/* Apply the delta window to the file of the current revision and, after
+   the last window, update the blame for it.
+   Implements svn_txdelta_window_handler_t. */
+static svn_error_t *
+blame_window_handler(svn_txdelta_window_t *window, void *baton)
+{
+  blame_delta_baton_t *dbaton = baton;
+  blame_baton_t *bb = dbaton->bb;
+  apr_pool_t *tmp_pool;
+
+  SVN_ERR(dbaton->wrapped_handler(window, dbaton->wrapped_baton));
+  if (window)
+    return SVN_NO_ERROR;
+
+  if (dbaton->source_stream)
+    SVN_ERR(svn_stream_close(dbaton->source_stream));
+
+  if (bb->last_filename)
+    {
+      svn_diff_t *diff;
+
+      SVN_ERR(svn_diff_file_diff_2(&diff, bb->last_filename,
+                                   dbaton->filename, bb->diff_options,
+                                   bb->currpool));
+      SVN_ERR(svn_diff__blame_update(bb->blame, diff, dbaton->revision,
+                                     bb->cancel_func, bb->cancel_baton));
+    }
+  else
+    svn_diff__blame_reset(bb->blame, dbaton->revision);
+
+  /* Keep this revision's file around for the next one. */
+  bb->last_filename = dbaton->filename;
+  tmp_pool = bb->lastpool;
+  bb->lastpool = bb->currpool;
+  bb->currpool = tmp_pool;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_file_rev_handler_t. */
+static svn_error_t *
+blame_file_rev_handler(void *baton,
+                       const char *path,
+                       svn_revnum_t rev,
+                       apr_hash_t *rev_props,
+                       svn_boolean_t result_of_merge,
+                       svn_txdelta_window_handler_t *delta_handler,
+                       void **delta_baton,
+                       apr_array_header_t *prop_diffs,
+                       apr_pool_t *pool)
+{
+  blame_baton_t *bb = baton;
+  blame_delta_baton_t *dbaton;
+  svn_stream_t *target_stream;
+
+  if (bb->cancel_func)
+    SVN_ERR(bb->cancel_func(bb->cancel_baton));
+
+  /* Revisions that don't change the contents don't change the blame. */
+  if (!delta_handler)
+    return SVN_NO_ERROR;
+
+  svn_pool_clear(bb->currpool);
+
+  dbaton = apr_pcalloc(bb->currpool, sizeof(*dbaton));
+  dbaton->bb = bb;
+  dbaton->revision = rev < bb->start
+                   ? bb->before_start
+                   : apr_pmemdup(bb->pool, &rev, sizeof(rev));
+
+  if (bb->last_filename)
+    SVN_ERR(svn_stream_open_readonly(&dbaton->source_stream,
+                                     bb->last_filename, bb->currpool,
+                                     pool));
+  SVN_ERR(svn_stream_open_unique(&target_stream, &dbaton->filename, NULL,
+                                 svn_io_file_del_on_pool_cleanup,
+                                 bb->currpool, pool));
+
+  svn_txdelta_apply(dbaton->source_stream, target_stream, NULL, NULL,
+                    bb->currpool,
+                    &dbaton->wrapped_handler, &dbaton->wrapped_baton);
+  *delta_handler = blame_window_handler;
+  *delta_baton = dbaton;
+
+  return SVN_NO_ERROR;
+}
+
+/* Compute the blame for PATH@END in REPOS as an array of blame_entry_t
+   in *ENTRIES, allocated in RESULT_POOL.  The other arguments are as for
+   svn_repos_get_blame(). */
+static svn_error_t *
+compute_blame(apr_array_header_t **entries,
+              svn_repos_t *repos,
+              const char *path,
+              svn_revnum_t start,
+              svn_revnum_t end,
+              svn_repos_authz_func_t authz_read_func,
+              void *authz_read_baton,
+              svn_cancel_func_t cancel_func,
+              void *cancel_baton,
+              apr_pool_t *result_pool,
+              apr_pool_t *scratch_pool)
+{
+  static const svn_revnum_t before_start = SVN_INVALID_REVNUM;
+  blame_baton_t bb;
+  apr_array_header_t *chunks;
+  int i;
+
+  bb.blame = svn_diff__blame_create(scratch_pool);
+  bb.start = start;
+  bb.diff_options = svn_diff_file_options_create(scratch_pool);
+  bb.cancel_func = cancel_func;
+  bb.cancel_baton = cancel_baton;
+  bb.before_start = &before_start;
+  bb.last_filename = NULL;
+  bb.pool = scratch_pool;
+  bb.lastpool = svn_pool_create(scratch_pool);
+  bb.currpool = svn_pool_create(scratch_pool);
+
+  /* Like the client, start one revision early so that we know what
+     actually changed in START. */
+  SVN_ERR(svn_repos_get_file_revs2(repos, path, MAX(0, start - 1), end,
+                                   FALSE, authz_read_func, authz_read_baton,
+                                   blame_file_rev_handler, &bb,
+                                   scratch_pool));
+
+  chunks = svn_diff__blame_chunks(bb.blame, scratch_pool);
+  *entries = apr_array_make(result_pool, chunks->nelts,
+                            sizeof(blame_entry_t));
+  for (i = 0; i < chunks->nelts; i++)
+    {
+      const svn_diff__blame_chunk_t *chunk
+        = &APR_ARRAY_IDX(chunks, i, svn_diff__blame_chunk_t);
+      blame_entry_t *entry = apr_array_push(*entries);
+
+      entry->revision = chunk->baton
+                      ? *(const svn_revnum_t *)chunk->baton
+                      : SVN_INVALID_REVNUM;
+      entry->start = chunk->start;
+    }
+
+  svn_pool_destroy(bb.lastpool);
+  svn_pool_destroy(bb.currpool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos_get_blame(svn_repos_t *repos,
+                    const char *path,
+                    svn_revnum_t start,
+                    svn_revnum_t end,
+                    svn_repos_authz_func_t authz_read_func,
+                    void *authz_read_baton,
+                    svn_repos_blame_receiver_t receiver,
+                    void *receiver_baton,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *scratch_pool)
+{
+  svn_cache__t *cache = NULL;
+  const char *key = NULL;
+  apr_array_header_t *entries = NULL;
+  apr_hash_t *rev_props = apr_hash_make(scratch_pool);
+  apr_pool_t *iterpool;
+  int i;
+
+  if (!SVN_IS_VALID_REVNUM(start) || !SVN_IS_VALID_REVNUM(end)
+      || start > end)
+    return svn_error_createf(SVN_ERR_INCORRECT_PARAMS, NULL,
+                             _("Invalid blame range r%ld:%ld"), start, end);
+
+  /* The result only depends on the node's history up to its last change,
+     unless path-based authz cuts that history short. */
+  if (!authz_read_func)
+    SVN_ERR(get_blame_cache(&cache, repos, scratch_pool, scratch_pool));
+
+  if (cache)
+    {
+      svn_fs_root_t *root;
+      svn_revnum_t created_rev;
+      svn_boolean_t found;
+
+      SVN_ERR(svn_fs_revision_root(&root, repos->fs, end, scratch_pool));
+      SVN_ERR(svn_fs_node_created_rev(&created_rev, root, path,
+                                      scratch_pool));
+      key = apr_psprintf(scratch_pool, "%ld:%ld:%s", start, created_rev,
+                         path);
+      SVN_ERR(svn_cache__get((void **)&entries, &found, cache, key,
+                             scratch_pool));
+    }
+
+  if (!entries)
+    {
+      SVN_ERR(compute_blame(&entries, repos, path, start, end,
+                            authz_read_func, authz_read_baton,
+                            cancel_func, cancel_baton,
+                            scratch_pool, scratch_pool));
+      if (cache)
+        SVN_ERR(svn_cache__set(cache, key, entries, scratch_pool));
+    }
+
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < entries->nelts; i++)
+    {
+      const blame_entry_t *entry = &APR_ARRAY_IDX(entries, i, blame_entry_t);
+      apr_hash_t *props = NULL;
+
+      svn_pool_clear(iterpool);
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      if (SVN_IS_VALID_REVNUM(entry->revision))
+        {
+          props = apr_hash_get(rev_props, &entry->revision,
+                               sizeof(entry->revision));
+          if (!props)
+            {
+              SVN_ERR(svn_repos_fs_revision_proplist(&props, repos,
+                                                     entry->revision,
+                                                     authz_read_func,
+                                                     authz_read_baton,
+                                                     scratch_pool));
+              apr_hash_set(rev_props, &entry->revision,
+                           sizeof(entry->revision), props);
+            }
+        }
+
+      SVN_ERR(receiver(receiver_baton, entry->start, entry->revision, props,
+                       iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
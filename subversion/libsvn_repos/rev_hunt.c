@@ -37,6 +37,7 @@
 #include "svn_props.h"
 #include "svn_mergeinfo.h"
 #include "repos.h"
+#include "private/svn_cache.h"
 #include "private/svn_fspath.h"
 #include "private/svn_fs_private.h"
 #include "private/svn_sorts_private.h"
@@ -628,6 +629,165 @@ svn_repos__prev_location(svn_revnum_t *appeared_rev,
 }
 
 
+/* The result of svn_repos__prev_location() for some path in some
+   revision, as kept in the location cache. */
+typedef struct cached_location_t
+{
+  svn_revnum_t appeared_rev;
+  svn_revnum_t prev_rev;
+
+  /* If there was no copy, the revision in which the node was created, as
+     returned by svn_fs_node_origin_rev().  SVN_INVALID_REVNUM if that
+     has not been looked up. */
+  svn_revnum_t origin_rev;
+
+  /* NULL if there was no copy. */
+  const char *prev_path;
+} cached_location_t;
+
+/* Implements svn_cache__serialize_func_t for cached_location_t. */
+static svn_error_t *
+serialize_location(void **data,
+                   apr_size_t *data_len,
+                   void *in,
+                   apr_pool_t *pool)
+{
+  cached_location_t *location = in;
+  svn_revnum_t header[3];
+  apr_size_t path_len = location->prev_path ? strlen(location->prev_path)
+                                            : 0;
+  char *buffer = apr_palloc(pool, sizeof(header) + path_len);
+
+  /* The three revisions, followed by the path without terminator. */
+  header[0] = location->appeared_rev;
+  header[1] = location->prev_rev;
+  header[2] = location->origin_rev;
+  memcpy(buffer, header, sizeof(header));
+  if (path_len)
+    memcpy(buffer + sizeof(header), location->prev_path, path_len);
+
+  *data = buffer;
+  *data_len = sizeof(header) + path_len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_cache__deserialize_func_t for cached_location_t. */
+static svn_error_t *
+deserialize_location(void **out,
+                     void *data,
+                     apr_size_t data_len,
+                     apr_pool_t *pool)
+{
+  cached_location_t *location = apr_palloc(pool, sizeof(*location));
+  svn_revnum_t header[3];
+
+  memcpy(header, data, sizeof(header));
+  location->appeared_rev = header[0];
+  location->prev_rev = header[1];
+  location->origin_rev = header[2];
+  location->prev_path = data_len > sizeof(header)
+                      ? apr_pstrmemdup(pool, (char *)data + sizeof(header),
+                                       data_len - sizeof(header))
+                      : NULL;
+  *out = location;
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *CACHE to the cache of previous node locations for FS, or to NULL
+   if the process-wide membuffer cache is disabled.
+
+   The locations of a node in committed revisions never change, so the
+   entries never need to be invalidated; new revisions simply add new
+   keys. */
+static svn_error_t *
+get_location_cache(svn_cache__t **cache,
+                   svn_fs_t *fs,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  svn_membuffer_t *membuffer = svn_cache__get_global_membuffer_cache();
+  const char *uuid;
+  const char *instance_id;
+
+  if (!membuffer)
+    {
+      *cache = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  /* A copy of the repository with the same UUID, loaded at the same path,
+     has the same revision numbers but not necessarily the same history. */
+  SVN_ERR(svn_fs_get_uuid(fs, &uuid, scratch_pool));
+  SVN_ERR(svn_fs__get_instance_id(&instance_id, fs, scratch_pool));
+  return svn_error_trace(svn_cache__create_membuffer_cache(
+                           cache, membuffer,
+                           serialize_location, deserialize_location,
+                           APR_HASH_KEY_STRING,
+                           apr_pstrcat(scratch_pool, "REPOS_LOCATIONS:", uuid,
+                                       ":", instance_id,
+                                       "/", svn_fs_path(fs, scratch_pool),
+                                       ":", SVN_VA_NULL),
+                           SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                           TRUE /* thread_safe */,
+                           FALSE /* short_lived */,
+                           result_pool, scratch_pool));
+}
+
+/* Like svn_repos__prev_location(), but return the result in *LOCATION
+   and take it from CACHE, if possible.  If WANT_ORIGIN is TRUE and
+   there was no copy, also fill in the origin revision of the node.
+   CACHE may be NULL.  Allocate *LOCATION in POOL. */
+static svn_error_t *
+get_prev_location(cached_location_t **location,
+                  svn_cache__t *cache,
+                  svn_fs_t *fs,
+                  svn_revnum_t revision,
+                  const char *path,
+                  svn_boolean_t want_origin,
+                  apr_pool_t *pool)
+{
+  const char *key = NULL;
+  cached_location_t *result;
+
+  if (cache)
+    {
+      svn_boolean_t found;
+
+      /* PATH is absolute, so this is unambiguous. */
+      key = apr_psprintf(pool, "%ld%s", revision, path);
+      SVN_ERR(svn_cache__get((void **)&result, &found, cache, key, pool));
+      if (found && (result->prev_path || !want_origin
+                    || SVN_IS_VALID_REVNUM(result->origin_rev)))
+        {
+          *location = result;
+          return SVN_NO_ERROR;
+        }
+    }
+
+  result = apr_palloc(pool, sizeof(*result));
+  SVN_ERR(svn_repos__prev_location(&result->appeared_rev, &result->prev_path,
+                                   &result->prev_rev, fs, revision, path,
+                                   pool));
+
+  result->origin_rev = SVN_INVALID_REVNUM;
+  if (!result->prev_path && want_origin)
+    {
+      svn_fs_root_t *root;
+
+      SVN_ERR(svn_fs_revision_root(&root, fs, revision, pool));
+      SVN_ERR(svn_fs_node_origin_rev(&result->origin_rev, root, path, pool));
+    }
+
+  if (cache)
+    SVN_ERR(svn_cache__set(cache, key, result, pool));
+
+  *location = result;
+  return SVN_NO_ERROR;
+}
+
+
 svn_error_t *
 svn_repos_trace_node_locations(svn_fs_t *fs,
                                apr_hash_t **locations,
@@ -644,6 +804,7 @@ svn_repos_trace_node_locations(svn_fs_t *fs,
   const char *path;
   svn_revnum_t revision;
   svn_boolean_t is_ancestor;
+  svn_cache__t *location_cache;
   apr_pool_t *lastpool, *currpool;
 
   SVN_ERR_ASSERT(location_revisions_orig->elt_size == sizeof(svn_revnum_t));
@@ -663,6 +824,7 @@ svn_repos_trace_node_locations(svn_fs_t *fs,
     }
 
   *locations = apr_hash_make(pool);
+  SVN_ERR(get_location_cache(&location_cache, fs, pool, pool));
 
   /* We flip between two pools in the second loop below. */
   lastpool = svn_pool_create(pool);
@@ -702,16 +864,21 @@ svn_repos_trace_node_locations(svn_fs_t *fs,
   while (revision_ptr < revision_ptr_end)
     {
       apr_pool_t *tmppool;
+      cached_location_t *location;
       svn_revnum_t appeared_rev, prev_rev;
       const char *prev_path;
 
       /* Find the target of the innermost copy relevant to path@revision.
          The copy may be of path itself, or of a parent directory. */
-      SVN_ERR(svn_repos__prev_location(&appeared_rev, &prev_path, &prev_rev,
-                                       fs, revision, path, currpool));
-      if (! prev_path)
+      SVN_ERR(get_prev_location(&location, location_cache, fs, revision,
+                                path, FALSE, currpool));
+      if (! location->prev_path)
         break;
 
+      appeared_rev = location->appeared_rev;
+      prev_path = location->prev_path;
+      prev_rev = location->prev_rev;
+
       /* Assign the current path to all younger revisions until we reach
          the copy target rev. */
       while ((revision_ptr < revision_ptr_end)
@@ -837,6 +1004,7 @@ svn_repos_node_location_segments(svn_repos_t *repos,
   svn_fs_t *fs = svn_repos_fs(repos);
   svn_stringbuf_t *current_path;
   svn_revnum_t youngest_rev, current_rev;
+  svn_cache__t *location_cache;
   apr_pool_t *subpool;
 
   SVN_ERR(svn_fs_youngest_rev(&youngest_rev, fs, pool));
@@ -883,13 +1051,14 @@ svn_repos_node_location_segments(svn_repos_t *repos,
     }
 
   /* Okay, let's get searching! */
+  SVN_ERR(get_location_cache(&location_cache, fs, pool, pool));
   subpool = svn_pool_create(pool);
   current_rev = peg_revision;
   current_path = svn_stringbuf_create(path, pool);
   while (current_rev >= end_rev)
     {
-      svn_revnum_t appeared_rev, prev_rev;
-      const char *cur_path, *prev_path;
+      cached_location_t *location;
+      const char *cur_path;
       svn_location_segment_t *segment;
 
       svn_pool_clear(subpool);
@@ -902,29 +1071,25 @@ svn_repos_node_location_segments(svn_repos_t *repos,
       /* segment path should be absolute without leading '/'. */
       segment->path = cur_path + 1;
 
-      SVN_ERR(svn_repos__prev_location(&appeared_rev, &prev_path, &prev_rev,
-                                       fs, current_rev, cur_path, subpool));
+      SVN_ERR(get_prev_location(&location, location_cache, fs, current_rev,
+                                cur_path, TRUE, subpool));
 
       /* If there are no previous locations for this thing (meaning,
-         it originated at the current path), then we simply need to
-         find its revision of origin to populate our final segment.
-         Otherwise, the APPEARED_REV is the start of current segment's
-         range. */
-      if (! prev_path)
+         it originated at the current path), then we simply need its
+         revision of origin to populate our final segment.  Otherwise,
+         the APPEARED_REV is the start of current segment's range. */
+      if (! location->prev_path)
         {
-          svn_fs_root_t *revroot;
-          SVN_ERR(svn_fs_revision_root(&revroot, fs, current_rev, subpool));
-          SVN_ERR(svn_fs_node_origin_rev(&(segment->range_start), revroot,
-                                         cur_path, subpool));
+          segment->range_start = location->origin_rev;
           if (segment->range_start < end_rev)
             segment->range_start = end_rev;
           current_rev = SVN_INVALID_REVNUM;
         }
       else
         {
-          segment->range_start = appeared_rev;
-          svn_stringbuf_set(current_path, prev_path);
-          current_rev = prev_rev;
+          segment->range_start = location->appeared_rev;
+          svn_stringbuf_set(current_path, location->prev_path);
+          current_rev = location->prev_rev;
         }
 
       /* Report our segment, providing it passes authz muster. */
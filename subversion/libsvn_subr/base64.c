@@ -36,6 +36,18 @@
 #include "private/svn_string_private.h"
 #include "private/svn_subr_private.h"
 
+/* Use SSSE3 kernels for whole lines if the compiler lets us enable that
+   instruction set per function.  Whether the CPU actually supports it
+   will be checked at runtime. */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) \
+    && (defined(__clang__) || __GNUC__ > 4 \
+        || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#  define SVN_BASE64_SSSE3 1
+#  include <tmmintrin.h>
+#else
+#  define SVN_BASE64_SSSE3 0
+#endif
+
 /* When asked to format the base64-encoded output as multiple lines,
    we put this many chars in each line (plus one new line char) unless
    we run out of data.
@@ -50,6 +62,128 @@
 static const char base64tab[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ" \
                                 "abcdefghijklmnopqrstuvwxyz0123456789+/";
 
+
+#if SVN_BASE64_SSSE3
+
+/* The SSSE3 kernels below process blocks of 12 bytes / 16 chars.
+   The algorithms are the ones described by Wojciech Mula and used
+   e.g. by the aklomp/base64 library. */
+
+/* Number of SSSE3 blocks that fit into a line.  The remainder of each
+   line will be processed by the standard code.  Because the kernels
+   read and write 16 bytes at a time, there must be at least 4 bytes
+   left in the line after the last block; see encode_line / decode_line.
+ */
+#define SSSE3_BLOCKS_PER_LINE ((BYTES_PER_LINE - 4) / 12)
+
+/* Return TRUE if the CPU we are running on supports SSSE3. */
+static svn_boolean_t
+have_ssse3(void)
+{
+  return __builtin_cpu_supports("ssse3") != 0;
+}
+
+/* Base64-encode COUNT blocks of 12 bytes from IN into 16 chars each
+   at OUT.  Reads 16 bytes per block, i.e. 4 bytes beyond the block. */
+__attribute__((target("ssse3")))
+static void
+encode_blocks_ssse3(const unsigned char *in, char *out, int count)
+{
+  /* Translation offsets from 6 bit values to base64 chars for the
+     ranges [0..25], [26..51], [52..61], [62] and [63]. */
+  const __m128i lut = _mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4,
+                                    -4, -4, -4, -4, -19, -16, 0, 0);
+  int i;
+
+  for (i = 0; i < count; ++i, in += 12, out += 16)
+    {
+      __m128i data = _mm_loadu_si128((const __m128i *)in);
+      __m128i t0, t1, t2, t3, indices, mask;
+
+      /* Distribute each 3-byte group over a 32 bit lane as b1 b0 b2 b1
+         and move the four 6 bit values into separate bytes. */
+      data = _mm_shuffle_epi8(data, _mm_set_epi8(10, 11,  9, 10,
+                                                  7,  8,  6,  7,
+                                                  4,  5,  3,  4,
+                                                  1,  2,  0,  1));
+      t0 = _mm_and_si128(data, _mm_set1_epi32(0x0fc0fc00));
+      t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+      t2 = _mm_and_si128(data, _mm_set1_epi32(0x003f03f0));
+      t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+      data = _mm_or_si128(t1, t3);
+
+      /* Map the values to their LUT range index and add the offsets. */
+      indices = _mm_subs_epu8(data, _mm_set1_epi8(51));
+      mask = _mm_cmpgt_epi8(data, _mm_set1_epi8(25));
+      indices = _mm_sub_epi8(indices, mask);
+      data = _mm_add_epi8(data, _mm_shuffle_epi8(lut, indices));
+
+      _mm_storeu_si128((__m128i *)out, data);
+    }
+}
+
+/* Base64-decode up to COUNT blocks of 16 chars from IN into 12 bytes
+   each at OUT.  Writes 16 bytes per block, i.e. 4 bytes beyond the
+   block.  Stop at the first block that contains a non-base64 char
+   (e.g. '=' or a new line) and return the number of blocks decoded. */
+__attribute__((target("ssse3")))
+static int
+decode_blocks_ssse3(const unsigned char *in, char *out, int count)
+{
+  /* Classification tables indexed by the low and high nibble.  A char
+     is valid iff the AND of both lookups is 0. */
+  const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11,
+                                       0x11, 0x11, 0x11, 0x11,
+                                       0x11, 0x11, 0x13, 0x1a,
+                                       0x1b, 0x1b, 0x1b, 0x1a);
+  const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02,
+                                       0x04, 0x08, 0x04, 0x08,
+                                       0x10, 0x10, 0x10, 0x10,
+                                       0x10, 0x10, 0x10, 0x10);
+
+  /* Offsets from chars to 6 bit values, indexed by the high nibble
+     ('/' being special). */
+  const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+                                         0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i mask_2f = _mm_set1_epi8(0x2f);
+  int i;
+
+  for (i = 0; i < count; ++i, in += 16, out += 12)
+    {
+      __m128i data = _mm_loadu_si128((const __m128i *)in);
+      __m128i hi_nibbles, lo_nibbles, hi, lo, eq_2f, roll;
+
+      hi_nibbles = _mm_and_si128(_mm_srli_epi32(data, 4), mask_2f);
+      lo_nibbles = _mm_and_si128(data, mask_2f);
+      hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+      lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+
+      /* Leave blocks with special chars to the standard code. */
+      if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi),
+                                           _mm_setzero_si128())))
+        break;
+
+      eq_2f = _mm_cmpeq_epi8(data, mask_2f);
+      roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles));
+      data = _mm_add_epi8(data, roll);
+
+      /* Pack 4x6 bits into 3x8 per lane, then the lanes into 12 bytes. */
+      data = _mm_maddubs_epi16(data, _mm_set1_epi32(0x01400140));
+      data = _mm_madd_epi16(data, _mm_set1_epi32(0x00011000));
+      data = _mm_shuffle_epi8(data, _mm_setr_epi8( 2,  1,  0,
+                                                   6,  5,  4,
+                                                  10,  9,  8,
+                                                  14, 13, 12,
+                                                  -1, -1, -1, -1));
+
+      _mm_storeu_si128((__m128i *)out, data);
+    }
+
+  return i;
+}
+
+#endif /* SVN_BASE64_SSSE3 */
+
 
 /* Binary input --> base64-encoded output */
 
@@ -101,6 +235,16 @@ encode_line(svn_stringbuf_t *str, const char *data)
   char *out = str->data + str->len;
   char *end = out + BASE64_LINELEN;
 
+#if SVN_BASE64_SSSE3
+  /* Let the vector unit do the bulk of the work. */
+  if (have_ssse3())
+    {
+      encode_blocks_ssse3(in, out, SSSE3_BLOCKS_PER_LINE);
+      in += SSSE3_BLOCKS_PER_LINE * 12;
+      out += SSSE3_BLOCKS_PER_LINE * 16;
+    }
+#endif
+
   /* We assume that BYTES_PER_LINE is a multiple of 3 and BASE64_LINELEN
      a multiple of 4. */
   for ( ; out != end; in += 3, out += 4)
@@ -379,6 +523,17 @@ decode_line(svn_stringbuf_t *str, const char **data)
   char *out = str->data + str->len;
   char *end = out + BYTES_PER_LINE;
 
+#if SVN_BASE64_SSSE3
+  /* Let the vector unit do the bulk of the work.  It stops at the first
+     block containing a special char. */
+  if (have_ssse3())
+    {
+      int blocks = decode_blocks_ssse3(p, out, SSSE3_BLOCKS_PER_LINE);
+      p += blocks * 16;
+      out += blocks * 12;
+    }
+#endif
+
   /* We assume that BYTES_PER_LINE is a multiple of 3 and BASE64_LINELEN
      a multiple of 4.  Stop translation as soon as we encounter a special
      char.  Leave the entire group untouched in that case. */
@@ -1155,6 +1155,9 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "###                              HTTP operation."                   NL
         "###   http-chunked-requests      Whether to use chunked transfer"   NL
         "###                              encoding for HTTP requests body."  NL
+        "###   http2                      Whether to offer HTTP/2 to https"  NL
+        "###                              servers.  All requests will then"  NL
+        "###                              share a single connection."        NL
         "###   ssl-authority-files        List of files, each of a trusted CA"
                                                                              NL
         "###   ssl-trust-default-ca       Trust the system 'default' CAs"    NL
@@ -1513,6 +1516,11 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "### to show meaningful differences for binary file formats.  [New"  NL
         "### in 1.9]"                                                        NL
         "# diff-ignore-content-type = no"                                    NL
+        "### Set blame-cache-dir to a directory in which 'svn blame' keeps"  NL
+        "### the blame it computes, so that blaming a younger revision of"   NL
+        "### the same file later only needs to process the revisions added"  NL
+        "### since.  Blame is not cached by default.  [New in 1.11]"         NL
+        "# blame-cache-dir = /home/jrandom/.cache/svn-blame"                 NL
         ""                                                                   NL
         "### Section for configuring automatic properties."                  NL
         "[auto-props]"                                                       NL
@@ -1554,6 +1562,19 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "### returning an error.  The default is 10000, i.e. 10 seconds."    NL
         "### Longer values may be useful when exclusive locking is enabled." NL
         "# busy-timeout = 10000"                                             NL
+        "### Set the number of threads that may access the files of a"       NL
+        "### working copy concurrently, e.g. to read directories during"     NL
+        "### 'svn status'.  This mainly helps on network file systems."      NL
+        "### The default is 1, i.e. no concurrent access."                   NL
+        "# worker-threads = 1"                                               NL
+        "### Set to the absolute path of a directory to share pristine"      NL
+        "### copies of file contents between all working copies on the"      NL
+        "### same file system.  Pristines already in that directory are"     NL
+        "### hard-linked into new working copies instead of downloading"     NL
+        "### them again (with 'http://' and 'https://' URLs), and new"       NL
+        "### pristines are added to it.  It must be writable by all users"   NL
+        "### of those working copies.  Unset by default."                    NL
+        "# shared-pristine-store ="                                          NL
         ;
 
       err = svn_io_file_open(&f, path,
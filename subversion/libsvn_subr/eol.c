@@ -30,9 +30,34 @@
 #include "private/svn_eol_private.h"
 #include "private/svn_dep_compat.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 char *
 svn_eol__find_eol_start(char *buf, apr_size_t len)
 {
+#if defined(__SSE2__)
+
+  /* Scan the input 16 bytes at a time.  This is where diff and blame spend
+   * much of their time splitting files into lines.  Once a chunk contains
+   * an EOL character, let the loops below find its exact position. */
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i lf = _mm_set1_epi8('\n');
+
+  for (; len >= sizeof(__m128i)
+       ; buf += sizeof(__m128i), len -= sizeof(__m128i))
+    {
+      __m128i chunk = _mm_loadu_si128((const __m128i *)buf);
+      __m128i eols = _mm_or_si128(_mm_cmpeq_epi8(chunk, cr),
+                                  _mm_cmpeq_epi8(chunk, lf));
+
+      if (_mm_movemask_epi8(eols))
+        break;
+    }
+
+#endif
+
 #if SVN_UNALIGNED_ACCESS_IS_OK
 
   /* Scan the input one machine word at a time. */
@@ -51,6 +51,13 @@
 #include <fcntl.h>
 #endif
 
+#if defined(__linux__)
+#include <errno.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/fs.h>
+#endif
+
 #include "svn_hash.h"
 #include "svn_types.h"
 #include "svn_dirent_uri.h"
@@ -824,8 +831,97 @@ svn_io_temp_dir(const char **dir,
 
 /*** Creating, copying and appending files. ***/
 
+/* Try to let the kernel transfer the contents of FROM_FILE to TO_FILE
+ * without passing the data through user space: first by letting both
+ * files share the same data blocks (a "reflink", copy-on-write), then by
+ * an in-kernel copy.  Both files must be at their start position with no
+ * data buffered by APR, and TO_FILE must be empty.
+ *
+ * Set *DONE to TRUE if the contents have been transferred.  If the kernel
+ * or the file system(s) can't do that for these two files, set *DONE to
+ * FALSE without touching either file, so that the caller may fall back to
+ * a plain copy.  Return any other failure as an APR status.
+ */
+static apr_status_t
+copy_contents_in_kernel(svn_boolean_t *done,
+                        apr_file_t *from_file,
+                        apr_file_t *to_file)
+{
+  *done = FALSE;
+
+#if defined(__linux__) && (defined(FICLONE) || defined(__NR_copy_file_range))
+  {
+    apr_os_file_t from_fd;
+    apr_os_file_t to_fd;
+    apr_status_t status;
+
+    status = apr_os_file_get(&from_fd, from_file);
+    if (status)
+      return status;
+    status = apr_os_file_get(&to_fd, to_file);
+    if (status)
+      return status;
+
+#ifdef FICLONE
+    /* Supported by e.g. Btrfs, XFS and OCFS2 within the same file system.
+       Any failure simply means "not here". */
+    if (ioctl(to_fd, FICLONE, from_fd) == 0)
+      {
+        *done = TRUE;
+        return APR_SUCCESS;
+      }
+#endif
+
+#ifdef __NR_copy_file_range
+    {
+      svn_boolean_t first = TRUE;
+
+      while (1)
+        {
+          long copied = syscall(__NR_copy_file_range, from_fd, NULL,
+                                to_fd, NULL, (size_t)0x40000000, 0U);
+
+          if (copied < 0)
+            {
+              if (errno == EINTR)
+                continue;
+
+              /* Nothing has been copied yet, so we can still leave the
+                 job to the caller.  Older kernels don't support copies
+                 across file systems and some file systems don't support
+                 this call at all. */
+              if (first && (errno == ENOSYS || errno == EXDEV
+                            || errno == EINVAL || errno == EBADF
+                            || errno == EOPNOTSUPP || errno == EPERM))
+                return APR_SUCCESS;
+
+              return APR_FROM_OS_ERROR(errno);
+            }
+          else if (copied == 0)
+            {
+              /* Some file systems, e.g. procfs and sysfs, report 0 bytes
+                 for files that are not actually empty.  If we did not get
+                 anything at all, let the caller read the file instead. */
+              if (first)
+                return APR_SUCCESS;
+
+              break;
+            }
+
+          first = FALSE;
+        }
+
+      *done = TRUE;
+    }
+#endif
+  }
+#endif
+
+  return APR_SUCCESS;
+}
+
 /* Transfer the contents of FROM_FILE to TO_FILE, using POOL for temporary
- * allocations.
+ * allocations.  Use copy_contents_in_kernel() where possible.
  *
  * NOTE: We don't use apr_copy_file() for this, since it takes filenames
  * as parameters.  Since we want to copy to a temporary file
@@ -838,6 +934,12 @@ copy_contents(apr_file_t *from_file,
               apr_file_t *to_file,
               apr_pool_t *pool)
 {
+  svn_boolean_t done;
+  apr_status_t status = copy_contents_in_kernel(&done, from_file, to_file);
+
+  if (status || done)
+    return status;
+
   /* Copy bytes till the cows come home. */
   while (1)
     {
@@ -870,6 +972,52 @@ copy_contents(apr_file_t *from_file,
 }
 
 
+svn_error_t *
+svn_io__file_copy_contents(apr_file_t *to_file,
+                           apr_file_t *from_file,
+                           svn_cancel_func_t cancel_func,
+                           void *cancel_baton,
+                           apr_pool_t *scratch_pool)
+{
+  svn_boolean_t done;
+  apr_status_t status;
+  const char *from_name;
+  char buf[SVN__STREAM_CHUNK_SIZE];
+
+  /* Make sure the kernel sees an empty target. */
+  SVN_ERR(svn_io_file_flush(to_file, scratch_pool));
+
+  status = copy_contents_in_kernel(&done, from_file, to_file);
+  if (!status && done)
+    return SVN_NO_ERROR;
+
+  if (!status)
+    while (1)
+      {
+        apr_size_t bytes_this_time = sizeof(buf);
+
+        if (cancel_func)
+          SVN_ERR(cancel_func(cancel_baton));
+
+        status = apr_file_read(from_file, buf, &bytes_this_time);
+        if (status && !APR_STATUS_IS_EOF(status))
+          break;
+
+        if (bytes_this_time)
+          {
+            SVN_ERR(svn_io_file_write_full(to_file, buf, bytes_this_time,
+                                           NULL, scratch_pool));
+          }
+
+        if (status)
+          return SVN_NO_ERROR;
+      }
+
+  SVN_ERR(svn_io_file_name_get(&from_name, from_file, scratch_pool));
+  return svn_error_wrap_apr(status, _("Can't copy '%s'"),
+                            svn_dirent_local_style(from_name, scratch_pool));
+}
+
 svn_error_t *
 svn_io_copy_file(const char *src,
                  const char *dst,
@@ -4319,6 +4467,45 @@ svn_io_file_rename2(const char *from_path, const char *to_path,
 }
 
 
+svn_error_t *
+svn_io__file_link(const char *from_path,
+                  const char *to_path,
+                  apr_pool_t *pool)
+{
+  apr_status_t status;
+  const char *from_path_apr, *to_path_apr;
+#if defined(WIN32)
+  const WCHAR *from_path_w;
+  const WCHAR *to_path_w;
+#endif
+
+  SVN_ERR(cstring_from_utf8(&from_path_apr, from_path, pool));
+  SVN_ERR(cstring_from_utf8(&to_path_apr, to_path, pool));
+
+#if defined(WIN32)
+  SVN_ERR(svn_io__utf8_to_unicode_longpath(&from_path_w, from_path_apr, pool));
+  SVN_ERR(svn_io__utf8_to_unicode_longpath(&to_path_w, to_path_apr, pool));
+  if (CreateHardLinkW(to_path_w, from_path_w, NULL))
+    status = APR_SUCCESS;
+  else
+    status = apr_get_os_error();
+#elif defined(SVN_ON_POSIX)
+  if (link(from_path_apr, to_path_apr) == 0)
+    status = APR_SUCCESS;
+  else
+    status = apr_get_os_error();
+#else
+  status = APR_ENOTIMPL;
+#endif
+
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't link '%s' to '%s'"),
+                              svn_dirent_local_style(to_path, pool),
+                              svn_dirent_local_style(from_path, pool));
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_io_file_move(const char *from_path, const char *to_path,
                  apr_pool_t *pool)
@@ -177,7 +177,160 @@ get_type_of_intersection(const svn_merge_range_t *r1,
   return SVN_NO_ERROR;
 }
 
-/* Modify or extend RANGELIST (a list of merge ranges) to incorporate
+/* Make sure FLAT has room for at least NELTS ranges, preserving the
+   ranges it already holds. */
+static void
+flat_reserve(svn_rangelist__flat_t *flat,
+             int nelts)
+{
+  if (nelts > flat->nalloc)
+    {
+      int nalloc = MAX(nelts, flat->nalloc * 2);
+      svn_merge_range_t *ranges = apr_palloc(flat->pool,
+                                             nalloc * sizeof(*ranges));
+
+      if (flat->nelts)
+        memcpy(ranges, flat->ranges, flat->nelts * sizeof(*ranges));
+
+      flat->ranges = ranges;
+      flat->nalloc = nalloc;
+    }
+}
+
+/* Append an uninitialized range to FLAT and return it.  The returned
+   pointer is only valid until FLAT grows again. */
+static svn_merge_range_t *
+flat_push(svn_rangelist__flat_t *flat)
+{
+  flat_reserve(flat, flat->nelts + 1);
+  return &flat->ranges[flat->nelts++];
+}
+
+/* Like svn_sort_compare_ranges() but for A and B pointing directly to
+   svn_merge_range_t objects, as for qsort() over a flat rangelist. */
+static int
+compare_range_values(const void *a,
+                     const void *b)
+{
+  const svn_merge_range_t *range_a = a;
+  const svn_merge_range_t *range_b = b;
+
+  return svn_sort_compare_ranges(&range_a, &range_b);
+}
+
+svn_rangelist__flat_t *
+svn_rangelist__flat_create(int nalloc,
+                           apr_pool_t *result_pool)
+{
+  svn_rangelist__flat_t *flat = apr_palloc(result_pool, sizeof(*flat));
+
+  flat->nalloc = MAX(nalloc, 1);
+  flat->nelts = 0;
+  flat->ranges = apr_palloc(result_pool,
+                            flat->nalloc * sizeof(*flat->ranges));
+  flat->pool = result_pool;
+
+  return flat;
+}
+
+svn_rangelist__flat_t *
+svn_rangelist__flat_import(const svn_rangelist_t *rangelist,
+                           apr_pool_t *result_pool)
+{
+  svn_rangelist__flat_t *flat
+    = svn_rangelist__flat_create(rangelist->nelts, result_pool);
+  int i;
+
+  for (i = 0; i < rangelist->nelts; i++)
+    flat->ranges[i] = *APR_ARRAY_IDX(rangelist, i, svn_merge_range_t *);
+  flat->nelts = rangelist->nelts;
+
+  return flat;
+}
+
+svn_rangelist_t *
+svn_rangelist__flat_export(const svn_rangelist__flat_t *flat,
+                           apr_pool_t *result_pool)
+{
+  svn_rangelist_t *rangelist = apr_array_make(result_pool, flat->nelts,
+                                              sizeof(svn_merge_range_t *));
+  svn_merge_range_t *copy;
+  int i;
+
+  if (flat->nelts == 0)
+    return rangelist;
+
+  /* One allocation for all ranges, like svn_rangelist_dup(). */
+  copy = apr_pmemdup(result_pool, flat->ranges,
+                     flat->nelts * sizeof(*copy));
+  for (i = 0; i < flat->nelts; i++)
+    APR_ARRAY_PUSH(rangelist, svn_merge_range_t *) = &copy[i];
+
+  return rangelist;
+}
+
+/* Store the ranges of FLAT in RANGELIST, replacing its previous contents.
+
+   The svn_merge_range_t objects already referenced by RANGELIST are never
+   modified, as other rangelists may share them.  Where a position in
+   RANGELIST already holds a range equal to the one in FLAT that object is
+   kept, all other positions get new objects allocated (in a single block)
+   in RESULT_POOL. */
+static void
+flat_store(svn_rangelist_t *rangelist,
+           const svn_rangelist__flat_t *flat,
+           apr_pool_t *result_pool)
+{
+  svn_merge_range_t *fresh = NULL;
+  int needed = 0;
+  int i;
+
+  for (i = 0; i < flat->nelts; i++)
+    {
+      const svn_merge_range_t *range;
+
+      if (i >= rangelist->nelts)
+        {
+          needed += flat->nelts - i;
+          break;
+        }
+
+      range = APR_ARRAY_IDX(rangelist, i, svn_merge_range_t *);
+      if (range->start != flat->ranges[i].start
+          || range->end != flat->ranges[i].end
+          || range->inheritable != flat->ranges[i].inheritable)
+        needed++;
+    }
+
+  if (needed)
+    fresh = apr_palloc(result_pool, needed * sizeof(*fresh));
+
+  for (i = 0; i < flat->nelts; i++)
+    {
+      svn_merge_range_t *range;
+
+      if (i < rangelist->nelts)
+        {
+          range = APR_ARRAY_IDX(rangelist, i, svn_merge_range_t *);
+          if (range->start == flat->ranges[i].start
+              && range->end == flat->ranges[i].end
+              && range->inheritable == flat->ranges[i].inheritable)
+            continue;
+
+          *fresh = flat->ranges[i];
+          APR_ARRAY_IDX(rangelist, i, svn_merge_range_t *) = fresh++;
+        }
+      else
+        {
+          *fresh = flat->ranges[i];
+          APR_ARRAY_PUSH(rangelist, svn_merge_range_t *) = fresh++;
+        }
+    }
+
+  rangelist->nelts = flat->nelts;
+}
+
+/* Modify or extend RANGELIST (a flat list of merge ranges) to incorporate
    NEW_RANGE. RANGELIST is a "rangelist" as defined in svn_mergeinfo.h.
 
    OVERVIEW
@@ -199,8 +352,7 @@ get_type_of_intersection(const svn_merge_range_t *r1,
    range before the last one in RANGELIST.
 
    If RANGELIST is empty or NEW_RANGE does not intersect with the lastrange
-   in RANGELIST, then append a copy of NEW_RANGE, allocated in RESULT_POOL,
-   to RANGELIST.
+   in RANGELIST, then append a copy of NEW_RANGE to RANGELIST.
 
    If NEW_RANGE intersects with the last range in RANGELIST then combine
    these two ranges as described below:
@@ -225,8 +377,7 @@ get_type_of_intersection(const svn_merge_range_t *r1,
    If CONSIDER_INHERITANCE is true, then only the intersection between the
    two ranges is combined, with the inheritability of the resulting range
    non-inheritable only if both ranges were non-inheritable.  The
-   non-intersecting portions are added as separate ranges allocated in
-   RESULT_POOL, e.g.:
+   non-intersecting portions are added as separate ranges, e.g.:
 
      Last range in        NEW_RANGE        RESULTING RANGES
      RANGELIST
@@ -244,45 +395,40 @@ get_type_of_intersection(const svn_merge_range_t *r1,
      -------------        ---------        ----------------
      4-10                 6*               4-10 (Not 4-5, 6, 7-10)
 
-   When replacing the last range in RANGELIST, either allocate a new range in
-   RESULT_POOL or modify the existing range in place.  Any new ranges added
-   to RANGELIST are allocated in RESULT_POOL.
+   NEW_RANGE must not point into RANGELIST.
 */
 static svn_error_t *
 combine_with_lastrange(const svn_merge_range_t *new_range,
-                       svn_rangelist_t *rangelist,
-                       svn_boolean_t consider_inheritance,
-                       apr_pool_t *result_pool)
+                       svn_rangelist__flat_t *rangelist,
+                       svn_boolean_t consider_inheritance)
 {
-  svn_merge_range_t *lastrange;
+  svn_merge_range_t lastrange;
   svn_merge_range_t combined_range;
 
   /* We don't accept a NULL RANGELIST. */
   SVN_ERR_ASSERT(rangelist);
 
-  if (rangelist->nelts > 0)
-    lastrange = APR_ARRAY_IDX(rangelist, rangelist->nelts - 1, svn_merge_range_t *);
-  else
-    lastrange = NULL;
-
-  if (!lastrange)
+  if (rangelist->nelts == 0)
     {
       /* No *LASTRANGE so push NEW_RANGE onto RANGELIST and we are done. */
-      APR_ARRAY_PUSH(rangelist, svn_merge_range_t *) =
-        svn_merge_range_dup(new_range, result_pool);
+      *flat_push(rangelist) = *new_range;
+      return SVN_NO_ERROR;
     }
-  else if (combine_ranges(&combined_range, lastrange, new_range,
+
+  /* Work on a copy, RANGELIST->RANGES may move when RANGELIST grows. */
+  lastrange = rangelist->ranges[rangelist->nelts - 1];
+
+  if (combine_ranges(&combined_range, &lastrange, new_range,
                      consider_inheritance))
     {
-      *lastrange = combined_range;
+      rangelist->ranges[rangelist->nelts - 1] = combined_range;
     }
   else if (!consider_inheritance)
     {
       /* We are not considering inheritance so we can merge intersecting
          ranges of different inheritability.  Of course if the ranges
          don't intersect at all we simply push NEW_RANGE onto RANGELIST. */
-      APR_ARRAY_PUSH(rangelist, svn_merge_range_t *) =
-            svn_merge_range_dup(new_range, result_pool);
+      *flat_push(rangelist) = *new_range;
     }
   else /* Considering inheritance */
     {
@@ -292,155 +438,140 @@ combine_with_lastrange(const svn_merge_range_t *new_range,
       intersection_type_t intersection_type;
       svn_boolean_t sorted = FALSE;
 
-      SVN_ERR(get_type_of_intersection(new_range, lastrange,
+      SVN_ERR(get_type_of_intersection(new_range, &lastrange,
                                         &intersection_type));
 
       switch (intersection_type)
         {
           case svn__no_intersection:
-            /* NEW_RANGE and *LASTRANGE *really* don't intersect so
-                just push NEW_RANGE onto RANGELIST. */
-            APR_ARRAY_PUSH(rangelist, svn_merge_range_t *) =
-              svn_merge_range_dup(new_range, result_pool);
-            sorted = (svn_sort_compare_ranges(&lastrange,
-                                              &new_range) < 0);
+          case svn__adjoining_intersection:
+            /* NEW_RANGE and *LASTRANGE *really* don't intersect or just
+                adjoin, so just push NEW_RANGE onto RANGELIST. */
+            *flat_push(rangelist) = *new_range;
+            sorted = (compare_range_values(&lastrange, new_range) < 0);
             break;
 
           case svn__equal_intersection:
             /* They range are equal so all we do is force the
                 inheritability of lastrange to true. */
-            lastrange->inheritable = TRUE;
+            rangelist->ranges[rangelist->nelts - 1].inheritable = TRUE;
             sorted = TRUE;
             break;
 
-          case svn__adjoining_intersection:
-            /* They adjoin but don't overlap so just push NEW_RANGE
-                onto RANGELIST. */
-            APR_ARRAY_PUSH(rangelist, svn_merge_range_t *) =
-              svn_merge_range_dup(new_range, result_pool);
-            sorted = (svn_sort_compare_ranges(&lastrange,
-                                              &new_range) < 0);
-            break;
-
           case svn__overlapping_intersection:
             /* They ranges overlap but neither is a proper subset of
                 the other.  We'll end up pusing two new ranges onto
                 RANGELIST, the intersecting part and the part unique to
                 NEW_RANGE.*/
             {
-              svn_merge_range_t *r1 = svn_merge_range_dup(lastrange,
-                                                          result_pool);
-              svn_merge_range_t *r2 = svn_merge_range_dup(new_range,
-                                                          result_pool);
+              svn_merge_range_t r1 = lastrange;
+              svn_merge_range_t r2 = *new_range;
 
               /* Pop off *LASTRANGE to make our manipulations
                   easier. */
-              apr_array_pop(rangelist);
+              rangelist->nelts--;
 
               /* Ensure R1 is the older range. */
-              if (r2->start < r1->start)
+              if (r2.start < r1.start)
                 {
                   /* Swap R1 and R2. */
-                  *r2 = *r1;
-                  *r1 = *new_range;
+                  r2 = r1;
+                  r1 = *new_range;
                 }
 
               /* Absorb the intersecting ranges into the
                   inheritable range. */
-              if (r1->inheritable)
-                r2->start = r1->end;
+              if (r1.inheritable)
+                r2.start = r1.end;
               else
-                r1->end = r2->start;
+                r1.end = r2.start;
 
               /* Push everything back onto RANGELIST. */
-              APR_ARRAY_PUSH(rangelist, svn_merge_range_t *) = r1;
-              sorted = (svn_sort_compare_ranges(&lastrange,
-                                                &r1) < 0);
-              APR_ARRAY_PUSH(rangelist, svn_merge_range_t *) = r2;
+              *flat_push(rangelist) = r1;
+              sorted = (compare_range_values(&lastrange, &r1) < 0);
+              *flat_push(rangelist) = r2;
               if (sorted)
-                sorted = (svn_sort_compare_ranges(&r1, &r2) < 0);
+                sorted = (compare_range_values(&r1, &r2) < 0);
               break;
             }
 
           default: /* svn__proper_subset_intersection */
             {
               /* One range is a proper subset of the other. */
-              svn_merge_range_t *r1 = svn_merge_range_dup(lastrange,
-                                                          result_pool);
-              svn_merge_range_t *r2 = svn_merge_range_dup(new_range,
-                                                          result_pool);
-              svn_merge_range_t *r3 = NULL;
+              svn_merge_range_t r1 = lastrange;
+              svn_merge_range_t r2 = *new_range;
+              svn_merge_range_t r3;
+              svn_boolean_t have_r2 = TRUE;
+              svn_boolean_t have_r3 = FALSE;
 
               /* Pop off *LASTRANGE to make our manipulations
                   easier. */
-              apr_array_pop(rangelist);
+              rangelist->nelts--;
 
               /* Ensure R1 is the superset. */
-              if (r2->start < r1->start || r2->end > r1->end)
+              if (r2.start < r1.start || r2.end > r1.end)
                 {
                   /* Swap R1 and R2. */
-                  *r2 = *r1;
-                  *r1 = *new_range;
+                  r2 = r1;
+                  r1 = *new_range;
                 }
 
-              if (r1->inheritable)
+              if (r1.inheritable)
                 {
                   /* The simple case: The superset is inheritable, so
                       just combine r1 and r2. */
-                  r1->start = MIN(r1->start, r2->start);
-                  r1->end = MAX(r1->end, r2->end);
-                  r2 = NULL;
+                  r1.start = MIN(r1.start, r2.start);
+                  r1.end = MAX(r1.end, r2.end);
+                  have_r2 = FALSE;
                 }
-              else if (r1->start == r2->start)
+              else if (r1.start == r2.start)
                 {
                   svn_revnum_t tmp_revnum;
 
                   /* *LASTRANGE and NEW_RANGE share an end point. */
-                  tmp_revnum = r1->end;
-                  r1->end = r2->end;
-                  r2->inheritable = r1->inheritable;
-                  r1->inheritable = TRUE;
-                  r2->start = r1->end;
-                  r2->end = tmp_revnum;
+                  tmp_revnum = r1.end;
+                  r1.end = r2.end;
+                  r2.inheritable = r1.inheritable;
+                  r1.inheritable = TRUE;
+                  r2.start = r1.end;
+                  r2.end = tmp_revnum;
                 }
-              else if (r1->end == r2->end)
+              else if (r1.end == r2.end)
                 {
                   /* *LASTRANGE and NEW_RANGE share an end point. */
-                  r1->end = r2->start;
-                  r2->inheritable = TRUE;
+                  r1.end = r2.start;
+                  r2.inheritable = TRUE;
                 }
               else
                 {
                   /* NEW_RANGE and *LASTRANGE share neither start
                       nor end points. */
-                  r3 = apr_pcalloc(result_pool, sizeof(*r3));
-                  r3->start = r2->end;
-                  r3->end = r1->end;
-                  r3->inheritable = r1->inheritable;
-                  r2->inheritable = TRUE;
-                  r1->end = r2->start;
+                  r3.start = r2.end;
+                  r3.end = r1.end;
+                  r3.inheritable = r1.inheritable;
+                  have_r3 = TRUE;
+                  r2.inheritable = TRUE;
+                  r1.end = r2.start;
                 }
 
               /* Push everything back onto RANGELIST. */
-              APR_ARRAY_PUSH(rangelist, svn_merge_range_t *) = r1;
-              sorted = (svn_sort_compare_ranges(&lastrange, &r1) < 0);
-              if (r2)
+              *flat_push(rangelist) = r1;
+              sorted = (compare_range_values(&lastrange, &r1) < 0);
+              if (have_r2)
                 {
-                  APR_ARRAY_PUSH(rangelist, svn_merge_range_t *) = r2;
+                  *flat_push(rangelist) = r2;
                   if (sorted)
-                    sorted = (svn_sort_compare_ranges(&r1, &r2) < 0);
+                    sorted = (compare_range_values(&r1, &r2) < 0);
                 }
-              if (r3)
+              if (have_r3)
                 {
-                  APR_ARRAY_PUSH(rangelist, svn_merge_range_t *) = r3;
+                  *flat_push(rangelist) = r3;
                   if (sorted)
                     {
-                      if (r2)
-                        sorted = (svn_sort_compare_ranges(&r2,
-                                                          &r3) < 0);
+                      if (have_r2)
+                        sorted = (compare_range_values(&r2, &r3) < 0);
                       else
-                        sorted = (svn_sort_compare_ranges(&r1,
-                                                          &r3) < 0);
+                        sorted = (compare_range_values(&r1, &r3) < 0);
                     }
                 }
               break;
@@ -450,7 +581,8 @@ combine_with_lastrange(const svn_merge_range_t *new_range,
       /* Some of the above cases might have put *RANGELIST out of
           order, so re-sort.*/
       if (!sorted)
-        svn_sort__array(rangelist, svn_sort_compare_ranges);
+        qsort(rangelist->ranges, rangelist->nelts,
+              sizeof(*rangelist->ranges), compare_range_values);
     }
 
   return SVN_NO_ERROR;
@@ -788,185 +920,165 @@ svn_mergeinfo_parse(svn_mergeinfo_t *mergeinfo,
   return err;
 }
 
-/* Cleanup after svn_rangelist_merge2 when it modifies the ending range of
-   a single rangelist element in-place.
+/* Append the range START-END with inheritability INHERITABLE to the
+   canonical flat rangelist OUTPUT, whose last range must not extend beyond
+   START.  Extend the last range of OUTPUT instead where the two adjoin and
+   have the same inheritability. */
+static void
+flat_append_canonical(svn_rangelist__flat_t *output,
+                      svn_revnum_t start,
+                      svn_revnum_t end,
+                      svn_boolean_t inheritable)
+{
+  svn_merge_range_t *last = output->nelts
+                          ? &output->ranges[output->nelts - 1]
+                          : NULL;
 
-   If *RANGE_INDEX is not a valid element in RANGELIST do nothing.  Otherwise
-   ensure that RANGELIST[*RANGE_INDEX]->END does not adjoin or overlap any
-   subsequent ranges in RANGELIST.
+  if (last && last->end == start && !last->inheritable == !inheritable)
+    {
+      last->end = end;
+    }
+  else
+    {
+      svn_merge_range_t *range = flat_push(output);
 
-   If overlap is found, then remove, modify, and/or add elements to RANGELIST
-   as per the invariants for rangelists documented in svn_mergeinfo.h.  If
-   RANGELIST[*RANGE_INDEX]->END adjoins a subsequent element then combine the
-   elements if their inheritability permits -- The inheritance of intersecting
-   and adjoining ranges is handled as per svn_mergeinfo_merge2.  Upon return
-   set *RANGE_INDEX to the index of the youngest element modified, added, or
-   adjoined to RANGELIST[*RANGE_INDEX].
+      range->start = start;
+      range->end = end;
+      range->inheritable = inheritable;
+    }
+}
 
-   Note: Adjoining rangelist elements are those where the end rev of the older
-   element is equal to the start rev of the younger element.
+/* Set OUTPUT, which must not be RANGELIST or CHANGES, to the union of the
+   canonical flat rangelists RANGELIST and CHANGES, following the rules of
+   svn_rangelist_merge2(): where the two overlap, the result is
+   non-inheritable only if both sides are non-inheritable.  The result is
+   canonical.
 
-   Any new elements inserted into RANGELIST are allocated in  RESULT_POOL.*/
+   Both inputs are walked once, side by side, so this takes time linear in
+   the total number of ranges. */
 static void
-adjust_remaining_ranges(svn_rangelist_t *rangelist,
-                        int *range_index,
-                        apr_pool_t *result_pool)
+flat_merge_into(svn_rangelist__flat_t *output,
+                const svn_rangelist__flat_t *rangelist,
+                const svn_rangelist__flat_t *changes)
 {
-  int i;
-  int starting_index;
-  int elements_to_delete = 0;
-  svn_merge_range_t *modified_range;
+  int i = 0;
+  int j = 0;
+  svn_merge_range_t range = { 0 };
+  svn_merge_range_t change = { 0 };
 
-  if (*range_index >= rangelist->nelts)
-    return;
+  output->nelts = 0;
+  flat_reserve(output, rangelist->nelts + changes->nelts);
 
-  starting_index = *range_index + 1;
-  modified_range = APR_ARRAY_IDX(rangelist, *range_index, svn_merge_range_t *);
+  if (rangelist->nelts)
+    range = rangelist->ranges[0];
+  if (changes->nelts)
+    change = changes->ranges[0];
 
-  for (i = *range_index + 1; i < rangelist->nelts; i++)
+  while (i < rangelist->nelts && j < changes->nelts)
     {
-      svn_merge_range_t *next_range = APR_ARRAY_IDX(rangelist, i,
-                                                    svn_merge_range_t *);
-
-      /* If MODIFIED_RANGE doesn't adjoin or overlap the next range in
-         RANGELIST then we are finished. */
-      if (modified_range->end < next_range->start)
-        break;
-
-      /* Does MODIFIED_RANGE adjoin NEXT_RANGE? */
-      if (modified_range->end == next_range->start)
+      if (range.end <= change.start)
         {
-          if (modified_range->inheritable == next_range->inheritable)
-            {
-              /* Combine adjoining ranges with the same inheritability. */
-              modified_range->end = next_range->end;
-              elements_to_delete++;
-            }
-          else
-            {
-              /* Cannot join because inheritance differs. */
-              (*range_index)++;
-            }
-          break;
+          /* RANGE lies wholly before CHANGE. */
+          flat_append_canonical(output, range.start, range.end,
+                                range.inheritable);
+          if (++i < rangelist->nelts)
+            range = rangelist->ranges[i];
         }
-
-      /* Alright, we know MODIFIED_RANGE overlaps NEXT_RANGE, but how? */
-      if (modified_range->end > next_range->end)
+      else if (change.end <= range.start)
         {
-          /* NEXT_RANGE is a proper subset of MODIFIED_RANGE and the two
-             don't share the same end range. */
-          if (modified_range->inheritable
-              || (modified_range->inheritable == next_range->inheritable))
-            {
-              /* MODIFIED_RANGE absorbs NEXT_RANGE. */
-              elements_to_delete++;
-            }
-          else
-            {
-              /* NEXT_RANGE is a proper subset MODIFIED_RANGE but
-                 MODIFIED_RANGE is non-inheritable and NEXT_RANGE is
-                 inheritable.  This means MODIFIED_RANGE is truncated,
-                 NEXT_RANGE remains, and the portion of MODIFIED_RANGE
-                 younger than NEXT_RANGE is added as a separate range:
-                  ______________________________________________
-                 |                                              |
-                 M                 MODIFIED_RANGE               N
-                 |                 (!inheritable)               |
-                 |______________________________________________|
-                                  |              |
-                                  O  NEXT_RANGE  P
-                                  | (inheritable)|
-                                  |______________|
-                                         |
-                                         V
-                  _______________________________________________
-                 |                |              |               |
-                 M MODIFIED_RANGE O  NEXT_RANGE  P   NEW_RANGE   N
-                 | (!inheritable) | (inheritable)| (!inheritable)|
-                 |________________|______________|_______________|
-              */
-              svn_merge_range_t *new_modified_range =
-                apr_palloc(result_pool, sizeof(*new_modified_range));
-              new_modified_range->start = next_range->end;
-              new_modified_range->end = modified_range->end;
-              new_modified_range->inheritable = FALSE;
-              modified_range->end = next_range->start;
-              (*range_index) += 2 + elements_to_delete;
-              svn_sort__array_insert(rangelist, &new_modified_range,
-                                     *range_index);
-              /* Recurse with the new range. */
-              adjust_remaining_ranges(rangelist, range_index, result_pool);
-              break;
-            }
+          /* CHANGE lies wholly before RANGE. */
+          flat_append_canonical(output, change.start, change.end,
+                                change.inheritable);
+          if (++j < changes->nelts)
+            change = changes->ranges[j];
         }
-      else if (modified_range->end == next_range->end)
+      else if (range.start < change.start)
         {
-          /* NEXT_RANGE is a proper subset MODIFIED_RANGE and share
-             the same end range. */
-          if (modified_range->inheritable
-              || (modified_range->inheritable == next_range->inheritable))
-            {
-              /* MODIFIED_RANGE absorbs NEXT_RANGE. */
-              elements_to_delete++;
-            }
-          else
-            {
-              /* The intersection between MODIFIED_RANGE and NEXT_RANGE is
-                 absorbed by the latter. */
-              modified_range->end = next_range->start;
-              (*range_index)++;
-            }
-          break;
+          /* Emit the part of RANGE before the overlap. */
+          flat_append_canonical(output, range.start, change.start,
+                                range.inheritable);
+          range.start = change.start;
+        }
+      else if (change.start < range.start)
+        {
+          /* Emit the part of CHANGE before the overlap. */
+          flat_append_canonical(output, change.start, range.start,
+                                change.inheritable);
+          change.start = range.start;
         }
       else
         {
-          /* NEXT_RANGE and MODIFIED_RANGE intersect but NEXT_RANGE is not
-             a proper subset of MODIFIED_RANGE, nor do the two share the
-             same end revision, i.e. they overlap. */
-          if (modified_range->inheritable == next_range->inheritable)
-            {
-              /* Combine overlapping ranges with the same inheritability. */
-              modified_range->end = next_range->end;
-              elements_to_delete++;
-            }
-          else if (modified_range->inheritable)
-            {
-              /* MODIFIED_RANGE absorbs the portion of NEXT_RANGE it overlaps
-                 and NEXT_RANGE is truncated. */
-              next_range->start = modified_range->end;
-              (*range_index)++;
-            }
-          else
-            {
-              /* NEXT_RANGE absorbs the portion of MODIFIED_RANGE it overlaps
-                 and MODIFIED_RANGE is truncated. */
-              modified_range->end = next_range->start;
-              (*range_index)++;
-            }
-          break;
+          /* Both start at the same revision.  Emit their common part,
+             which is inheritable if either side is. */
+          svn_revnum_t end = MIN(range.end, change.end);
+
+          flat_append_canonical(output, range.start, end,
+                                range.inheritable || change.inheritable);
+
+          range.start = end;
+          change.start = end;
+          if (range.start == range.end && ++i < rangelist->nelts)
+            range = rangelist->ranges[i];
+          if (change.start == change.end && ++j < changes->nelts)
+            change = changes->ranges[j];
         }
     }
 
-  if (elements_to_delete)
-    svn_sort__array_delete(rangelist, starting_index, elements_to_delete);
+  /* At most one of the two lists has ranges left; the current one may
+     have been truncated. */
+  if (i < rangelist->nelts)
+    {
+      flat_append_canonical(output, range.start, range.end,
+                            range.inheritable);
+      for (i++; i < rangelist->nelts; i++)
+        flat_append_canonical(output, rangelist->ranges[i].start,
+                              rangelist->ranges[i].end,
+                              rangelist->ranges[i].inheritable);
+    }
+  else if (j < changes->nelts)
+    {
+      flat_append_canonical(output, change.start, change.end,
+                            change.inheritable);
+      for (j++; j < changes->nelts; j++)
+        flat_append_canonical(output, changes->ranges[j].start,
+                              changes->ranges[j].end,
+                              changes->ranges[j].inheritable);
+    }
+}
+
+svn_error_t *
+svn_rangelist__flat_merge(svn_rangelist__flat_t **output,
+                          const svn_rangelist__flat_t *rangelist,
+                          const svn_rangelist__flat_t *changes,
+                          apr_pool_t *result_pool)
+{
+  *output = svn_rangelist__flat_create(rangelist->nelts + changes->nelts,
+                                       result_pool);
+  flat_merge_into(*output, rangelist, changes);
+
+  return SVN_NO_ERROR;
 }
 
-#if 0 /* Temporary debug helper code */
+/* Set *FLAT to a flat copy of RANGELIST in RESULT_POOL, canonicalizing
+   the copy (but not RANGELIST itself) if RANGELIST is not canonical yet.
+   Use SCRATCH_POOL for temporary allocations. */
 static svn_error_t *
-dual_dump(const char *prefix,
-  const svn_rangelist_t *rangelist,
-  const svn_rangelist_t *changes,
-  apr_pool_t *scratch_pool)
+flat_import_canonical(svn_rangelist__flat_t **flat,
+                      const svn_rangelist_t *rangelist,
+                      apr_pool_t *result_pool,
+                      apr_pool_t *scratch_pool)
 {
-  svn_string_t *rls, *chg;
+  if (! svn_rangelist__is_canonical(rangelist))
+    {
+      svn_rangelist_t *copy = svn_rangelist_dup(rangelist, scratch_pool);
 
-  SVN_ERR(svn_rangelist_to_string(&rls, rangelist, scratch_pool));
-  SVN_ERR(svn_rangelist_to_string(&chg, changes, scratch_pool));
+      SVN_ERR(svn_rangelist__canonicalize(copy, scratch_pool));
+      rangelist = copy;
+    }
 
-  SVN_DBG(("%s: %s / %s", prefix, rls->data, chg->data));
+  *flat = svn_rangelist__flat_import(rangelist, result_pool);
   return SVN_NO_ERROR;
 }
-#endif
 
 svn_error_t *
 svn_rangelist_merge2(svn_rangelist_t *rangelist,
@@ -974,268 +1086,20 @@ svn_rangelist_merge2(svn_rangelist_t *rangelist,
                      apr_pool_t *result_pool,
                      apr_pool_t *scratch_pool)
 {
-  svn_rangelist_t *changes;
-  int i = 0;
-  int j;
+  svn_rangelist__flat_t *flat_rangelist;
+  svn_rangelist__flat_t *flat_changes;
+  svn_rangelist__flat_t *merged;
 
   SVN_ERR(svn_rangelist__canonicalize(rangelist, scratch_pool));
+  flat_rangelist = svn_rangelist__flat_import(rangelist, scratch_pool);
 
-  /* We may modify CHANGES, so make a copy in SCRATCH_POOL. */
-  changes = svn_rangelist_dup(chg, scratch_pool);
-  SVN_ERR(svn_rangelist__canonicalize(changes, scratch_pool));
-
-  for (j = 0; j < changes->nelts; j++)
-    {
-      svn_merge_range_t *range;
-      svn_merge_range_t *change =
-        APR_ARRAY_IDX(changes, j, svn_merge_range_t *);
-      int res;
-
-      range = (i < rangelist->nelts)
-              ? APR_ARRAY_IDX(rangelist, i, svn_merge_range_t *)
-              : NULL;
-
-      if (!range || change->end < range->start)
-        {
-          /* No overlap, nor adjoin, copy change to result range */
-          svn_merge_range_t *chg_copy = svn_merge_range_dup(change,
-                                                            result_pool);
-          svn_sort__array_insert(rangelist, &chg_copy, i++);
-          continue;
-        }
-      else if ((change->start > range->end)
-               || (change->start == range->end
-                   && change->inheritable != range->inheritable))
-        {
-          /* No overlap, nor adjoin. Check next range item against change */
-          i++;
-          j--;
-          continue;
-        }
-
-      if (change->start < range->start
-          && range->inheritable != change->inheritable
-          && ! (change->inheritable && range_contains(change, range, FALSE))
-          && ! (range->inheritable && range_contains(range, change, FALSE)))
-        {
-          /* Can't fold change into existing range.
-             Insert new range before range */
-
-          svn_merge_range_t *chg_copy = svn_merge_range_dup(change,
-                                                            result_pool);
-
-          chg_copy->start = MIN(change->start, range->start);
-          if (! change->inheritable)
-            chg_copy->end = range->start;
-          else
-            range->start = change->end;
+  /* We must not modify CHG, so canonicalize a copy if necessary. */
+  SVN_ERR(flat_import_canonical(&flat_changes, chg, scratch_pool,
+                                scratch_pool));
 
-          svn_sort__array_insert(rangelist, &chg_copy, i++);
-
-          change->start = chg_copy->end;
-          if (change->start >= change->end)
-            continue; /* No overlap with range left */
-        }
-      else
-        {
-          range->start = MIN(range->start, change->start);
-        }
-
-      SVN_ERR_ASSERT(change->start >= range->start);
-
-      res = svn_sort_compare_ranges(&range, &change);
-
-      if (res == 0)
-        {
-          /* Only when merging two non-inheritable ranges is the result also
-             non-inheritable.  In all other cases ensure an inheritable
-             result. */
-          if (range->inheritable || change->inheritable)
-            range->inheritable = TRUE;
-          i++;
-          continue;
-        }
-      else if (res < 0) /* CHANGE is younger than RANGE */
-        {
-          if (range->end == change->start)
-            {
-              /* RANGE and CHANGE adjoin */
-              if (range->inheritable == change->inheritable)
-                {
-                  /* RANGE and CHANGE have the same inheritability so
-                     RANGE expands to absord CHANGE. */
-                  range->end = change->end;
-                  adjust_remaining_ranges(rangelist, &i, result_pool);
-                  continue;
-                }
-              else
-                {
-                  /* RANGE and CHANGE adjoin, but have different
-                     inheritability.  Since RANGE is older, just
-                     move on to the next RANGE. */
-                  SVN_ERR_MALFUNCTION();
-                }
-            }
-          else
-            {
-              /* RANGE and CHANGE overlap, but how? */
-              if ((range->inheritable == change->inheritable)
-                  || range->inheritable)
-                {
-                  /* If CHANGE is a proper subset of RANGE, it absorbs RANGE
-                      with no adjustment otherwise only the intersection is
-                      absorbed and CHANGE is truncated. */
-                  if (range->end >= change->end)
-                    continue;
-                  else
-                    {
-                      change->start = range->end;
-                      j--;
-                      continue;
-                    }
-                }
-              else
-                {
-                  /* RANGE is non-inheritable and CHANGE is inheritable. */
-                  if (range->start < change->start)
-                    {
-                      /* CHANGE absorbs intersection with RANGE and RANGE
-                         is truncated. */
-                      svn_merge_range_t *range_copy =
-                        svn_merge_range_dup(range, result_pool);
-                      range_copy->end = change->start;
-                      range->start = change->start;
-                      svn_sort__array_insert(rangelist, &range_copy, i++);
-                      j--;
-                      continue;
-                    }
-                  else
-                    {
-                      /* CHANGE and RANGE share the same start rev, but
-                         RANGE is considered older because its end rev
-                         is older. */
-                      range->inheritable = TRUE;
-                      change->start = range->end;
-                      j--;
-                      continue;
-                    }
-                }
-            }
-        }
-      else /* res > 0, CHANGE is older than RANGE */
-        {
-          if (change->end == range->start)
-            {
-              /* RANGE and CHANGE adjoin */
-              if (range->inheritable == change->inheritable)
-                {
-                  /* RANGE and CHANGE have the same inheritability so we
-                     can simply combine the two in place. */
-                  range->start = change->start;
-                  continue;
-                }
-              else
-                {
-                  /* RANGE and CHANGE have different inheritability so insert
-                     a copy of CHANGE into RANGELIST. */
-                  SVN_ERR_MALFUNCTION(); /* Already handled */
-                }
-            }
-          else
-            {
-              /* RANGE and CHANGE overlap. */
-              if (range->inheritable == change->inheritable)
-                {
-                  /* RANGE and CHANGE have the same inheritability so we
-                     can simply combine the two in place... */
-                  range->start = change->start;
-                  if (range->end < change->end)
-                    {
-                      /* ...but if RANGE is expanded ensure that we don't
-                         violate any rangelist invariants. */
-                      range->end = change->end;
-                      adjust_remaining_ranges(rangelist, &i, result_pool);
-                    }
-                  continue;
-                }
-              else if (range->inheritable)
-                {
-                  if (change->start < range->start)
-                    {
-                      /* RANGE is inheritable so absorbs any part of CHANGE
-                         it overlaps.  CHANGE is truncated and the remainder
-                         inserted into RANGELIST. */
-                      SVN_ERR_MALFUNCTION(); /* Already handled */
-                    }
-                  else
-                    {
-                      /* CHANGE and RANGE share the same start rev, but
-                         CHANGE is considered older because CHANGE->END is
-                         older than RANGE->END. */
-                      continue;
-                    }
-                }
-              else
-                {
-                  /* RANGE is non-inheritable and CHANGE is inheritable. */
-                  if (change->start < range->start)
-                    {
-                      if (change->end == range->end)
-                        {
-                          /* RANGE is a proper subset of CHANGE and share the
-                             same end revision, so set RANGE equal to CHANGE. */
-                          range->start = change->start;
-                          range->inheritable = TRUE;
-                          continue;
-                        }
-                      else if (change->end > range->end)
-                        {
-                          /* RANGE is a proper subset of CHANGE and CHANGE has
-                             a younger end revision, so set RANGE equal to its
-                             intersection with CHANGE and truncate CHANGE. */
-                          range->start = change->start;
-                          range->inheritable = TRUE;
-                          change->start = range->end;
-                          j--;
-                          continue;
-                        }
-                      else
-                        {
-                          /* CHANGE and RANGE overlap. Set RANGE equal to its
-                             intersection with CHANGE and take the remainder
-                             of RANGE and insert it into RANGELIST. */
-                          svn_merge_range_t *range_copy =
-                            svn_merge_range_dup(range, result_pool);
-                          range_copy->start = change->end;
-                          range->start = change->start;
-                          range->end = change->end;
-                          range->inheritable = TRUE;
-                          svn_sort__array_insert(rangelist, &range_copy, ++i);
-                          continue;
-                        }
-                    }
-                  else
-                    {
-                      /* CHANGE and RANGE share the same start rev, but
-                         CHANGE is considered older because its end rev
-                         is older.
-
-                         Insert the intersection of RANGE and CHANGE into
-                         RANGELIST and then set RANGE to the non-intersecting
-                         portion of RANGE. */
-                      svn_merge_range_t *range_copy =
-                        svn_merge_range_dup(range, result_pool);
-                      range_copy->end = change->end;
-                      range_copy->inheritable = TRUE;
-                      range->start = change->end;
-                      svn_sort__array_insert(rangelist, &range_copy, i++);
-                      continue;
-                    }
-                }
-            }
-        }
-      SVN_ERR_MALFUNCTION(); /* Unreachable */
-    }
+  SVN_ERR(svn_rangelist__flat_merge(&merged, flat_rangelist, flat_changes,
+                                    scratch_pool));
+  flat_store(rangelist, merged, result_pool);
 
 #ifdef SVN_DEBUG
   SVN_ERR_ASSERT(svn_rangelist__is_canonical(rangelist));
@@ -1338,13 +1202,55 @@ svn_mergeinfo__set_inheritance(svn_mergeinfo_t mergeinfo,
   return;
 }
 
+/* Return the index of the first range in RANGES[FIRST .. NELTS-1] that
+   ends after REV, or NELTS if there is none.  The ends of these ranges
+   must be ascending, as they are in any canonical rangelist.
+
+   Probe at exponentially growing distances from FIRST and then bisect the
+   last step, so a run of K skipped ranges costs O(log K) comparisons while
+   the common case of skipping nothing costs one. */
+static int
+skip_ranges_ending_by(const svn_merge_range_t *ranges,
+                      int first,
+                      int nelts,
+                      svn_revnum_t rev)
+{
+  int lo, hi;
+  int step = 1;
+
+  if (first >= nelts || ranges[first].end > rev)
+    return first;
+
+  /* RANGES[LO] ends at or before REV. */
+  lo = first;
+  while (lo + step < nelts && ranges[lo + step].end <= rev)
+    {
+      lo += step;
+      step *= 2;
+    }
+
+  /* RANGES[HI] ends after REV, or HI is NELTS. */
+  hi = MIN(lo + step, nelts);
+  while (hi - lo > 1)
+    {
+      int mid = lo + (hi - lo) / 2;
+
+      if (ranges[mid].end <= rev)
+        lo = mid;
+      else
+        hi = mid;
+    }
+
+  return hi;
+}
+
 /* If DO_REMOVE is true, then remove any overlapping ranges described by
-   RANGELIST1 from RANGELIST2 and place the results in *OUTPUT.  When
+   RANGELIST1 from RANGELIST2 and place the results in OUTPUT.  When
    DO_REMOVE is true, RANGELIST1 is effectively the "eraser" and RANGELIST2
    the "whiteboard".
 
    If DO_REMOVE is false, then capture the intersection between RANGELIST1
-   and RANGELIST2 and place the results in *OUTPUT.  The ordering of
+   and RANGELIST2 and place the results in OUTPUT.  The ordering of
    RANGELIST1 and RANGELIST2 doesn't matter when DO_REMOVE is false.
 
    If CONSIDER_INHERITANCE is true, then take the inheritance of the
@@ -1355,7 +1261,7 @@ svn_mergeinfo__set_inheritance(svn_mergeinfo_t mergeinfo,
    may intersect, but the resulting intersection is non-inheritable only
    if both ranges were non-inheritable, e.g.:
 
-   RANGELIST1  RANGELIST2  CONSIDER     DO_REMOVE  *OUTPUT
+   RANGELIST1  RANGELIST2  CONSIDER     DO_REMOVE  OUTPUT
                            INHERITANCE
    ----------  ------      -----------  ---------  -------
 
@@ -1369,37 +1275,33 @@ svn_mergeinfo__set_inheritance(svn_mergeinfo_t mergeinfo,
    90-420      1-100       FALSE        FALSE      90-100
    90-420*     1-100*      FALSE        FALSE      90-100*
 
-   Allocate the contents of *OUTPUT in POOL. */
+   OUTPUT must be empty and must not be RANGELIST1 or RANGELIST2. */
 static svn_error_t *
-rangelist_intersect_or_remove(svn_rangelist_t **output,
-                              const svn_rangelist_t *rangelist1,
-                              const svn_rangelist_t *rangelist2,
-                              svn_boolean_t do_remove,
-                              svn_boolean_t consider_inheritance,
-                              apr_pool_t *pool)
+flat_intersect_or_remove(svn_rangelist__flat_t *output,
+                         const svn_rangelist__flat_t *rangelist1,
+                         const svn_rangelist__flat_t *rangelist2,
+                         svn_boolean_t do_remove,
+                         svn_boolean_t consider_inheritance)
 {
   int i1, i2, lasti2;
   svn_merge_range_t working_elt2;
 
-  *output = apr_array_make(pool, 1, sizeof(svn_merge_range_t *));
-
   i1 = 0;
   i2 = 0;
   lasti2 = -1;  /* Initialized to a value that "i2" will never be. */
 
   while (i1 < rangelist1->nelts && i2 < rangelist2->nelts)
     {
-      svn_merge_range_t *elt1, *elt2;
+      const svn_merge_range_t *elt1, *elt2;
 
-      elt1 = APR_ARRAY_IDX(rangelist1, i1, svn_merge_range_t *);
+      elt1 = &rangelist1->ranges[i1];
 
       /* Instead of making a copy of the entire array of rangelist2
          elements, we just keep a copy of the current rangelist2 element
          that needs to be used, and modify our copy if necessary. */
       if (i2 != lasti2)
         {
-          working_elt2 =
-            *(APR_ARRAY_IDX(rangelist2, i2, svn_merge_range_t *));
+          working_elt2 = rangelist2->ranges[i2];
           lasti2 = i2;
         }
 
@@ -1424,9 +1326,8 @@ rangelist_intersect_or_remove(svn_rangelist_t **output,
                  if both ranges are non-inheritable. */
               tmp_range.inheritable =
                 (elt2->inheritable || elt1->inheritable);
-              SVN_ERR(combine_with_lastrange(&tmp_range, *output,
-                                             consider_inheritance,
-                                             pool));
+              SVN_ERR(combine_with_lastrange(&tmp_range, output,
+                                             consider_inheritance));
             }
 
           i2++;
@@ -1460,9 +1361,8 @@ rangelist_intersect_or_remove(svn_rangelist_t **output,
                     (elt2->inheritable || elt1->inheritable);
                 }
 
-              SVN_ERR(combine_with_lastrange(&tmp_range,
-                                             *output, consider_inheritance,
-                                             pool));
+              SVN_ERR(combine_with_lastrange(&tmp_range, output,
+                                             consider_inheritance));
             }
 
           /* Set up the rest of the rangelist2 range for further
@@ -1480,10 +1380,8 @@ rangelist_intersect_or_remove(svn_rangelist_t **output,
                      if both ranges are non-inheritable. */
                   tmp_range.inheritable =
                     (elt2->inheritable || elt1->inheritable);
-                  SVN_ERR(combine_with_lastrange(&tmp_range,
-                                                 *output,
-                                                 consider_inheritance,
-                                                 pool));
+                  SVN_ERR(combine_with_lastrange(&tmp_range, output,
+                                                 consider_inheritance));
                 }
 
               working_elt2.start = elt1->end;
@@ -1500,27 +1398,30 @@ rangelist_intersect_or_remove(svn_rangelist_t **output,
              If it is on past the rangelist2 on the right side, we
              need to output the rangelist2 and increment the
              rangelist2.  */
-          if (svn_sort_compare_ranges(&elt1, &elt2) < 0)
-            i1++;
-          else
+          if (compare_range_values(elt1, elt2) < 0)
             {
-              svn_merge_range_t *lastrange;
-
-              if ((*output)->nelts > 0)
-                lastrange = APR_ARRAY_IDX(*output, (*output)->nelts - 1,
-                                          svn_merge_range_t *);
-              else
-                lastrange = NULL;
-
-              if (do_remove && !(lastrange &&
-                                 combine_ranges(lastrange, lastrange, elt2,
-                                                consider_inheritance)))
-                {
-                  lastrange = svn_merge_range_dup(elt2, pool);
-                  APR_ARRAY_PUSH(*output, svn_merge_range_t *) = lastrange;
-                }
+              /* Every following rangelist1 range that ends before ELT2
+                 starts would end up here, too; skip them all at once. */
+              i1 = skip_ranges_ending_by(rangelist1->ranges, i1 + 1,
+                                         rangelist1->nelts, elt2->start);
+            }
+          else if (do_remove)
+            {
+              if (!(output->nelts > 0
+                    && combine_ranges(&output->ranges[output->nelts - 1],
+                                      &output->ranges[output->nelts - 1],
+                                      elt2, consider_inheritance)))
+                *flat_push(output) = *elt2;
               i2++;
             }
+          else
+            {
+              /* Nothing to intersect with.  Skip ELT2 as well as all
+                 further untouched rangelist2 ranges that end before ELT1
+                 starts. */
+              i2 = skip_ranges_ending_by(rangelist2->ranges, i2 + 1,
+                                         rangelist2->nelts, elt1->start);
+            }
         }
     }
 
@@ -1534,25 +1435,72 @@ rangelist_intersect_or_remove(svn_rangelist_t **output,
          the rangelist2 element. */
       if (i2 == lasti2 && i2 < rangelist2->nelts)
         {
-          SVN_ERR(combine_with_lastrange(&working_elt2, *output,
-                                         consider_inheritance, pool));
+          SVN_ERR(combine_with_lastrange(&working_elt2, output,
+                                         consider_inheritance));
           i2++;
         }
 
       /* Copy any other remaining untouched rangelist2 elements.  */
       for (; i2 < rangelist2->nelts; i2++)
-        {
-          svn_merge_range_t *elt = APR_ARRAY_IDX(rangelist2, i2,
-                                                 svn_merge_range_t *);
-
-          SVN_ERR(combine_with_lastrange(elt, *output,
-                                         consider_inheritance, pool));
-        }
+        SVN_ERR(combine_with_lastrange(&rangelist2->ranges[i2], output,
+                                       consider_inheritance));
     }
 
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_rangelist__flat_intersect(svn_rangelist__flat_t **output,
+                              const svn_rangelist__flat_t *rangelist1,
+                              const svn_rangelist__flat_t *rangelist2,
+                              svn_boolean_t consider_inheritance,
+                              apr_pool_t *result_pool)
+{
+  *output = svn_rangelist__flat_create(MIN(rangelist1->nelts,
+                                           rangelist2->nelts),
+                                       result_pool);
+  return flat_intersect_or_remove(*output, rangelist1, rangelist2, FALSE,
+                                  consider_inheritance);
+}
+
+svn_error_t *
+svn_rangelist__flat_remove(svn_rangelist__flat_t **output,
+                           const svn_rangelist__flat_t *eraser,
+                           const svn_rangelist__flat_t *whiteboard,
+                           svn_boolean_t consider_inheritance,
+                           apr_pool_t *result_pool)
+{
+  *output = svn_rangelist__flat_create(whiteboard->nelts, result_pool);
+  return flat_intersect_or_remove(*output, eraser, whiteboard, TRUE,
+                                  consider_inheritance);
+}
+
+/* Like flat_intersect_or_remove() but for svn_rangelist_t inputs and
+   output.  Allocate the contents of *OUTPUT in POOL. */
+static svn_error_t *
+rangelist_intersect_or_remove(svn_rangelist_t **output,
+                              const svn_rangelist_t *rangelist1,
+                              const svn_rangelist_t *rangelist2,
+                              svn_boolean_t do_remove,
+                              svn_boolean_t consider_inheritance,
+                              apr_pool_t *pool)
+{
+  apr_pool_t *scratch_pool = svn_pool_create(pool);
+  svn_rangelist__flat_t *flat_output
+    = svn_rangelist__flat_create(rangelist2->nelts, scratch_pool);
+
+  SVN_ERR(flat_intersect_or_remove(
+            flat_output,
+            svn_rangelist__flat_import(rangelist1, scratch_pool),
+            svn_rangelist__flat_import(rangelist2, scratch_pool),
+            do_remove, consider_inheritance));
+
+  *output = svn_rangelist__flat_export(flat_output, pool);
+  svn_pool_destroy(scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
 
 svn_error_t *
 svn_rangelist_intersect(svn_rangelist_t **output,
@@ -2698,19 +2646,34 @@ svn_rangelist__merge_many(svn_rangelist_t *merged_rangelist,
   if (apr_hash_count(merge_history))
     {
       apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+      svn_rangelist__flat_t *merged, *spare;
       apr_hash_index_t *hi;
 
+      /* Accumulate the union in flat form, alternating between two
+         buffers, and convert back to MERGED_RANGELIST only once. */
+      SVN_ERR(svn_rangelist__canonicalize(merged_rangelist, scratch_pool));
+      merged = svn_rangelist__flat_import(merged_rangelist, scratch_pool);
+      spare = svn_rangelist__flat_create(merged->nelts, scratch_pool);
+
       for (hi = apr_hash_first(scratch_pool, merge_history);
            hi;
            hi = apr_hash_next(hi))
         {
           svn_rangelist_t *subtree_rangelist = apr_hash_this_val(hi);
+          svn_rangelist__flat_t *changes, *swap;
 
           svn_pool_clear(iterpool);
-          SVN_ERR(svn_rangelist_merge2(merged_rangelist, subtree_rangelist,
-                                       result_pool, iterpool));
+          SVN_ERR(flat_import_canonical(&changes, subtree_rangelist,
+                                        iterpool, iterpool));
+
+          flat_merge_into(spare, merged, changes);
+          swap = merged;
+          merged = spare;
+          spare = swap;
         }
       svn_pool_destroy(iterpool);
+
+      flat_store(merged_rangelist, merged, result_pool);
     }
   return SVN_NO_ERROR;
 }
@@ -0,0 +1,408 @@
+/*
+ * thread_pool.c: execute independent tasks on a process-wide worker pool
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_thread_pool.h>
+#include <apr_thread_cond.h>
+
+#include "svn_pools.h"
+#include "svn_sorts.h"
+#include "svn_private_config.h"
+
+#include "private/svn_atomic.h"
+#include "private/svn_mutex.h"
+#include "private/svn_thread_pool.h"
+
+/* Handy macro to check APR function results and turning them into
+ * svn_error_t upon failure. */
+#define WRAP_APR_ERR(x,msg)                     \
+  {                                             \
+    apr_status_t status_ = (x);                 \
+    if (status_)                                \
+      return svn_error_wrap_apr(status_, msg);  \
+  }
+
+/* Number of microseconds that an unused thread remains in the pool before
+ * being terminated.  Callers tend to submit tasks in bursts, so keep the
+ * threads around for a while. */
+#define THREADPOOL_THREAD_IDLE_LIMIT 1000000
+
+/* Maximum number of threads in THREAD_POOL, i.e. number of tasks that can
+ * be executed concurrently throughout the process.  Groups requesting a
+ * higher concurrency will simply get their tasks queued. */
+#define MAX_THREADS 64
+
+
+/* A simple SVN-wrapper around the apr_thread_cond_* API */
+#if APR_HAS_THREADS
+typedef apr_thread_cond_t thread_cond_t;
+#else
+typedef int thread_cond_t;
+#endif
+
+static svn_error_t *
+thread_cond_create(thread_cond_t **cond,
+                   apr_pool_t *result_pool)
+{
+#if APR_HAS_THREADS
+
+  WRAP_APR_ERR(apr_thread_cond_create(cond, result_pool),
+               _("Can't create condition variable"));
+
+#else
+
+  *cond = apr_pcalloc(result_pool, sizeof(**cond));
+
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+thread_cond_broadcast(thread_cond_t *cond)
+{
+#if APR_HAS_THREADS
+
+  WRAP_APR_ERR(apr_thread_cond_broadcast(cond),
+               _("Can't broadcast condition variable"));
+
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+thread_cond_wait(thread_cond_t *cond,
+                 svn_mutex__t *mutex)
+{
+#if APR_HAS_THREADS
+
+  WRAP_APR_ERR(apr_thread_cond_wait(cond, svn_mutex__get(mutex)),
+               _("Can't wait on condition variable"));
+
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+
+struct svn_thread_pool__group_t
+{
+  /* Maximum number of tasks in flight.  At least 1. */
+  int concurrency;
+
+  /* Number of tasks submitted but not yet completed. */
+  int in_flight;
+
+  /* Combined errors of completed tasks that have no handle. */
+  svn_error_t *errors;
+
+  /* Synchronization objects.  Guard all of the above and the DONE and
+   * ERR members of all tasks in this group. */
+  svn_mutex__t *mutex;
+  thread_cond_t *cond;
+};
+
+struct svn_thread_pool__task_t
+{
+  /* The group that this task belongs to. */
+  svn_thread_pool__group_t *group;
+
+  /* The function to execute and its parameter. */
+  svn_thread_pool__func_t func;
+  void *baton;
+
+  /* Root pool that this structure is allocated in and that gets passed
+   * to FUNC.  Being a root pool, it may be used by the worker thread
+   * without further synchronization. */
+  apr_pool_t *pool;
+
+  /* Whether the submitter holds a handle to this task. */
+  svn_boolean_t has_handle;
+
+  /* Set once FUNC returned. */
+  svn_boolean_t done;
+
+  /* FUNC's result, if HAS_HANDLE is set and not collected yet. */
+  svn_error_t *err;
+};
+
+#if APR_HAS_THREADS
+
+/* The process-wide thread pool. */
+static apr_thread_pool_t *thread_pool = NULL;
+
+#endif
+
+/* Keep track on whether we already created the THREAD_POOL . */
+static svn_atomic_t thread_pool_initialized = FALSE;
+
+#if APR_HAS_THREADS
+
+/* Destructor function that implicitly cleans up any running threads
+   in the THREAD_POOL *once*.
+
+   Must be run as a pre-cleanup hook.
+ */
+static apr_status_t
+thread_pool_pre_cleanup(void *data)
+{
+  apr_thread_pool_t *tp = thread_pool;
+  if (!thread_pool)
+    return APR_SUCCESS;
+
+  thread_pool = NULL;
+  thread_pool_initialized = FALSE;
+
+  return apr_thread_pool_destroy(tp);
+}
+
+#endif
+
+/* Implements svn_atomic__err_init_func_t. */
+static svn_error_t *
+create_thread_pool(void *baton,
+                   apr_pool_t *scratch_pool)
+{
+#if APR_HAS_THREADS
+  /* The thread-pool must be allocated from a thread-safe pool that lives
+     as long as the process does. */
+  apr_pool_t *pool = svn_pool_create(NULL);
+
+  WRAP_APR_ERR(apr_thread_pool_create(&thread_pool, 0, MAX_THREADS, pool),
+               _("Can't create worker thread pool"));
+
+  /* Work around an APR bug:  The cleanup must happen in the pre-cleanup
+     hook instead of the normal cleanup hook.  Otherwise, the sub-pools
+     containing the thread objects would already be invalid. */
+  apr_pool_pre_cleanup_register(pool, NULL, thread_pool_pre_cleanup);
+
+  /* let idle threads linger for a while in case more tasks are coming */
+  apr_thread_pool_idle_wait_set(thread_pool, THREADPOOL_THREAD_IDLE_LIMIT);
+
+  /* don't queue tasks unless we reached the worker thread limit */
+  apr_thread_pool_threshold_set(thread_pool, 0);
+
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_thread_pool__group_create(svn_thread_pool__group_t **group_p,
+                              int concurrency,
+                              apr_pool_t *result_pool)
+{
+  svn_thread_pool__group_t *group = apr_pcalloc(result_pool, sizeof(*group));
+
+  group->concurrency = MAX(1, concurrency);
+  group->in_flight = 0;
+  group->errors = SVN_NO_ERROR;
+
+  SVN_ERR(svn_mutex__init(&group->mutex, TRUE, result_pool));
+  SVN_ERR(thread_cond_create(&group->cond, result_pool));
+
+  if (group->concurrency > 1)
+    SVN_ERR(svn_atomic__init_once(&thread_pool_initialized,
+                                  create_thread_pool, NULL, result_pool));
+
+  *group_p = group;
+
+  return SVN_NO_ERROR;
+}
+
+svn_boolean_t
+svn_thread_pool__group_is_parallel(svn_thread_pool__group_t *group)
+{
+#if APR_HAS_THREADS
+  return group->concurrency > 1 && thread_pool != NULL;
+#else
+  return FALSE;
+#endif
+}
+
+/* Record ERR as the result of TASK, mark it as completed and wake up
+ * everybody waiting for the TASK's group.  Release the TASK, if there is
+ * no handle to it. */
+static svn_error_t *
+complete_task(svn_thread_pool__task_t *task,
+              svn_error_t *err)
+{
+  svn_thread_pool__group_t *group = task->group;
+  apr_pool_t *to_release = NULL;
+
+  SVN_ERR(svn_mutex__lock(group->mutex));
+
+  if (task->has_handle)
+    {
+      task->err = err;
+    }
+  else
+    {
+      group->errors = svn_error_compose_create(group->errors, err);
+      to_release = task->pool;
+    }
+
+  task->done = TRUE;
+  group->in_flight--;
+
+  err = thread_cond_broadcast(group->cond);
+  SVN_ERR(svn_mutex__unlock(group->mutex, err));
+
+  /* Nobody but us may access TASK anymore. */
+  if (to_release)
+    svn_pool_destroy(to_release);
+
+  return SVN_NO_ERROR;
+}
+
+#if APR_HAS_THREADS
+
+/* Thread-pool task:  Execute the svn_thread_pool__task_t given by DATA. */
+static void * APR_THREAD_FUNC
+worker_func(apr_thread_t *tid,
+            void *data)
+{
+  svn_thread_pool__task_t *task = data;
+  svn_error_t *err = task->func(task->baton, task->pool);
+
+  /* If this fails, there is nobody we could report it to.  The waiting
+     threads will probably deadlock anyway. */
+  svn_error_clear(complete_task(task, err));
+
+  return NULL;
+}
+
+#endif
+
+svn_error_t *
+svn_thread_pool__run(svn_thread_pool__task_t **task_p,
+                     svn_thread_pool__group_t *group,
+                     svn_thread_pool__func_t func,
+                     void *baton)
+{
+  svn_thread_pool__task_t *task;
+  apr_pool_t *pool;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  /* Throttle the submitter until there is a free slot in GROUP.
+   * This loop implicitly handles spurious wake-ups. */
+  SVN_ERR(svn_mutex__lock(group->mutex));
+  while (!err && group->in_flight >= group->concurrency)
+    err = thread_cond_wait(group->cond, group->mutex);
+
+  if (!err)
+    group->in_flight++;
+
+  SVN_ERR(svn_mutex__unlock(group->mutex, err));
+
+  /* Each task must use a separate, thread-safe pool.  A root pool
+   * achieves exactly that. */
+  pool = svn_pool_create(NULL);
+  task = apr_pcalloc(pool, sizeof(*task));
+  task->group = group;
+  task->func = func;
+  task->baton = baton;
+  task->pool = pool;
+  task->has_handle = task_p != NULL;
+  task->done = FALSE;
+  task->err = SVN_NO_ERROR;
+
+  /* TASK may be gone once it has been started and has no handle. */
+  if (task_p)
+    *task_p = task;
+
+#if APR_HAS_THREADS
+  if (svn_thread_pool__group_is_parallel(group))
+    {
+      apr_status_t status = apr_thread_pool_push(thread_pool, worker_func,
+                                                 task, 0, NULL);
+      if (status == APR_SUCCESS)
+        return SVN_NO_ERROR;
+
+      /* Could not schedule the task.  Simply run it in this thread. */
+    }
+#endif
+
+  return svn_error_trace(complete_task(task, func(baton, pool)));
+}
+
+svn_error_t *
+svn_thread_pool__task_done(svn_boolean_t *done,
+                           svn_thread_pool__task_t *task)
+{
+  svn_thread_pool__group_t *group = task->group;
+
+  SVN_ERR(svn_mutex__lock(group->mutex));
+  *done = task->done;
+  SVN_ERR(svn_mutex__unlock(group->mutex, SVN_NO_ERROR));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_thread_pool__task_wait(svn_thread_pool__task_t *task)
+{
+  svn_thread_pool__group_t *group = task->group;
+  svn_error_t *err = SVN_NO_ERROR;
+  svn_error_t *result;
+
+  /* This loop implicitly handles spurious wake-ups. */
+  SVN_ERR(svn_mutex__lock(group->mutex));
+  while (!err && !task->done)
+    err = thread_cond_wait(group->cond, group->mutex);
+
+  result = err ? SVN_NO_ERROR : task->err;
+  if (!err)
+    task->err = SVN_NO_ERROR;
+
+  SVN_ERR(svn_mutex__unlock(group->mutex, err));
+
+  return svn_error_trace(result);
+}
+
+void
+svn_thread_pool__task_destroy(svn_thread_pool__task_t *task)
+{
+  svn_error_clear(svn_thread_pool__task_wait(task));
+  svn_pool_destroy(task->pool);
+}
+
+svn_error_t *
+svn_thread_pool__group_wait(svn_thread_pool__group_t *group)
+{
+  svn_error_t *err = SVN_NO_ERROR;
+  svn_error_t *result;
+
+  /* This loop implicitly handles spurious wake-ups. */
+  SVN_ERR(svn_mutex__lock(group->mutex));
+  while (!err && group->in_flight > 0)
+    err = thread_cond_wait(group->cond, group->mutex);
+
+  result = err ? SVN_NO_ERROR : group->errors;
+  if (!err)
+    group->errors = SVN_NO_ERROR;
+
+  SVN_ERR(svn_mutex__unlock(group->mutex, err));
+
+  return svn_error_trace(result);
+}
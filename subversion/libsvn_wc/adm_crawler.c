@@ -39,6 +39,7 @@
 #include "svn_dirent_uri.h"
 #include "svn_path.h"
 
+#include "private/svn_subr_private.h"
 #include "private/svn_wc_private.h"
 
 #include "wc.h"
@@ -1227,6 +1228,195 @@ svn_wc__internal_transmit_text_deltas(svn_stream_t *tempstream,
                                 scratch_pool));
 }
 
+struct svn_wc__text_delta_t
+{
+  const char *local_abspath;
+
+  /* Delta source and target, as in svn_wc__internal_transmit_text_deltas().
+     LOCAL_STREAM also writes the new pristine text. */
+  svn_stream_t *base_stream;
+  svn_stream_t *local_stream;
+
+  /* Checksums; the calculated ones become valid when the respective
+     stream got closed. */
+  const svn_checksum_t *expected_md5_checksum;
+  svn_checksum_t *verify_checksum;
+  svn_checksum_t *local_md5_checksum;
+  svn_checksum_t *local_sha1_checksum;
+
+  svn_wc__db_install_data_t *install_data;
+
+  /* The delta in svndiff format, produced by svn_wc__text_delta_compute(). */
+  svn_spillbuf_t *svndiff;
+  svn_boolean_t computed;
+};
+
+/* Keep deltas up to this size in memory, spool larger ones to disk. */
+#define TEXT_DELTA_SPILL_SIZE (1024 * 1024)
+
+svn_error_t *
+svn_wc__text_delta_prepare(svn_wc__text_delta_t **delta_p,
+                           svn_wc_context_t *wc_ctx,
+                           const char *local_abspath,
+                           svn_boolean_t fulltext,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool)
+{
+  svn_wc__db_t *db = wc_ctx->db;
+  svn_wc__text_delta_t *delta = apr_pcalloc(result_pool, sizeof(*delta));
+  svn_stream_t *new_pristine_stream;
+
+  delta->local_abspath = apr_pstrdup(result_pool, local_abspath);
+
+  SVN_ERR(svn_wc__internal_translated_stream(&delta->local_stream, db,
+                                             local_abspath, local_abspath,
+                                             SVN_WC_TRANSLATE_TO_NF,
+                                             result_pool, scratch_pool));
+
+  SVN_ERR(svn_wc__db_pristine_prepare_install(&new_pristine_stream,
+                                              &delta->install_data,
+                                              &delta->local_sha1_checksum,
+                                              NULL, db, local_abspath,
+                                              result_pool, scratch_pool));
+  delta->local_stream = copying_stream(delta->local_stream,
+                                       new_pristine_stream, result_pool);
+
+  if (! fulltext)
+    SVN_ERR(read_and_checksum_pristine_text(&delta->base_stream,
+                                            &delta->expected_md5_checksum,
+                                            &delta->verify_checksum,
+                                            db, local_abspath,
+                                            result_pool, scratch_pool));
+  else
+    delta->base_stream = svn_stream_empty(result_pool);
+
+  delta->local_stream = svn_stream_checksummed2(delta->local_stream,
+                                                &delta->local_md5_checksum,
+                                                NULL, svn_checksum_md5, TRUE,
+                                                result_pool);
+
+  delta->svndiff = svn_spillbuf__create(SVN__STREAM_CHUNK_SIZE,
+                                        TEXT_DELTA_SPILL_SIZE, result_pool);
+
+  *delta_p = delta;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__text_delta_compute(void *baton,
+                           apr_pool_t *scratch_pool)
+{
+  svn_wc__text_delta_t *delta = baton;
+  svn_txdelta_stream_t *txdelta_stream;
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+  svn_error_t *err;
+  svn_error_t *err2;
+
+  /* Spool uncompressed svndiff.  The RA layer decides on the format and
+     compression of what actually goes over the wire. */
+  svn_txdelta2(&txdelta_stream,
+               svn_stream_disown(delta->base_stream, scratch_pool),
+               svn_stream_disown(delta->local_stream, scratch_pool),
+               FALSE, scratch_pool);
+  svn_txdelta_to_svndiff3(&handler, &handler_baton,
+                          svn_stream__from_spillbuf(delta->svndiff,
+                                                    scratch_pool),
+                          0, SVN_DELTA_COMPRESSION_LEVEL_NONE,
+                          scratch_pool);
+  err = svn_txdelta_send_txstream(txdelta_stream, handler, handler_baton,
+                                  scratch_pool);
+
+  /* Close the two streams to force writing the digests.  The checksums
+     live in DELTA's pool, as do the streams. */
+  err2 = svn_stream_close(delta->base_stream);
+  if (err2)
+    {
+      delta->verify_checksum = NULL;
+      err = svn_error_compose_create(err, err2);
+    }
+
+  err = svn_error_compose_create(err, svn_stream_close(delta->local_stream));
+
+  /* See svn_wc__internal_transmit_text_deltas(). */
+  if (delta->expected_md5_checksum && delta->verify_checksum
+      && !svn_checksum_match(delta->expected_md5_checksum,
+                             delta->verify_checksum))
+    {
+      err = svn_error_compose_create(
+              svn_checksum_mismatch_err(delta->expected_md5_checksum,
+                            delta->verify_checksum, scratch_pool,
+                            _("Checksum mismatch for text base of '%s'"),
+                            svn_dirent_local_style(delta->local_abspath,
+                                                   scratch_pool)),
+              err);
+
+      return svn_error_create(SVN_ERR_WC_CORRUPT_TEXT_BASE, err, NULL);
+    }
+
+  SVN_ERR_W(err, apr_psprintf(scratch_pool,
+                              _("While preparing '%s' for commit"),
+                              svn_dirent_local_style(delta->local_abspath,
+                                                     scratch_pool)));
+
+  delta->computed = TRUE;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__text_delta_transmit(const svn_checksum_t **new_text_base_md5_checksum,
+                            const svn_checksum_t **new_text_base_sha1_checksum,
+                            svn_wc__text_delta_t *delta,
+                            const svn_delta_editor_t *editor,
+                            void *file_baton,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool)
+{
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+  const char *base_digest_hex = NULL;
+  svn_stream_t *parser;
+
+  SVN_ERR_ASSERT(delta->computed);
+
+  if (delta->expected_md5_checksum)
+    base_digest_hex = svn_checksum_to_cstring_display(
+                                            delta->expected_md5_checksum,
+                                            scratch_pool);
+
+  /* Replay the spooled windows into the editor. */
+  SVN_ERR(editor->apply_textdelta(file_baton, base_digest_hex, scratch_pool,
+                                  &handler, &handler_baton));
+  parser = svn_txdelta_parse_svndiff(handler, handler_baton, TRUE,
+                                     scratch_pool);
+  SVN_ERR_W(svn_stream_copy3(svn_stream__from_spillbuf(delta->svndiff,
+                                                       scratch_pool),
+                             parser, NULL, NULL, scratch_pool),
+            apr_psprintf(scratch_pool, _("While preparing '%s' for commit"),
+                         svn_dirent_local_style(delta->local_abspath,
+                                                scratch_pool)));
+
+  if (new_text_base_md5_checksum)
+    *new_text_base_md5_checksum = svn_checksum_dup(delta->local_md5_checksum,
+                                                   result_pool);
+
+  SVN_ERR(svn_wc__db_pristine_install(delta->install_data,
+                                      delta->local_sha1_checksum,
+                                      delta->local_md5_checksum,
+                                      scratch_pool));
+  if (new_text_base_sha1_checksum)
+    *new_text_base_sha1_checksum = svn_checksum_dup(delta->local_sha1_checksum,
+                                                    result_pool);
+
+  /* Close the file baton, and get outta here. */
+  return svn_error_trace(
+             editor->close_file(file_baton,
+                                svn_checksum_to_cstring(
+                                            delta->local_md5_checksum,
+                                            scratch_pool),
+                                scratch_pool));
+}
+
 svn_error_t *
 svn_wc_transmit_text_deltas3(const svn_checksum_t **new_text_base_md5_checksum,
                              const svn_checksum_t **new_text_base_sha1_checksum,
@@ -114,3 +114,74 @@ svn_wc_context_destroy(svn_wc_context_t *wc_ctx)
 
   return SVN_NO_ERROR;
 }
+
+
+struct svn_wc_session_t
+{
+  svn_wc__db_t *db;
+  svn_config_t *config;
+};
+
+/* APR pool cleanup handler for svn_wc_session_t. */
+static apr_status_t
+close_session_apr(void *data)
+{
+  svn_wc_session_t *session = data;
+  svn_error_t *err = svn_wc__db_close(session->db);
+
+  if (err)
+    {
+      int result = err->apr_err;
+      svn_error_clear(err);
+      return result;
+    }
+
+  return APR_SUCCESS;
+}
+
+
+svn_error_t *
+svn_wc_session_create(svn_wc_session_t **session,
+                      const svn_config_t *config,
+                      apr_pool_t *result_pool,
+                      apr_pool_t *scratch_pool)
+{
+  svn_wc_session_t *s = apr_pcalloc(result_pool, sizeof(*s));
+
+  s->config = (svn_config_t *)config;
+  SVN_ERR(svn_wc__db_open(&s->db, s->config, FALSE, TRUE, result_pool,
+                          scratch_pool));
+
+  /* The wcroots of this DB will be used across many operations. */
+  svn_wc__db_start_epoch(s->db);
+
+  apr_pool_cleanup_register(result_pool, s, close_session_apr,
+                            apr_pool_cleanup_null);
+
+  *session = s;
+
+  return SVN_NO_ERROR;
+}
+
+
+svn_error_t *
+svn_wc_session_context_create(svn_wc_context_t **wc_ctx,
+                              svn_wc_session_t *session,
+                              apr_pool_t *result_pool)
+{
+  /* Anything might have happened to the working copies since the
+     previous context was created. */
+  svn_wc__db_start_epoch(session->db);
+
+  return svn_error_trace(svn_wc__context_create_with_db(wc_ctx,
+                                                        session->config,
+                                                        session->db,
+                                                        result_pool));
+}
+
+
+int
+svn_wc__get_worker_threads(svn_wc_context_t *wc_ctx)
+{
+  return svn_wc__db_get_worker_threads(wc_ctx->db);
+}
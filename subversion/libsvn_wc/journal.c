@@ -0,0 +1,840 @@
+/*
+ * journal.c:  journal of working copy directories changed on disk
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <string.h>
+
+#include <apr_pools.h>
+#include <apr_hash.h>
+#include <apr_time.h>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+#include "svn_dirent_uri.h"
+#include "svn_hash.h"
+#include "svn_io.h"
+#include "svn_path.h"
+#include "svn_pools.h"
+#include "svn_sorts.h"
+#include "svn_wc.h"
+
+#include "wc.h"
+#include "adm_files.h"
+#include "journal.h"
+
+#include "private/svn_wc_private.h"
+
+#include "svn_private_config.h"
+
+
+/* First line of every journal file. */
+#define JOURNAL_HEADER "SVN-WC-JOURNAL 1"
+
+/* Basename prefix of the files that readers create in the administrative
+   area to make sure the journal has caught up.  Each reader appends a
+   UUID, so that it cannot mistake the sync line of an earlier reader for
+   its own. */
+#define SYNC_PREFIX "journal-sync"
+
+/* Replace the journal with a compacted copy after this many sync lines
+   have been appended to it. */
+#define MAX_SYNC_LINES 100
+
+/* Maximum time in microseconds that a reader waits for the watcher to
+   catch up before falling back to a full scan. */
+#define SYNC_TIMEOUT (5 * APR_USEC_PER_SEC)
+
+/* The basename of the working copy DB in the administrative area. */
+#define SDB_FILE "wc.db"
+
+struct svn_wc__journal_t
+{
+  /* The working copy root that the journal belongs to. */
+  const char *root_abspath;
+
+  /* The directories that may not match the working copy DB.  Maps
+     const char * relpaths below ROOT_ABSPATH to an arbitrary value. */
+  apr_hash_t *dirty;
+};
+
+/* State of a reader processing a journal file while it is being written. */
+typedef struct journal_reader_t
+{
+  /* The journal file, open for reading. */
+  apr_file_t *file;
+
+  /* The last line read, if it is not complete yet. */
+  svn_stringbuf_t *partial;
+
+  /* Number of complete lines processed so far. */
+  apr_int64_t lines;
+
+  /* Offset of the first byte in PARTIAL within FILE. */
+  apr_off_t offset;
+
+  /* The basename of our sync file and whether the watcher has seen it.
+     Only sync lines starting at or after SYNC_OFFSET count. */
+  const char *sync_name;
+  apr_off_t sync_offset;
+  svn_boolean_t synced;
+
+  /* Whether the watcher has replaced FILE with a new journal. */
+  svn_boolean_t rotated;
+
+  /* Whether the journal lists all initially dirty directories. */
+  svn_boolean_t primed;
+
+  /* Whether the journal is malformed or has been declared useless. */
+  svn_boolean_t invalid;
+
+  /* The dirty directories found so far, allocated in POOL. */
+  apr_hash_t *dirty;
+  apr_pool_t *pool;
+} journal_reader_t;
+
+/* Process the complete journal LINE, found at OFFSET, for READER. */
+static void
+process_line(journal_reader_t *reader,
+             const char *line,
+             apr_off_t offset)
+{
+  if (reader->lines++ == 0)
+    {
+      if (strcmp(line, JOURNAL_HEADER) != 0)
+        reader->invalid = TRUE;
+    }
+  else if (strncmp(line, "dirty ", 6) == 0)
+    {
+      const char *relpath = line + 6;
+
+      if (!svn_hash_gets(reader->dirty, relpath))
+        svn_hash_sets(reader->dirty, apr_pstrdup(reader->pool, relpath), "");
+    }
+  else if (strncmp(line, "sync ", 5) == 0)
+    {
+      if (offset >= reader->sync_offset
+          && strcmp(line + 5, reader->sync_name) == 0)
+        reader->synced = TRUE;
+    }
+  else if (strcmp(line, "primed") == 0)
+    {
+      reader->primed = TRUE;
+    }
+  else if (strcmp(line, "rotated") == 0)
+    {
+      reader->rotated = TRUE;
+    }
+  else
+    {
+      /* "overflow" or anything we don't understand. */
+      reader->invalid = TRUE;
+    }
+}
+
+/* Read and process all lines that have been appended to READER's journal
+   since the last call.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+read_new_lines(journal_reader_t *reader,
+               apr_pool_t *scratch_pool)
+{
+  char buffer[4096];
+  svn_boolean_t eof = FALSE;
+
+  while (!eof)
+    {
+      apr_size_t len;
+      const char *line, *end;
+
+      SVN_ERR(svn_io_file_read_full2(reader->file, buffer, sizeof(buffer),
+                                     &len, &eof, scratch_pool));
+      svn_stringbuf_appendbytes(reader->partial, buffer, len);
+
+      line = reader->partial->data;
+      while ((end = memchr(line, '\n',
+                           reader->partial->len - (line - reader->partial->data))))
+        {
+          reader->partial->data[end - reader->partial->data] = '\0';
+          process_line(reader, line,
+                       reader->offset + (line - reader->partial->data));
+          line = end + 1;
+        }
+
+      reader->offset += line - reader->partial->data;
+      svn_stringbuf_remove(reader->partial, 0, line - reader->partial->data);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* The watcher replaced the journal that READER was reading.  Continue
+   with the new one at JOURNAL_ABSPATH from its beginning.  Set
+   READER->FILE to NULL if there is no journal anymore.  Use SCRATCH_POOL
+   for temporary allocations. */
+static svn_error_t *
+reopen_journal(journal_reader_t *reader,
+               const char *journal_abspath,
+               apr_pool_t *scratch_pool)
+{
+  svn_error_t *err;
+
+  SVN_ERR(svn_io_file_close(reader->file, scratch_pool));
+  err = svn_io_file_open(&reader->file, journal_abspath, APR_READ,
+                         APR_OS_DEFAULT, scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      reader->file = NULL;
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  /* Our sync file cannot have been reported before the new journal was
+     created, so every sync line in it is recent enough. */
+  svn_stringbuf_setempty(reader->partial);
+  reader->lines = 0;
+  reader->offset = 0;
+  reader->sync_offset = 0;
+  reader->rotated = FALSE;
+  reader->primed = FALSE;
+  reader->dirty = apr_hash_make(reader->pool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__journal_open(svn_wc__journal_t **journal,
+                     const char *wcroot_abspath,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
+{
+  const char *adm_abspath = svn_wc__adm_child(wcroot_abspath, NULL,
+                                              scratch_pool);
+  const char *journal_abspath = svn_dirent_join(adm_abspath,
+                                                SVN_WC__ADM_JOURNAL,
+                                                scratch_pool);
+  const char *sync_abspath;
+  apr_file_t *sync_file;
+  svn_filesize_t journal_size;
+  journal_reader_t reader = { 0 };
+  apr_interval_time_t delay = 1000;
+  apr_time_t start;
+  svn_error_t *err;
+
+  *journal = NULL;
+
+  err = svn_io_file_open(&reader.file, journal_abspath, APR_READ,
+                         APR_OS_DEFAULT, scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  /* The watcher holds an exclusive lock on the journal while it is
+     running.  Without it, the journal may miss changes. */
+  err = svn_io_lock_open_file(reader.file, FALSE, TRUE, scratch_pool);
+  if (!err)
+    {
+      SVN_ERR(svn_io_unlock_open_file(reader.file, scratch_pool));
+      return svn_error_trace(svn_io_file_close(reader.file, scratch_pool));
+    }
+  else if (!APR_STATUS_IS_EAGAIN(err->apr_err)
+           && !APR_STATUS_IS_EACCES(err->apr_err))
+    {
+      /* Locking is not supported here.  Don't trust the journal. */
+      svn_error_clear(err);
+      return svn_error_trace(svn_io_file_close(reader.file, scratch_pool));
+    }
+  svn_error_clear(err);
+
+  /* Sync lines written before this point belong to other readers. */
+  SVN_ERR(svn_io_file_size_get(&journal_size, reader.file, scratch_pool));
+
+  /* Events reach the watcher asynchronously.  Create a file that it will
+     report once all earlier changes have been written to the journal. */
+  err = svn_io_open_uniquely_named(&sync_file, &sync_abspath, adm_abspath,
+                                   apr_pstrcat(scratch_pool, SYNC_PREFIX, "-",
+                                               svn_uuid_generate(scratch_pool),
+                                               SVN_VA_NULL),
+                                   ".tmp", svn_io_file_del_none,
+                                   scratch_pool, scratch_pool);
+  if (err)
+    {
+      /* E.g. a read-only working copy.  Just do without the journal. */
+      svn_error_clear(err);
+      return svn_error_trace(svn_io_file_close(reader.file, scratch_pool));
+    }
+  SVN_ERR(svn_io_file_close(sync_file, scratch_pool));
+
+  reader.partial = svn_stringbuf_create_empty(scratch_pool);
+  reader.sync_name = svn_dirent_basename(sync_abspath, scratch_pool);
+  reader.sync_offset = (apr_off_t)journal_size;
+  reader.dirty = apr_hash_make(result_pool);
+  reader.pool = result_pool;
+
+  start = apr_time_now();
+  while (TRUE)
+    {
+      err = read_new_lines(&reader, scratch_pool);
+      if (err || reader.synced || reader.invalid
+          || apr_time_now() - start > SYNC_TIMEOUT)
+        break;
+
+      if (reader.rotated)
+        {
+          err = reopen_journal(&reader, journal_abspath, scratch_pool);
+          if (err || !reader.file)
+            break;
+
+          continue;
+        }
+
+      apr_sleep(delay);
+      delay = MIN(2 * delay, 50000);
+    }
+
+  err = svn_error_compose_create(err, svn_io_remove_file2(sync_abspath, TRUE,
+                                                          scratch_pool));
+  if (reader.file)
+    err = svn_error_compose_create(err, svn_io_file_close(reader.file,
+                                                          scratch_pool));
+  SVN_ERR(err);
+
+  if (reader.file && reader.synced && reader.primed && !reader.invalid)
+    {
+      *journal = apr_pcalloc(result_pool, sizeof(**journal));
+      (*journal)->root_abspath = apr_pstrdup(result_pool, wcroot_abspath);
+      (*journal)->dirty = reader.dirty;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_boolean_t
+svn_wc__journal_dir_is_clean(const svn_wc__journal_t *journal,
+                             const char *local_abspath)
+{
+  const char *relpath = svn_dirent_skip_ancestor(journal->root_abspath,
+                                                 local_abspath);
+
+  return relpath && !svn_hash_gets(journal->dirty, relpath);
+}
+
+
+#if defined(__linux__)
+
+/* Events that make a watched directory dirty. */
+#define WATCH_MASK (IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB \
+                    | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF \
+                    | IN_MOVE_SELF | IN_ONLYDIR | IN_DONT_FOLLOW)
+
+/* State of a running watcher. */
+typedef struct watcher_t
+{
+  /* The working copy root being watched, its administrative area and the
+     journal in there. */
+  const char *root_abspath;
+  const char *adm_abspath;
+  const char *journal_abspath;
+
+  /* The inotify instance. */
+  int fd;
+
+  /* The watch descriptor of ADM_ABSPATH, which only reports sync files
+     and changes of the DB. */
+  int adm_wd;
+
+  /* Whether the DB changed since the journal was last primed.  Changes
+     like 'svn rm --keep-local' or committing one make a directory differ
+     from the DB without touching it, so the journal gets primed again
+     before the next reader is told that it is up to date. */
+  svn_boolean_t db_changed;
+
+  /* What to prime the journal with. */
+  svn_wc_context_t *wc_ctx;
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+
+  /* Maps int watch descriptors to const char * relpaths. */
+  apr_hash_t *watches;
+
+  /* All directories written to the journal as dirty.  Maps const char *
+     relpaths to an arbitrary value. */
+  apr_hash_t *dirty;
+
+  /* Journal lines not written yet. */
+  svn_stringbuf_t *pending;
+
+  /* The journal file, open for writing and exclusively locked, and the
+     pool it lives in. */
+  apr_file_t *journal;
+  apr_pool_t *journal_pool;
+
+  /* Number of sync lines written to JOURNAL. */
+  int syncs;
+
+  /* Pool for all of the above. */
+  apr_pool_t *pool;
+} watcher_t;
+
+/* Append a line stating that directory RELPATH is dirty to W's pending
+   output, unless we did so before. */
+static void
+mark_dirty(watcher_t *w,
+           const char *relpath)
+{
+  if (svn_hash_gets(w->dirty, relpath))
+    return;
+
+  relpath = apr_pstrdup(w->pool, relpath);
+  svn_hash_sets(w->dirty, relpath, "");
+
+  svn_stringbuf_appendcstr(w->pending, "dirty ");
+  svn_stringbuf_appendcstr(w->pending, relpath);
+  svn_stringbuf_appendbyte(w->pending, '\n');
+}
+
+/* Write W's pending output to the journal.  Use SCRATCH_POOL for temporary
+   allocations. */
+static svn_error_t *
+flush_journal(watcher_t *w,
+              apr_pool_t *scratch_pool)
+{
+  if (svn_stringbuf_isempty(w->pending))
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_io_file_write_full(w->journal, w->pending->data,
+                                 w->pending->len, NULL, scratch_pool));
+  svn_stringbuf_setempty(w->pending);
+
+  return SVN_NO_ERROR;
+}
+
+/* Create a new journal file in W's administrative area under a temporary
+   name, lock it exclusively and set *FILE and *TEMP_ABSPATH to it.
+   Allocate *FILE in RESULT_POOL and use SCRATCH_POOL for temporary
+   allocations. */
+static svn_error_t *
+create_journal(apr_file_t **file,
+               const char **temp_abspath,
+               watcher_t *w,
+               apr_pool_t *result_pool,
+               apr_pool_t *scratch_pool)
+{
+  SVN_ERR(svn_io_open_uniquely_named(file, temp_abspath, w->adm_abspath,
+                                     SVN_WC__ADM_JOURNAL, ".tmp",
+                                     svn_io_file_del_none,
+                                     result_pool, scratch_pool));
+  SVN_ERR(svn_io_lock_open_file(*file, TRUE, TRUE, result_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Replace W's journal with one that only lists the dirty directories,
+   dropping all sync lines that readers have consumed by now.  Readers
+   still processing the old journal will find a "rotated" line at its
+   end and continue with the new one.  Use SCRATCH_POOL for temporary
+   allocations. */
+static svn_error_t *
+rotate_journal(watcher_t *w,
+               apr_pool_t *scratch_pool)
+{
+  apr_pool_t *journal_pool = svn_pool_create(w->pool);
+  apr_file_t *journal;
+  const char *temp_abspath;
+  svn_stringbuf_t *contents;
+  apr_hash_index_t *hi;
+
+  SVN_ERR(create_journal(&journal, &temp_abspath, w, journal_pool,
+                         scratch_pool));
+
+  contents = svn_stringbuf_create(JOURNAL_HEADER "\n", scratch_pool);
+  for (hi = apr_hash_first(scratch_pool, w->dirty); hi; hi = apr_hash_next(hi))
+    {
+      svn_stringbuf_appendcstr(contents, "dirty ");
+      svn_stringbuf_appendcstr(contents, apr_hash_this_key(hi));
+      svn_stringbuf_appendbyte(contents, '\n');
+    }
+  svn_stringbuf_appendcstr(contents, "primed\n");
+
+  SVN_ERR(svn_io_file_write_full(journal, contents->data, contents->len,
+                                 NULL, scratch_pool));
+  SVN_ERR(svn_io_file_rename2(temp_abspath, w->journal_abspath, FALSE,
+                              scratch_pool));
+
+  /* Closing the old journal releases our lock on it. */
+  SVN_ERR(svn_io_file_write_full(w->journal, "rotated\n", 8, NULL,
+                                 scratch_pool));
+  svn_pool_destroy(w->journal_pool);
+
+  w->journal = journal;
+  w->journal_pool = journal_pool;
+  w->syncs = 0;
+
+  return SVN_NO_ERROR;
+}
+
+/* Watch directory RELPATH of W and all its sub-directories except for
+   administrative areas.  If MARK is set, mark them all as dirty.  Use
+   SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+add_watches(watcher_t *w,
+             const char *relpath,
+             svn_boolean_t mark,
+             apr_pool_t *scratch_pool)
+{
+  const char *local_abspath = svn_dirent_join(w->root_abspath, relpath,
+                                              scratch_pool);
+  const char *local_abspath_apr;
+  apr_hash_t *dirents;
+  apr_hash_index_t *hi;
+  apr_pool_t *iterpool;
+  int *wd = apr_palloc(w->pool, sizeof(*wd));
+  svn_error_t *err;
+
+  SVN_ERR(svn_path_cstring_from_utf8(&local_abspath_apr, local_abspath,
+                                     scratch_pool));
+
+  *wd = inotify_add_watch(w->fd, local_abspath_apr, WATCH_MASK);
+  if (*wd < 0)
+    {
+      /* The directory may have vanished already. */
+      if (errno == ENOENT || errno == ENOTDIR)
+        return SVN_NO_ERROR;
+
+      return svn_error_wrap_apr(apr_get_os_error(),
+                                _("Can't watch directory '%s'"),
+                                svn_dirent_local_style(local_abspath,
+                                                       scratch_pool));
+    }
+
+  apr_hash_set(w->watches, wd, sizeof(*wd), apr_pstrdup(w->pool, relpath));
+  if (mark)
+    mark_dirty(w, relpath);
+
+  /* Sub-directories created after this point will be reported as events
+     and get watched then. */
+  err = svn_io_get_dirents3(&dirents, local_abspath, TRUE,
+                            scratch_pool, scratch_pool);
+  if (err && (APR_STATUS_IS_ENOENT(err->apr_err)
+              || SVN__APR_STATUS_IS_ENOTDIR(err->apr_err)))
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  iterpool = svn_pool_create(scratch_pool);
+  for (hi = apr_hash_first(scratch_pool, dirents); hi; hi = apr_hash_next(hi))
+    {
+      const char *name = apr_hash_this_key(hi);
+      const svn_io_dirent2_t *dirent = apr_hash_this_val(hi);
+
+      svn_pool_clear(iterpool);
+
+      if (dirent->kind != svn_node_dir || dirent->special
+          || svn_wc_is_adm_dir(name, iterpool))
+        continue;
+
+      SVN_ERR(add_watches(w, svn_relpath_join(relpath, name, iterpool),
+                          mark, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_wc_status_func4_t.  Mark the directories containing
+   interesting nodes as dirty in the watcher_t BATON. */
+static svn_error_t *
+prime_status(void *baton,
+             const char *local_abspath,
+             const svn_wc_status3_t *status,
+             apr_pool_t *scratch_pool)
+{
+  watcher_t *w = baton;
+  const char *relpath = svn_dirent_skip_ancestor(w->root_abspath,
+                                                 local_abspath);
+
+  if (!relpath)
+    return SVN_NO_ERROR;
+
+  if (status->kind == svn_node_dir || status->actual_kind == svn_node_dir)
+    mark_dirty(w, relpath);
+
+  if (*relpath)
+    mark_dirty(w, svn_relpath_dirname(relpath, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Mark all directories that differ from the DB as dirty in W's journal.
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+prime_journal(watcher_t *w,
+              apr_pool_t *scratch_pool)
+{
+  w->db_changed = FALSE;
+
+  return svn_error_trace(svn_wc_walk_status(w->wc_ctx, w->root_abspath,
+                                            svn_depth_infinity,
+                                            FALSE /* get_all */,
+                                            TRUE /* no_ignore */,
+                                            FALSE /* ignore_text_mods */,
+                                            NULL, prime_status, w,
+                                            w->cancel_func, w->cancel_baton,
+                                            scratch_pool));
+}
+
+/* Update W's journal for inotify EVENT.  Use SCRATCH_POOL for temporary
+   allocations. */
+static svn_error_t *
+handle_event(watcher_t *w,
+             const struct inotify_event *event,
+             apr_pool_t *scratch_pool)
+{
+  const char *relpath;
+  const char *name = NULL;
+
+  if (event->mask & IN_Q_OVERFLOW)
+    {
+      svn_stringbuf_appendcstr(w->pending, "overflow\n");
+      SVN_ERR(flush_journal(w, scratch_pool));
+
+      return svn_error_create(SVN_ERR_WC_CORRUPT, NULL,
+                              _("Too many changes at once; the change "
+                                "journal is incomplete"));
+    }
+
+  if (event->len)
+    SVN_ERR(svn_path_cstring_to_utf8(&name, event->name, scratch_pool));
+
+  /* Readers waiting for us to catch up. */
+  if (event->wd == w->adm_wd)
+    {
+      if (name && (event->mask & IN_MODIFY) && strcmp(name, SDB_FILE) == 0)
+        w->db_changed = TRUE;
+
+      if (name && (event->mask & IN_CREATE)
+          && strncmp(name, SYNC_PREFIX, strlen(SYNC_PREFIX)) == 0)
+        {
+          if (w->db_changed)
+            SVN_ERR(prime_journal(w, scratch_pool));
+
+          svn_stringbuf_appendcstr(w->pending,
+                                   apr_pstrcat(scratch_pool, "sync ", name,
+                                               "\n", SVN_VA_NULL));
+          w->syncs++;
+        }
+      return SVN_NO_ERROR;
+    }
+
+  relpath = apr_hash_get(w->watches, &event->wd, sizeof(event->wd));
+  if (!relpath)
+    return SVN_NO_ERROR;
+
+  if (event->mask & IN_IGNORED)
+    {
+      apr_hash_set(w->watches, &event->wd, sizeof(event->wd), NULL);
+      return SVN_NO_ERROR;
+    }
+
+  mark_dirty(w, relpath);
+
+  /* Our path for a moved directory is no longer valid.  Its new location,
+     if within the working copy, will be reported as a new directory. */
+  if (event->mask & IN_MOVE_SELF)
+    {
+      apr_hash_set(w->watches, &event->wd, sizeof(event->wd), NULL);
+      inotify_rm_watch(w->fd, event->wd);
+    }
+
+  if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO))
+      && name && !svn_wc_is_adm_dir(name, scratch_pool))
+    SVN_ERR(add_watches(w, svn_relpath_join(relpath, name, scratch_pool),
+                        TRUE, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Release W's inotify instance. */
+static apr_status_t
+close_inotify(void *baton)
+{
+  watcher_t *w = baton;
+
+  close(w->fd);
+
+  return APR_SUCCESS;
+}
+
+svn_error_t *
+svn_wc__watch_changes(svn_wc_context_t *wc_ctx,
+                      const char *local_abspath,
+                      svn_cancel_func_t cancel_func,
+                      void *cancel_baton,
+                      apr_pool_t *scratch_pool)
+{
+  watcher_t *w = apr_pcalloc(scratch_pool, sizeof(*w));
+  const char *temp_abspath;
+  const char *adm_abspath_apr;
+  svn_wc__journal_t *running;
+  svn_boolean_t is_wcroot;
+  apr_pool_t *iterpool;
+  /* Properly aligned for the events that read() places in it. */
+  union
+  {
+    struct inotify_event event;
+    char data[64 * 1024];
+  } buffer;
+
+  SVN_ERR(svn_wc__db_is_wcroot(&is_wcroot, wc_ctx->db, local_abspath,
+                               scratch_pool));
+  if (!is_wcroot)
+    return svn_error_createf(SVN_ERR_WC_NOT_WORKING_COPY, NULL,
+                             _("'%s' is not the root of a working copy"),
+                             svn_dirent_local_style(local_abspath,
+                                                    scratch_pool));
+
+  w->root_abspath = local_abspath;
+  w->wc_ctx = wc_ctx;
+  w->cancel_func = cancel_func;
+  w->cancel_baton = cancel_baton;
+  w->adm_abspath = svn_wc__adm_child(local_abspath, NULL, scratch_pool);
+  w->watches = apr_hash_make(scratch_pool);
+  w->dirty = apr_hash_make(scratch_pool);
+  w->pending = svn_stringbuf_create(JOURNAL_HEADER "\n", scratch_pool);
+  w->pool = scratch_pool;
+  w->journal_abspath = svn_dirent_join(w->adm_abspath, SVN_WC__ADM_JOURNAL,
+                                       scratch_pool);
+
+  SVN_ERR(svn_wc__journal_open(&running, local_abspath,
+                               scratch_pool, scratch_pool));
+  if (running)
+    return svn_error_createf(SVN_ERR_WC_LOCKED, NULL,
+                             _("Working copy '%s' is already being watched"),
+                             svn_dirent_local_style(local_abspath,
+                                                    scratch_pool));
+
+  /* Build the new journal under a temporary name.  Our own status walk
+     must not open and close it, as that would release our lock. */
+  w->journal_pool = svn_pool_create(scratch_pool);
+  SVN_ERR(create_journal(&w->journal, &temp_abspath, w, w->journal_pool,
+                         scratch_pool));
+
+  w->fd = inotify_init1(IN_CLOEXEC);
+  if (w->fd < 0)
+    return svn_error_wrap_apr(apr_get_os_error(),
+                              _("Can't initialize inotify"));
+  apr_pool_cleanup_register(scratch_pool, w, close_inotify,
+                            apr_pool_cleanup_null);
+
+  SVN_ERR(svn_path_cstring_from_utf8(&adm_abspath_apr, w->adm_abspath,
+                                     scratch_pool));
+  w->adm_wd = inotify_add_watch(w->fd, adm_abspath_apr,
+                                IN_CREATE | IN_MODIFY | IN_ONLYDIR);
+  if (w->adm_wd < 0)
+    return svn_error_wrap_apr(apr_get_os_error(),
+                              _("Can't watch directory '%s'"),
+                              svn_dirent_local_style(w->adm_abspath,
+                                                     scratch_pool));
+
+  /* Watch first, then scan.  Anything that changes during the scan will
+     be reported by inotify. */
+  SVN_ERR(add_watches(w, "", FALSE, scratch_pool));
+  SVN_ERR(prime_journal(w, scratch_pool));
+  svn_stringbuf_appendcstr(w->pending, "primed\n");
+  SVN_ERR(flush_journal(w, scratch_pool));
+  SVN_ERR(svn_io_file_rename2(temp_abspath, w->journal_abspath, FALSE,
+                              scratch_pool));
+
+  iterpool = svn_pool_create(scratch_pool);
+  while (TRUE)
+    {
+      struct pollfd pfd;
+      ssize_t len;
+      char *p;
+      int rc;
+
+      svn_pool_clear(iterpool);
+
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      pfd.fd = w->fd;
+      pfd.events = POLLIN;
+      pfd.revents = 0;
+      rc = poll(&pfd, 1, 500);
+      if (rc < 0 && errno != EINTR)
+        return svn_error_wrap_apr(apr_get_os_error(),
+                                  _("Can't wait for inotify events"));
+      if (rc <= 0)
+        continue;
+
+      len = read(w->fd, buffer.data, sizeof(buffer.data));
+      if (len < 0)
+        {
+          if (errno == EINTR || errno == EAGAIN)
+            continue;
+
+          return svn_error_wrap_apr(apr_get_os_error(),
+                                    _("Can't read inotify events"));
+        }
+
+      for (p = buffer.data; p < buffer.data + len; )
+        {
+          const struct inotify_event *event = (const void *)p;
+
+          SVN_ERR(handle_event(w, event, iterpool));
+          p += sizeof(*event) + event->len;
+        }
+
+      SVN_ERR(flush_journal(w, iterpool));
+
+      if (w->syncs >= MAX_SYNC_LINES)
+        SVN_ERR(rotate_journal(w, iterpool));
+    }
+
+  /* Not reached. */
+}
+
+#else /* !__linux__ */
+
+svn_error_t *
+svn_wc__watch_changes(svn_wc_context_t *wc_ctx,
+                      const char *local_abspath,
+                      svn_cancel_func_t cancel_func,
+                      void *cancel_baton,
+                      apr_pool_t *scratch_pool)
+{
+  return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                          _("Watching working copies for changes is not "
+                            "supported on this platform"));
+}
+
+#endif /* __linux__ */
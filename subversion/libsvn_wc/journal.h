@@ -0,0 +1,87 @@
+/*
+ * journal.h:  journal of working copy directories changed on disk
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+/* A change journal is maintained by svn_wc__watch_changes() in the
+ * administrative area of a working copy root as long as that function
+ * runs.  It lists the directories that were not in sync with the working
+ * copy DB when watching began or after the DB changed, and all directories
+ * that got modified on disk since then.  All other directories still
+ * contain exactly what the DB says they do, i.e. the status walker does not
+ * need to read them.
+ *
+ * The file format is line based:
+ *
+ *   SVN-WC-JOURNAL 1
+ *   dirty RELPATH      directory RELPATH may differ from the DB
+ *   primed             all initially dirty directories have been listed
+ *   sync NAME          all changes before NAME got created are listed
+ *   rotated            continue with the journal that replaced this one
+ *   overflow           changes got lost, the journal is useless
+ *
+ * Every reader creates a sync file with a unique NAME.  The watcher
+ * periodically replaces the journal with a copy that lacks the sync lines
+ * of earlier readers, so that it does not grow without bounds.
+ */
+
+#ifndef SVN_LIBSVN_WC_JOURNAL_H
+#define SVN_LIBSVN_WC_JOURNAL_H
+
+#include <apr_pools.h>
+
+#include "svn_types.h"
+#include "svn_error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* The basename of the journal file in the administrative area. */
+#define SVN_WC__ADM_JOURNAL             "journal"
+
+/* An in-memory representation of a complete and current change journal. */
+typedef struct svn_wc__journal_t svn_wc__journal_t;
+
+/* Set *JOURNAL to the change journal of the working copy rooted at
+   WCROOT_ABSPATH, allocated in RESULT_POOL.  Set *JOURNAL to NULL if
+   there is no journal that can be trusted, e.g. because no watcher is
+   currently running for that working copy.
+
+   This waits for the watcher to catch up with all changes that happened
+   before this call.  Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_wc__journal_open(svn_wc__journal_t **journal,
+                     const char *wcroot_abspath,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool);
+
+/* Return TRUE if the on-disk contents of directory LOCAL_ABSPATH are
+   known to match the working copy DB according to JOURNAL. */
+svn_boolean_t
+svn_wc__journal_dir_is_clean(const svn_wc__journal_t *journal,
+                             const char *local_abspath);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_LIBSVN_WC_JOURNAL_H */
@@ -52,6 +52,8 @@ typedef struct merge_target_t
 
   const char *diff3_cmd;                    /* The diff3 command and options */
   const apr_array_header_t *merge_options;
+  int diff3_threads;                        /* Threads for the internal diff3
+                                               of large files */
 
 } merge_target_t;
 
@@ -375,8 +377,14 @@ init_conflict_markers(const char **target_marker,
     *right_marker = ">>>>>>> .new";
 }
 
+/* Internal merges of files at least this large use several threads for
+ * the diff3, if the caller allows that. */
+#define DIFF3_THREADS_MIN_SIZE (1024 * 1024)
+
 /* Do a 3-way merge of the files at paths LEFT, DETRANSLATED_TARGET,
- * and RIGHT, using diff options provided in MERGE_OPTIONS.  Store the merge
+ * and RIGHT, using diff options provided in MERGE_OPTIONS.  If
+ * DIFF3_THREADS is larger than 1 and the target is large, let up to
+ * DIFF3_THREADS threads compute the diff.  Store the merge
  * result in the file RESULT_F.
  * If there are conflicts, set *CONTAINS_CONFLICTS to true, and use
  * TARGET_LABEL, LEFT_LABEL, and RIGHT_LABEL as labels for conflict
@@ -392,6 +400,7 @@ do_text_merge(svn_boolean_t *contains_conflicts,
               const char *target_label,
               const char *left_label,
               const char *right_label,
+              int diff3_threads,
               svn_cancel_func_t cancel_func,
               void *cancel_baton,
               apr_pool_t *pool)
@@ -409,6 +418,15 @@ do_text_merge(svn_boolean_t *contains_conflicts,
     SVN_ERR(svn_diff_file_options_parse(diff3_options,
                                         merge_options, pool));
 
+  if (diff3_threads > 1)
+    {
+      apr_finfo_t finfo;
+
+      SVN_ERR(svn_io_stat(&finfo, detranslated_target, APR_FINFO_SIZE,
+                          pool));
+      if (finfo.size >= DIFF3_THREADS_MIN_SIZE)
+        diff3_options->diff3_threads = diff3_threads;
+    }
 
   init_conflict_markers(&target_marker, &left_marker, &right_marker,
                         target_label, left_label, right_label, pool);
@@ -792,68 +810,83 @@ merge_file_trivial(svn_skel_t **work_items,
 }
 
 
-/* Handle a non-trivial merge of 'text' files.  (Assume that a trivial
- * merge was not possible.)
- *
- * Set *WORK_ITEMS, *CONFLICT_SKEL and *MERGE_OUTCOME according to the
- * result -- to install the merged file, or to indicate a conflict.
- *
- * On successful merge, leave the result in a temporary file and set
- * *WORK_ITEMS to hold work items that will translate and install that
- * file into its proper form and place (unless DRY_RUN) and delete the
- * temporary file (in any case).  Set *MERGE_OUTCOME to 'merged' or
- * 'unchanged'.
- *
- * If a conflict occurs, set *MERGE_OUTCOME to 'conflicted', and (unless
- * DRY_RUN) set *WORK_ITEMS and *CONFLICT_SKEL to record the conflict
- * and copies of the pre-merge files.  See preserve_pre_merge_files()
- * for details.
+/* Create an empty file in the temporary area of the working copy of the
+ * merge target MT that the merged text of MT will be written to, and set
+ * *RESULT_TARGET to its path.  We want to use a name that reflects the
+ * original, in case this ultimately winds up in a conflict resolution
+ * editor.  Set *SPECIAL to whether MT is a special file, in which case the
+ * merged text must be compared with DETRANSLATED_TARGET_ABSPATH instead of
+ * the working file to find out whether the merge changed anything.
  *
- * On entry, all of the output pointers must be non-null and *CONFLICT_SKEL
- * must either point to an existing conflict skel or be NULL.
+ * This and finish_text_merge() do the working copy database accesses that
+ * merge_text_file() needs, so that run_text_merge() does not need any.
  */
-static svn_error_t*
-merge_text_file(svn_skel_t **work_items,
-                svn_skel_t **conflict_skel,
-                enum svn_wc_merge_outcome_t *merge_outcome,
-                const merge_target_t *mt,
-                const char *left_abspath,
-                const char *right_abspath,
-                const char *left_label,
-                const char *right_label,
-                const char *target_label,
-                svn_boolean_t dry_run,
-                const char *detranslated_target_abspath,
-                svn_cancel_func_t cancel_func,
-                void *cancel_baton,
-                apr_pool_t *result_pool,
-                apr_pool_t *scratch_pool)
+static svn_error_t *
+reserve_merge_result(const char **result_target,
+                     svn_boolean_t *special,
+                     const merge_target_t *mt,
+                     const char *detranslated_target_abspath,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
 {
-  apr_pool_t *pool = scratch_pool;  /* ### temporary rename  */
-  svn_boolean_t contains_conflicts;
-  apr_file_t *result_f;
-  const char *result_target;
-  const char *base_name;
   const char *temp_dir;
-  svn_skel_t *work_item;
 
-  *work_items = NULL;
+  SVN_ERR(svn_wc__db_temp_wcroot_tempdir(&temp_dir, mt->db, mt->wri_abspath,
+                                         scratch_pool, scratch_pool));
+  SVN_ERR(svn_io_open_uniquely_named(NULL, result_target, temp_dir,
+                                     svn_dirent_basename(mt->local_abspath,
+                                                         scratch_pool),
+                                     ".tmp", svn_io_file_del_none,
+                                     result_pool, scratch_pool));
+
+  /* If 'special', then use the detranslated form of the target file.
+     This is so we don't try to follow symlinks, but the same treatment
+     is probably also appropriate for whatever special file types we may
+     invent in the future. */
+  SVN_ERR(svn_wc__get_translate_info(NULL, NULL, NULL, special,
+                                     mt->db, mt->local_abspath,
+                                     mt->old_actual_props, TRUE,
+                                     scratch_pool, scratch_pool));
 
-  base_name = svn_dirent_basename(mt->local_abspath, scratch_pool);
+  return SVN_NO_ERROR;
+}
 
-  /* Open a second temporary file for writing; this is where diff3
-     will write the merged results.  We want to use a tempfile
-     with a name that reflects the original, in case this
-     ultimately winds up in a conflict resolution editor.  */
-  SVN_ERR(svn_wc__db_temp_wcroot_tempdir(&temp_dir, mt->db, mt->wri_abspath,
-                                         pool, pool));
-  SVN_ERR(svn_io_open_uniquely_named(&result_f, &result_target,
-                                     temp_dir, base_name, ".tmp",
-                                     svn_io_file_del_none, pool, pool));
+/* Run the external or internal 3-way merge of LEFT_ABSPATH,
+ * DETRANSLATED_TARGET_ABSPATH and RIGHT_ABSPATH for the merge target MT
+ * and write the result to the existing file RESULT_TARGET.
+ *
+ * Set *CONTAINS_CONFLICTS to whether there were conflicts.  If there
+ * were none, set *SAME to whether the result equals the file at
+ * COMPARE_ABSPATH.
+ *
+ * This does not access the working copy database, i.e. it may run on any
+ * thread.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+run_text_merge(svn_boolean_t *contains_conflicts,
+               svn_boolean_t *same,
+               const merge_target_t *mt,
+               const char *result_target,
+               const char *left_abspath,
+               const char *right_abspath,
+               const char *left_label,
+               const char *right_label,
+               const char *target_label,
+               const char *compare_abspath,
+               const char *detranslated_target_abspath,
+               svn_cancel_func_t cancel_func,
+               void *cancel_baton,
+               apr_pool_t *scratch_pool)
+{
+  apr_file_t *result_f;
+
+  SVN_ERR(svn_io_file_open(&result_f, result_target,
+                           APR_WRITE | APR_TRUNCATE | APR_BUFFERED,
+                           APR_OS_DEFAULT, scratch_pool));
 
   /* Run the external or internal merge, as requested. */
   if (mt->diff3_cmd)
-      SVN_ERR(do_text_merge_external(&contains_conflicts,
+      SVN_ERR(do_text_merge_external(contains_conflicts,
                                      result_f,
                                      mt->diff3_cmd,
                                      mt->merge_options,
@@ -863,9 +896,9 @@ merge_text_file(svn_skel_t **work_items,
                                      target_label,
                                      left_label,
                                      right_label,
-                                     pool));
+                                     scratch_pool));
   else /* Use internal merge. */
-    SVN_ERR(do_text_merge(&contains_conflicts,
+    SVN_ERR(do_text_merge(contains_conflicts,
                           result_f,
                           mt->merge_options,
                           detranslated_target_abspath,
@@ -874,10 +907,50 @@ merge_text_file(svn_skel_t **work_items,
                           target_label,
                           left_label,
                           right_label,
+                          mt->diff3_threads,
                           cancel_func, cancel_baton,
-                          pool));
+                          scratch_pool));
+
+  SVN_ERR(svn_io_file_close(result_f, scratch_pool));
+
+  if (*contains_conflicts)
+    *same = FALSE;
+  else
+    SVN_ERR(svn_io_files_contents_same_p(same, result_target,
+                                         compare_abspath, scratch_pool));
 
-  SVN_ERR(svn_io_file_close(result_f, pool));
+  return SVN_NO_ERROR;
+}
+
+/* Determine the outcome of a merge that run_text_merge() wrote to
+ * RESULT_TARGET and set *WORK_ITEMS, *CONFLICT_SKEL and *MERGE_OUTCOME
+ * like merge_text_file() does.  CONTAINS_CONFLICTS and SAME are the
+ * results of run_text_merge(); the other arguments are those of
+ * merge_text_file().
+ */
+static svn_error_t *
+finish_text_merge(svn_skel_t **work_items,
+                  svn_skel_t **conflict_skel,
+                  enum svn_wc_merge_outcome_t *merge_outcome,
+                  const merge_target_t *mt,
+                  const char *result_target,
+                  svn_boolean_t contains_conflicts,
+                  svn_boolean_t same,
+                  const char *left_abspath,
+                  const char *right_abspath,
+                  const char *left_label,
+                  const char *right_label,
+                  const char *target_label,
+                  svn_boolean_t dry_run,
+                  const char *detranslated_target_abspath,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  svn_skel_t *work_item;
+
+  *work_items = NULL;
 
   /* Determine the MERGE_OUTCOME, and record any conflict. */
   if (contains_conflicts)
@@ -914,25 +987,7 @@ merge_text_file(svn_skel_t **work_items,
         }
     }
   else
-    {
-      svn_boolean_t same, special;
-
-      /* If 'special', then use the detranslated form of the
-         target file.  This is so we don't try to follow symlinks,
-         but the same treatment is probably also appropriate for
-         whatever special file types we may invent in the future. */
-      SVN_ERR(svn_wc__get_translate_info(NULL, NULL, NULL,
-                                         &special, mt->db, mt->local_abspath,
-                                         mt->old_actual_props, TRUE,
-                                         pool, pool));
-      SVN_ERR(svn_io_files_contents_same_p(&same, result_target,
-                                           (special ?
-                                              detranslated_target_abspath :
-                                              mt->local_abspath),
-                                           pool));
-
-      *merge_outcome = same ? svn_wc_merge_unchanged : svn_wc_merge_merged;
-    }
+    *merge_outcome = same ? svn_wc_merge_unchanged : svn_wc_merge_merged;
 
   if (*merge_outcome != svn_wc_merge_unchanged && ! dry_run)
     {
@@ -956,6 +1011,70 @@ merge_text_file(svn_skel_t **work_items,
   return SVN_NO_ERROR;
 }
 
+/* Handle a non-trivial merge of 'text' files.  (Assume that a trivial
+ * merge was not possible.)
+ *
+ * Set *WORK_ITEMS, *CONFLICT_SKEL and *MERGE_OUTCOME according to the
+ * result -- to install the merged file, or to indicate a conflict.
+ *
+ * On successful merge, leave the result in a temporary file and set
+ * *WORK_ITEMS to hold work items that will translate and install that
+ * file into its proper form and place (unless DRY_RUN) and delete the
+ * temporary file (in any case).  Set *MERGE_OUTCOME to 'merged' or
+ * 'unchanged'.
+ *
+ * If a conflict occurs, set *MERGE_OUTCOME to 'conflicted', and (unless
+ * DRY_RUN) set *WORK_ITEMS and *CONFLICT_SKEL to record the conflict
+ * and copies of the pre-merge files.  See preserve_pre_merge_files()
+ * for details.
+ *
+ * On entry, all of the output pointers must be non-null and *CONFLICT_SKEL
+ * must either point to an existing conflict skel or be NULL.
+ */
+static svn_error_t*
+merge_text_file(svn_skel_t **work_items,
+                svn_skel_t **conflict_skel,
+                enum svn_wc_merge_outcome_t *merge_outcome,
+                const merge_target_t *mt,
+                const char *left_abspath,
+                const char *right_abspath,
+                const char *left_label,
+                const char *right_label,
+                const char *target_label,
+                svn_boolean_t dry_run,
+                const char *detranslated_target_abspath,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  svn_boolean_t contains_conflicts;
+  svn_boolean_t same;
+  svn_boolean_t special;
+  const char *result_target;
+
+  SVN_ERR(reserve_merge_result(&result_target, &special, mt,
+                               detranslated_target_abspath,
+                               scratch_pool, scratch_pool));
+  SVN_ERR(run_text_merge(&contains_conflicts, &same, mt, result_target,
+                         left_abspath, right_abspath,
+                         left_label, right_label, target_label,
+                         special ? detranslated_target_abspath
+                                 : mt->local_abspath,
+                         detranslated_target_abspath,
+                         cancel_func, cancel_baton, scratch_pool));
+
+  return svn_error_trace(finish_text_merge(work_items, conflict_skel,
+                                           merge_outcome, mt, result_target,
+                                           contains_conflicts, same,
+                                           left_abspath, right_abspath,
+                                           left_label, right_label,
+                                           target_label, dry_run,
+                                           detranslated_target_abspath,
+                                           cancel_func, cancel_baton,
+                                           result_pool, scratch_pool));
+}
+
 /* Handle a non-trivial merge of 'binary' files: don't actually merge, just
  * flag a conflict.  (Assume that a trivial merge was not possible.)
  *
@@ -1074,6 +1193,55 @@ merge_binary_file(svn_skel_t **work_items,
   return SVN_NO_ERROR;
 }
 
+/* Decide whether the merge target MT is to be merged as a 'binary' file
+   and set *IS_BINARY accordingly.  Detranslate the target to repository
+   normal form and set *DETRANSLATED_TARGET_ABSPATH to the result; see
+   detranslate_wc_file() for FORCE_COPY.  Set *NEW_LEFT_ABSPATH to
+   LEFT_ABSPATH or a copy of it with the target's new eol style.
+   Temporary files that this creates will be removed on RESULT_POOL
+   cleanup, unless FORCE_COPY is TRUE. */
+static svn_error_t *
+begin_merge(svn_boolean_t *is_binary,
+            const char **detranslated_target_abspath,
+            const char **new_left_abspath,
+            const merge_target_t *mt,
+            const char *left_abspath,
+            svn_cancel_func_t cancel_func,
+            void *cancel_baton,
+            apr_pool_t *result_pool,
+            apr_pool_t *scratch_pool)
+{
+  const svn_prop_t *mimeprop;
+
+  /* Decide if the merge target is a text or binary file. */
+  if ((mimeprop = get_prop(mt->prop_diff, SVN_PROP_MIME_TYPE))
+      && mimeprop->value)
+    *is_binary = svn_mime_type_is_binary(mimeprop->value->data);
+  else
+    {
+      const char *value = svn_prop_get_value(mt->old_actual_props,
+                                             SVN_PROP_MIME_TYPE);
+
+      *is_binary = value && svn_mime_type_is_binary(value);
+    }
+
+  SVN_ERR(detranslate_wc_file(detranslated_target_abspath, mt,
+                              (! *is_binary) && mt->diff3_cmd != NULL,
+                              mt->local_abspath,
+                              cancel_func, cancel_baton,
+                              result_pool, scratch_pool));
+
+  /* We cannot depend on the left file to contain the same eols as the
+     right file. If the merge target has mods, this will mark the entire
+     file as conflicted, so we need to compensate. */
+  SVN_ERR(maybe_update_target_eols(new_left_abspath, mt->prop_diff,
+                                   left_abspath,
+                                   cancel_func, cancel_baton,
+                                   result_pool, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_wc__internal_merge(svn_skel_t **work_items,
                        svn_skel_t **conflict_skel,
@@ -1097,8 +1265,7 @@ svn_wc__internal_merge(svn_skel_t **work_items,
                        apr_pool_t *scratch_pool)
 {
   const char *detranslated_target_abspath;
-  svn_boolean_t is_binary = FALSE;
-  const svn_prop_t *mimeprop;
+  svn_boolean_t is_binary;
   svn_skel_t *work_item;
   merge_target_t mt;
 
@@ -1116,31 +1283,12 @@ svn_wc__internal_merge(svn_skel_t **work_items,
   mt.prop_diff = prop_diff;
   mt.diff3_cmd = diff3_cmd;
   mt.merge_options = merge_options;
+  mt.diff3_threads = 1;
 
-  /* Decide if the merge target is a text or binary file. */
-  if ((mimeprop = get_prop(prop_diff, SVN_PROP_MIME_TYPE))
-      && mimeprop->value)
-    is_binary = svn_mime_type_is_binary(mimeprop->value->data);
-  else
-    {
-      const char *value = svn_prop_get_value(mt.old_actual_props,
-                                             SVN_PROP_MIME_TYPE);
-
-      is_binary = value && svn_mime_type_is_binary(value);
-    }
-
-  SVN_ERR(detranslate_wc_file(&detranslated_target_abspath, &mt,
-                              (! is_binary) && diff3_cmd != NULL,
-                              target_abspath,
-                              cancel_func, cancel_baton,
-                              scratch_pool, scratch_pool));
-
-  /* We cannot depend on the left file to contain the same eols as the
-     right file. If the merge target has mods, this will mark the entire
-     file as conflicted, so we need to compensate. */
-  SVN_ERR(maybe_update_target_eols(&left_abspath, prop_diff, left_abspath,
-                                   cancel_func, cancel_baton,
-                                   scratch_pool, scratch_pool));
+  SVN_ERR(begin_merge(&is_binary, &detranslated_target_abspath,
+                      &left_abspath, &mt, left_abspath,
+                      cancel_func, cancel_baton,
+                      scratch_pool, scratch_pool));
 
   SVN_ERR(merge_file_trivial(work_items, merge_outcome,
                              left_abspath, right_abspath,
@@ -1201,41 +1349,140 @@ svn_wc__internal_merge(svn_skel_t **work_items,
 }
 
 
+/* The state of a merge into a working file from
+   svn_wc__merge_file_prepare() to svn_wc__merge_file_install(). */
+struct svn_wc__file_merge_t
+{
+  merge_target_t mt;
+
+  /* Copies of the arguments of svn_wc__merge_file_prepare(), where
+     LEFT_ABSPATH has got the new eol style of the target. */
+  const char *left_abspath;
+  const char *right_abspath;
+  const char *left_label;
+  const char *right_label;
+  const char *target_label;
+  const svn_wc_conflict_version_t *left_version;
+  const svn_wc_conflict_version_t *right_version;
+  svn_boolean_t dry_run;
+  svn_boolean_t merge_props;
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+
+  /* The target is not a versioned file and will not be touched. */
+  svn_boolean_t skipped;
+
+  svn_node_kind_t kind;
+  const char *detranslated_target_abspath;
+  svn_boolean_t has_magic_property;
+
+  /* The outcome as far as known before svn_wc__merge_file_compute(). */
+  svn_skel_t *work_items;
+  svn_skel_t *conflict_skel;
+  apr_hash_t *new_actual_props;
+  enum svn_wc_merge_outcome_t content_outcome;
+  svn_wc_notify_state_t props_outcome;
+
+  /* Whether the text still has to be merged into RESULT_TARGET by
+     svn_wc__merge_file_compute() and whether that happened already.
+     COMPARE_ABSPATH is the file that the result has to be compared with
+     to find out whether the merge changed anything. */
+  svn_boolean_t text_pending;
+  svn_boolean_t text_computed;
+  const char *result_target;
+  const char *compare_abspath;
+
+  /* The results of svn_wc__merge_file_compute(). */
+  svn_boolean_t contains_conflicts;
+  svn_boolean_t same;
+};
+
+/* Set *COPY_ABSPATH to a new temporary file with the contents of the
+   file at SOURCE_ABSPATH that will be removed on RESULT_POOL cleanup. */
+static svn_error_t *
+copy_to_temp_file(const char **copy_abspath,
+                  const char *source_abspath,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  SVN_ERR(svn_io_open_unique_file3(NULL, copy_abspath, NULL,
+                                   svn_io_file_del_on_pool_cleanup,
+                                   result_pool, scratch_pool));
+  SVN_ERR(svn_io_copy_file(source_abspath, *copy_abspath, TRUE,
+                           scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
-svn_wc_merge5(enum svn_wc_merge_outcome_t *merge_content_outcome,
-              enum svn_wc_notify_state_t *merge_props_outcome,
-              svn_wc_context_t *wc_ctx,
-              const char *left_abspath,
-              const char *right_abspath,
-              const char *target_abspath,
-              const char *left_label,
-              const char *right_label,
-              const char *target_label,
-              const svn_wc_conflict_version_t *left_version,
-              const svn_wc_conflict_version_t *right_version,
-              svn_boolean_t dry_run,
-              const char *diff3_cmd,
-              const apr_array_header_t *merge_options,
-              apr_hash_t *original_props,
-              const apr_array_header_t *prop_diff,
-              svn_wc_conflict_resolver_func2_t conflict_func,
-              void *conflict_baton,
-              svn_cancel_func_t cancel_func,
-              void *cancel_baton,
-              apr_pool_t *scratch_pool)
+svn_wc__merge_file_prepare(svn_wc__file_merge_t **merge,
+                           svn_wc_context_t *wc_ctx,
+                           const char *left_abspath,
+                           const char *right_abspath,
+                           const char *target_abspath,
+                           const char *left_label,
+                           const char *right_label,
+                           const char *target_label,
+                           const svn_wc_conflict_version_t *left_version,
+                           const svn_wc_conflict_version_t *right_version,
+                           svn_boolean_t dry_run,
+                           const char *diff3_cmd,
+                           const apr_array_header_t *merge_options,
+                           apr_hash_t *original_props,
+                           const apr_array_header_t *prop_diff,
+                           svn_boolean_t merge_props,
+                           svn_boolean_t copy_inputs,
+                           svn_cancel_func_t cancel_func,
+                           void *cancel_baton,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool)
 {
+  svn_wc__file_merge_t *m = apr_pcalloc(result_pool, sizeof(*m));
   const char *dir_abspath = svn_dirent_dirname(target_abspath, scratch_pool);
-  svn_skel_t *work_items;
-  svn_skel_t *conflict_skel = NULL;
   apr_hash_t *pristine_props = NULL;
   apr_hash_t *old_actual_props;
-  apr_hash_t *new_actual_props = NULL;
-  svn_node_kind_t kind;
+  svn_boolean_t is_binary;
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(left_abspath));
   SVN_ERR_ASSERT(svn_dirent_is_absolute(right_abspath));
   SVN_ERR_ASSERT(svn_dirent_is_absolute(target_abspath));
 
+  *merge = m;
+  m->mt.db = wc_ctx->db;
+  m->mt.local_abspath = apr_pstrdup(result_pool, target_abspath);
+  m->mt.wri_abspath = m->mt.local_abspath;
+  m->mt.prop_diff = prop_diff;
+  m->mt.diff3_cmd = apr_pstrdup(result_pool, diff3_cmd);
+  m->mt.diff3_threads = 1;
+  if (merge_options)
+    {
+      apr_array_header_t *options
+        = apr_array_make(result_pool, merge_options->nelts,
+                         sizeof(const char *));
+      int i;
+
+      for (i = 0; i < merge_options->nelts; i++)
+        APR_ARRAY_PUSH(options, const char *)
+          = apr_pstrdup(result_pool,
+                        APR_ARRAY_IDX(merge_options, i, const char *));
+      m->mt.merge_options = options;
+    }
+  m->left_label = apr_pstrdup(result_pool, left_label);
+  m->right_label = apr_pstrdup(result_pool, right_label);
+  m->target_label = apr_pstrdup(result_pool, target_label);
+  m->left_version = left_version
+                  ? svn_wc_conflict_version_dup(left_version, result_pool)
+                  : NULL;
+  m->right_version = right_version
+                   ? svn_wc_conflict_version_dup(right_version, result_pool)
+                   : NULL;
+  m->dry_run = dry_run;
+  m->merge_props = merge_props;
+  m->cancel_func = cancel_func;
+  m->cancel_baton = cancel_baton;
+  m->content_outcome = svn_wc_merge_no_merge;
+  m->props_outcome = svn_wc_notify_state_unchanged;
+
   /* Before we do any work, make sure we hold a write lock.  */
   if (!dry_run)
     SVN_ERR(svn_wc__write_check(wc_ctx->db, dir_abspath, scratch_pool));
@@ -1247,20 +1494,18 @@ svn_wc_merge5(enum svn_wc_merge_outcome_t *merge_content_outcome,
     svn_boolean_t props_mod;
     svn_boolean_t conflicted;
 
-    SVN_ERR(svn_wc__db_read_info(&status, &kind, NULL, NULL, NULL, NULL, NULL,
+    SVN_ERR(svn_wc__db_read_info(&status, &m->kind, NULL, NULL, NULL, NULL,
+                                 NULL, NULL, NULL, NULL, NULL, NULL, NULL,
                                  NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-                                 NULL, NULL, NULL, NULL, NULL, NULL,
                                  &conflicted, NULL, &had_props, &props_mod,
                                  NULL, NULL, NULL,
                                  wc_ctx->db, target_abspath,
                                  scratch_pool, scratch_pool));
 
-    if (kind != svn_node_file || (status != svn_wc__db_status_normal
-                                  && status != svn_wc__db_status_added))
+    if (m->kind != svn_node_file || (status != svn_wc__db_status_normal
+                                     && status != svn_wc__db_status_added))
       {
-        *merge_content_outcome = svn_wc_merge_no_merge;
-        if (merge_props_outcome)
-          *merge_props_outcome = svn_wc_notify_state_unchanged;
+        m->skipped = TRUE;
         return SVN_NO_ERROR;
       }
 
@@ -1289,30 +1534,31 @@ svn_wc_merge5(enum svn_wc_merge_outcome_t *merge_content_outcome,
         /* else: Conflict was resolved by removing markers */
       }
 
-    if (merge_props_outcome && had_props)
+    if (merge_props && had_props)
       {
         SVN_ERR(svn_wc__db_read_pristine_props(&pristine_props,
                                                wc_ctx->db, target_abspath,
-                                               scratch_pool, scratch_pool));
+                                               result_pool, scratch_pool));
       }
-    else if (merge_props_outcome)
-      pristine_props = apr_hash_make(scratch_pool);
+    else if (merge_props)
+      pristine_props = apr_hash_make(result_pool);
 
     if (props_mod)
       {
         SVN_ERR(svn_wc__db_read_props(&old_actual_props,
                                       wc_ctx->db, target_abspath,
-                                      scratch_pool, scratch_pool));
+                                      result_pool, scratch_pool));
       }
     else if (pristine_props)
       old_actual_props = pristine_props;
     else
-      old_actual_props = apr_hash_make(scratch_pool);
+      old_actual_props = apr_hash_make(result_pool);
   }
+  m->mt.old_actual_props = old_actual_props;
 
   /* Merge the properties, if requested.  We merge the properties first
    * because the properties can affect the text (EOL style, keywords). */
-  if (merge_props_outcome)
+  if (merge_props)
     {
       int i;
 
@@ -1332,97 +1578,253 @@ svn_wc_merge5(enum svn_wc_merge_outcome_t *merge_content_outcome,
                                                             scratch_pool));
         }
 
-      SVN_ERR(svn_wc__merge_props(&conflict_skel,
-                                  merge_props_outcome,
-                                  &new_actual_props,
+      SVN_ERR(svn_wc__merge_props(&m->conflict_skel,
+                                  &m->props_outcome,
+                                  &m->new_actual_props,
                                   wc_ctx->db, target_abspath,
                                   original_props, pristine_props, old_actual_props,
                                   prop_diff,
-                                  scratch_pool, scratch_pool));
+                                  result_pool, scratch_pool));
+      m->has_magic_property = svn_wc__has_magic_property(prop_diff);
     }
 
-  /* Merge the text. */
-  SVN_ERR(svn_wc__internal_merge(&work_items,
-                                 &conflict_skel,
-                                 merge_content_outcome,
-                                 wc_ctx->db,
-                                 left_abspath,
-                                 right_abspath,
-                                 target_abspath,
-                                 target_abspath,
-                                 left_label, right_label, target_label,
-                                 old_actual_props,
-                                 dry_run,
-                                 diff3_cmd,
-                                 merge_options,
-                                 prop_diff,
-                                 cancel_func, cancel_baton,
-                                 scratch_pool, scratch_pool));
+  /* Prepare the text merge and do it right away if it is trivial or
+     merely raises a conflict. */
+  SVN_ERR(begin_merge(&is_binary, &m->detranslated_target_abspath,
+                      &left_abspath, &m->mt, left_abspath,
+                      cancel_func, cancel_baton,
+                      result_pool, scratch_pool));
 
-  /* If this isn't a dry run, then update the DB, run the work, and
-   * call the conflict resolver callback.  */
-  if (!dry_run)
+  SVN_ERR(merge_file_trivial(&m->work_items, &m->content_outcome,
+                             left_abspath, right_abspath,
+                             target_abspath, m->detranslated_target_abspath,
+                             dry_run, wc_ctx->db, cancel_func, cancel_baton,
+                             result_pool, scratch_pool));
+  if (m->content_outcome != svn_wc_merge_no_merge)
+    return SVN_NO_ERROR;
+
+  if (is_binary)
     {
-      if (conflict_skel)
+      /* Raise a text conflict */
+      SVN_ERR(merge_binary_file(&m->work_items,
+                                &m->conflict_skel,
+                                &m->content_outcome,
+                                &m->mt,
+                                left_abspath,
+                                right_abspath,
+                                left_label,
+                                right_label,
+                                target_label,
+                                dry_run,
+                                m->detranslated_target_abspath,
+                                result_pool, scratch_pool));
+    }
+  else
+    {
+      svn_boolean_t special;
+
+      if (copy_inputs)
         {
-          svn_skel_t *work_item;
+          SVN_ERR(copy_to_temp_file(&left_abspath, left_abspath,
+                                    result_pool, scratch_pool));
+          SVN_ERR(copy_to_temp_file(&right_abspath, right_abspath,
+                                    result_pool, scratch_pool));
+        }
 
-          SVN_ERR(svn_wc__conflict_skel_set_op_merge(conflict_skel,
-                                                     left_version,
-                                                     right_version,
-                                                     scratch_pool,
-                                                     scratch_pool));
+      SVN_ERR(reserve_merge_result(&m->result_target, &special, &m->mt,
+                                   m->detranslated_target_abspath,
+                                   result_pool, scratch_pool));
+      m->compare_abspath = special ? m->detranslated_target_abspath
+                                   : m->mt.local_abspath;
+      m->left_abspath = apr_pstrdup(result_pool, left_abspath);
+      m->right_abspath = apr_pstrdup(result_pool, right_abspath);
+      m->text_pending = TRUE;
+    }
 
-          SVN_ERR(svn_wc__conflict_create_markers(&work_item,
-                                                  wc_ctx->db, target_abspath,
-                                                  conflict_skel,
-                                                  scratch_pool, scratch_pool));
+  return SVN_NO_ERROR;
+}
 
-          work_items = svn_wc__wq_merge(work_items, work_item, scratch_pool);
-        }
+svn_error_t *
+svn_wc__merge_file_compute(void *baton,
+                           apr_pool_t *scratch_pool)
+{
+  svn_wc__file_merge_t *m = baton;
 
-      if (new_actual_props)
-        SVN_ERR(svn_wc__db_op_set_props(wc_ctx->db, target_abspath,
-                                        new_actual_props,
-                                        svn_wc__has_magic_property(prop_diff),
+  if (! m->text_pending)
+    return SVN_NO_ERROR;
+
+  SVN_ERR_ASSERT(! m->text_computed);
+
+  SVN_ERR(run_text_merge(&m->contains_conflicts, &m->same, &m->mt,
+                         m->result_target,
+                         m->left_abspath, m->right_abspath,
+                         m->left_label, m->right_label, m->target_label,
+                         m->compare_abspath,
+                         m->detranslated_target_abspath,
+                         m->cancel_func, m->cancel_baton,
+                         scratch_pool));
+  m->text_computed = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__merge_file_install(enum svn_wc_merge_outcome_t *merge_content_outcome,
+                           enum svn_wc_notify_state_t *merge_props_outcome,
+                           svn_wc__file_merge_t *merge,
+                           svn_wc_conflict_resolver_func2_t conflict_func,
+                           void *conflict_baton,
+                           apr_pool_t *scratch_pool)
+{
+  svn_wc__db_t *db = merge->mt.db;
+  const char *target_abspath = merge->mt.local_abspath;
+  svn_skel_t *work_items = merge->work_items;
+  svn_skel_t *conflict_skel = merge->conflict_skel;
+  svn_skel_t *work_item;
+
+  *merge_content_outcome = merge->content_outcome;
+  if (merge_props_outcome)
+    *merge_props_outcome = merge->props_outcome;
+
+  if (merge->skipped)
+    return SVN_NO_ERROR;
+
+  if (merge->text_pending)
+    {
+      SVN_ERR_ASSERT(merge->text_computed);
+
+      SVN_ERR(finish_text_merge(&work_item, &conflict_skel,
+                                merge_content_outcome, &merge->mt,
+                                merge->result_target,
+                                merge->contains_conflicts, merge->same,
+                                merge->left_abspath, merge->right_abspath,
+                                merge->left_label, merge->right_label,
+                                merge->target_label, merge->dry_run,
+                                merge->detranslated_target_abspath,
+                                merge->cancel_func, merge->cancel_baton,
+                                scratch_pool, scratch_pool));
+      work_items = svn_wc__wq_merge(work_items, work_item, scratch_pool);
+    }
+
+  /* If this isn't a dry run, then update the DB, run the work, and
+   * call the conflict resolver callback.  */
+  if (merge->dry_run)
+    return SVN_NO_ERROR;
+
+  /* Regardless of text or binariness, we might need to tweak the
+     executable bit on the new working file, and possibly make it
+     read-only. */
+  SVN_ERR(svn_wc__wq_build_sync_file_flags(&work_item, db, target_abspath,
+                                           scratch_pool, scratch_pool));
+  work_items = svn_wc__wq_merge(work_items, work_item, scratch_pool);
+
+  if (conflict_skel)
+    {
+      SVN_ERR(svn_wc__conflict_skel_set_op_merge(conflict_skel,
+                                                 merge->left_version,
+                                                 merge->right_version,
+                                                 scratch_pool,
+                                                 scratch_pool));
+
+      SVN_ERR(svn_wc__conflict_create_markers(&work_item,
+                                              db, target_abspath,
+                                              conflict_skel,
+                                              scratch_pool, scratch_pool));
+
+      work_items = svn_wc__wq_merge(work_items, work_item, scratch_pool);
+    }
+
+  if (merge->new_actual_props)
+    SVN_ERR(svn_wc__db_op_set_props(db, target_abspath,
+                                    merge->new_actual_props,
+                                    merge->has_magic_property,
+                                    conflict_skel, work_items,
+                                    scratch_pool));
+  else if (conflict_skel)
+    SVN_ERR(svn_wc__db_op_mark_conflict(db, target_abspath,
                                         conflict_skel, work_items,
                                         scratch_pool));
-      else if (conflict_skel)
-        SVN_ERR(svn_wc__db_op_mark_conflict(wc_ctx->db, target_abspath,
-                                            conflict_skel, work_items,
-                                            scratch_pool));
-      else if (work_items)
-        SVN_ERR(svn_wc__db_wq_add(wc_ctx->db, target_abspath, work_items,
-                                  scratch_pool));
+  else if (work_items)
+    SVN_ERR(svn_wc__db_wq_add(db, target_abspath, work_items,
+                              scratch_pool));
 
-      if (work_items)
-        SVN_ERR(svn_wc__wq_run(wc_ctx->db, target_abspath,
-                               cancel_func, cancel_baton,
-                               scratch_pool));
+  if (work_items)
+    SVN_ERR(svn_wc__wq_run(db, target_abspath,
+                           merge->cancel_func, merge->cancel_baton,
+                           scratch_pool));
 
-      if (conflict_skel && conflict_func)
-        {
-          svn_boolean_t text_conflicted, prop_conflicted;
-
-          SVN_ERR(svn_wc__conflict_invoke_resolver(
-                    wc_ctx->db, target_abspath, kind,
-                    conflict_skel, merge_options,
-                    conflict_func, conflict_baton,
-                    cancel_func, cancel_baton,
-                    scratch_pool));
-
-          /* Reset *MERGE_CONTENT_OUTCOME etc. if a conflict was resolved. */
-          SVN_ERR(svn_wc__internal_conflicted_p(
-                    &text_conflicted, &prop_conflicted, NULL,
-                    wc_ctx->db, target_abspath, scratch_pool));
-          if (*merge_props_outcome == svn_wc_notify_state_conflicted
-              && ! prop_conflicted)
-            *merge_props_outcome = svn_wc_notify_state_merged;
-          if (*merge_content_outcome == svn_wc_merge_conflict
-              && ! text_conflicted)
-            *merge_content_outcome = svn_wc_merge_merged;
-        }
+  if (conflict_skel && conflict_func)
+    {
+      svn_boolean_t text_conflicted, prop_conflicted;
+
+      SVN_ERR(svn_wc__conflict_invoke_resolver(
+                db, target_abspath, merge->kind,
+                conflict_skel, merge->mt.merge_options,
+                conflict_func, conflict_baton,
+                merge->cancel_func, merge->cancel_baton,
+                scratch_pool));
+
+      /* Reset *MERGE_CONTENT_OUTCOME etc. if a conflict was resolved. */
+      SVN_ERR(svn_wc__internal_conflicted_p(
+                &text_conflicted, &prop_conflicted, NULL,
+                db, target_abspath, scratch_pool));
+      if (merge_props_outcome
+          && *merge_props_outcome == svn_wc_notify_state_conflicted
+          && ! prop_conflicted)
+        *merge_props_outcome = svn_wc_notify_state_merged;
+      if (*merge_content_outcome == svn_wc_merge_conflict
+          && ! text_conflicted)
+        *merge_content_outcome = svn_wc_merge_merged;
     }
 
   return SVN_NO_ERROR;
 }
+
+svn_error_t *
+svn_wc_merge5(enum svn_wc_merge_outcome_t *merge_content_outcome,
+              enum svn_wc_notify_state_t *merge_props_outcome,
+              svn_wc_context_t *wc_ctx,
+              const char *left_abspath,
+              const char *right_abspath,
+              const char *target_abspath,
+              const char *left_label,
+              const char *right_label,
+              const char *target_label,
+              const svn_wc_conflict_version_t *left_version,
+              const svn_wc_conflict_version_t *right_version,
+              svn_boolean_t dry_run,
+              const char *diff3_cmd,
+              const apr_array_header_t *merge_options,
+              apr_hash_t *original_props,
+              const apr_array_header_t *prop_diff,
+              svn_wc_conflict_resolver_func2_t conflict_func,
+              void *conflict_baton,
+              svn_cancel_func_t cancel_func,
+              void *cancel_baton,
+              apr_pool_t *scratch_pool)
+{
+  svn_wc__file_merge_t *merge;
+
+  SVN_ERR(svn_wc__merge_file_prepare(&merge, wc_ctx,
+                                     left_abspath, right_abspath,
+                                     target_abspath,
+                                     left_label, right_label, target_label,
+                                     left_version, right_version,
+                                     dry_run, diff3_cmd, merge_options,
+                                     original_props, prop_diff,
+                                     merge_props_outcome != NULL,
+                                     FALSE /* copy_inputs */,
+                                     cancel_func, cancel_baton,
+                                     scratch_pool, scratch_pool));
+
+  /* Stay within the working copy's configured thread limit. */
+  merge->mt.diff3_threads = svn_wc__db_get_worker_threads(wc_ctx->db);
+  SVN_ERR(svn_wc__merge_file_compute(merge, scratch_pool));
+
+  return svn_error_trace(svn_wc__merge_file_install(merge_content_outcome,
+                                                    merge_props_outcome,
+                                                    merge,
+                                                    conflict_func,
+                                                    conflict_baton,
+                                                    scratch_pool));
+}
@@ -78,83 +78,123 @@
 */
 
 
-/* Set *MODIFIED_P to TRUE if (after translation) VERSIONED_FILE_ABSPATH
- * (of VERSIONED_FILE_SIZE bytes) differs from PRISTINE_STREAM (of
- * PRISTINE_SIZE bytes), else to FALSE if not.
- *
- * If EXACT_COMPARISON is FALSE, translate VERSIONED_FILE_ABSPATH's EOL
- * style and keywords to repository-normal form according to its properties,
- * and compare the result with PRISTINE_STREAM.  If EXACT_COMPARISON is
- * TRUE, translate PRISTINE_STREAM's EOL style and keywords to working-copy
- * form according to VERSIONED_FILE_ABSPATH's properties, and compare the
- * result with VERSIONED_FILE_ABSPATH.
- *
- * HAS_PROPS should be TRUE if the file had properties when it was not
- * modified, otherwise FALSE.
- *
- * PROPS_MOD should be TRUE if the file's properties have been changed,
- * otherwise FALSE.
+/* Everything needed to compare a working file with its pristine text
+   without accessing the DB, so that the comparison may run on any
+   thread. */
+struct svn_wc__text_compare_t
+{
+  /* The working file and its on-disk size and timestamp. */
+  const char *local_abspath;
+  svn_filesize_t filesize;
+  apr_time_t mtime;
+
+  /* The pristine text file. */
+  const char *pristine_abspath;
+
+  /* Translation from (EXACT_COMPARISON) or to the working copy form. */
+  svn_boolean_t exact_comparison;
+  svn_boolean_t need_translation;
+  svn_boolean_t special;
+  svn_subst_eol_style_t eol_style;
+  const char *eol_str;
+  apr_hash_t *keywords;
+};
+
+/* Size of the blocks that untranslated files get compared in.  memcmp()
+ * is vectorized by all relevant C libraries, so the only thing left to
+ * do is to keep the per-call overhead low. */
+#define COMPARE_BLOCK_SIZE (256 * 1024)
+
+/* Set *SAME to TRUE if the contents of the files PRISTINE and WORKING are
+ * identical, else to FALSE.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+compare_files(svn_boolean_t *same,
+              apr_file_t *pristine,
+              apr_file_t *working,
+              apr_pool_t *scratch_pool)
+{
+  char *buf1 = apr_palloc(scratch_pool, COMPARE_BLOCK_SIZE);
+  char *buf2 = apr_palloc(scratch_pool, COMPARE_BLOCK_SIZE);
+  svn_boolean_t eof1 = FALSE;
+  svn_boolean_t eof2 = FALSE;
+
+  *same = TRUE;
+  while (*same && !eof1 && !eof2)
+    {
+      apr_size_t len1, len2;
+
+      SVN_ERR(svn_io_file_read_full2(pristine, buf1, COMPARE_BLOCK_SIZE,
+                                     &len1, &eof1, scratch_pool));
+      SVN_ERR(svn_io_file_read_full2(working, buf2, COMPARE_BLOCK_SIZE,
+                                     &len2, &eof2, scratch_pool));
+
+      *same = (len1 == len2) && (memcmp(buf1, buf2, len1) == 0);
+    }
+
+  if (eof1 != eof2)
+    *same = FALSE;
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *MODIFIED_P to TRUE if (after translation) the working file of
+ * COMPARE differs from its pristine text, else to FALSE if not.
  *
- * PRISTINE_STREAM will be closed before a successful return.
+ * If COMPARE->EXACT_COMPARISON is FALSE, translate the working file's EOL
+ * style and keywords to repository-normal form according to its
+ * properties, and compare the result with the pristine text.  If it is
+ * TRUE, translate the pristine text's EOL style and keywords to
+ * working-copy form, and compare the result with the working file.
  *
- * DB is a wc_db; use SCRATCH_POOL for temporary allocation.
+ * This does not access the DB.  Use SCRATCH_POOL for temporary
+ * allocation.
  */
 static svn_error_t *
 compare_and_verify(svn_boolean_t *modified_p,
-                   svn_wc__db_t *db,
-                   const char *versioned_file_abspath,
-                   svn_filesize_t versioned_file_size,
-                   svn_stream_t *pristine_stream,
-                   svn_filesize_t pristine_size,
-                   svn_boolean_t has_props,
-                   svn_boolean_t props_mod,
-                   svn_boolean_t exact_comparison,
+                   const svn_wc__text_compare_t *compare,
                    apr_pool_t *scratch_pool)
 {
   svn_boolean_t same;
-  svn_subst_eol_style_t eol_style;
-  const char *eol_str;
-  apr_hash_t *keywords;
-  svn_boolean_t special = FALSE;
-  svn_boolean_t need_translation;
+  const char *eol_str = compare->eol_str;
+  apr_file_t *pristine_file;
+  svn_stream_t *pristine_stream;
   svn_stream_t *v_stream; /* versioned_file */
 
-  SVN_ERR_ASSERT(svn_dirent_is_absolute(versioned_file_abspath));
+  SVN_ERR(svn_io_file_open(&pristine_file, compare->pristine_abspath,
+                           APR_READ, APR_OS_DEFAULT, scratch_pool));
 
-  if (props_mod)
-    has_props = TRUE; /* Maybe it didn't have properties; but it has now */
-
-  if (has_props)
+  if (! compare->need_translation)
     {
-      SVN_ERR(svn_wc__get_translate_info(&eol_style, &eol_str,
-                                         &keywords,
-                                         &special,
-                                         db, versioned_file_abspath, NULL,
-                                         !exact_comparison,
-                                         scratch_pool, scratch_pool));
+      apr_file_t *file;
+      apr_finfo_t finfo;
 
-      need_translation = svn_subst_translation_required(eol_style, eol_str,
-                                                        keywords, special,
-                                                        TRUE);
-    }
-  else
-    need_translation = FALSE;
+      SVN_ERR(svn_io_file_info_get(&finfo, APR_FINFO_SIZE, pristine_file,
+                                   scratch_pool));
+      if (compare->filesize != finfo.size)
+        {
+          *modified_p = TRUE;
+          return svn_error_trace(svn_io_file_close(pristine_file,
+                                                   scratch_pool));
+        }
 
-  if (! need_translation
-      && (versioned_file_size != pristine_size))
-    {
-      *modified_p = TRUE;
+      /* Fast path: no stream machinery, just raw blocks. */
+      SVN_ERR(svn_io_file_open(&file, compare->local_abspath, APR_READ,
+                               APR_OS_DEFAULT, scratch_pool));
+      SVN_ERR(compare_files(&same, pristine_file, file, scratch_pool));
+      SVN_ERR(svn_io_file_close(file, scratch_pool));
+      SVN_ERR(svn_io_file_close(pristine_file, scratch_pool));
 
-      /* ### Why did we open the pristine? */
-      return svn_error_trace(svn_stream_close(pristine_stream));
+      *modified_p = (! same);
+      return SVN_NO_ERROR;
     }
 
-  /* ### Other checks possible? */
+  pristine_stream = svn_stream_from_aprfile2(pristine_file, FALSE,
+                                             scratch_pool);
 
   /* Reading files is necessary. */
-  if (special && need_translation)
+  if (compare->special)
     {
-      SVN_ERR(svn_subst_read_specialfile(&v_stream, versioned_file_abspath,
+      SVN_ERR(svn_subst_read_specialfile(&v_stream, compare->local_abspath,
                                           scratch_pool, scratch_pool));
     }
   else
@@ -162,39 +202,39 @@ compare_and_verify(svn_boolean_t *modified_p,
       /* We don't use APR-level buffering because the comparison function
        * will do its own buffering. */
       apr_file_t *file;
-      SVN_ERR(svn_io_file_open(&file, versioned_file_abspath, APR_READ,
+      SVN_ERR(svn_io_file_open(&file, compare->local_abspath, APR_READ,
                                APR_OS_DEFAULT, scratch_pool));
       v_stream = svn_stream_from_aprfile2(file, FALSE, scratch_pool);
 
-      if (need_translation)
+      if (!compare->exact_comparison)
         {
-          if (!exact_comparison)
-            {
-              if (eol_style == svn_subst_eol_style_native)
-                eol_str = SVN_SUBST_NATIVE_EOL_STR;
-              else if (eol_style != svn_subst_eol_style_fixed
-                       && eol_style != svn_subst_eol_style_none)
-                return svn_error_create(SVN_ERR_IO_UNKNOWN_EOL,
-                                        svn_stream_close(v_stream), NULL);
-
-              /* Wrap file stream to detranslate into normal form,
-               * "repairing" the EOL style if it is inconsistent. */
-              v_stream = svn_subst_stream_translated(v_stream,
-                                                     eol_str,
-                                                     TRUE /* repair */,
-                                                     keywords,
-                                                     FALSE /* expand */,
-                                                     scratch_pool);
-            }
-          else
-            {
-              /* Wrap base stream to translate into working copy form, and
-               * arrange to throw an error if its EOL style is inconsistent. */
-              pristine_stream = svn_subst_stream_translated(pristine_stream,
-                                                            eol_str, FALSE,
-                                                            keywords, TRUE,
-                                                            scratch_pool);
-            }
+          if (compare->eol_style == svn_subst_eol_style_native)
+            eol_str = SVN_SUBST_NATIVE_EOL_STR;
+          else if (compare->eol_style != svn_subst_eol_style_fixed
+                   && compare->eol_style != svn_subst_eol_style_none)
+            return svn_error_create(SVN_ERR_IO_UNKNOWN_EOL,
+                                    svn_error_compose_create(
+                                      svn_stream_close(v_stream),
+                                      svn_stream_close(pristine_stream)),
+                                    NULL);
+
+          /* Wrap file stream to detranslate into normal form,
+           * "repairing" the EOL style if it is inconsistent. */
+          v_stream = svn_subst_stream_translated(v_stream,
+                                                 eol_str,
+                                                 TRUE /* repair */,
+                                                 compare->keywords,
+                                                 FALSE /* expand */,
+                                                 scratch_pool);
+        }
+      else
+        {
+          /* Wrap base stream to translate into working copy form, and
+           * arrange to throw an error if its EOL style is inconsistent. */
+          pristine_stream = svn_subst_stream_translated(pristine_stream,
+                                                        eol_str, FALSE,
+                                                        compare->keywords,
+                                                        TRUE, scratch_pool);
         }
     }
 
@@ -207,14 +247,14 @@ compare_and_verify(svn_boolean_t *modified_p,
 }
 
 svn_error_t *
-svn_wc__internal_file_modified_p(svn_boolean_t *modified_p,
-                                 svn_wc__db_t *db,
-                                 const char *local_abspath,
-                                 svn_boolean_t exact_comparison,
-                                 apr_pool_t *scratch_pool)
+svn_wc__text_compare_create(svn_wc__text_compare_t **compare,
+                            svn_boolean_t *modified_p,
+                            svn_wc__db_t *db,
+                            const char *local_abspath,
+                            svn_boolean_t exact_comparison,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool)
 {
-  svn_stream_t *pristine_stream;
-  svn_filesize_t pristine_size;
   svn_wc__db_status_t status;
   svn_node_kind_t kind;
   const svn_checksum_t *checksum;
@@ -223,6 +263,9 @@ svn_wc__internal_file_modified_p(svn_boolean_t *modified_p,
   svn_boolean_t has_props;
   svn_boolean_t props_mod;
   const svn_io_dirent2_t *dirent;
+  svn_wc__text_compare_t *c;
+
+  *compare = NULL;
 
   /* Read the relevant info */
   SVN_ERR(svn_wc__db_read_info(&status, &kind, NULL, NULL, NULL, NULL, NULL,
@@ -302,45 +345,98 @@ svn_wc__internal_file_modified_p(svn_boolean_t *modified_p,
     }
 
  compare_them:
-  SVN_ERR(svn_wc__db_pristine_read(&pristine_stream, &pristine_size,
-                                   db, local_abspath, checksum,
-                                   scratch_pool, scratch_pool));
-
-  /* Check all bytes, and verify checksum if requested. */
-  {
-    svn_error_t *err;
-    err = compare_and_verify(modified_p, db,
-                             local_abspath, dirent->filesize,
-                             pristine_stream, pristine_size,
-                             has_props, props_mod,
-                             exact_comparison,
-                             scratch_pool);
-
-    /* At this point we already opened the pristine file, so we know that
-       the access denied applies to the working copy path */
-    if (err && APR_STATUS_IS_EACCES(err->apr_err))
-      return svn_error_create(SVN_ERR_WC_PATH_ACCESS_DENIED, err, NULL);
-    else
-      SVN_ERR(err);
-  }
-
-  if (!*modified_p)
+  c = apr_pcalloc(result_pool, sizeof(*c));
+  c->local_abspath = apr_pstrdup(result_pool, local_abspath);
+  c->filesize = dirent->filesize;
+  c->mtime = dirent->mtime;
+  c->exact_comparison = exact_comparison;
+
+  SVN_ERR(svn_wc__db_pristine_get_path(&c->pristine_abspath, db,
+                                       local_abspath, checksum,
+                                       result_pool, scratch_pool));
+
+  /* Maybe it didn't have properties; but it has now */
+  if (has_props || props_mod)
     {
-      svn_boolean_t own_lock;
+      SVN_ERR(svn_wc__get_translate_info(&c->eol_style, &c->eol_str,
+                                         &c->keywords,
+                                         &c->special,
+                                         db, local_abspath, NULL,
+                                         !exact_comparison,
+                                         result_pool, scratch_pool));
 
-      /* The timestamp is missing or "broken" so "repair" it if we can. */
-      SVN_ERR(svn_wc__db_wclock_owns_lock(&own_lock, db, local_abspath, FALSE,
-                                          scratch_pool));
-      if (own_lock)
-        SVN_ERR(svn_wc__db_global_record_fileinfo(db, local_abspath,
-                                                  dirent->filesize,
-                                                  dirent->mtime,
-                                                  scratch_pool));
+      c->need_translation = svn_subst_translation_required(c->eol_style,
+                                                           c->eol_str,
+                                                           c->keywords,
+                                                           c->special,
+                                                           TRUE);
     }
 
+  *compare = c;
+
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_wc__text_compare_run(svn_boolean_t *modified_p,
+                         const svn_wc__text_compare_t *compare,
+                         apr_pool_t *scratch_pool)
+{
+  svn_error_t *err = compare_and_verify(modified_p, compare, scratch_pool);
+
+  /* The pristine store is private to us, so we know that the access
+     denied applies to the working copy path */
+  if (err && APR_STATUS_IS_EACCES(err->apr_err))
+    return svn_error_create(SVN_ERR_WC_PATH_ACCESS_DENIED, err, NULL);
+
+  return svn_error_trace(err);
+}
+
+svn_error_t *
+svn_wc__text_compare_finish(svn_wc__db_t *db,
+                            const svn_wc__text_compare_t *compare,
+                            svn_boolean_t modified,
+                            apr_pool_t *scratch_pool)
+{
+  svn_boolean_t own_lock;
+
+  if (modified)
+    return SVN_NO_ERROR;
+
+  /* The timestamp is missing or "broken" so "repair" it if we can. */
+  SVN_ERR(svn_wc__db_wclock_owns_lock(&own_lock, db, compare->local_abspath,
+                                      FALSE, scratch_pool));
+  if (own_lock)
+    SVN_ERR(svn_wc__db_global_record_fileinfo(db, compare->local_abspath,
+                                              compare->filesize,
+                                              compare->mtime,
+                                              scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__internal_file_modified_p(svn_boolean_t *modified_p,
+                                 svn_wc__db_t *db,
+                                 const char *local_abspath,
+                                 svn_boolean_t exact_comparison,
+                                 apr_pool_t *scratch_pool)
+{
+  svn_wc__text_compare_t *compare;
+
+  SVN_ERR(svn_wc__text_compare_create(&compare, modified_p, db,
+                                      local_abspath, exact_comparison,
+                                      scratch_pool, scratch_pool));
+  if (!compare)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_wc__text_compare_run(modified_p, compare, scratch_pool));
+
+  return svn_error_trace(svn_wc__text_compare_finish(db, compare,
+                                                     *modified_p,
+                                                     scratch_pool));
+}
+
 
 svn_error_t *
 svn_wc_text_modified_p2(svn_boolean_t *modified_p,
@@ -46,11 +46,13 @@
 
 #include "wc.h"
 #include "props.h"
+#include "journal.h"
 
 #include "private/svn_sorts_private.h"
 #include "private/svn_wc_private.h"
 #include "private/svn_fspath.h"
 #include "private/svn_editor.h"
+#include "private/svn_thread_pool.h"
 
 
 /* The file internal variant of svn_wc_status3_t, with slightly more
@@ -100,8 +102,78 @@ struct walk_status_baton
 
   /* Repository locks, if set. */
   apr_hash_t *repos_locks;
+
+  /*** Parallel directory reads and text comparisons ***/
+  /* Worker threads reading directories and comparing file contents ahead
+     of the walk.  NULL, if all of that shall be done by the walking thread
+     itself. */
+  svn_thread_pool__group_t *prefetch_group;
+
+  /* Directories being read ahead of time.  Maps const char * abspaths
+     to prefetch_t *.  NULL, if PREFETCH_GROUP is NULL. */
+  apr_hash_t *prefetched;
+
+  /* Pool to create the pools of new PREFETCHED entries in. */
+  apr_pool_t *prefetch_pool;
+
+  /* How many children of a directory to look ahead for sub-directories
+     to read. */
+  int prefetch_ahead;
+
+  /* Files whose contents are being compared with their pristine text ahead
+     of time.  Maps const char * abspaths to verification_t *.  NULL, if
+     PREFETCH_GROUP is NULL. */
+  apr_hash_t *verifications;
+
+  /* How many children of a directory to look ahead for files that need
+     a text comparison. */
+  int verify_ahead;
+
+  /*** Change journal ***/
+  /* Directories changed on disk as recorded by a running watcher.  NULL,
+     if every directory has to be read. */
+  const svn_wc__journal_t *journal;
 };
 
+/* A directory that gets read by a worker thread ahead of time. */
+typedef struct prefetch_t
+{
+  /* The pool this structure is allocated in.  Destroyed by
+     release_prefetch(). */
+  apr_pool_t *pool;
+
+  /* The directory to read. */
+  const char *local_abspath;
+
+  /* Whether to determine the node kinds only, i.e. whether to skip
+     stat()ing the directory entries. */
+  svn_boolean_t only_check_type;
+
+  /* The directory entries, allocated in the task's pool.  Maps const
+     char * basenames to svn_io_dirent2_t *. */
+  apr_hash_t *dirents;
+
+  /* The task reading the directory. */
+  svn_thread_pool__task_t *task;
+} prefetch_t;
+
+/* A file whose text modification status gets determined ahead of time. */
+typedef struct verification_t
+{
+  /* The file. */
+  const char *local_abspath;
+
+  /* The comparison that a worker thread executes, or NULL if the cheap
+     checks were conclusive already. */
+  svn_wc__text_compare_t *compare;
+
+  /* The result, valid once TASK has completed. */
+  svn_boolean_t modified;
+
+  /* The task comparing the contents.  NULL, if COMPARE is NULL. */
+  svn_thread_pool__task_t *task;
+} verification_t;
+
 /*** Editor batons ***/
 
 struct edit_baton
@@ -334,6 +406,9 @@ internal_status(svn_wc__internal_status_t **status,
    do not adjust the result for missing working copy files.
 
    The status struct's repos_lock field will be set to REPOS_LOCK.
+
+   If TEXT_MODIFIED is not NULL, it is the result of a text modification
+   check that the caller already did for LOCAL_ABSPATH.
 */
 static svn_error_t *
 assemble_status(svn_wc__internal_status_t **status,
@@ -348,6 +423,7 @@ assemble_status(svn_wc__internal_status_t **status,
                 svn_boolean_t ignore_text_mods,
                 svn_boolean_t check_working_copy,
                 const svn_lock_t *repos_lock,
+                const svn_boolean_t *text_modified,
                 apr_pool_t *result_pool,
                 apr_pool_t *scratch_pool)
 {
@@ -468,6 +544,8 @@ assemble_status(svn_wc__internal_status_t **status,
                      && info->recorded_size == dirent->filesize
                      && info->recorded_time == dirent->mtime))
             text_modified_p = FALSE;
+          else if (text_modified)
+            text_modified_p = *text_modified;
           else
             {
               svn_error_t *err;
@@ -785,6 +863,42 @@ assemble_unversioned(svn_wc__internal_status_t **status,
 }
 
 
+/* Set *MODIFIED to the text modification status determined by
+   VERIFICATION, which must be registered in WB, and release it.  Use
+   SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+finish_verification(svn_boolean_t *modified,
+                    const struct walk_status_baton *wb,
+                    verification_t *verification,
+                    apr_pool_t *scratch_pool)
+{
+  svn_hash_sets(wb->verifications, verification->local_abspath, NULL);
+
+  if (verification->task)
+    {
+      svn_error_t *err = svn_thread_pool__task_wait(verification->task);
+
+      svn_thread_pool__task_destroy(verification->task);
+
+      /* Same as in assemble_status(). */
+      if (err && err->apr_err == SVN_ERR_WC_PATH_ACCESS_DENIED)
+        {
+          svn_error_clear(err);
+          verification->modified = TRUE;
+        }
+      else
+        SVN_ERR(err);
+
+      SVN_ERR(svn_wc__text_compare_finish(wb->db, verification->compare,
+                                          verification->modified,
+                                          scratch_pool));
+    }
+
+  *modified = verification->modified;
+
+  return SVN_NO_ERROR;
+}
+
 /* Given an ENTRY object representing PATH, build a status structure
    and pass it off to the STATUS_FUNC/STATUS_BATON.  All other
    arguments are the same as those passed to assemble_status().  */
@@ -803,6 +917,15 @@ send_status_structure(const struct walk_status_baton *wb,
 {
   svn_wc__internal_status_t *statstruct;
   const svn_lock_t *repos_lock = NULL;
+  verification_t *verification = NULL;
+  svn_boolean_t text_modified;
+
+  /* Pick up the result of a text comparison done ahead of time. */
+  if (wb->verifications)
+    verification = svn_hash_gets(wb->verifications, local_abspath);
+  if (verification)
+    SVN_ERR(finish_verification(&text_modified, wb, verification,
+                                scratch_pool));
 
   /* Check for a repository lock. */
   if (wb->repos_locks)
@@ -831,7 +954,9 @@ send_status_structure(const struct walk_status_baton *wb,
                           parent_repos_uuid,
                           info, dirent, get_all,
                           wb->ignore_text_mods, wb->check_working_copy,
-                          repos_lock, scratch_pool, scratch_pool));
+                          repos_lock,
+                          verification ? &text_modified : NULL,
+                          scratch_pool, scratch_pool));
 
   if (statstruct && status_func)
     return svn_error_trace((*status_func)(status_baton, local_abspath,
@@ -1023,6 +1148,305 @@ send_unversioned_item(const struct walk_status_baton *wb,
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_thread_pool__func_t.  Read the directory described by
+   the prefetch_t BATON. */
+static svn_error_t *
+prefetch_dirents(void *baton,
+                 apr_pool_t *result_pool)
+{
+  prefetch_t *prefetch = baton;
+  apr_pool_t *scratch_pool = svn_pool_create(result_pool);
+
+  SVN_ERR(svn_io_get_dirents3(&prefetch->dirents, prefetch->local_abspath,
+                              prefetch->only_check_type,
+                              result_pool, scratch_pool));
+  svn_pool_destroy(scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* If WB reads directories in parallel, start reading those children of
+   LOCAL_ABSPATH that the walk will descend into with DEPTH.  Look at
+   SORTED_CHILDREN, an array of svn_sort__item_t, from index *NEXT up to
+   but excluding LIMIT and update *NEXT accordingly.  NODES maps the child
+   basenames to their struct svn_wc__db_info_t *.
+
+   This must match the recursion criteria in one_child_status().  Use
+   SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+start_prefetch(const struct walk_status_baton *wb,
+               const char *local_abspath,
+               const apr_array_header_t *sorted_children,
+               int *next,
+               int limit,
+               apr_hash_t *nodes,
+               svn_depth_t depth,
+               apr_pool_t *scratch_pool)
+{
+  if (!wb->prefetch_group || depth != svn_depth_infinity)
+    return SVN_NO_ERROR;
+
+  for (; *next < limit && *next < sorted_children->nelts; ++*next)
+    {
+      svn_sort__item_t item = APR_ARRAY_IDX(sorted_children, *next,
+                                            svn_sort__item_t);
+      const struct svn_wc__db_info_t *info;
+      prefetch_t *prefetch;
+      apr_pool_t *pool;
+      const char *child_abspath;
+
+      info = apr_hash_get(nodes, item.key, item.klen);
+      if (!info
+          || info->status == svn_wc__db_status_not_present
+          || info->status == svn_wc__db_status_excluded
+          || info->status == svn_wc__db_status_server_excluded
+          || info->kind != svn_node_dir
+          || !info->has_descendants)
+        continue;
+
+      child_abspath = svn_dirent_join(local_abspath, item.key, scratch_pool);
+
+      /* get_dir_status() won't read it anyway. */
+      if (wb->journal
+          && svn_wc__journal_dir_is_clean(wb->journal, child_abspath))
+        continue;
+
+      pool = svn_pool_create(wb->prefetch_pool);
+      prefetch = apr_pcalloc(pool, sizeof(*prefetch));
+      prefetch->pool = pool;
+      prefetch->local_abspath = apr_pstrdup(pool, child_abspath);
+      prefetch->only_check_type = wb->ignore_text_mods;
+
+      SVN_ERR(svn_thread_pool__run(&prefetch->task, wb->prefetch_group,
+                                   prefetch_dirents, prefetch));
+      svn_hash_sets(wb->prefetched, prefetch->local_abspath, prefetch);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_thread_pool__func_t.  Compare the file contents for
+   the verification_t BATON. */
+static svn_error_t *
+verify_text(void *baton,
+            apr_pool_t *result_pool)
+{
+  verification_t *verification = baton;
+
+  return svn_error_trace(svn_wc__text_compare_run(&verification->modified,
+                                                  verification->compare,
+                                                  result_pool));
+}
+
+/* Start comparing the contents of those files among the children of
+   LOCAL_ABSPATH that need a full text comparison, so that their status
+   can be sent without delay later.  Look at SORTED_CHILDREN, an array of
+   svn_sort__item_t, from index *NEXT up to but excluding LIMIT and update
+   *NEXT accordingly.  NODES and DIRENTS are the children's DB and on-disk
+   information as in get_dir_status().
+
+   This must match the text comparison criteria in assemble_status().
+   Allocate the verifications in RESULT_POOL, which must remain valid
+   until they got released.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+start_verifications(const struct walk_status_baton *wb,
+                    const char *local_abspath,
+                    const apr_array_header_t *sorted_children,
+                    int *next,
+                    int limit,
+                    apr_hash_t *nodes,
+                    apr_hash_t *dirents,
+                    apr_pool_t *result_pool,
+                    apr_pool_t *scratch_pool)
+{
+  if (!wb->verifications || wb->ignore_text_mods || !wb->check_working_copy)
+    return SVN_NO_ERROR;
+
+  for (; *next < limit && *next < sorted_children->nelts; ++*next)
+    {
+      svn_sort__item_t item = APR_ARRAY_IDX(sorted_children, *next,
+                                            svn_sort__item_t);
+      const struct svn_wc__db_info_t *info;
+      const svn_io_dirent2_t *dirent;
+      verification_t *verification;
+
+      info = apr_hash_get(nodes, item.key, item.klen);
+      dirent = apr_hash_get(dirents, item.key, item.klen);
+
+      if (!info || !dirent
+          || (info->status != svn_wc__db_status_normal
+              && info->status != svn_wc__db_status_added)
+          || info->incomplete
+          || (info->kind != svn_node_file && info->kind != svn_node_symlink)
+          || !info->has_checksum
+          || dirent->kind != svn_node_file
+#ifdef HAVE_SYMLINK
+          || info->special != dirent->special
+#endif
+          || (info->recorded_size != SVN_INVALID_FILESIZE
+              && info->recorded_time != 0
+              && info->recorded_size == dirent->filesize
+              && info->recorded_time == dirent->mtime))
+        continue;
+
+      verification = apr_pcalloc(result_pool, sizeof(*verification));
+      verification->local_abspath = svn_dirent_join(local_abspath, item.key,
+                                                    result_pool);
+
+      SVN_ERR(svn_wc__text_compare_create(&verification->compare,
+                                          &verification->modified,
+                                          wb->db,
+                                          verification->local_abspath,
+                                          FALSE /* exact_comparison */,
+                                          result_pool, scratch_pool));
+      if (verification->compare)
+        SVN_ERR(svn_thread_pool__run(&verification->task,
+                                     wb->prefetch_group,
+                                     verify_text, verification));
+
+      svn_hash_sets(wb->verifications, verification->local_abspath,
+                    verification);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Release the resources held by PREFETCH, which must be registered in WB,
+   including its directory entries and PREFETCH itself. */
+static void
+release_prefetch(const struct walk_status_baton *wb,
+                 prefetch_t *prefetch)
+{
+  svn_hash_sets(wb->prefetched, prefetch->local_abspath, NULL);
+  svn_thread_pool__task_destroy(prefetch->task);
+  svn_pool_destroy(prefetch->pool);
+}
+
+/* Wait for all directory reads and text comparisons of WB to finish and
+   release them.  The prefetch_t structures themselves go away with WB's
+   PREFETCH_POOL. */
+static svn_error_t *
+release_all_prefetches(const struct walk_status_baton *wb,
+                       apr_pool_t *scratch_pool)
+{
+  apr_hash_index_t *hi;
+
+  if (!wb->prefetch_group)
+    return SVN_NO_ERROR;
+
+  for (hi = apr_hash_first(scratch_pool, wb->prefetched);
+       hi;
+       hi = apr_hash_next(hi))
+    svn_thread_pool__task_destroy(((prefetch_t *)apr_hash_this_val(hi))->task);
+
+  for (hi = apr_hash_first(scratch_pool, wb->verifications);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      verification_t *verification = apr_hash_this_val(hi);
+
+      if (verification->task)
+        svn_thread_pool__task_destroy(verification->task);
+    }
+
+  apr_hash_clear(wb->prefetched);
+  apr_hash_clear(wb->verifications);
+
+  return svn_error_trace(svn_thread_pool__group_wait(wb->prefetch_group));
+}
+
+/* Set *DIRENTS to the directory entries of LOCAL_ABSPATH as returned by
+   svn_io_get_dirents3(), or to an empty hash if that is not a directory.
+
+   If WB read LOCAL_ABSPATH ahead of time, take the entries from there and
+   set *PREFETCH to the respective entry, which the caller must release
+   with release_prefetch() once *DIRENTS is no longer needed.  Otherwise,
+   set *PREFETCH to NULL.
+
+   Allocate *DIRENTS in RESULT_POOL and use SCRATCH_POOL for temporary
+   allocations. */
+static svn_error_t *
+read_dirents(apr_hash_t **dirents,
+             prefetch_t **prefetch,
+             const struct walk_status_baton *wb,
+             const char *local_abspath,
+             apr_pool_t *result_pool,
+             apr_pool_t *scratch_pool)
+{
+  svn_error_t *err;
+
+  *prefetch = wb->prefetched ? svn_hash_gets(wb->prefetched, local_abspath)
+                             : NULL;
+  if (*prefetch)
+    {
+      err = svn_thread_pool__task_wait((*prefetch)->task);
+
+      /* The copy's values will still live in the task's pool. */
+      if (!err)
+        *dirents = apr_hash_copy(result_pool, (*prefetch)->dirents);
+    }
+  else
+    {
+      err = svn_io_get_dirents3(dirents, local_abspath,
+                                wb->ignore_text_mods /* only_check_type*/,
+                                result_pool, scratch_pool);
+    }
+
+  if (err
+      && (APR_STATUS_IS_ENOENT(err->apr_err)
+          || SVN__APR_STATUS_IS_ENOTDIR(err->apr_err)))
+    {
+      svn_error_clear(err);
+      *dirents = apr_hash_make(result_pool);
+    }
+  else
+    SVN_ERR(err);
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *DIRENTS to the directory entries that a directory containing the
+   children NODES has on disk if it matches the working copy DB, i.e. if
+   WB's change journal lists it as clean.  NODES maps basenames to
+   struct svn_wc__db_info_t *.  Allocate *DIRENTS in RESULT_POOL. */
+static void
+expected_dirents(apr_hash_t **dirents,
+                 apr_hash_t *nodes,
+                 apr_pool_t *result_pool)
+{
+  apr_hash_index_t *hi;
+
+  *dirents = apr_hash_make(result_pool);
+  for (hi = apr_hash_first(result_pool, nodes); hi; hi = apr_hash_next(hi))
+    {
+      const struct svn_wc__db_info_t *info = apr_hash_this_val(hi);
+      svn_io_dirent2_t *dirent;
+
+      /* Nodes in other states would have made the directory dirty. */
+      if (info->status != svn_wc__db_status_normal
+          && info->status != svn_wc__db_status_incomplete)
+        continue;
+
+      dirent = svn_io_dirent2_create(result_pool);
+      if (info->kind == svn_node_dir)
+        {
+          dirent->kind = svn_node_dir;
+        }
+      else
+        {
+          dirent->kind = svn_node_file;
+#ifdef HAVE_SYMLINK
+          dirent->special = info->special;
+#endif
+          dirent->filesize = info->recorded_size;
+          dirent->mtime = info->recorded_time;
+        }
+
+      apr_hash_set(*dirents, apr_hash_this_key(hi),
+                   apr_hash_this_key_len(hi), dirent);
+    }
+}
+
 static svn_error_t *
 get_dir_status(const struct walk_status_baton *wb,
                const char *local_abspath,
@@ -1233,8 +1657,11 @@ get_dir_status(const struct walk_status_baton *wb,
   apr_hash_t *dirents, *nodes, *conflicts, *all_children;
   apr_array_header_t *sorted_children;
   apr_array_header_t *collected_ignore_patterns = NULL;
+  prefetch_t *prefetch = NULL;
+  svn_boolean_t dir_is_clean;
   apr_pool_t *iterpool;
-  svn_error_t *err;
+  int next_prefetch = 0;
+  int next_verification = 0;
   int i;
 
   if (cancel_func)
@@ -1245,21 +1672,14 @@ get_dir_status(const struct walk_status_baton *wb,
 
   iterpool = svn_pool_create(scratch_pool);
 
-  if (wb->check_working_copy)
-    {
-      err = svn_io_get_dirents3(&dirents, local_abspath,
-                                wb->ignore_text_mods /* only_check_type*/,
-                                scratch_pool, iterpool);
-      if (err
-          && (APR_STATUS_IS_ENOENT(err->apr_err)
-              || SVN__APR_STATUS_IS_ENOTDIR(err->apr_err)))
-        {
-          svn_error_clear(err);
-          dirents = apr_hash_make(scratch_pool);
-        }
-      else
-        SVN_ERR(err);
-    }
+  /* A running watcher may tell us that reading the directory is pointless.
+     Its expected contents will be derived from the DB below. */
+  dir_is_clean = (wb->journal
+                  && svn_wc__journal_dir_is_clean(wb->journal, local_abspath));
+
+  if (wb->check_working_copy && !dir_is_clean)
+    SVN_ERR(read_dirents(&dirents, &prefetch, wb, local_abspath,
+                         scratch_pool, iterpool));
   else
     dirents = apr_hash_make(scratch_pool);
 
@@ -1283,6 +1703,9 @@ get_dir_status(const struct walk_status_baton *wb,
                                         !wb->check_working_copy,
                                         scratch_pool, iterpool));
 
+  if (wb->check_working_copy && dir_is_clean)
+    expected_dirents(&dirents, nodes, scratch_pool);
+
   all_children = apr_hash_overlay(scratch_pool, nodes, dirents);
   if (apr_hash_count(conflicts) > 0)
     all_children = apr_hash_overlay(scratch_pool, conflicts, all_children);
@@ -1334,7 +1757,12 @@ get_dir_status(const struct walk_status_baton *wb,
 
   /* If the requested depth is empty, we only need status on this-dir. */
   if (depth == svn_depth_empty)
-    return SVN_NO_ERROR;
+    {
+      if (prefetch)
+        release_prefetch(wb, prefetch);
+
+      return SVN_NO_ERROR;
+    }
 
   /* Walk all the children of this directory. */
   sorted_children = svn_sort__hash(all_children,
@@ -1351,6 +1779,17 @@ get_dir_status(const struct walk_status_baton *wb,
 
       svn_pool_clear(iterpool);
 
+      /* Let the worker threads read the next few sub-directories while we
+         are busy with the current child. */
+      SVN_ERR(start_prefetch(wb, local_abspath, sorted_children,
+                             &next_prefetch, i + wb->prefetch_ahead,
+                             nodes, depth, iterpool));
+
+      /* Keep the worker threads busy comparing the files ahead of us. */
+      SVN_ERR(start_verifications(wb, local_abspath, sorted_children,
+                                  &next_verification, i + wb->verify_ahead,
+                                  nodes, dirents, scratch_pool, iterpool));
+
       item = APR_ARRAY_IDX(sorted_children, i, svn_sort__item_t);
       key = item.key;
       klen = item.klen;
@@ -1381,6 +1820,9 @@ get_dir_status(const struct walk_status_baton *wb,
                                iterpool));
     }
 
+  if (prefetch)
+    release_prefetch(wb, prefetch);
+
   /* Destroy our subpools. */
   svn_pool_destroy(iterpool);
 
@@ -2513,6 +2955,13 @@ svn_wc__get_status_editor(const svn_delta_editor_t **editor,
   eb->wb.check_working_copy = check_working_copy;
   eb->wb.repos_locks      = NULL;
   eb->wb.repos_root       = NULL;
+  eb->wb.prefetch_group   = NULL;
+  eb->wb.prefetched       = NULL;
+  eb->wb.prefetch_pool    = NULL;
+  eb->wb.prefetch_ahead   = 0;
+  eb->wb.verifications    = NULL;
+  eb->wb.verify_ahead     = 0;
+  eb->wb.journal          = NULL;
 
   SVN_ERR(svn_wc__db_externals_defined_below(&eb->wb.externals,
                                              wc_ctx->db, eb->target_abspath,
@@ -2619,19 +3068,22 @@ stat_wc_dirent_case_sensitive(const svn_io_dirent2_t **dirent,
                                 result_pool, scratch_pool));
 }
 
-svn_error_t *
-svn_wc__internal_walk_status(svn_wc__db_t *db,
-                             const char *local_abspath,
-                             svn_depth_t depth,
-                             svn_boolean_t get_all,
-                             svn_boolean_t no_ignore,
-                             svn_boolean_t ignore_text_mods,
-                             const apr_array_header_t *ignore_patterns,
-                             svn_wc_status_func4_t status_func,
-                             void *status_baton,
-                             svn_cancel_func_t cancel_func,
-                             void *cancel_baton,
-                             apr_pool_t *scratch_pool)
+/* Implement svn_wc__internal_walk_status() and, if USE_JOURNAL is TRUE,
+   svn_wc__walk_status_journaled(). */
+static svn_error_t *
+walk_status(svn_wc__db_t *db,
+            const char *local_abspath,
+            svn_depth_t depth,
+            svn_boolean_t get_all,
+            svn_boolean_t no_ignore,
+            svn_boolean_t ignore_text_mods,
+            const apr_array_header_t *ignore_patterns,
+            svn_boolean_t use_journal,
+            svn_wc_status_func4_t status_func,
+            void *status_baton,
+            svn_cancel_func_t cancel_func,
+            void *cancel_baton,
+            apr_pool_t *scratch_pool)
 {
   struct walk_status_baton wb;
   const svn_io_dirent2_t *dirent;
@@ -2644,6 +3096,13 @@ svn_wc__internal_walk_status(svn_wc__db_t *db,
   wb.check_working_copy = TRUE;
   wb.repos_root = NULL;
   wb.repos_locks = NULL;
+  wb.prefetch_group = NULL;
+  wb.prefetched = NULL;
+  wb.prefetch_pool = NULL;
+  wb.prefetch_ahead = 0;
+  wb.verifications = NULL;
+  wb.verify_ahead = 0;
+  wb.journal = NULL;
 
   /* Use the caller-provided ignore patterns if provided; the build-time
      configured defaults otherwise. */
@@ -2690,19 +3149,53 @@ svn_wc__internal_walk_status(svn_wc__db_t *db,
       && info->status != svn_wc__db_status_excluded
       && info->status != svn_wc__db_status_server_excluded)
     {
-      SVN_ERR(get_dir_status(&wb,
-                             local_abspath,
-                             FALSE /* skip_root */,
-                             NULL, NULL, NULL,
-                             info,
-                             dirent,
-                             ignore_patterns,
-                             depth,
-                             get_all,
-                             no_ignore,
-                             status_func, status_baton,
-                             cancel_func, cancel_baton,
-                             scratch_pool));
+      int worker_threads = svn_wc__db_get_worker_threads(db);
+
+      /* Skip reading the directories that a watcher saw unchanged. */
+      if (use_journal && depth != svn_depth_empty)
+        {
+          const char *wcroot_abspath;
+          svn_wc__journal_t *journal;
+
+          SVN_ERR(svn_wc__db_get_wcroot(&wcroot_abspath, db, local_abspath,
+                                        scratch_pool, scratch_pool));
+          SVN_ERR(svn_wc__journal_open(&journal, wcroot_abspath,
+                                       scratch_pool, scratch_pool));
+          wb.journal = journal;
+        }
+
+      /* Directory reads and text comparisons may take a while, e.g. on
+         network file systems or after touching all files.  Let multiple
+         threads do them. */
+      if (worker_threads > 1)
+        {
+          SVN_ERR(svn_thread_pool__group_create(&wb.prefetch_group,
+                                                worker_threads,
+                                                scratch_pool));
+          wb.prefetched = apr_hash_make(scratch_pool);
+          wb.prefetch_pool = scratch_pool;
+          wb.prefetch_ahead = worker_threads;
+          wb.verifications = apr_hash_make(scratch_pool);
+          wb.verify_ahead = 4 * worker_threads;
+        }
+
+      err = get_dir_status(&wb,
+                           local_abspath,
+                           FALSE /* skip_root */,
+                           NULL, NULL, NULL,
+                           info,
+                           dirent,
+                           ignore_patterns,
+                           depth,
+                           get_all,
+                           no_ignore,
+                           status_func, status_baton,
+                           cancel_func, cancel_baton,
+                           scratch_pool);
+
+      /* Don't leave any worker behind, even in case of an error. */
+      SVN_ERR(svn_error_compose_create(
+                err, release_all_prefetches(&wb, scratch_pool)));
     }
   else
     {
@@ -2735,6 +3228,50 @@ svn_wc__internal_walk_status(svn_wc__db_t *db,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_wc__internal_walk_status(svn_wc__db_t *db,
+                             const char *local_abspath,
+                             svn_depth_t depth,
+                             svn_boolean_t get_all,
+                             svn_boolean_t no_ignore,
+                             svn_boolean_t ignore_text_mods,
+                             const apr_array_header_t *ignore_patterns,
+                             svn_wc_status_func4_t status_func,
+                             void *status_baton,
+                             svn_cancel_func_t cancel_func,
+                             void *cancel_baton,
+                             apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(walk_status(db, local_abspath, depth, get_all,
+                                     no_ignore, ignore_text_mods,
+                                     ignore_patterns, FALSE,
+                                     status_func, status_baton,
+                                     cancel_func, cancel_baton,
+                                     scratch_pool));
+}
+
+svn_error_t *
+svn_wc__walk_status_journaled(svn_wc_context_t *wc_ctx,
+                              const char *local_abspath,
+                              svn_depth_t depth,
+                              svn_boolean_t get_all,
+                              svn_boolean_t no_ignore,
+                              svn_boolean_t ignore_text_mods,
+                              const apr_array_header_t *ignore_patterns,
+                              svn_wc_status_func4_t status_func,
+                              void *status_baton,
+                              svn_cancel_func_t cancel_func,
+                              void *cancel_baton,
+                              apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(walk_status(wc_ctx->db, local_abspath, depth,
+                                     get_all, no_ignore, ignore_text_mods,
+                                     ignore_patterns, TRUE,
+                                     status_func, status_baton,
+                                     cancel_func, cancel_baton,
+                                     scratch_pool));
+}
+
 svn_error_t *
 svn_wc_walk_status(svn_wc_context_t *wc_ctx,
                    const char *local_abspath,
@@ -2901,6 +3438,7 @@ internal_status(svn_wc__internal_status_t **status,
                                          TRUE /* get_all */,
                                          FALSE, check_working_copy,
                                          NULL /* repos_lock */,
+                                         NULL /* text_modified */,
                                          result_pool, scratch_pool));
 }
 
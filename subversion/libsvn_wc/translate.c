@@ -46,6 +46,7 @@
 #include "translate.h"
 #include "props.h"
 
+#include "private/svn_io_private.h"
 #include "private/svn_wc_private.h"
 
 
@@ -167,6 +168,37 @@ svn_wc__internal_translated_file(const char **xlated_abspath,
       /* Translation would be a no-op, so return the original file. */
       *xlated_abspath = src_abspath;
     }
+  else if (! svn_subst_translation_required(style, eol, keywords, special,
+                                            TRUE))
+    {
+      /* A verbatim copy was requested. Copy file-to-file, so that the
+         file system may share the data blocks of both files. */
+      const char *tmp_dir;
+      apr_file_t *src_file;
+      apr_file_t *tmp_file;
+      const char *tmp_vfile;
+
+      if (flags & SVN_WC_TRANSLATE_USE_GLOBAL_TMP)
+        tmp_dir = NULL;
+      else
+        SVN_ERR(svn_wc__db_temp_wcroot_tempdir(&tmp_dir, db, versioned_abspath,
+                                               scratch_pool, scratch_pool));
+
+      SVN_ERR(svn_io_open_unique_file3(&tmp_file, &tmp_vfile, tmp_dir,
+                (flags & SVN_WC_TRANSLATE_NO_OUTPUT_CLEANUP)
+                  ? svn_io_file_del_none
+                  : svn_io_file_del_on_pool_cleanup,
+                result_pool, scratch_pool));
+      SVN_ERR(svn_io_file_open(&src_file, src_abspath, APR_READ,
+                               APR_OS_DEFAULT, scratch_pool));
+      SVN_ERR(svn_io__file_copy_contents(tmp_file, src_file,
+                                         cancel_func, cancel_baton,
+                                         scratch_pool));
+      SVN_ERR(svn_io_file_close(src_file, scratch_pool));
+      SVN_ERR(svn_io_file_close(tmp_file, scratch_pool));
+
+      *xlated_abspath = tmp_vfile;
+    }
   else  /* some translation (or copying) is necessary */
     {
       const char *tmp_dir;
@@ -261,9 +261,17 @@ struct edit_baton
   /* After closing the root directory a copy of its edited value */
   svn_boolean_t edited;
 
+  /* BASE nodes completed by close_directory() and close_file() that have
+     not been written to the DB yet.  See flush_batch(). */
+  svn_wc__db_base_batch_t *batch;
+
   apr_pool_t *pool;
 };
 
+/* The number of nodes that may wait in the batch of an edit baton before
+   they get written to the DB. */
+#define UPDATE_BATCH_SIZE 1000
+
 
 /* Record in the edit baton EB that LOCAL_ABSPATH's base version is not being
  * updated.
@@ -490,6 +498,31 @@ cleanup_edit_baton(void *edit_baton)
   return APR_SUCCESS;
 }
 
+/* Write the nodes waiting in EB's batch to the DB in a single transaction.
+   If RUN_QUEUE is TRUE, also run the work queue to install their working
+   files.
+
+   Nodes get collected rather than written one by one, to avoid a DB
+   transaction per node when adding many nodes.  Their work items get
+   queued only when they are written, so until then a crash leaves their
+   parent directories incomplete, just like an interrupted edit would.
+   Anything that needs to see the DB state after a node got completed has
+   to flush the batch first.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+flush_batch(struct edit_baton *eb,
+            svn_boolean_t run_queue,
+            apr_pool_t *scratch_pool)
+{
+  SVN_ERR(svn_wc__db_base_batch_flush(eb->batch, scratch_pool));
+
+  if (run_queue)
+    SVN_ERR(svn_wc__wq_run(eb->db, eb->wcroot_abspath,
+                           eb->cancel_func, eb->cancel_baton,
+                           scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Calculate the new repos_relpath for a directory or file */
 static svn_error_t *
 calculate_repos_relpath(const char **new_repos_relpath,
@@ -2597,6 +2630,9 @@ close_directory(void *dir_baton,
         apr_hash_index_t *hi;
         apr_pool_t *iterpool = svn_pool_create(scratch_pool);
 
+        /* The children we completed must be visible below. */
+        SVN_ERR(flush_batch(eb, FALSE, scratch_pool));
+
         for (hi = apr_hash_first(scratch_pool, new_children);
              hi;
              hi = apr_hash_next(hi))
@@ -2796,29 +2832,52 @@ close_directory(void *dir_baton,
 
       /* Update the BASE data for the directory and mark the directory
          complete */
-      SVN_ERR(svn_wc__db_base_add_directory(
-                eb->db, db->local_abspath,
-                eb->wcroot_abspath,
-                db->new_repos_relpath,
-                eb->repos_root, eb->repos_uuid,
-                *eb->target_revision,
-                props,
-                db->changed_rev, db->changed_date, db->changed_author,
-                NULL /* children */,
-                db->ambient_depth,
-                (dav_prop_changes->nelts > 0)
-                    ? svn_prop_array_to_hash(dav_prop_changes, pool)
-                    : NULL,
-                (! db->shadowed) && new_base_props != NULL,
-                new_actual_props, iprops,
-                conflict_skel, all_work_items,
-                scratch_pool));
+      if (conflict_skel)
+        {
+          /* The resolver below needs to see the whole directory. */
+          SVN_ERR(flush_batch(eb, FALSE, scratch_pool));
+          SVN_ERR(svn_wc__db_base_add_directory(
+                    eb->db, db->local_abspath,
+                    eb->wcroot_abspath,
+                    db->new_repos_relpath,
+                    eb->repos_root, eb->repos_uuid,
+                    *eb->target_revision,
+                    props,
+                    db->changed_rev, db->changed_date, db->changed_author,
+                    NULL /* children */,
+                    db->ambient_depth,
+                    (dav_prop_changes->nelts > 0)
+                        ? svn_prop_array_to_hash(dav_prop_changes, pool)
+                        : NULL,
+                    (! db->shadowed) && new_base_props != NULL,
+                    new_actual_props, iprops,
+                    conflict_skel, all_work_items,
+                    scratch_pool));
+        }
+      else
+        {
+          SVN_ERR(svn_wc__db_base_batch_add_directory(
+                    eb->batch, db->local_abspath,
+                    db->new_repos_relpath,
+                    *eb->target_revision,
+                    props,
+                    db->changed_rev, db->changed_date, db->changed_author,
+                    db->ambient_depth,
+                    (dav_prop_changes->nelts > 0)
+                        ? svn_prop_array_to_hash(dav_prop_changes, pool)
+                        : NULL,
+                    (! db->shadowed) && new_base_props != NULL,
+                    new_actual_props, iprops,
+                    all_work_items,
+                    scratch_pool));
+        }
     }
 
-  /* Process all of the queued work items for this directory.  */
-  SVN_ERR(svn_wc__wq_run(eb->db, db->local_abspath,
-                         eb->cancel_func, eb->cancel_baton,
-                         scratch_pool));
+  /* Process all of the queued work items, once enough nodes are waiting
+     or someone needs to see this directory in its final state.  */
+  if (conflict_skel
+      || svn_wc__db_base_batch_count(eb->batch) >= UPDATE_BATCH_SIZE)
+    SVN_ERR(flush_batch(eb, TRUE, scratch_pool));
 
   if (db->parent_baton)
     svn_hash_sets(db->parent_baton->not_present_nodes, db->name, NULL);
@@ -4558,30 +4617,63 @@ close_file(void *file_baton,
         svn_hash_sets(eb->wcroot_iprops, fb->local_abspath, NULL);
     }
 
-  SVN_ERR(svn_wc__db_base_add_file(eb->db, fb->local_abspath,
-                                   eb->wcroot_abspath,
-                                   fb->new_repos_relpath,
-                                   eb->repos_root, eb->repos_uuid,
-                                   *eb->target_revision,
-                                   new_base_props,
-                                   fb->changed_rev,
-                                   fb->changed_date,
-                                   fb->changed_author,
-                                   new_checksum,
-                                   (dav_prop_changes->nelts > 0)
-                                     ? svn_prop_array_to_hash(
-                                                      dav_prop_changes,
-                                                      scratch_pool)
-                                     : NULL,
-                                   (fb->add_existed && fb->adding_file),
-                                   (! fb->shadowed) && new_base_props,
-                                   new_actual_props,
-                                   iprops,
-                                   keep_recorded_info,
-                                   (fb->shadowed && fb->obstruction_found),
-                                   conflict_skel,
-                                   all_work_items,
-                                   scratch_pool));
+  if (conflict_skel)
+    {
+      /* The resolver needs to see this file in the DB. */
+      SVN_ERR(flush_batch(eb, FALSE, scratch_pool));
+      SVN_ERR(svn_wc__db_base_add_file(eb->db, fb->local_abspath,
+                                       eb->wcroot_abspath,
+                                       fb->new_repos_relpath,
+                                       eb->repos_root, eb->repos_uuid,
+                                       *eb->target_revision,
+                                       new_base_props,
+                                       fb->changed_rev,
+                                       fb->changed_date,
+                                       fb->changed_author,
+                                       new_checksum,
+                                       (dav_prop_changes->nelts > 0)
+                                         ? svn_prop_array_to_hash(
+                                                          dav_prop_changes,
+                                                          scratch_pool)
+                                         : NULL,
+                                       (fb->add_existed && fb->adding_file),
+                                       (! fb->shadowed) && new_base_props,
+                                       new_actual_props,
+                                       iprops,
+                                       keep_recorded_info,
+                                       (fb->shadowed
+                                        && fb->obstruction_found),
+                                       conflict_skel,
+                                       all_work_items,
+                                       scratch_pool));
+    }
+  else
+    {
+      SVN_ERR(svn_wc__db_base_batch_add_file(eb->batch, fb->local_abspath,
+                                             fb->new_repos_relpath,
+                                             *eb->target_revision,
+                                             new_base_props,
+                                             fb->changed_rev,
+                                             fb->changed_date,
+                                             fb->changed_author,
+                                             new_checksum,
+                                             (dav_prop_changes->nelts > 0)
+                                               ? svn_prop_array_to_hash(
+                                                          dav_prop_changes,
+                                                          scratch_pool)
+                                               : NULL,
+                                             (fb->add_existed
+                                              && fb->adding_file),
+                                             (! fb->shadowed)
+                                               && new_base_props,
+                                             new_actual_props,
+                                             iprops,
+                                             keep_recorded_info,
+                                             (fb->shadowed
+                                              && fb->obstruction_found),
+                                             all_work_items,
+                                             scratch_pool));
+    }
 
   if (conflict_skel && eb->conflict_func)
     SVN_ERR(svn_wc__conflict_invoke_resolver(eb->db, fb->local_abspath,
@@ -4735,6 +4827,9 @@ close_edit(void *edit_baton,
   struct edit_baton *eb = edit_baton;
   apr_pool_t *scratch_pool = eb->pool;
 
+  /* Everything below operates on the final state of the edited nodes. */
+  SVN_ERR(flush_batch(eb, FALSE, scratch_pool));
+
   /* The editor didn't even open the root; we have to take care of
      some cleanup stuffs. */
   if (! eb->root_opened
@@ -4946,6 +5041,9 @@ make_editor(svn_revnum_t *target_revision,
 
   SVN_ERR(svn_wc__db_get_wcroot(&eb->wcroot_abspath, db, anchor_abspath,
                                 edit_pool, scratch_pool));
+  SVN_ERR(svn_wc__db_base_batch_create(&eb->batch, db, eb->wcroot_abspath,
+                                       repos_root, repos_uuid,
+                                       edit_pool, scratch_pool));
 
   if (switch_url)
     eb->switch_repos_relpath =
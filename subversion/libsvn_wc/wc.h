@@ -349,6 +349,46 @@ svn_wc__internal_file_modified_p(svn_boolean_t *modified_p,
                                  svn_boolean_t exact_comparison,
                                  apr_pool_t *scratch_pool);
 
+/* The phases of svn_wc__internal_file_modified_p(), for callers that want
+ * to compare the contents of multiple files concurrently.
+ *
+ * Only svn_wc__text_compare_run() reads file contents.  It does not access
+ * the DB and may be called from any thread.  The other two functions must
+ * be called from the thread that owns DB.
+ */
+typedef struct svn_wc__text_compare_t svn_wc__text_compare_t;
+
+/* Do the cheap checks of svn_wc__internal_file_modified_p() for
+ * LOCAL_ABSPATH in DB.  If they are conclusive, set *MODIFIED_P and set
+ * *COMPARE to NULL.  Otherwise, set *COMPARE to a description of the
+ * contents comparison still to do, allocated in RESULT_POOL.  Use
+ * SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_wc__text_compare_create(svn_wc__text_compare_t **compare,
+                            svn_boolean_t *modified_p,
+                            svn_wc__db_t *db,
+                            const char *local_abspath,
+                            svn_boolean_t exact_comparison,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool);
+
+/* Compare the file contents as described by COMPARE and set *MODIFIED_P
+ * accordingly.  Return SVN_ERR_WC_PATH_ACCESS_DENIED if the working file
+ * can't be read.  Use SCRATCH_POOL for all allocations. */
+svn_error_t *
+svn_wc__text_compare_run(svn_boolean_t *modified_p,
+                         const svn_wc__text_compare_t *compare,
+                         apr_pool_t *scratch_pool);
+
+/* Do the "timestamp repair" of svn_wc__internal_file_modified_p() in DB
+ * for the file described by COMPARE, if MODIFIED is FALSE.  Use
+ * SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_wc__text_compare_finish(svn_wc__db_t *db,
+                            const svn_wc__text_compare_t *compare,
+                            svn_boolean_t modified,
+                            apr_pool_t *scratch_pool);
+
 
 /* Prepare to merge a file content change into the working copy.
 
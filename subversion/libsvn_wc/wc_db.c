@@ -1840,6 +1840,296 @@ svn_wc__db_base_add_file(svn_wc__db_t *db,
 }
 
 
+/* A node waiting in a svn_wc__db_base_batch_t. */
+typedef struct batch_node_t
+{
+  const char *local_abspath;
+  const char *local_relpath;
+  insert_base_baton_t ibb;
+} batch_node_t;
+
+struct svn_wc__db_base_batch_t
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *repos_root_url;
+  const char *repos_uuid;
+
+  /* The batch_node_t * to insert, allocated in POOL. */
+  apr_array_header_t *nodes;
+  apr_pool_t *pool;
+};
+
+svn_error_t *
+svn_wc__db_base_batch_create(svn_wc__db_base_batch_t **batch,
+                             svn_wc__db_t *db,
+                             const char *wri_abspath,
+                             const char *repos_root_url,
+                             const char *repos_uuid,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool)
+{
+  svn_wc__db_base_batch_t *new_batch = apr_pcalloc(result_pool,
+                                                   sizeof(*new_batch));
+  const char *local_relpath;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+  SVN_ERR_ASSERT(svn_uri_is_canonical(repos_root_url, scratch_pool));
+  SVN_ERR_ASSERT(repos_uuid != NULL);
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&new_batch->wcroot,
+                                                &local_relpath, db,
+                                                wri_abspath,
+                                                result_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(new_batch->wcroot);
+
+  new_batch->repos_root_url = apr_pstrdup(result_pool, repos_root_url);
+  new_batch->repos_uuid = apr_pstrdup(result_pool, repos_uuid);
+  new_batch->pool = svn_pool_create(result_pool);
+  new_batch->nodes = apr_array_make(new_batch->pool, 16,
+                                    sizeof(batch_node_t *));
+
+  *batch = new_batch;
+  return SVN_NO_ERROR;
+}
+
+/* Return a deep copy of the depth-first ordered array of
+   svn_prop_inherited_item_t * IPROPS, allocated in RESULT_POOL. */
+static apr_array_header_t *
+iprops_dup(const apr_array_header_t *iprops,
+           apr_pool_t *result_pool)
+{
+  apr_array_header_t *dup;
+  int i;
+
+  if (!iprops)
+    return NULL;
+
+  dup = apr_array_make(result_pool, iprops->nelts,
+                       sizeof(svn_prop_inherited_item_t *));
+  for (i = 0; i < iprops->nelts; i++)
+    {
+      const svn_prop_inherited_item_t *iprop
+        = APR_ARRAY_IDX(iprops, i, svn_prop_inherited_item_t *);
+      svn_prop_inherited_item_t *iprop_dup
+        = apr_palloc(result_pool, sizeof(*iprop_dup));
+
+      iprop_dup->path_or_url = apr_pstrdup(result_pool, iprop->path_or_url);
+      iprop_dup->prop_hash = svn_prop_hash_dup(iprop->prop_hash,
+                                               result_pool);
+      APR_ARRAY_PUSH(dup, svn_prop_inherited_item_t *) = iprop_dup;
+    }
+
+  return dup;
+}
+
+/* Add a node for LOCAL_ABSPATH to BATCH and return its blank insert
+   baton, with the properties common to all nodes copied from the
+   arguments.  */
+static svn_error_t *
+batch_add_node(insert_base_baton_t **ibb,
+               svn_wc__db_base_batch_t *batch,
+               const char *local_abspath,
+               svn_node_kind_t kind,
+               const char *repos_relpath,
+               svn_revnum_t revision,
+               const apr_hash_t *props,
+               svn_revnum_t changed_rev,
+               apr_time_t changed_date,
+               const char *changed_author,
+               apr_hash_t *dav_cache,
+               svn_boolean_t update_actual_props,
+               apr_hash_t *new_actual_props,
+               apr_array_header_t *new_iprops,
+               const svn_skel_t *work_items)
+{
+  apr_pool_t *pool = batch->pool;
+  batch_node_t *node = apr_pcalloc(pool, sizeof(*node));
+  const char *local_relpath;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
+  SVN_ERR_ASSERT(repos_relpath != NULL);
+  SVN_ERR_ASSERT(SVN_IS_VALID_REVNUM(revision));
+  SVN_ERR_ASSERT(props != NULL);
+  SVN_ERR_ASSERT(SVN_IS_VALID_REVNUM(changed_rev));
+
+  local_relpath = svn_dirent_skip_ancestor(batch->wcroot->abspath,
+                                           local_abspath);
+  SVN_ERR_ASSERT(local_relpath != NULL);
+
+  node->local_abspath = apr_pstrdup(pool, local_abspath);
+  node->local_relpath = apr_pstrdup(pool, local_relpath);
+
+  blank_ibb(&node->ibb);
+
+  node->ibb.repos_root_url = batch->repos_root_url;
+  node->ibb.repos_uuid = batch->repos_uuid;
+
+  node->ibb.status = svn_wc__db_status_normal;
+  node->ibb.kind = kind;
+  node->ibb.repos_relpath = apr_pstrdup(pool, repos_relpath);
+  node->ibb.revision = revision;
+
+  node->ibb.props = svn_prop_hash_dup(props, pool);
+  node->ibb.changed_rev = changed_rev;
+  node->ibb.changed_date = changed_date;
+  node->ibb.changed_author = apr_pstrdup(pool, changed_author);
+
+  if (dav_cache)
+    node->ibb.dav_cache = svn_prop_hash_dup(dav_cache, pool);
+  node->ibb.iprops = iprops_dup(new_iprops, pool);
+
+  if (update_actual_props)
+    {
+      node->ibb.update_actual_props = TRUE;
+      if (new_actual_props)
+        node->ibb.new_actual_props = svn_prop_hash_dup(new_actual_props,
+                                                       pool);
+    }
+
+  if (work_items)
+    node->ibb.work_items = svn_skel__dup(work_items, TRUE, pool);
+
+  APR_ARRAY_PUSH(batch->nodes, batch_node_t *) = node;
+
+  *ibb = &node->ibb;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__db_base_batch_add_directory(svn_wc__db_base_batch_t *batch,
+                                    const char *local_abspath,
+                                    const char *repos_relpath,
+                                    svn_revnum_t revision,
+                                    const apr_hash_t *props,
+                                    svn_revnum_t changed_rev,
+                                    apr_time_t changed_date,
+                                    const char *changed_author,
+                                    svn_depth_t depth,
+                                    apr_hash_t *dav_cache,
+                                    svn_boolean_t update_actual_props,
+                                    apr_hash_t *new_actual_props,
+                                    apr_array_header_t *new_iprops,
+                                    const svn_skel_t *work_items,
+                                    apr_pool_t *scratch_pool)
+{
+  insert_base_baton_t *ibb;
+
+  SVN_ERR(batch_add_node(&ibb, batch, local_abspath, svn_node_dir,
+                         repos_relpath, revision, props,
+                         changed_rev, changed_date, changed_author,
+                         dav_cache, update_actual_props, new_actual_props,
+                         new_iprops, work_items));
+  ibb->depth = depth;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__db_base_batch_add_file(svn_wc__db_base_batch_t *batch,
+                               const char *local_abspath,
+                               const char *repos_relpath,
+                               svn_revnum_t revision,
+                               const apr_hash_t *props,
+                               svn_revnum_t changed_rev,
+                               apr_time_t changed_date,
+                               const char *changed_author,
+                               const svn_checksum_t *checksum,
+                               apr_hash_t *dav_cache,
+                               svn_boolean_t delete_working,
+                               svn_boolean_t update_actual_props,
+                               apr_hash_t *new_actual_props,
+                               apr_array_header_t *new_iprops,
+                               svn_boolean_t keep_recorded_info,
+                               svn_boolean_t insert_base_deleted,
+                               const svn_skel_t *work_items,
+                               apr_pool_t *scratch_pool)
+{
+  insert_base_baton_t *ibb;
+
+  SVN_ERR_ASSERT(checksum != NULL);
+
+  SVN_ERR(batch_add_node(&ibb, batch, local_abspath, svn_node_file,
+                         repos_relpath, revision, props,
+                         changed_rev, changed_date, changed_author,
+                         dav_cache, update_actual_props, new_actual_props,
+                         new_iprops, work_items));
+  ibb->checksum = svn_checksum_dup(checksum, batch->pool);
+  ibb->keep_recorded_info = keep_recorded_info;
+  ibb->insert_base_deleted = insert_base_deleted;
+  ibb->delete_working = delete_working;
+
+  return SVN_NO_ERROR;
+}
+
+int
+svn_wc__db_base_batch_count(const svn_wc__db_base_batch_t *batch)
+{
+  return batch->nodes->nelts;
+}
+
+/* The body of svn_wc__db_base_batch_flush(). */
+static svn_error_t *
+base_batch_flush_txn(svn_wc__db_base_batch_t *batch,
+                     apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_int64_t repos_id;
+  int i;
+
+  /* All nodes share the same repository. */
+  SVN_ERR(create_repos_id(&repos_id, batch->repos_root_url,
+                          batch->repos_uuid, batch->wcroot->sdb,
+                          scratch_pool));
+
+  for (i = 0; i < batch->nodes->nelts; i++)
+    {
+      batch_node_t *node = APR_ARRAY_IDX(batch->nodes, i, batch_node_t *);
+
+      svn_pool_clear(iterpool);
+
+      node->ibb.repos_id = repos_id;
+      SVN_ERR(insert_base_node(&node->ibb, batch->wcroot,
+                               node->local_relpath, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__db_base_batch_flush(svn_wc__db_base_batch_t *batch,
+                            apr_pool_t *scratch_pool)
+{
+  svn_error_t *err = SVN_NO_ERROR;
+  int i;
+
+  if (batch->nodes->nelts == 0)
+    return SVN_NO_ERROR;
+
+  /* The statements used by insert_base_node() stay prepared in the
+     wcroot's sdb, so each of them gets compiled only once as well. */
+  SVN_WC__DB_WITH_TXN(base_batch_flush_txn(batch, scratch_pool),
+                      batch->wcroot);
+
+  for (i = 0; i < batch->nodes->nelts && !err; i++)
+    {
+      batch_node_t *node = APR_ARRAY_IDX(batch->nodes, i, batch_node_t *);
+
+      /* If a file used to be a directory we should remove children so pass
+       * depth infinity. */
+      err = flush_entries(batch->wcroot, node->local_abspath,
+                          node->ibb.kind == svn_node_dir
+                            ? node->ibb.depth : svn_depth_infinity,
+                          scratch_pool);
+    }
+
+  svn_pool_clear(batch->pool);
+  batch->nodes = apr_array_make(batch->pool, 16, sizeof(batch_node_t *));
+
+  return svn_error_trace(err);
+}
+
+
 svn_error_t *
 svn_wc__db_base_add_symlink(svn_wc__db_t *db,
                             const char *local_abspath,
@@ -13597,6 +13887,97 @@ svn_wc__db_wq_record_and_fetch_next(apr_uint64_t *id,
 }
 
 
+/* The body of svn_wc__db_wq_record_and_fetch_batch() except for the
+   recording of timestamps and sizes. */
+static svn_error_t *
+wq_fetch_batch(apr_array_header_t **ids,
+               apr_array_header_t **work_items,
+               svn_wc__db_wcroot_t *wcroot,
+               const apr_array_header_t *completed_ids,
+               int max_items,
+               apr_pool_t *result_pool,
+               apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  int i;
+
+  if (completed_ids && completed_ids->nelts)
+    {
+      SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                        STMT_DELETE_WORK_ITEM));
+      for (i = 0; i < completed_ids->nelts; i++)
+        {
+          SVN_ERR(svn_sqlite__bind_int64(stmt, 1,
+                                         APR_ARRAY_IDX(completed_ids, i,
+                                                       apr_uint64_t)));
+          SVN_ERR(svn_sqlite__step_done(stmt));
+        }
+    }
+
+  if (max_items == 0)
+    {
+      *ids = NULL;
+      *work_items = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  *ids = apr_array_make(result_pool, max_items, sizeof(apr_uint64_t));
+  *work_items = apr_array_make(result_pool, max_items, sizeof(svn_skel_t *));
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_WORK_ITEMS));
+  SVN_ERR(svn_sqlite__bind_int(stmt, 1, max_items));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+
+  while (have_row)
+    {
+      apr_size_t len;
+      const void *val;
+
+      APR_ARRAY_PUSH(*ids, apr_uint64_t) = svn_sqlite__column_int64(stmt, 0);
+
+      val = svn_sqlite__column_blob(stmt, 1, &len, result_pool);
+      APR_ARRAY_PUSH(*work_items, svn_skel_t *)
+        = svn_skel__parse(val, len, result_pool);
+
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    }
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+svn_error_t *
+svn_wc__db_wq_record_and_fetch_batch(apr_array_header_t **ids,
+                                     apr_array_header_t **work_items,
+                                     svn_wc__db_t *db,
+                                     const char *wri_abspath,
+                                     const apr_array_header_t *completed_ids,
+                                     apr_hash_t *record_map,
+                                     int max_items,
+                                     apr_pool_t *result_pool,
+                                     apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              wri_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  SVN_WC__DB_WITH_TXN(
+    svn_error_compose_create(
+            wq_fetch_batch(ids, work_items, wcroot, completed_ids,
+                           max_items, result_pool, scratch_pool),
+            record_map ? wq_record(wcroot, record_map, scratch_pool)
+                       : SVN_NO_ERROR),
+    wcroot);
+
+  return SVN_NO_ERROR;
+}
+
 
 /* ### temporary API. remove before release.  */
 svn_error_t *
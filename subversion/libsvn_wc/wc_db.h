@@ -268,6 +268,22 @@ svn_wc__db_open(svn_wc__db_t **db,
 svn_error_t *
 svn_wc__db_close(svn_wc__db_t *db);
 
+/* Return the maximum number of threads that may access working copy
+   files concurrently on behalf of DB, as configured by
+   SVN_CONFIG_OPTION_WC_WORKER_THREADS.  The result is at least 1.  */
+int
+svn_wc__db_get_worker_threads(svn_wc__db_t *db);
+
+/* Start a new epoch for DB, which is going to be used for many operations
+   over a long time.  Working copies that DB already knows about will be
+   verified once per epoch, when they are first used: if their database
+   file got replaced, upgraded or removed in the meantime, DB forgets about
+   them and locates them again.  Other directories are checked for having
+   become working copies of their own when they are first used, and the
+   cached node kinds are invalidated. */
+void
+svn_wc__db_start_epoch(svn_wc__db_t *db);
+
 
 /* Initialize the SDB for LOCAL_ABSPATH, which should be a working copy path.
 
@@ -530,6 +546,86 @@ svn_wc__db_base_add_file(svn_wc__db_t *db,
                          apr_pool_t *scratch_pool);
 
 
+/* A set of BASE nodes waiting to be written to a working copy DB in a
+   single transaction.
+
+   Writing each node in a transaction of its own makes SQLite sync the DB
+   file for every node.  An editor that adds many nodes, like a checkout,
+   can instead collect them in a batch and write them all at once.  Until
+   the batch got flushed, the DB does not know about the nodes in it and
+   their work items are not queued.  */
+typedef struct svn_wc__db_base_batch_t svn_wc__db_base_batch_t;
+
+/* Set *BATCH to a new, empty batch for the working copy containing
+   WRI_ABSPATH in DB.  All nodes added to it belong to the repository
+   identified by REPOS_ROOT_URL and REPOS_UUID.
+
+   Allocate *BATCH in RESULT_POOL and use SCRATCH_POOL for temporary
+   allocations. */
+svn_error_t *
+svn_wc__db_base_batch_create(svn_wc__db_base_batch_t **batch,
+                             svn_wc__db_t *db,
+                             const char *wri_abspath,
+                             const char *repos_root_url,
+                             const char *repos_uuid,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool);
+
+/* Like svn_wc__db_base_add_directory() without children or a conflict,
+   but only add the directory to BATCH.  All arguments get copied. */
+svn_error_t *
+svn_wc__db_base_batch_add_directory(svn_wc__db_base_batch_t *batch,
+                                    const char *local_abspath,
+                                    const char *repos_relpath,
+                                    svn_revnum_t revision,
+                                    const apr_hash_t *props,
+                                    svn_revnum_t changed_rev,
+                                    apr_time_t changed_date,
+                                    const char *changed_author,
+                                    svn_depth_t depth,
+                                    apr_hash_t *dav_cache,
+                                    svn_boolean_t update_actual_props,
+                                    apr_hash_t *new_actual_props,
+                                    apr_array_header_t *new_iprops,
+                                    const svn_skel_t *work_items,
+                                    apr_pool_t *scratch_pool);
+
+/* Like svn_wc__db_base_add_file() without a conflict, but only add the
+   file to BATCH.  All arguments get copied. */
+svn_error_t *
+svn_wc__db_base_batch_add_file(svn_wc__db_base_batch_t *batch,
+                               const char *local_abspath,
+                               const char *repos_relpath,
+                               svn_revnum_t revision,
+                               const apr_hash_t *props,
+                               svn_revnum_t changed_rev,
+                               apr_time_t changed_date,
+                               const char *changed_author,
+                               const svn_checksum_t *checksum,
+                               apr_hash_t *dav_cache,
+                               svn_boolean_t delete_working,
+                               svn_boolean_t update_actual_props,
+                               apr_hash_t *new_actual_props,
+                               apr_array_header_t *new_iprops,
+                               svn_boolean_t keep_recorded_info,
+                               svn_boolean_t insert_base_deleted,
+                               const svn_skel_t *work_items,
+                               apr_pool_t *scratch_pool);
+
+/* Return the number of nodes in BATCH. */
+int
+svn_wc__db_base_batch_count(const svn_wc__db_base_batch_t *batch);
+
+/* Write all nodes in BATCH to the DB in a single transaction, in the
+   order they were added, and empty BATCH.  On error, none of them got
+   written.
+
+   Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_wc__db_base_batch_flush(svn_wc__db_base_batch_t *batch,
+                            apr_pool_t *scratch_pool);
+
+
 /* Add or replace a symlink in the BASE tree.
 
    The symlink is located at LOCAL_ABSPATH on the local filesystem, and
@@ -3028,6 +3124,27 @@ svn_wc__db_wq_record_and_fetch_next(apr_uint64_t *id,
                                     apr_pool_t *result_pool,
                                     apr_pool_t *scratch_pool);
 
+/* Variant of svn_wc__db_wq_record_and_fetch_next() for executing work
+   items in batches.  In a single transaction, mark the work items
+   COMPLETED_IDS (an array of apr_uint64_t) as completed, record the
+   timestamps and sizes in RECORD_MAP (which may be NULL) and fetch up to
+   MAX_ITEMS of the next work items in queue order.
+
+   Set *IDS to an array of the apr_uint64_t identifiers of the fetched
+   items and *WORK_ITEMS to an array of the corresponding svn_skel_t *,
+   both allocated in RESULT_POOL.  If MAX_ITEMS is 0, fetch nothing and
+   set both to NULL. */
+svn_error_t *
+svn_wc__db_wq_record_and_fetch_batch(apr_array_header_t **ids,
+                                     apr_array_header_t **work_items,
+                                     svn_wc__db_t *db,
+                                     const char *wri_abspath,
+                                     const apr_array_header_t *completed_ids,
+                                     apr_hash_t *record_map,
+                                     int max_items,
+                                     apr_pool_t *result_pool,
+                                     apr_pool_t *scratch_pool);
+
 
 /* @} */
 
@@ -39,7 +39,29 @@
 #define PRISTINE_STORAGE_EXT ".svn-base"
 #define PRISTINE_STORAGE_RELPATH "pristine"
 #define PRISTINE_TEMPDIR_RELPATH "tmp"
+#define SHARED_PRISTINE_MD5_EXT ".md5"
 
+/* If SVN_CONFIG_OPTION_WC_SHARED_PRISTINE_STORE is set, pristine texts are
+ * also kept in that directory, using the same layout as the pristine store
+ * of a working copy.  Next to each text, a file with the additional
+ * extension SHARED_PRISTINE_MD5_EXT holds its MD-5 checksum, which working
+ * copies record along with the text.
+ *
+ * Working copies hard-link shared texts into their own store, so the
+ * link count of a shared text is its reference count: once only the
+ * shared store links to it, no working copy uses it anymore and it can be
+ * removed.  Pristine files are read-only and never modified in place, so
+ * sharing their inode is safe.
+ *
+ * Anybody who can write to the shared store could plant a text under a
+ * wrong name, and hard links share the owner and permissions of the
+ * original.  A working copy therefore only keeps a link if the linked file
+ * is owned by the current user and matches the expected checksums, i.e.
+ * the store is effectively shared by the working copies of a single user.
+ *
+ * The shared store is merely a cache.  Failures to use it are ignored and
+ * the working copy's own store gets used as if it was not configured.
+ */
 
 
 /* Returns in PRISTINE_ABSPATH a new string allocated from RESULT_POOL,
@@ -54,24 +76,20 @@ get_pristine_fname(const char **pristine_abspath,
                    const char *wcroot_abspath,
                    const svn_checksum_t *sha1_checksum,
                    apr_pool_t *result_pool,
-                   apr_pool_t *scratch_pool)
+                   apr_pool_t *scratch_pool);
+
+/* Like get_pristine_fname(), but for the pristine store located in the
+   directory BASE_DIR_ABSPATH. */
+static svn_error_t *
+get_pristine_fname_in(const char **pristine_abspath,
+                      const char *base_dir_abspath,
+                      const svn_checksum_t *sha1_checksum,
+                      apr_pool_t *result_pool,
+                      apr_pool_t *scratch_pool)
 {
-  const char *base_dir_abspath;
   const char *hexdigest = svn_checksum_to_cstring(sha1_checksum, scratch_pool);
   char subdir[3];
 
-  /* ### code is in transition. make sure we have the proper data.  */
-  SVN_ERR_ASSERT(pristine_abspath != NULL);
-  SVN_ERR_ASSERT(svn_dirent_is_absolute(wcroot_abspath));
-  SVN_ERR_ASSERT(sha1_checksum != NULL);
-  SVN_ERR_ASSERT(sha1_checksum->kind == svn_checksum_sha1);
-
-  base_dir_abspath = svn_dirent_join_many(scratch_pool,
-                                          wcroot_abspath,
-                                          svn_wc_get_adm_dir(scratch_pool),
-                                          PRISTINE_STORAGE_RELPATH,
-                                          SVN_VA_NULL);
-
   /* We should have a valid checksum and (thus) a valid digest. */
   SVN_ERR_ASSERT(hexdigest != NULL);
 
@@ -92,6 +110,395 @@ get_pristine_fname(const char **pristine_abspath,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+get_pristine_fname(const char **pristine_abspath,
+                   const char *wcroot_abspath,
+                   const svn_checksum_t *sha1_checksum,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  const char *base_dir_abspath;
+
+  /* ### code is in transition. make sure we have the proper data.  */
+  SVN_ERR_ASSERT(pristine_abspath != NULL);
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wcroot_abspath));
+  SVN_ERR_ASSERT(sha1_checksum != NULL);
+  SVN_ERR_ASSERT(sha1_checksum->kind == svn_checksum_sha1);
+
+  base_dir_abspath = svn_dirent_join_many(scratch_pool,
+                                          wcroot_abspath,
+                                          svn_wc_get_adm_dir(scratch_pool),
+                                          PRISTINE_STORAGE_RELPATH,
+                                          SVN_VA_NULL);
+
+  return svn_error_trace(get_pristine_fname_in(pristine_abspath,
+                                               base_dir_abspath,
+                                               sha1_checksum,
+                                               result_pool, scratch_pool));
+}
+
+/* Set *SHARED_ABSPATH to the path of the pristine text identified by
+   SHA1_CHECKSUM in the shared pristine store SHARED_DIR_ABSPATH and
+   *MD5_CHECKSUM to its MD-5 checksum, both allocated in RESULT_POOL.  Set
+   *SHARED_ABSPATH to NULL if the shared store does not have that text.
+
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+shared_pristine_lookup(const char **shared_abspath,
+                       svn_checksum_t **md5_checksum,
+                       const char *shared_dir_abspath,
+                       const svn_checksum_t *sha1_checksum,
+                       apr_pool_t *result_pool,
+                       apr_pool_t *scratch_pool)
+{
+  const char *pristine_abspath;
+  svn_stringbuf_t *md5_hex;
+  svn_node_kind_t kind;
+  svn_error_t *err;
+
+  *shared_abspath = NULL;
+
+  SVN_ERR(get_pristine_fname_in(&pristine_abspath, shared_dir_abspath,
+                                sha1_checksum, result_pool, scratch_pool));
+
+  /* Read the checksum first.  It gets written before the text is linked
+     into place and removed after the text got unlinked. */
+  err = svn_stringbuf_from_file2(&md5_hex,
+                                 apr_pstrcat(scratch_pool, pristine_abspath,
+                                             SHARED_PRISTINE_MD5_EXT,
+                                             SVN_VA_NULL),
+                                 scratch_pool);
+  if (!err)
+    {
+      svn_stringbuf_strip_whitespace(md5_hex);
+      err = svn_checksum_parse_hex(md5_checksum, svn_checksum_md5,
+                                   md5_hex->data, result_pool);
+    }
+  if (!err && !*md5_checksum)
+    err = svn_error_create(SVN_ERR_BAD_CHECKSUM_PARSE, NULL, NULL);
+  if (err)
+    {
+      /* Not in the shared store or unusable. */
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(svn_io_check_path(pristine_abspath, &kind, scratch_pool));
+  if (kind == svn_node_file)
+    *shared_abspath = pristine_abspath;
+
+  return SVN_NO_ERROR;
+}
+
+/* Add the installed pristine text PRISTINE_ABSPATH of a working copy,
+   identified by SHA1_CHECKSUM and MD5_CHECKSUM, to the shared pristine
+   store SHARED_DIR_ABSPATH unless it is already there.
+
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+shared_pristine_publish(const char *shared_dir_abspath,
+                        const char *pristine_abspath,
+                        const svn_checksum_t *sha1_checksum,
+                        const svn_checksum_t *md5_checksum,
+                        apr_pool_t *scratch_pool)
+{
+  const char *shared_abspath;
+  const char *md5_abspath;
+  const char *md5_hex;
+  svn_node_kind_t kind;
+  svn_error_t *err;
+
+  SVN_ERR(get_pristine_fname_in(&shared_abspath, shared_dir_abspath,
+                                sha1_checksum, scratch_pool, scratch_pool));
+  md5_abspath = apr_pstrcat(scratch_pool, shared_abspath,
+                            SHARED_PRISTINE_MD5_EXT, SVN_VA_NULL);
+
+  SVN_ERR(svn_io_check_path(md5_abspath, &kind, scratch_pool));
+  if (kind != svn_node_file)
+    {
+      SVN_ERR(svn_io_make_dir_recursively(svn_dirent_dirname(md5_abspath,
+                                                             scratch_pool),
+                                          scratch_pool));
+
+      md5_hex = svn_checksum_to_cstring(md5_checksum, scratch_pool);
+      SVN_ERR(svn_io_write_atomic2(md5_abspath, md5_hex, strlen(md5_hex),
+                                   NULL, FALSE, scratch_pool));
+    }
+
+  err = svn_io__file_link(pristine_abspath, shared_abspath, scratch_pool);
+  if (err && APR_STATUS_IS_EEXIST(err->apr_err))
+    {
+      /* Somebody else was faster. */
+      svn_error_clear(err);
+      err = SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(err);
+}
+
+/* Set *VALID to TRUE if the pristine text PRISTINE_ABSPATH, linked into
+   a working copy from the shared store, can be trusted to be the text
+   identified by SHA1_CHECKSUM and MD5_CHECKSUM and of size EXPECTED_SIZE,
+   if that is not negative.  Set *SIZE to its actual size.
+
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+verify_linked_pristine(svn_boolean_t *valid,
+                       apr_off_t *size,
+                       const char *pristine_abspath,
+                       const svn_checksum_t *sha1_checksum,
+                       const svn_checksum_t *md5_checksum,
+                       apr_off_t expected_size,
+                       apr_pool_t *scratch_pool)
+{
+  apr_finfo_t finfo;
+  apr_int32_t wanted = APR_FINFO_SIZE;
+  svn_stream_t *stream;
+  svn_checksum_t *actual_sha1_checksum;
+  svn_checksum_t *actual_md5_checksum;
+
+  *valid = FALSE;
+
+#if defined(APR_HAS_USER) && !defined(WIN32) && !defined(__OS2__)
+  wanted |= APR_FINFO_OWNER;
+#endif
+
+  SVN_ERR(svn_io_stat(&finfo, pristine_abspath, wanted, scratch_pool));
+  *size = finfo.size;
+
+#if defined(APR_HAS_USER) && !defined(WIN32) && !defined(__OS2__)
+  {
+    apr_uid_t uid;
+    apr_gid_t gid;
+    apr_status_t status = apr_uid_current(&uid, &gid, scratch_pool);
+
+    if (status)
+      return svn_error_wrap_apr(status, _("Error getting UID of process"));
+
+    /* Another user could make the file writable again, or it may not
+       even be readable for us. */
+    if (apr_uid_compare(uid, finfo.user) != APR_SUCCESS)
+      return SVN_NO_ERROR;
+  }
+#endif
+
+  if (expected_size >= 0 && finfo.size != expected_size)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_stream_open_readonly(&stream, pristine_abspath,
+                                   scratch_pool, scratch_pool));
+  stream = svn_stream_checksummed2(stream, &actual_sha1_checksum, NULL,
+                                   svn_checksum_sha1, TRUE, scratch_pool);
+  stream = svn_stream_checksummed2(stream, &actual_md5_checksum, NULL,
+                                   svn_checksum_md5, TRUE, scratch_pool);
+  SVN_ERR(svn_stream_close(stream));
+
+  *valid = (svn_checksum_match(actual_sha1_checksum, sha1_checksum)
+            && svn_checksum_match(actual_md5_checksum, md5_checksum));
+
+  return SVN_NO_ERROR;
+}
+
+/* Link the text SHARED_ABSPATH from the shared pristine store to
+   PRISTINE_ABSPATH in the store of a working copy, if it is the text
+   identified by SHA1_CHECKSUM and MD5_CHECKSUM and, if EXPECTED_SIZE is
+   not negative, of that size.  Set *LINKED to TRUE and *SIZE to the size
+   of the text on success.  Otherwise, set *LINKED to FALSE and leave no
+   file at PRISTINE_ABSPATH.
+
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+shared_pristine_link(svn_boolean_t *linked,
+                     apr_off_t *size,
+                     const char *shared_abspath,
+                     const char *pristine_abspath,
+                     const svn_checksum_t *sha1_checksum,
+                     const svn_checksum_t *md5_checksum,
+                     apr_off_t expected_size,
+                     apr_pool_t *scratch_pool)
+{
+  svn_error_t *err;
+
+  *linked = FALSE;
+
+  /* A file already there is an orphan. */
+  SVN_ERR(svn_io_remove_file2(pristine_abspath, TRUE, scratch_pool));
+
+  err = svn_io_make_dir_recursively(svn_dirent_dirname(pristine_abspath,
+                                                       scratch_pool),
+                                    scratch_pool);
+  if (!err)
+    err = svn_io__file_link(shared_abspath, pristine_abspath, scratch_pool);
+  if (err)
+    {
+      /* E.g. the working copy is on another file system.  Or the text
+         got removed from the shared store in the meantime. */
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+
+  /* Verify what we linked to, not the shared name, which may get replaced
+     at any time. */
+  err = verify_linked_pristine(linked, size, pristine_abspath,
+                               sha1_checksum, md5_checksum, expected_size,
+                               scratch_pool);
+  if (err || !*linked)
+    {
+      svn_error_clear(err);
+      *linked = FALSE;
+      SVN_ERR(svn_io_remove_file2(pristine_abspath, TRUE, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Remove the pristine text identified by SHA1_CHECKSUM from the shared
+   pristine store SHARED_DIR_ABSPATH if no working copy links to it.
+
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+shared_pristine_release(const char *shared_dir_abspath,
+                        const svn_checksum_t *sha1_checksum,
+                        apr_pool_t *scratch_pool)
+{
+  const char *shared_abspath;
+  apr_finfo_t finfo;
+  svn_error_t *err;
+
+  SVN_ERR(get_pristine_fname_in(&shared_abspath, shared_dir_abspath,
+                                sha1_checksum, scratch_pool, scratch_pool));
+
+  err = svn_io_stat(&finfo, shared_abspath, APR_FINFO_NLINK, scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  /* A working copy that links to the text right after this check keeps
+     its link, so removing our name is still safe. */
+  if (finfo.nlink > 1)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_io_remove_file2(shared_abspath, TRUE, scratch_pool));
+  SVN_ERR(svn_io_remove_file2(apr_pstrcat(scratch_pool, shared_abspath,
+                                          SHARED_PRISTINE_MD5_EXT,
+                                          SVN_VA_NULL),
+                              TRUE, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Try to link the pristine text identified by SHA1_CHECKSUM from the shared
+   pristine store SHARED_DIR_ABSPATH into the store of WCROOT.  Set *ADOPTED
+   to TRUE if WCROOT's store contains that text afterwards.
+
+   This function expects to be executed inside a SQLite txn that has already
+   acquired a 'RESERVED' lock. */
+static svn_error_t *
+shared_pristine_adopt_txn(svn_boolean_t *adopted,
+                          svn_wc__db_wcroot_t *wcroot,
+                          const char *shared_dir_abspath,
+                          const svn_checksum_t *sha1_checksum,
+                          apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  const char *shared_abspath;
+  svn_checksum_t *md5_checksum;
+  const char *pristine_abspath;
+  svn_boolean_t linked;
+  apr_off_t size;
+
+  *adopted = FALSE;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb, STMT_SELECT_PRISTINE));
+  SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, sha1_checksum, scratch_pool));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  SVN_ERR(svn_sqlite__reset(stmt));
+
+  SVN_ERR(get_pristine_fname(&pristine_abspath, wcroot->abspath,
+                             sha1_checksum, scratch_pool, scratch_pool));
+
+  if (have_row)
+    {
+      svn_node_kind_t kind;
+
+      /* Installed concurrently?  Or is the row left without its file? */
+      SVN_ERR(svn_io_check_path(pristine_abspath, &kind, scratch_pool));
+      if (kind == svn_node_file)
+        {
+          *adopted = TRUE;
+          return SVN_NO_ERROR;
+        }
+    }
+
+  SVN_ERR(shared_pristine_lookup(&shared_abspath, &md5_checksum,
+                                 shared_dir_abspath, sha1_checksum,
+                                 scratch_pool, scratch_pool));
+  if (!shared_abspath)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(shared_pristine_link(&linked, &size, shared_abspath,
+                               pristine_abspath, sha1_checksum, md5_checksum,
+                               -1, scratch_pool));
+  if (!linked)
+    return SVN_NO_ERROR;
+
+  /* The existing row already describes the text we linked. */
+  if (!have_row)
+    {
+      SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                        STMT_INSERT_PRISTINE));
+      SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, sha1_checksum, scratch_pool));
+      SVN_ERR(svn_sqlite__bind_checksum(stmt, 2, md5_checksum, scratch_pool));
+      SVN_ERR(svn_sqlite__bind_int64(stmt, 3, size));
+      SVN_ERR(svn_sqlite__insert(NULL, stmt));
+    }
+
+  *adopted = TRUE;
+  return SVN_NO_ERROR;
+}
+
+/* If DB has a shared pristine store, make sure the pristine text identified
+   by SHA1_CHECKSUM is present in the store of WCROOT if the shared store
+   has it.  Set *PRESENT to TRUE if that text is now known to be present in
+   WCROOT's store.
+
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+maybe_adopt_shared_pristine(svn_boolean_t *present,
+                            svn_wc__db_t *db,
+                            svn_wc__db_wcroot_t *wcroot,
+                            const svn_checksum_t *sha1_checksum,
+                            apr_pool_t *scratch_pool)
+{
+  const char *shared_abspath;
+  svn_checksum_t *md5_checksum;
+
+  *present = FALSE;
+  if (!db->shared_pristine_abspath)
+    return SVN_NO_ERROR;
+
+  /* Callers are mostly read-only operations.  Don't take out a write lock
+     on the DB unless there is something to adopt. */
+  SVN_ERR(shared_pristine_lookup(&shared_abspath, &md5_checksum,
+                                 db->shared_pristine_abspath, sha1_checksum,
+                                 scratch_pool, scratch_pool));
+  if (!shared_abspath)
+    return SVN_NO_ERROR;
+
+  /* Ensure the SQL txn has at least a 'RESERVED' lock before we start looking
+   * at the disk, to ensure no concurrent pristine install/delete txn. */
+  SVN_SQLITE__WITH_IMMEDIATE_TXN(
+    shared_pristine_adopt_txn(present, wcroot, db->shared_pristine_abspath,
+                              sha1_checksum, scratch_pool),
+    wcroot->sdb);
+
+  return SVN_NO_ERROR;
+}
+
 
 svn_error_t *
 svn_wc__db_pristine_get_path(const char **pristine_abspath,
@@ -246,6 +653,21 @@ svn_wc__db_pristine_read(svn_stream_t **contents,
   SVN_ERR(get_pristine_fname(&pristine_abspath, wcroot->abspath,
                              sha1_checksum,
                              scratch_pool, scratch_pool));
+
+  if (db->shared_pristine_abspath)
+    {
+      svn_node_kind_t kind;
+
+      SVN_ERR(svn_io_check_path(pristine_abspath, &kind, scratch_pool));
+      if (kind != svn_node_file)
+        {
+          svn_boolean_t adopted;
+
+          SVN_ERR(maybe_adopt_shared_pristine(&adopted, db, wcroot,
+                                              sha1_checksum, scratch_pool));
+        }
+    }
+
   SVN_WC__DB_WITH_TXN(
     pristine_read_txn(contents, size,
                       wcroot, sha1_checksum, pristine_abspath,
@@ -283,6 +705,8 @@ pristine_install_txn(svn_sqlite__db_t *sdb,
                      svn_stream_t *install_stream,
                      /* The target path for the file (within the pristine store). */
                      const char *pristine_abspath,
+                     /* The shared pristine store, or NULL. */
+                     const char *shared_dir_abspath,
                      /* The pristine text's SHA-1 checksum. */
                      const svn_checksum_t *sha1_checksum,
                      /* The pristine text's MD-5 checksum. */
@@ -291,6 +715,8 @@ pristine_install_txn(svn_sqlite__db_t *sdb,
 {
   svn_sqlite__stmt_t *stmt;
   svn_boolean_t have_row;
+  svn_boolean_t linked = FALSE;
+  apr_finfo_t finfo;
 
   /* If this pristine text is already present in the store, just keep it:
    * delete the new one and return. */
@@ -329,23 +755,55 @@ pristine_install_txn(svn_sqlite__db_t *sdb,
       return SVN_NO_ERROR;
     }
 
+  SVN_ERR(svn_stream__install_get_info(&finfo, install_stream,
+                                       APR_FINFO_SIZE, scratch_pool));
+
+  /* Share the text with other working copies, if possible. */
+  if (shared_dir_abspath)
+    {
+      const char *shared_abspath;
+      svn_checksum_t *shared_md5_checksum;
+
+      SVN_ERR(shared_pristine_lookup(&shared_abspath, &shared_md5_checksum,
+                                     shared_dir_abspath, sha1_checksum,
+                                     scratch_pool, scratch_pool));
+      if (shared_abspath)
+        {
+          apr_off_t size;
+
+          SVN_ERR(shared_pristine_link(&linked, &size, shared_abspath,
+                                       pristine_abspath, sha1_checksum,
+                                       md5_checksum, finfo.size,
+                                       scratch_pool));
+        }
+    }
+
   /* Move the file to its target location.  (If it is already there, it is
    * an orphan file and it doesn't matter if we overwrite it.) */
-  {
-    apr_finfo_t finfo;
-    SVN_ERR(svn_stream__install_get_info(&finfo, install_stream,
-                                         APR_FINFO_SIZE, scratch_pool));
+  if (linked)
+    SVN_ERR(svn_stream__install_delete(install_stream, scratch_pool));
+  else
     SVN_ERR(svn_stream__install_stream(install_stream, pristine_abspath,
                                        TRUE, scratch_pool));
 
-    SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_INSERT_PRISTINE));
-    SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, sha1_checksum, scratch_pool));
-    SVN_ERR(svn_sqlite__bind_checksum(stmt, 2, md5_checksum, scratch_pool));
-    SVN_ERR(svn_sqlite__bind_int64(stmt, 3, finfo.size));
-    SVN_ERR(svn_sqlite__insert(NULL, stmt));
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_INSERT_PRISTINE));
+  SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, sha1_checksum, scratch_pool));
+  SVN_ERR(svn_sqlite__bind_checksum(stmt, 2, md5_checksum, scratch_pool));
+  SVN_ERR(svn_sqlite__bind_int64(stmt, 3, finfo.size));
+  SVN_ERR(svn_sqlite__insert(NULL, stmt));
 
-    SVN_ERR(svn_io_set_file_read_only(pristine_abspath, FALSE, scratch_pool));
-  }
+  if (!linked)
+    {
+      SVN_ERR(svn_io_set_file_read_only(pristine_abspath, FALSE,
+                                        scratch_pool));
+
+      if (shared_dir_abspath)
+        svn_error_clear(shared_pristine_publish(shared_dir_abspath,
+                                                pristine_abspath,
+                                                sha1_checksum,
+                                                md5_checksum,
+                                                scratch_pool));
+    }
 
   return SVN_NO_ERROR;
 }
@@ -354,6 +812,9 @@ struct svn_wc__db_install_data_t
 {
   svn_wc__db_wcroot_t *wcroot;
   svn_stream_t *inner_stream;
+
+  /* The shared pristine store, or NULL. */
+  const char *shared_pristine_abspath;
 };
 
 svn_error_t *
@@ -380,6 +841,7 @@ svn_wc__db_pristine_prepare_install(svn_stream_t **stream,
 
   *install_data = apr_pcalloc(result_pool, sizeof(**install_data));
   (*install_data)->wcroot = wcroot;
+  (*install_data)->shared_pristine_abspath = db->shared_pristine_abspath;
 
   SVN_ERR_W(svn_stream__create_for_install(stream,
                                            temp_dir_abspath,
@@ -421,6 +883,7 @@ svn_wc__db_pristine_install(svn_wc__db_install_data_t *install_data,
   SVN_SQLITE__WITH_IMMEDIATE_TXN(
     pristine_install_txn(wcroot->sdb,
                          install_data->inner_stream, pristine_abspath,
+                         install_data->shared_pristine_abspath,
                          sha1_checksum, md5_checksum,
                          scratch_pool),
     wcroot->sdb);
@@ -699,6 +1162,7 @@ pristine_remove_if_unreferenced_txn(svn_sqlite__db_t *sdb,
                                     svn_wc__db_wcroot_t *wcroot,
                                     const svn_checksum_t *sha1_checksum,
                                     const char *pristine_abspath,
+                                    const char *shared_dir_abspath,
                                     apr_pool_t *scratch_pool)
 {
   svn_sqlite__stmt_t *stmt;
@@ -724,6 +1188,12 @@ pristine_remove_if_unreferenced_txn(svn_sqlite__db_t *sdb,
 
       SVN_ERR(svn_io_remove_file2(pristine_abspath, ignore_enoent,
                                   scratch_pool));
+
+      /* Were we the last working copy using the shared text? */
+      if (shared_dir_abspath)
+        svn_error_clear(shared_pristine_release(shared_dir_abspath,
+                                                sha1_checksum,
+                                                scratch_pool));
     }
 
   return SVN_NO_ERROR;
@@ -731,11 +1201,13 @@ pristine_remove_if_unreferenced_txn(svn_sqlite__db_t *sdb,
 
 /* If the pristine text referenced by SHA1_CHECKSUM in WCROOT has a
  * reference count of zero, delete it (both the database row and the disk
- * file).
+ * file).  Also delete it from the shared pristine store SHARED_DIR_ABSPATH,
+ * if not NULL, when no other working copy uses it.
  *
  * Implements 'notes/wc-ng/pristine-store' section A-3(b). */
 static svn_error_t *
 pristine_remove_if_unreferenced(svn_wc__db_wcroot_t *wcroot,
+                                const char *shared_dir_abspath,
                                 const svn_checksum_t *sha1_checksum,
                                 apr_pool_t *scratch_pool)
 {
@@ -748,7 +1220,8 @@ pristine_remove_if_unreferenced(svn_wc__db_wcroot_t *wcroot,
    * at the disk, to ensure no concurrent pristine install/delete txn. */
   SVN_SQLITE__WITH_IMMEDIATE_TXN(
     pristine_remove_if_unreferenced_txn(
-      wcroot->sdb, wcroot, sha1_checksum, pristine_abspath, scratch_pool),
+      wcroot->sdb, wcroot, sha1_checksum, pristine_abspath,
+      shared_dir_abspath, scratch_pool),
     wcroot->sdb);
 
   return SVN_NO_ERROR;
@@ -792,7 +1265,8 @@ svn_wc__db_pristine_remove(svn_wc__db_t *db,
   }
 
   /* If not referenced, remove the PRISTINE table row and the file. */
-  SVN_ERR(pristine_remove_if_unreferenced(wcroot, sha1_checksum, scratch_pool));
+  SVN_ERR(pristine_remove_if_unreferenced(wcroot, db->shared_pristine_abspath,
+                                          sha1_checksum, scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -831,6 +1305,7 @@ svn_wc__db_pristine_remove(svn_wc__db_t *db,
  */
 static svn_error_t *
 pristine_cleanup_wcroot(svn_wc__db_wcroot_t *wcroot,
+                        const char *shared_dir_abspath,
                         apr_pool_t *scratch_pool)
 {
   svn_sqlite__stmt_t *stmt;
@@ -853,8 +1328,8 @@ pristine_cleanup_wcroot(svn_wc__db_wcroot_t *wcroot,
 
       SVN_ERR(svn_sqlite__column_checksum(&sha1_checksum, stmt, 0,
                                           iterpool));
-      err = pristine_remove_if_unreferenced(wcroot, sha1_checksum,
-                                            iterpool);
+      err = pristine_remove_if_unreferenced(wcroot, shared_dir_abspath,
+                                            sha1_checksum, iterpool);
     }
 
   svn_pool_destroy(iterpool);
@@ -877,7 +1352,8 @@ svn_wc__db_pristine_cleanup(svn_wc__db_t *db,
                               wri_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
-  SVN_ERR(pristine_cleanup_wcroot(wcroot, scratch_pool));
+  SVN_ERR(pristine_cleanup_wcroot(wcroot, db->shared_pristine_abspath,
+                                  scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -937,8 +1413,11 @@ svn_wc__db_pristine_check(svn_boolean_t *present,
       return svn_error_trace(err);
     else if (kind_on_disk != svn_node_file)
       {
-        *present = FALSE;
-        return SVN_NO_ERROR;
+        /* Another working copy may have it. */
+        return svn_error_trace(maybe_adopt_shared_pristine(present, db,
+                                                           wcroot,
+                                                           sha1_checksum,
+                                                           scratch_pool));
       }
   }
 
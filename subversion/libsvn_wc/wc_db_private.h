@@ -52,10 +52,29 @@ struct svn_wc__db_t {
   /* Busy timeout in ms., 0 for the libsvn_subr default. */
   apr_int32_t timeout;
 
+  /* Maximum number of threads accessing working copy files concurrently.
+     At least 1. */
+  int worker_threads;
+
+  /* The directory holding pristine texts shared with other working copies,
+     or NULL.  See wc_db_pristine.c. */
+  const char *shared_pristine_abspath;
+
   /* Map a given working copy directory to its relevant data.
      const char *local_abspath -> svn_wc__db_wcroot_t *wcroot  */
   apr_hash_t *dir_data;
 
+  /* If not 0, DIR_DATA outlives single operations and its entries must be
+     revalidated once per epoch before they get used again.  See
+     svn_wc__db_start_epoch(). */
+  apr_uint64_t epoch;
+
+  /* Sub-directories in DIR_DATA, mapped to the wcroot above them in an
+     earlier epoch, that have not been checked for becoming working copies
+     of their own in the current epoch.  The keys are those of DIR_DATA.
+     const char *local_abspath -> const char *local_abspath  */
+  apr_hash_t *unverified_dirs;
+
   /* A few members to assist with caching of kind values for paths.  See
      get_path_kind() for use. */
   struct
@@ -107,6 +126,13 @@ typedef struct svn_wc__db_wcroot_t {
      const char *local_abspath -> svn_wc_adm_access_t *adm_access */
   apr_hash_t *access_cache;
 
+  /* Identity of the SDB file when we opened it and the DB epoch in which
+     we last verified that it is still the same file.  Only used if the
+     DB's epoch is not 0. */
+  apr_ino_t sdb_inode;
+  apr_dev_t sdb_device;
+  apr_uint64_t epoch;
+
 } svn_wc__db_wcroot_t;
 
 
@@ -43,6 +43,10 @@
 #define UNKNOWN_WC_ID ((apr_int64_t) -1)
 #define FORMAT_FROM_SDB (-1)
 
+/* Upper limit for SVN_CONFIG_OPTION_WC_WORKER_THREADS.  More threads
+   than that will hardly speed up anything. */
+#define MAX_WORKER_THREADS 64
+
 /* #define VERIFY_ON_CLOSE */
 
 /* Get the format version from a wc-1 directory. If it is not a working copy
@@ -232,6 +236,8 @@ svn_wc__db_open(svn_wc__db_t **db,
   (*db)->verify_format = !open_without_upgrade;
   (*db)->enforce_empty_wq = enforce_empty_wq;
   (*db)->dir_data = apr_hash_make(result_pool);
+  (*db)->unverified_dirs = apr_hash_make(result_pool);
+  (*db)->worker_threads = 1;
 
   (*db)->state_pool = result_pool;
 
@@ -241,6 +247,8 @@ svn_wc__db_open(svn_wc__db_t **db,
       svn_error_t *err;
       svn_boolean_t sqlite_exclusive = FALSE;
       apr_int64_t timeout;
+      apr_int64_t threads;
+      const char *shared_pristine_dir;
 
       err = svn_config_get_bool(config, &sqlite_exclusive,
                                 SVN_CONFIG_SECTION_WORKING_COPY,
@@ -261,6 +269,26 @@ svn_wc__db_open(svn_wc__db_t **db,
         svn_error_clear(err);
       else
         (*db)->timeout = (apr_int32_t)timeout;
+
+      err = svn_config_get_int64(config, &threads,
+                                 SVN_CONFIG_SECTION_WORKING_COPY,
+                                 SVN_CONFIG_OPTION_WC_WORKER_THREADS,
+                                 1);
+      if (err || threads < 1 || threads > MAX_WORKER_THREADS)
+        svn_error_clear(err);
+      else
+        (*db)->worker_threads = (int)threads;
+
+      svn_config_get(config, &shared_pristine_dir,
+                     SVN_CONFIG_SECTION_WORKING_COPY,
+                     SVN_CONFIG_OPTION_WC_SHARED_PRISTINE_STORE, NULL);
+      if (shared_pristine_dir && *shared_pristine_dir)
+        {
+          shared_pristine_dir = svn_dirent_internal_style(shared_pristine_dir,
+                                                          result_pool);
+          if (svn_dirent_is_absolute(shared_pristine_dir))
+            (*db)->shared_pristine_abspath = shared_pristine_dir;
+        }
     }
 
   return SVN_NO_ERROR;
@@ -294,6 +322,192 @@ svn_wc__db_close(svn_wc__db_t *db)
 }
 
 
+int
+svn_wc__db_get_worker_threads(svn_wc__db_t *db)
+{
+  return db->worker_threads;
+}
+
+
+void
+svn_wc__db_start_epoch(svn_wc__db_t *db)
+{
+  apr_hash_index_t *hi;
+
+  db->epoch++;
+
+  /* Sub-directories, versioned or not, were mapped to the wcroot above
+     them based on what was on disk back then.  They may have become
+     working copies of their own in the meantime, which get_cached_wcroot()
+     checks before using them again.  The wcroots get verified there as
+     well. */
+  apr_hash_clear(db->unverified_dirs);
+  for (hi = apr_hash_first(NULL, db->dir_data); hi; hi = apr_hash_next(hi))
+    {
+      const svn_wc__db_wcroot_t *wcroot = apr_hash_this_val(hi);
+      const char *local_abspath = apr_hash_this_key(hi);
+
+      if (strcmp(local_abspath, wcroot->abspath) != 0)
+        svn_hash_sets(db->unverified_dirs, local_abspath, local_abspath);
+    }
+
+  if (db->parse_cache.abspath)
+    svn_stringbuf_setempty(db->parse_cache.abspath);
+}
+
+
+/* Set *FINFO to the identity of the SDB file of WCROOT.  If it does not
+   exist, set FINFO->FILETYPE to APR_NOFILE. */
+static svn_error_t *
+stat_sdb_file(apr_finfo_t *finfo,
+              svn_wc__db_wcroot_t *wcroot,
+              apr_pool_t *scratch_pool)
+{
+  svn_error_t *err;
+
+  err = svn_io_stat(finfo, svn_wc__adm_child(wcroot->abspath, SDB_FILE,
+                                             scratch_pool),
+                    APR_FINFO_IDENT | APR_FINFO_TYPE, scratch_pool);
+  if (err && (APR_STATUS_IS_ENOENT(err->apr_err)
+              || SVN__APR_STATUS_IS_ENOTDIR(err->apr_err)))
+    {
+      svn_error_clear(err);
+      finfo->filetype = APR_NOFILE;
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(err);
+}
+
+/* Remember the identity of WCROOT's SDB file, if DB has to revalidate it
+   in later epochs. */
+static svn_error_t *
+record_sdb_identity(svn_wc__db_t *db,
+                    svn_wc__db_wcroot_t *wcroot,
+                    apr_pool_t *scratch_pool)
+{
+  apr_finfo_t finfo;
+
+  if (!db->epoch || !wcroot->sdb)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(stat_sdb_file(&finfo, wcroot, scratch_pool));
+  wcroot->sdb_inode = finfo.inode;
+  wcroot->sdb_device = finfo.device;
+  wcroot->epoch = db->epoch;
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *VALID to TRUE if the SDB file of WCROOT is still the one that we
+   opened and has the same format.  An in-place upgrade keeps the file. */
+static svn_error_t *
+revalidate_wcroot(svn_boolean_t *valid,
+                  svn_wc__db_wcroot_t *wcroot,
+                  apr_pool_t *scratch_pool)
+{
+  apr_finfo_t finfo;
+  int format;
+
+  *valid = FALSE;
+
+  SVN_ERR(stat_sdb_file(&finfo, wcroot, scratch_pool));
+  if (finfo.filetype != APR_REG
+      || finfo.inode != wcroot->sdb_inode
+      || finfo.device != wcroot->sdb_device)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_sqlite__read_schema_version(&format, wcroot->sdb,
+                                          scratch_pool));
+  *valid = (format == wcroot->format);
+
+  return SVN_NO_ERROR;
+}
+
+/* Return in *WCROOT the wcroot that DB has cached for the directory
+   LOCAL_DIR_ABSPATH, or NULL if there is none.  If the wcroot has not been
+   verified in the current epoch of DB yet and its SDB file has been
+   replaced, upgraded or removed since it was opened, drop it from DB and
+   return NULL.  Likewise, if LOCAL_DIR_ABSPATH has become a working copy
+   of its own, drop its mapping and those of the directories below it and
+   return NULL. */
+static svn_error_t *
+get_cached_wcroot(svn_wc__db_wcroot_t **wcroot,
+                  svn_wc__db_t *db,
+                  const char *local_dir_abspath,
+                  apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *cached = svn_hash_gets(db->dir_data,
+                                              local_dir_abspath);
+  apr_hash_index_t *hi;
+  apr_status_t result;
+
+  *wcroot = cached;
+  if (!cached || !db->epoch || !cached->sdb)
+    return SVN_NO_ERROR;
+
+  if (cached->epoch != db->epoch)
+    {
+      svn_boolean_t valid;
+
+      SVN_ERR(revalidate_wcroot(&valid, cached, scratch_pool));
+      if (!valid)
+        {
+          /* The working copy has been deleted, re-created or upgraded
+             behind our back.  Forget about it, like svn_wc__db_drop_root()
+             does, and start over. */
+          for (hi = apr_hash_first(scratch_pool, db->dir_data);
+               hi;
+               hi = apr_hash_next(hi))
+            {
+              if (apr_hash_this_val(hi) == cached)
+                svn_hash_sets(db->dir_data, apr_hash_this_key(hi), NULL);
+            }
+
+          result = apr_pool_cleanup_run(db->state_pool, cached,
+                                        close_wcroot);
+          if (result != APR_SUCCESS)
+            return svn_error_wrap_apr(result, NULL);
+
+          *wcroot = NULL;
+          return SVN_NO_ERROR;
+        }
+
+      cached->epoch = db->epoch;
+    }
+
+  if (svn_hash_gets(db->unverified_dirs, local_dir_abspath))
+    {
+      svn_node_kind_t kind;
+
+      svn_hash_sets(db->unverified_dirs, local_dir_abspath, NULL);
+
+      SVN_ERR(svn_io_check_path(svn_wc__adm_child(local_dir_abspath,
+                                                  SDB_FILE, scratch_pool),
+                                &kind, scratch_pool));
+      if (kind == svn_node_file)
+        {
+          /* A new working copy.  Everything below it is part of that one
+             now, so locate it all again. */
+          for (hi = apr_hash_first(scratch_pool, db->dir_data);
+               hi;
+               hi = apr_hash_next(hi))
+            {
+              const char *dir_abspath = apr_hash_this_key(hi);
+
+              if (apr_hash_this_val(hi) == cached
+                  && svn_dirent_is_ancestor(local_dir_abspath, dir_abspath))
+                svn_hash_sets(db->dir_data, dir_abspath, NULL);
+            }
+
+          *wcroot = NULL;
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+
 svn_error_t *
 svn_wc__db_pdh_create_wcroot(svn_wc__db_wcroot_t **wcroot,
                              const char *wcroot_abspath,
@@ -533,7 +747,7 @@ svn_wc__db_wcroot_parse_local_abspath(svn_wc__db_wcroot_t **wcroot,
      ### outside of the wcroot) and then managing all of that within DB.
      ### for now: play quick & dirty. */
 
-  probe_wcroot = svn_hash_gets(db->dir_data, local_abspath);
+  SVN_ERR(get_cached_wcroot(&probe_wcroot, db, local_abspath, scratch_pool));
   if (probe_wcroot != NULL)
     {
       *wcroot = probe_wcroot;
@@ -568,7 +782,8 @@ svn_wc__db_wcroot_parse_local_abspath(svn_wc__db_wcroot_t **wcroot,
                        scratch_pool);
 
       /* Is this directory in our hash?  */
-      probe_wcroot = svn_hash_gets(db->dir_data, local_dir_abspath);
+      SVN_ERR(get_cached_wcroot(&probe_wcroot, db, local_dir_abspath,
+                                scratch_pool));
       if (probe_wcroot != NULL)
         {
           const char *dir_relpath;
@@ -701,7 +916,8 @@ svn_wc__db_wcroot_parse_local_abspath(svn_wc__db_wcroot_t **wcroot,
               if (resolved_kind == svn_node_dir)
                 {
                   /* Is this directory recorded in our hash?  */
-                  found_wcroot = svn_hash_gets(db->dir_data, local_abspath);
+                  SVN_ERR(get_cached_wcroot(&found_wcroot, db, local_abspath,
+                                            scratch_pool));
                   if (found_wcroot)
                     break;
 
@@ -730,7 +946,8 @@ try_symlink_as_dir:
       symlink_wcroot_abspath = NULL;
 
       /* Is the parent directory recorded in our hash?  */
-      found_wcroot = svn_hash_gets(db->dir_data, local_abspath);
+      SVN_ERR(get_cached_wcroot(&found_wcroot, db, local_abspath,
+                                scratch_pool));
       if (found_wcroot != NULL)
         break;
     }
@@ -787,6 +1004,8 @@ try_symlink_as_dir:
              upgrading with exclusive wc locking. */
           return svn_error_compose_create(err, svn_sqlite__close(sdb));
         }
+      else
+        SVN_ERR(record_sdb_identity(db, *wcroot, scratch_pool));
     }
   else
     {
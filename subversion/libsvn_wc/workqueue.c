@@ -40,6 +40,7 @@
 
 #include "private/svn_io_private.h"
 #include "private/svn_skel.h"
+#include "private/svn_thread_pool.h"
 
 
 /* Workqueue operation names.  */
@@ -77,13 +78,18 @@ struct work_item_dispatch {
                        apr_pool_t *scratch_pool);
 };
 
-/* Forward definition */
+/* Forward definitions */
 static svn_error_t *
 get_and_record_fileinfo(work_item_baton_t *wqb,
                         const char *local_abspath,
                         svn_boolean_t ignore_enoent,
                         apr_pool_t *scratch_pool);
 
+static void
+record_fileinfo(work_item_baton_t *wqb,
+                const char *local_abspath,
+                const svn_io_dirent2_t *dirent);
+
 /* ------------------------------------------------------------------------ */
 /* OP_REMOVE_BASE  */
 
@@ -445,60 +451,77 @@ svn_wc__wq_build_postupgrade(svn_skel_t **work_item,
 
 /* OP_FILE_INSTALL */
 
-/* Process the OP_FILE_INSTALL work item WORK_ITEM.
- * See svn_wc__wq_build_file_install() which generates this work item.
- * Implements (struct work_item_dispatch).func. */
+/* The part of an OP_FILE_INSTALL work item that does not access the DB,
+   as determined by prepare_file_install(). */
+typedef struct file_install_t
+{
+  /* The file to install and where to install it from. */
+  const char *local_abspath;
+  const char *source_abspath;
+
+  /* Where to create the temporary file. */
+  const char *temp_dir_abspath;
+
+  /* How to translate the source. */
+  svn_subst_eol_style_t style;
+  const char *eol;
+  apr_hash_t *keywords;
+  svn_boolean_t special;
+
+  /* How to tweak the installed file. */
+  svn_boolean_t set_executable;
+  svn_boolean_t set_read_only;
+  apr_time_t affected_time; /* 0, if the time shall not be set */
+
+  /* Whether to stat the installed file for recording its fileinfo. */
+  svn_boolean_t record_fileinfo;
+} file_install_t;
+
+/* Read everything needed for executing the OP_FILE_INSTALL work item
+   WORK_ITEM from DB and set *INSTALL accordingly, allocated in
+   RESULT_POOL.  Use SCRATCH_POOL for temporary allocations. */
 static svn_error_t *
-run_file_install(work_item_baton_t *wqb,
-                 svn_wc__db_t *db,
-                 const svn_skel_t *work_item,
-                 const char *wri_abspath,
-                 svn_cancel_func_t cancel_func,
-                 void *cancel_baton,
-                 apr_pool_t *scratch_pool)
+prepare_file_install(file_install_t **install,
+                     svn_wc__db_t *db,
+                     const svn_skel_t *work_item,
+                     const char *wri_abspath,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
 {
   const svn_skel_t *arg1 = work_item->children->next;
   const svn_skel_t *arg4 = arg1->next->next->next;
+  file_install_t *fi = apr_pcalloc(result_pool, sizeof(*fi));
   const char *local_relpath;
-  const char *local_abspath;
   svn_boolean_t use_commit_times;
-  svn_boolean_t record_fileinfo;
-  svn_boolean_t special;
-  svn_stream_t *src_stream;
-  svn_subst_eol_style_t style;
-  const char *eol;
-  apr_hash_t *keywords;
-  const char *temp_dir_abspath;
-  svn_stream_t *dst_stream;
   apr_int64_t val;
   const char *wcroot_abspath;
-  const char *source_abspath;
   const svn_checksum_t *checksum;
   apr_hash_t *props;
   apr_time_t changed_date;
 
   local_relpath = apr_pstrmemdup(scratch_pool, arg1->data, arg1->len);
-  SVN_ERR(svn_wc__db_from_relpath(&local_abspath, db, wri_abspath,
-                                  local_relpath, scratch_pool, scratch_pool));
+  SVN_ERR(svn_wc__db_from_relpath(&fi->local_abspath, db, wri_abspath,
+                                  local_relpath, result_pool, scratch_pool));
 
   SVN_ERR(svn_skel__parse_int(&val, arg1->next, scratch_pool));
   use_commit_times = (val != 0);
   SVN_ERR(svn_skel__parse_int(&val, arg1->next->next, scratch_pool));
-  record_fileinfo = (val != 0);
+  fi->record_fileinfo = (val != 0);
 
   SVN_ERR(svn_wc__db_read_node_install_info(&wcroot_abspath,
                                             &checksum, &props,
                                             &changed_date,
-                                            db, local_abspath, wri_abspath,
+                                            db, fi->local_abspath,
+                                            wri_abspath,
                                             scratch_pool, scratch_pool));
 
   if (arg4 != NULL)
     {
       /* Use the provided path for the source.  */
       local_relpath = apr_pstrmemdup(scratch_pool, arg4->data, arg4->len);
-      SVN_ERR(svn_wc__db_from_relpath(&source_abspath, db, wri_abspath,
+      SVN_ERR(svn_wc__db_from_relpath(&fi->source_abspath, db, wri_abspath,
                                       local_relpath,
-                                      scratch_pool, scratch_pool));
+                                      result_pool, scratch_pool));
     }
   else if (! checksum)
     {
@@ -513,86 +536,41 @@ run_file_install(work_item_baton_t *wqb,
                                _("Can't install '%s' from pristine store, "
                                  "because no checksum is recorded for this "
                                  "file"),
-                               svn_dirent_local_style(local_abspath,
+                               svn_dirent_local_style(fi->local_abspath,
                                                       scratch_pool));
     }
   else
     {
-      SVN_ERR(svn_wc__db_pristine_get_future_path(&source_abspath,
+      SVN_ERR(svn_wc__db_pristine_get_future_path(&fi->source_abspath,
                                                   wcroot_abspath,
                                                   checksum,
-                                                  scratch_pool, scratch_pool));
+                                                  result_pool, scratch_pool));
     }
 
-  SVN_ERR(svn_stream_open_readonly(&src_stream, source_abspath,
-                                   scratch_pool, scratch_pool));
-
   /* Fetch all the translation bits.  */
-  SVN_ERR(svn_wc__get_translate_info(&style, &eol,
-                                     &keywords,
-                                     &special, db, local_abspath,
+  SVN_ERR(svn_wc__get_translate_info(&fi->style, &fi->eol,
+                                     &fi->keywords,
+                                     &fi->special, db, fi->local_abspath,
                                      props, FALSE,
-                                     scratch_pool, scratch_pool));
-  if (special)
-    {
-      /* When this stream is closed, the resulting special file will
-         atomically be created/moved into place at LOCAL_ABSPATH.  */
-      SVN_ERR(svn_subst_create_specialfile(&dst_stream, local_abspath,
-                                           scratch_pool, scratch_pool));
-
-      /* Copy the "repository normal" form of the special file into the
-         special stream.  */
-      SVN_ERR(svn_stream_copy3(src_stream, dst_stream,
-                               cancel_func, cancel_baton,
-                               scratch_pool));
-
-      /* No need to set exec or read-only flags on special files.  */
+                                     result_pool, scratch_pool));
 
+  /* No need to set exec or read-only flags on special files.  */
+  if (fi->special)
+    {
       /* ### Shouldn't this record a timestamp and size, etc.? */
+      fi->record_fileinfo = FALSE;
+      *install = fi;
       return SVN_NO_ERROR;
     }
 
-  if (svn_subst_translation_required(style, eol, keywords,
-                                     FALSE /* special */,
-                                     TRUE /* force_eol_check */))
-    {
-      /* Wrap it in a translating (expanding) stream.  */
-      src_stream = svn_subst_stream_translated(src_stream, eol,
-                                               TRUE /* repair */,
-                                               keywords,
-                                               TRUE /* expand */,
-                                               scratch_pool);
-    }
-
   /* Where is the Right Place to put a temp file in this working copy?  */
-  SVN_ERR(svn_wc__db_temp_wcroot_tempdir(&temp_dir_abspath,
+  SVN_ERR(svn_wc__db_temp_wcroot_tempdir(&fi->temp_dir_abspath,
                                          db, wcroot_abspath,
-                                         scratch_pool, scratch_pool));
-
-  /* Translate to a temporary file. We don't want the user seeing a partial
-     file, nor let them muck with it while we translate. We may also need to
-     get its TRANSLATED_SIZE before the user can monkey it.  */
-  SVN_ERR(svn_stream__create_for_install(&dst_stream, temp_dir_abspath,
-                                         scratch_pool, scratch_pool));
-
-  /* Copy from the source to the dest, translating as we go. This will also
-     close both streams.  */
-  SVN_ERR(svn_stream_copy3(src_stream, dst_stream,
-                           cancel_func, cancel_baton,
-                           scratch_pool));
-
-  /* All done. Move the file into place.  */
-  /* With a single db we might want to install files in a missing directory.
-     Simply trying this scenario on error won't do any harm and at least
-     one user reported this problem on IRC. */
-  SVN_ERR(svn_stream__install_stream(dst_stream, local_abspath,
-                                     TRUE /* make_parents*/, scratch_pool));
+                                         result_pool, scratch_pool));
 
   /* Tweak the on-disk file according to its properties.  */
 #ifndef WIN32
-  if (props && svn_hash_gets(props, SVN_PROP_EXECUTABLE))
-    SVN_ERR(svn_io_set_file_executable(local_abspath, TRUE, FALSE,
-                                       scratch_pool));
+  fi->set_executable = (props && svn_hash_gets(props, SVN_PROP_EXECUTABLE));
 #endif
 
   /* Note that this explicitly checks the pristine properties, to make sure
@@ -605,32 +583,154 @@ run_file_install(work_item_baton_t *wqb,
                                    NULL, NULL, NULL, NULL, NULL, NULL, NULL,
                                    NULL, NULL, &lock, NULL, NULL, NULL, NULL,
                                    NULL, NULL, NULL, NULL, NULL, NULL,
-                                   db, local_abspath,
+                                   db, fi->local_abspath,
                                    scratch_pool, scratch_pool));
 
-      if (!lock && status != svn_wc__db_status_added)
-        SVN_ERR(svn_io_set_file_read_only(local_abspath, FALSE, scratch_pool));
+      fi->set_read_only = (!lock && status != svn_wc__db_status_added);
     }
 
   if (use_commit_times)
+    fi->affected_time = changed_date;
+
+  *install = fi;
+  return SVN_NO_ERROR;
+}
+
+/* Install the file described by INSTALL.  If INSTALL->RECORD_FILEINFO is
+   set, set *DIRENT to the installed file's dirent, allocated in
+   RESULT_POOL, and to NULL otherwise.
+
+   This does not access the DB and may be called on any thread.  Use
+   SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+execute_file_install(const svn_io_dirent2_t **dirent,
+                     const file_install_t *install,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
+{
+  const char *local_abspath = install->local_abspath;
+  svn_stream_t *src_stream;
+  svn_stream_t *dst_stream;
+
+  *dirent = NULL;
+
+  if (install->special)
     {
-      if (changed_date)
-        SVN_ERR(svn_io_set_file_affected_time(changed_date,
-                                              local_abspath,
+      SVN_ERR(svn_stream_open_readonly(&src_stream, install->source_abspath,
+                                       scratch_pool, scratch_pool));
+
+      /* When this stream is closed, the resulting special file will
+         atomically be created/moved into place at LOCAL_ABSPATH.  */
+      SVN_ERR(svn_subst_create_specialfile(&dst_stream, local_abspath,
+                                           scratch_pool, scratch_pool));
+
+      /* Copy the "repository normal" form of the special file into the
+         special stream.  */
+      return svn_error_trace(svn_stream_copy3(src_stream, dst_stream,
+                                              cancel_func, cancel_baton,
                                               scratch_pool));
     }
 
+  /* Translate to a temporary file. We don't want the user seeing a partial
+     file, nor let them muck with it while we translate. We may also need to
+     get its TRANSLATED_SIZE before the user can monkey it.  */
+  SVN_ERR(svn_stream__create_for_install(&dst_stream,
+                                         install->temp_dir_abspath,
+                                         scratch_pool, scratch_pool));
+
+  if (svn_subst_translation_required(install->style, install->eol,
+                                     install->keywords,
+                                     FALSE /* special */,
+                                     TRUE /* force_eol_check */))
+    {
+      SVN_ERR(svn_stream_open_readonly(&src_stream, install->source_abspath,
+                                       scratch_pool, scratch_pool));
+
+      /* Wrap it in a translating (expanding) stream.  */
+      src_stream = svn_subst_stream_translated(src_stream, install->eol,
+                                               TRUE /* repair */,
+                                               install->keywords,
+                                               TRUE /* expand */,
+                                               scratch_pool);
+
+      /* Copy from the source to the dest, translating as we go. This will
+         also close both streams.  */
+      SVN_ERR(svn_stream_copy3(src_stream, dst_stream,
+                               cancel_func, cancel_baton,
+                               scratch_pool));
+    }
+  else
+    {
+      apr_file_t *src_file;
+
+      /* The working file is a verbatim copy of the pristine. Copy it
+         file-to-file, so that the file system may share the data blocks
+         or copy them without passing them through user space. */
+      SVN_ERR(svn_io_file_open(&src_file, install->source_abspath,
+                               APR_READ, APR_OS_DEFAULT, scratch_pool));
+      SVN_ERR(svn_io__file_copy_contents(svn_stream__aprfile(dst_stream),
+                                         src_file, cancel_func, cancel_baton,
+                                         scratch_pool));
+      SVN_ERR(svn_io_file_close(src_file, scratch_pool));
+    }
+
+  /* All done. Move the file into place.  */
+  /* With a single db we might want to install files in a missing directory.
+     Simply trying this scenario on error won't do any harm and at least
+     one user reported this problem on IRC. */
+  SVN_ERR(svn_stream__install_stream(dst_stream, local_abspath,
+                                     TRUE /* make_parents*/, scratch_pool));
+
+  if (install->set_executable)
+    SVN_ERR(svn_io_set_file_executable(local_abspath, TRUE, FALSE,
+                                       scratch_pool));
+
+  if (install->set_read_only)
+    SVN_ERR(svn_io_set_file_read_only(local_abspath, FALSE, scratch_pool));
+
+  if (install->affected_time)
+    SVN_ERR(svn_io_set_file_affected_time(install->affected_time,
+                                          local_abspath,
+                                          scratch_pool));
+
   /* ### this should happen before we rename the file into place.  */
-  if (record_fileinfo)
+  if (install->record_fileinfo)
     {
-      SVN_ERR(get_and_record_fileinfo(wqb, local_abspath,
-                                      FALSE /* ignore_enoent */,
-                                      scratch_pool));
+      SVN_ERR(svn_io_stat_dirent2(dirent, local_abspath, FALSE, FALSE,
+                                  result_pool, scratch_pool));
+      if ((*dirent)->kind != svn_node_file)
+        *dirent = NULL;
     }
 
   return SVN_NO_ERROR;
 }
 
+/* Process the OP_FILE_INSTALL work item WORK_ITEM.
+ * See svn_wc__wq_build_file_install() which generates this work item.
+ * Implements (struct work_item_dispatch).func. */
+static svn_error_t *
+run_file_install(work_item_baton_t *wqb,
+                 svn_wc__db_t *db,
+                 const svn_skel_t *work_item,
+                 const char *wri_abspath,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *scratch_pool)
+{
+  file_install_t *install;
+  const svn_io_dirent2_t *dirent;
+
+  SVN_ERR(prepare_file_install(&install, db, work_item, wri_abspath,
+                               scratch_pool, scratch_pool));
+  SVN_ERR(execute_file_install(&dirent, install, cancel_func, cancel_baton,
+                               scratch_pool, scratch_pool));
+  record_fileinfo(wqb, install->local_abspath, dirent);
+
+  return SVN_NO_ERROR;
+}
+
 
 svn_error_t *
 svn_wc__wq_build_file_install(svn_skel_t **work_item,
@@ -1474,6 +1574,262 @@ dispatch_work_item(work_item_baton_t *wqb,
 }
 
 
+/* Return ERR, which occurred while running WORK_ITEM with identifier ID
+   from the work queue associated with WRI_ABSPATH, wrapped in an error
+   naming the work item.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+wrap_work_item_error(svn_error_t *err,
+                     const char *wri_abspath,
+                     apr_uint64_t id,
+                     const svn_skel_t *work_item,
+                     apr_pool_t *scratch_pool)
+{
+  const char *skel = svn_skel__unparse(work_item, scratch_pool)->data;
+
+  return svn_error_createf(SVN_ERR_WC_BAD_ADM_LOG, err,
+                           _("Failed to run the WC DB work queue "
+                             "associated with '%s', work item %d %s"),
+                           svn_dirent_local_style(wri_abspath,
+                                                  scratch_pool),
+                           (int)id, skel);
+}
+
+/* Maximum number of work items to fetch from the DB at once. */
+#define WORK_ITEM_BATCH_SIZE 256
+
+/* An OP_FILE_INSTALL work item executed by a worker thread. */
+typedef struct install_task_t
+{
+  /* The work item and its identifier. */
+  apr_uint64_t id;
+  const svn_skel_t *work_item;
+
+  /* What the worker shall do. */
+  file_install_t *install;
+
+  /* The installed file's dirent, if it shall be recorded.  Allocated in
+     the task's pool. */
+  const svn_io_dirent2_t *dirent;
+
+  /* The task executing INSTALL. */
+  svn_thread_pool__task_t *task;
+} install_task_t;
+
+/* State of svn_wc__wq_run() while executing work items in parallel. */
+typedef struct install_batch_t
+{
+  /* The worker threads. */
+  svn_thread_pool__group_t *group;
+
+  /* The install_task_t * that have been started but not finished yet,
+     in queue order. */
+  apr_array_header_t *pending;
+
+  /* The files being installed by PENDING.  Maps const char * abspaths to
+     install_task_t *. */
+  apr_hash_t *targets;
+} install_batch_t;
+
+/* Implements svn_thread_pool__func_t.  Execute the install_task_t BATON. */
+static svn_error_t *
+install_file_task(void *baton,
+                  apr_pool_t *result_pool)
+{
+  install_task_t *task = baton;
+
+  /* The walking thread checks for cancellation between work items. */
+  return svn_error_trace(execute_file_install(&task->dirent, task->install,
+                                              NULL, NULL,
+                                              result_pool, result_pool));
+}
+
+/* Wait for all pending file installations of BATCH to complete, in queue
+   order.  Record their fileinfo in WQB and append the identifiers of
+   their work items to COMPLETED_IDS.  The work items belong to the queue
+   associated with WRI_ABSPATH.
+
+   Return the error of the first failed work item, if any.  All tasks will
+   have been released in any case.  Use SCRATCH_POOL for temporary
+   allocations. */
+static svn_error_t *
+finish_installs(install_batch_t *batch,
+                work_item_baton_t *wqb,
+                apr_array_header_t *completed_ids,
+                const char *wri_abspath,
+                apr_pool_t *scratch_pool)
+{
+  svn_error_t *err = SVN_NO_ERROR;
+  int i;
+
+  for (i = 0; i < batch->pending->nelts; i++)
+    {
+      install_task_t *task = APR_ARRAY_IDX(batch->pending, i,
+                                           install_task_t *);
+
+      if (!err)
+        {
+          err = svn_thread_pool__task_wait(task->task);
+          if (err)
+            {
+              err = wrap_work_item_error(err, wri_abspath, task->id,
+                                         task->work_item, scratch_pool);
+            }
+          else
+            {
+              /* Copy the dirent before the task's pool goes away. */
+              record_fileinfo(wqb, task->install->local_abspath,
+                              task->dirent);
+              APR_ARRAY_PUSH(completed_ids, apr_uint64_t) = task->id;
+            }
+        }
+
+      svn_thread_pool__task_destroy(task->task);
+    }
+
+  apr_array_clear(batch->pending);
+  apr_hash_clear(batch->targets);
+
+  return svn_error_trace(err);
+}
+
+/* Start executing the OP_FILE_INSTALL WORK_ITEM with identifier ID from
+   the queue associated with WRI_ABSPATH in DB as part of BATCH.  WQB and
+   COMPLETED_IDS are as for finish_installs().
+
+   Allocate the task in RESULT_POOL, which must remain valid until the task
+   got finished.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+start_install(install_batch_t *batch,
+              work_item_baton_t *wqb,
+              apr_array_header_t *completed_ids,
+              svn_wc__db_t *db,
+              const char *wri_abspath,
+              apr_uint64_t id,
+              const svn_skel_t *work_item,
+              apr_pool_t *result_pool,
+              apr_pool_t *scratch_pool)
+{
+  install_task_t *task = apr_pcalloc(result_pool, sizeof(*task));
+  svn_error_t *err;
+
+  task->id = id;
+  task->work_item = work_item;
+
+  /* Anything that needs the DB happens here, on the calling thread. */
+  err = prepare_file_install(&task->install, db, work_item, wri_abspath,
+                             result_pool, scratch_pool);
+  if (err)
+    return svn_error_trace(wrap_work_item_error(err, wri_abspath, id,
+                                                work_item, scratch_pool));
+
+  /* Installing the same file twice must happen in queue order. */
+  if (svn_hash_gets(batch->targets, task->install->local_abspath))
+    SVN_ERR(finish_installs(batch, wqb, completed_ids, wri_abspath,
+                            scratch_pool));
+
+  SVN_ERR(svn_thread_pool__run(&task->task, batch->group,
+                               install_file_task, task));
+  APR_ARRAY_PUSH(batch->pending, install_task_t *) = task;
+  svn_hash_sets(batch->targets, task->install->local_abspath, task);
+
+  return SVN_NO_ERROR;
+}
+
+/* Execute the work items WORK_ITEMS with the identifiers IDS, as fetched by
+   svn_wc__db_wq_record_and_fetch_batch() from the queue associated with
+   WRI_ABSPATH in DB.
+
+   File installations get executed on the worker threads of BATCH, if it
+   has any.  All other work items get executed in queue order on the
+   calling thread, once all work items before them have completed.
+
+   Record fileinfo in WQB and append the identifiers of completed work items
+   to COMPLETED_IDS, flushing both to the DB before running a work item on
+   the calling thread.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+run_work_items(install_batch_t *batch,
+               work_item_baton_t *wqb,
+               apr_array_header_t *completed_ids,
+               svn_wc__db_t *db,
+               const char *wri_abspath,
+               const apr_array_header_t *ids,
+               const apr_array_header_t *work_items,
+               svn_cancel_func_t cancel_func,
+               void *cancel_baton,
+               apr_pool_t *scratch_pool)
+{
+  svn_boolean_t parallel = svn_thread_pool__group_is_parallel(batch->group);
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_error_t *err = SVN_NO_ERROR;
+  int i;
+
+  for (i = 0; !err && i < work_items->nelts; i++)
+    {
+      apr_uint64_t id = APR_ARRAY_IDX(ids, i, apr_uint64_t);
+      const svn_skel_t *work_item = APR_ARRAY_IDX(work_items, i,
+                                                  const svn_skel_t *);
+
+      svn_pool_clear(iterpool);
+
+      /* Stop work queue processing, if requested. A future 'svn cleanup'
+         should be able to continue the processing.  */
+      if (cancel_func)
+        {
+          err = cancel_func(cancel_baton);
+          if (err)
+            break;
+        }
+
+      if (parallel && svn_skel__matches_atom(work_item->children,
+                                             OP_FILE_INSTALL))
+        {
+          err = start_install(batch, wqb, completed_ids, db, wri_abspath,
+                              id, work_item, scratch_pool, iterpool);
+          continue;
+        }
+
+      /* Other work items may depend on everything before them, including
+         the DB state. */
+      err = finish_installs(batch, wqb, completed_ids, wri_abspath,
+                            iterpool);
+      if (!err && (completed_ids->nelts || wqb->used))
+        {
+          apr_array_header_t *unused_ids, *unused_items;
+
+          err = svn_wc__db_wq_record_and_fetch_batch(&unused_ids,
+                                                     &unused_items,
+                                                     db, wri_abspath,
+                                                     completed_ids,
+                                                     wqb->record_map, 0,
+                                                     iterpool, iterpool);
+          if (!err)
+            {
+              apr_array_clear(completed_ids);
+              svn_pool_clear(wqb->result_pool);
+              wqb->record_map = NULL;
+              wqb->used = FALSE;
+            }
+        }
+      if (err)
+        break;
+
+      err = dispatch_work_item(wqb, db, wri_abspath, work_item,
+                               cancel_func, cancel_baton, iterpool);
+      if (err)
+        err = wrap_work_item_error(err, wri_abspath, id, work_item,
+                                   iterpool);
+      else
+        /* The work item finished without error. Mark it completed
+           with the next DB access.  */
+        APR_ARRAY_PUSH(completed_ids, apr_uint64_t) = id;
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(err);
+}
+
+
 svn_error_t *
 svn_wc__wq_run(svn_wc__db_t *db,
                const char *wri_abspath,
@@ -1482,8 +1838,10 @@ svn_wc__wq_run(svn_wc__db_t *db,
                apr_pool_t *scratch_pool)
 {
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
-  apr_uint64_t last_id = 0;
+  apr_array_header_t *completed_ids;
+  install_batch_t batch;
   work_item_baton_t wib = { 0 };
+  svn_error_t *err = SVN_NO_ERROR;
   wib.result_pool = svn_pool_create(scratch_pool);
 
 #ifdef SVN_DEBUG_WORK_QUEUE
@@ -1500,70 +1858,68 @@ svn_wc__wq_run(svn_wc__db_t *db,
   }
 #endif
 
-  while (TRUE)
+  /* Installing files mostly waits for the file system, e.g. when creating
+     and translating lots of small files during a checkout.  Let multiple
+     threads do that. */
+  SVN_ERR(svn_thread_pool__group_create(&batch.group,
+                                        svn_wc__db_get_worker_threads(db),
+                                        scratch_pool));
+  batch.pending = apr_array_make(scratch_pool, WORK_ITEM_BATCH_SIZE,
+                                 sizeof(install_task_t *));
+  batch.targets = apr_hash_make(scratch_pool);
+  completed_ids = apr_array_make(scratch_pool, WORK_ITEM_BATCH_SIZE,
+                                 sizeof(apr_uint64_t));
+
+  while (!err)
     {
-      apr_uint64_t id;
-      svn_skel_t *work_item;
-      svn_error_t *err;
+      apr_array_header_t *ids;
+      apr_array_header_t *work_items;
 
       svn_pool_clear(iterpool);
 
-      if (! wib.used)
-        {
-          /* Make sure to do this *early* in the loop iteration. There may
-             be a LAST_ID that needs to be marked as completed, *before* we
-             start worrying about anything else.  */
-          SVN_ERR(svn_wc__db_wq_fetch_next(&id, &work_item, db, wri_abspath,
-                                           last_id, iterpool, iterpool));
-        }
-      else
-        {
-          /* Make sure to do this *early* in the loop iteration. There may
-             be a LAST_ID that needs to be marked as completed, *before* we
-             start worrying about anything else.  */
-          SVN_ERR(svn_wc__db_wq_record_and_fetch_next(&id, &work_item,
-                                                      db, wri_abspath,
-                                                      last_id, wib.record_map,
-                                                      iterpool,
-                                                      wib.result_pool));
-
-          svn_pool_clear(wib.result_pool);
-          wib.record_map = NULL;
-          wib.used = FALSE;
-        }
+      /* Make sure to do this *early* in the loop iteration. There may
+         be completed work items that need to be marked as such, *before*
+         we start worrying about anything else.  */
+      SVN_ERR(svn_wc__db_wq_record_and_fetch_batch(&ids, &work_items,
+                                                   db, wri_abspath,
+                                                   completed_ids,
+                                                   wib.record_map,
+                                                   WORK_ITEM_BATCH_SIZE,
+                                                   iterpool, iterpool));
+      apr_array_clear(completed_ids);
+      svn_pool_clear(wib.result_pool);
+      wib.record_map = NULL;
+      wib.used = FALSE;
 
       /* Stop work queue processing, if requested. A future 'svn cleanup'
          should be able to continue the processing. Note that we may
-         have WORK_ITEM, but we'll just skip its processing for now.  */
+         have WORK_ITEMS, but we'll just skip their processing for now.  */
       if (cancel_func)
         SVN_ERR(cancel_func(cancel_baton));
 
-      /* If we have a WORK_ITEM, then process the sucker. Otherwise,
+      /* If we have WORK_ITEMS, then process the suckers. Otherwise,
          we're done.  */
-      if (work_item == NULL)
+      if (work_items->nelts == 0)
         break;
 
-      err = dispatch_work_item(&wib, db, wri_abspath, work_item,
-                               cancel_func, cancel_baton, iterpool);
-      if (err)
-        {
-          const char *skel = svn_skel__unparse(work_item, scratch_pool)->data;
-
-          return svn_error_createf(SVN_ERR_WC_BAD_ADM_LOG, err,
-                                   _("Failed to run the WC DB work queue "
-                                     "associated with '%s', work item %d %s"),
-                                   svn_dirent_local_style(wri_abspath,
-                                                          scratch_pool),
-                                   (int)id, skel);
-        }
-
-      /* The work item finished without error. Mark it completed
-         in the next loop.  */
-      last_id = id;
+      err = run_work_items(&batch, &wib, completed_ids, db, wri_abspath,
+                           ids, work_items, cancel_func, cancel_baton,
+                           iterpool);
+
+      /* Wait for the remaining installations in any case; they refer to
+         the work items in ITERPOOL. */
+      err = svn_error_compose_create(err,
+                                     finish_installs(&batch, &wib,
+                                                     completed_ids,
+                                                     wri_abspath,
+                                                     iterpool));
     }
 
+  err = svn_error_compose_create(err,
+                                 svn_thread_pool__group_wait(batch.group));
+
   svn_pool_destroy(iterpool);
-  return SVN_NO_ERROR;
+  return svn_error_trace(err);
 }
 
 
@@ -1629,13 +1985,25 @@ get_and_record_fileinfo(work_item_baton_t *wqb,
   if (dirent->kind != svn_node_file)
     return SVN_NO_ERROR;
 
+  record_fileinfo(wqb, local_abspath, dirent);
+
+  return SVN_NO_ERROR;
+}
+
+/* Record DIRENT, if not NULL, as the fileinfo of LOCAL_ABSPATH in WQB. */
+static void
+record_fileinfo(work_item_baton_t *wqb,
+                const char *local_abspath,
+                const svn_io_dirent2_t *dirent)
+{
+  if (! dirent)
+    return;
+
   wqb->used = TRUE;
 
   if (! wqb->record_map)
     wqb->record_map = apr_hash_make(wqb->result_pool);
 
   svn_hash_sets(wqb->record_map, apr_pstrdup(wqb->result_pool, local_abspath),
-                dirent);
-
-  return SVN_NO_ERROR;
+                svn_io_dirent2_dup(dirent, wqb->result_pool));
 }
@@ -186,6 +186,24 @@ enum dav_svn_private_restype {
 };
 
 
+/* A complete GET response body together with the header values that
+   describe it, as kept by the response cache (see response_cache.c). */
+typedef struct dav_svn__cached_response_t {
+  /* Value of the ETag header. */
+  const char *etag;
+
+  /* Value of the Content-Type header. */
+  const char *mimetype;
+
+  /* Whether the body is an svndiff against the requested delta base. */
+  svn_boolean_t is_svndiff;
+
+  /* The response body.  NULL while the response is still being
+     rendered. */
+  const svn_string_t *body;
+} dav_svn__cached_response_t;
+
+
 /* store info about a root in a repository */
 typedef struct dav_svn_root {
   /* If a root within the FS has been opened, the value is stored here.
@@ -303,6 +321,14 @@ struct dav_resource_private {
   /* whether this resource parameters are fixed and won't change
      between requests. */
   svn_boolean_t idempotent;
+
+  /* Key of this resource's GET response in the response cache.  NULL,
+     if the response must not be cached. */
+  const char *response_key;
+
+  /* The response headers determined by set_headers(), if RESPONSE_KEY is
+     set.  The body will be set if the response came from the cache. */
+  dav_svn__cached_response_t *response;
 };
 
 
@@ -340,6 +366,10 @@ svn_boolean_t dav_svn__get_revprop_cache_flag(request_rec *r);
 svn_boolean_t
 dav_svn__get_nodeprop_cache_flag(request_rec *r);
 
+/* for the repository referred to by this request, should GET responses
+ * for immutable resources be cached? */
+svn_boolean_t dav_svn__get_response_cache_flag(request_rec *r);
+
 /* has block read mode been enabled for the repository referred to by this
  * request? */
 svn_boolean_t dav_svn__get_block_read_flag(request_rec *r);
@@ -425,6 +455,11 @@ const char *dav_svn__get_root_dir(request_rec *r);
 /* Return the data compression level to be used over the wire. */
 int dav_svn__get_compression_level(request_rec *r);
 
+/* Return the number of worker threads that may render text deltas of
+   "send-all" update reports concurrently.  Values below 2 mean that the
+   deltas get rendered by the request thread itself. */
+int dav_svn__get_update_render_threads(request_rec *r);
+
 /* Return the hook script environment parsed from the configuration. */
 const char *dav_svn__get_hooks_env(request_rec *r);
 
@@ -702,6 +737,7 @@ static const dav_report_elem dav_svn__reports_list[] = {
   { SVN_XML_NAMESPACE, SVN_DAV__MERGEINFO_REPORT },
   { SVN_XML_NAMESPACE, SVN_DAV__INHERITED_PROPS_REPORT },
   { SVN_XML_NAMESPACE, "list-report" },
+  { SVN_XML_NAMESPACE, "blame-report" },
   { NULL, NULL },
 };
 
@@ -759,6 +795,11 @@ dav_svn__list_report(const dav_resource *resource,
                      const apr_xml_doc *doc,
                      dav_svn__output *output);
 
+dav_error *
+dav_svn__blame_report(const dav_resource *resource,
+                      const apr_xml_doc *doc,
+                      dav_svn__output *output);
+
 /*** posts/ ***/
 
 /* The various POST handlers, defined in posts/, and used by repos.c.  */
@@ -993,6 +1034,12 @@ svn_error_t *dav_svn__brigade_printf(apr_bucket_brigade *bb,
                                      ...)
   __attribute__((format(printf, 3, 4)));
 
+/* Like dav_svn__brigade_printf() but taking the format arguments from AP. */
+svn_error_t *dav_svn__brigade_vprintf(apr_bucket_brigade *bb,
+                                      dav_svn__output *output,
+                                      const char *fmt,
+                                      va_list ap);
+
 /* Write an unspecified number of strings to OUTPUT using BB.  */
 svn_error_t *dav_svn__brigade_putstrs(apr_bucket_brigade *bb,
                                       dav_svn__output *output,
@@ -1129,6 +1176,32 @@ dav_svn__fuzzy_escape_author(const char *author,
                              apr_pool_t *result_pool,
                              apr_pool_t *scratch_pool);
 
+/*** response_cache.c ***/
+
+/* Set *RESPONSE to the response cached under KEY, allocated in
+ * RESULT_POOL, or to NULL if there is no such response.
+ */
+svn_error_t *
+dav_svn__response_cache_get(dav_svn__cached_response_t **response,
+                            const char *key,
+                            apr_pool_t *result_pool);
+
+/* Return TRUE, if a response with a body of BODY_LEN bytes may be stored
+ * in the response cache.  Return FALSE, if it is too large or if there is
+ * no response cache.
+ */
+svn_boolean_t
+dav_svn__response_cache_is_cachable(apr_size_t body_len);
+
+/* Store RESPONSE, which must have a body, under KEY in the response cache.
+ * Silently ignore responses that are too large.  Use SCRATCH_POOL for
+ * temporary allocations.
+ */
+svn_error_t *
+dav_svn__response_cache_set(const char *key,
+                            const dav_svn__cached_response_t *response,
+                            apr_pool_t *scratch_pool);
+
 /*** mirror.c ***/
 
 /* Perform the fixup hook for the R request.  */
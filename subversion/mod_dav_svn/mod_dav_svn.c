@@ -67,6 +67,10 @@ typedef struct server_conf_t {
      compression level. */
   int compression_level;
 
+  /* Number of worker threads rendering the text deltas of "send-all"
+     update reports.  Negative value used to specify the default. */
+  int update_render_threads;
+
 } server_conf_t;
 
 
@@ -106,6 +110,7 @@ typedef struct dir_conf_t {
   enum conf_flag fulltext_cache;     /* whether to enable fulltext caching */
   enum conf_flag revprop_cache;      /* whether to enable revprop caching */
   enum conf_flag nodeprop_cache;     /* whether to enable nodeprop caching */
+  enum conf_flag response_cache;     /* whether to enable response caching */
   enum conf_flag block_read;         /* whether to enable block read mode */
   const char *hooks_env;             /* path to hook script env config file */
 } dir_conf_t;
@@ -203,6 +208,7 @@ create_server_config(apr_pool_t *p, server_rec *s)
   server_conf_t *conf = apr_pcalloc(p, sizeof(server_conf_t));
 
   conf->compression_level = -1;
+  conf->update_render_threads = -1;
 
   return conf;
 }
@@ -231,6 +237,11 @@ merge_server_config(apr_pool_t *p, void *base, void *overrides)
       newconf->compression_level = child->compression_level;
     }
 
+  if (child->update_render_threads < 0)
+    newconf->update_render_threads = parent->update_render_threads;
+  else
+    newconf->update_render_threads = child->update_render_threads;
+
   return newconf;
 }
 
@@ -282,6 +293,7 @@ merge_dir_config(apr_pool_t *p, void *base, void *overrides)
   newconf->fulltext_cache = INHERIT_VALUE(parent, child, fulltext_cache);
   newconf->revprop_cache = INHERIT_VALUE(parent, child, revprop_cache);
   newconf->nodeprop_cache = INHERIT_VALUE(parent, child, nodeprop_cache);
+  newconf->response_cache = INHERIT_VALUE(parent, child, response_cache);
   newconf->block_read = INHERIT_VALUE(parent, child, block_read);
   newconf->root_dir = INHERIT_VALUE(parent, child, root_dir);
   newconf->hooks_env = INHERIT_VALUE(parent, child, hooks_env);
@@ -591,6 +603,19 @@ SVNCacheNodeProps_cmd(cmd_parms *cmd, void *config, int arg)
   return NULL;
 }
 
+static const char *
+SVNCacheResponses_cmd(cmd_parms *cmd, void *config, int arg)
+{
+  dir_conf_t *conf = config;
+
+  if (arg)
+    conf->response_cache = CONF_FLAG_ON;
+  else
+    conf->response_cache = CONF_FLAG_OFF;
+
+  return NULL;
+}
+
 static const char *
 SVNBlockRead_cmd(cmd_parms *cmd, void *config, int arg)
 {
@@ -652,6 +677,30 @@ SVNCompressionLevel_cmd(cmd_parms *cmd, void *config, const char *arg1)
   return NULL;
 }
 
+static const char *
+SVNUpdateRenderThreads_cmd(cmd_parms *cmd, void *config, const char *arg1)
+{
+  server_conf_t *conf;
+  int value = 0;
+  svn_error_t *err = svn_cstring_atoi(&value, arg1);
+  if (err)
+    {
+      svn_error_clear(err);
+      return "Invalid decimal number for the SVN update render threads.";
+    }
+
+  if (value < 0)
+    return apr_psprintf(cmd->pool,
+                        "%d is not a valid number of render threads.",
+                        value);
+
+  conf = ap_get_module_config(cmd->server->module_config,
+                              &dav_svn_module);
+  conf->update_render_threads = value;
+
+  return NULL;
+}
+
 static const char *
 SVNUseUTF8_cmd(cmd_parms *cmd, void *config, int arg)
 {
@@ -1016,6 +1065,17 @@ dav_svn__get_nodeprop_cache_flag(request_rec *r)
   return get_conf_flag(conf->nodeprop_cache, TRUE);
 }
 
+svn_boolean_t
+dav_svn__get_response_cache_flag(request_rec *r)
+{
+  dir_conf_t *conf;
+
+  conf = ap_get_module_config(r->per_dir_config, &dav_svn_module);
+
+  /* response caching is disabled by default. */
+  return get_conf_flag(conf->response_cache, FALSE);
+}
+
 svn_boolean_t
 dav_svn__get_block_read_flag(request_rec *r)
 {
@@ -1045,6 +1105,18 @@ dav_svn__get_compression_level(request_rec *r)
     }
 }
 
+int
+dav_svn__get_update_render_threads(request_rec *r)
+{
+  server_conf_t *conf;
+
+  conf = ap_get_module_config(r->server->module_config,
+                              &dav_svn_module);
+
+  /* Rendering on the request thread is the default. */
+  return conf->update_render_threads < 0 ? 0 : conf->update_render_threads;
+}
+
 const char *
 dav_svn__get_hooks_env(request_rec *r)
 {
@@ -1375,6 +1447,13 @@ static const command_rec cmds[] =
                "if sufficient in-memory cache is available"
                "(default is On)."),
 
+  /* per directory/location */
+  AP_INIT_FLAG("SVNCacheResponses", SVNCacheResponses_cmd, NULL,
+               ACCESS_CONF|RSRC_CONF,
+               "serves repeated GET requests for files in fixed revisions "
+               "from the in-memory cache (see SVNInMemoryCacheSize) "
+               "(default is Off)."),
+
   /* per directory/location */
   AP_INIT_FLAG("SVNBlockRead", SVNBlockRead_cmd, NULL,
                ACCESS_CONF|RSRC_CONF,
@@ -1395,6 +1474,14 @@ static const command_rec cmds[] =
                 "content over the network (0 for no compression, 9 for "
                 "maximum, 5 is default)."),
 
+  /* per server */
+  AP_INIT_TAKE1("SVNUpdateRenderThreads", SVNUpdateRenderThreads_cmd, NULL,
+                RSRC_CONF,
+                "specifies the number of worker threads per request that "
+                "compress and encode file contents sent in bulk update "
+                "responses (default is 0; 0 and 1 let the request thread "
+                "do all the work)."),
+
   /* per server */
   AP_INIT_FLAG("SVNUseUTF8",
                SVNUseUTF8_cmd, NULL,
@@ -42,10 +42,34 @@
 
 #include "private/svn_log.h"
 #include "private/svn_fspath.h"
+#include "private/svn_thread_pool.h"
 
 #include "../dav_svn.h"
 
 
+/* Text deltas of files whose svndiff data exceeds this size will be
+   rendered by the request thread, i.e. we don't buffer them in memory. */
+#define RENDER_MAX_FILE_SIZE (4 * 1024 * 1024)
+
+/* Once this much data is held back because of still running txdelta
+   renderings, wait for all of them to finish before continuing. */
+#define RENDER_MAX_PENDING_SIZE (16 * 1024 * 1024)
+
+/* A piece of the report output that has to wait for a txdelta element
+   being rendered by a worker thread.  These form a FIFO in report order. */
+typedef struct pending_output_t {
+  /* Literal report text.  NULL if this is a txdelta element. */
+  svn_stringbuf_t *text;
+
+  /* The txdelta rendering task and its baton (a render_baton_t).
+     Only used if TEXT is NULL. */
+  svn_thread_pool__task_t *task;
+  struct render_baton_t *render;
+
+  /* Next element in report order or NULL. */
+  struct pending_output_t *next;
+} pending_output_t;
+
 /* State baton for the overall update process. */
 typedef struct update_ctx_t {
   const dav_resource *resource;
@@ -96,6 +120,26 @@ typedef struct update_ctx_t {
      resource" and are we advertising support for as much? */
   svn_boolean_t enable_v2_response;
 
+  /* Worker threads that render the txdelta elements in "send-all" mode.
+     NULL if those shall be rendered by the request thread. */
+  svn_thread_pool__group_t *render_group;
+
+  /* Report output held back while txdelta elements are being rendered.
+     Both are NULL if nothing is pending. */
+  pending_output_t *pending_head;
+  pending_output_t *pending_tail;
+
+  /* Approximate number of bytes held by the pending output and the
+     windows waiting to be rendered. */
+  apr_size_t pending_size;
+
+  /* Pool for the pending_output_t elements and literal texts.  Gets
+     cleared whenever the pending list becomes empty. */
+  apr_pool_t *pending_pool;
+
+  /* Parent pool for the per-file rendering pools. */
+  apr_pool_t *pool;
+
 } update_ctx_t;
 
 
@@ -137,6 +181,182 @@ typedef struct item_baton_t {
 #define DIR_OR_FILE(is_dir) ((is_dir) ? "directory" : "file")
 
 
+/* Baton for render_txdelta(), describing a txdelta element to render. */
+typedef struct render_baton_t {
+  /* Pool holding this structure and WINDOWS.  It is owned by the request
+     thread; worker threads only read from it. */
+  apr_pool_t *pool;
+
+  /* Value of the base-checksum attribute of the txdelta element or NULL. */
+  const char *base_checksum;
+
+  /* SVNDIFF version and compression level to use. */
+  int svndiff_version;
+  int compression_level;
+
+  /* The svn_txdelta_window_t * to render, not including the final NULL. */
+  apr_array_header_t *windows;
+
+  /* Approximate size of WINDOWS in bytes. */
+  apr_size_t size;
+
+  /* The complete txdelta element, allocated in the task's pool. */
+  svn_stringbuf_t *result;
+} render_baton_t;
+
+
+/* Write the pending output of UC to the response in report order, up to
+   the first txdelta element that is still being rendered.  If WAIT_ALL
+   is set, wait for the renderings to complete and write everything. */
+static svn_error_t *
+flush_pending(update_ctx_t *uc, svn_boolean_t wait_all)
+{
+  while (uc->pending_head)
+    {
+      pending_output_t *head = uc->pending_head;
+      render_baton_t *render = head->render;
+      svn_error_t *err;
+
+      if (head->text)
+        {
+          SVN_ERR(dav_svn__brigade_write(uc->bb, uc->output,
+                                         head->text->data, head->text->len));
+          uc->pending_head = head->next;
+          uc->pending_size -= head->text->len;
+          continue;
+        }
+
+      if (! wait_all)
+        {
+          svn_boolean_t done;
+
+          SVN_ERR(svn_thread_pool__task_done(&done, head->task));
+          if (! done)
+            break;
+        }
+
+      err = svn_thread_pool__task_wait(head->task);
+      if (! err)
+        err = dav_svn__brigade_write(uc->bb, uc->output,
+                                     render->result->data,
+                                     render->result->len);
+
+      /* Release the rendering resources, even in case of an error. */
+      uc->pending_head = head->next;
+      uc->pending_size -= render->size;
+      svn_thread_pool__task_destroy(head->task);
+      svn_pool_destroy(render->pool);
+
+      SVN_ERR(err);
+    }
+
+  if (! uc->pending_head)
+    {
+      uc->pending_tail = NULL;
+      uc->pending_size = 0;
+      svn_pool_clear(uc->pending_pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+
+/* Wait for all txdelta renderings of UC to finish and drop all pending
+   output.  Used when the report gets aborted. */
+static void
+discard_pending(update_ctx_t *uc)
+{
+  pending_output_t *element;
+
+  for (element = uc->pending_head; element; element = element->next)
+    if (! element->text)
+      {
+        svn_thread_pool__task_destroy(element->task);
+        svn_pool_destroy(element->render->pool);
+      }
+
+  uc->pending_head = NULL;
+  uc->pending_tail = NULL;
+  uc->pending_size = 0;
+}
+
+
+/* Append ELEMENT to the pending output of UC. */
+static void
+append_pending(update_ctx_t *uc, pending_output_t *element)
+{
+  if (uc->pending_tail)
+    uc->pending_tail->next = element;
+  else
+    uc->pending_head = element;
+
+  uc->pending_tail = element;
+}
+
+
+/* Queue the NULL-terminated STR behind the pending output of UC.
+   The pending output must not be empty. */
+static void
+queue_text(update_ctx_t *uc, const char *str)
+{
+  pending_output_t *tail = uc->pending_tail;
+  apr_size_t len = strlen(str);
+
+  if (! tail->text)
+    {
+      tail = apr_pcalloc(uc->pending_pool, sizeof(*tail));
+      tail->text = svn_stringbuf_create_empty(uc->pending_pool);
+      append_pending(uc, tail);
+    }
+
+  svn_stringbuf_appendbytes(tail->text, str, len);
+  uc->pending_size += len;
+}
+
+
+/* Send the NULL-terminated STR as part of the report of UC.  If earlier
+   parts of the report are still being rendered, queue STR behind them. */
+static svn_error_t *
+upd_puts(update_ctx_t *uc, const char *str)
+{
+  if (uc->pending_head)
+    SVN_ERR(flush_pending(uc, FALSE));
+
+  if (! uc->pending_head)
+    return dav_svn__brigade_puts(uc->bb, uc->output, str);
+
+  queue_text(uc, str);
+
+  return SVN_NO_ERROR;
+}
+
+
+/* Like upd_puts() but using FMT as the output format string. */
+static svn_error_t *
+upd_printf(update_ctx_t *uc, const char *fmt, ...)
+{
+  svn_error_t *err;
+  va_list ap;
+
+  if (uc->pending_head)
+    SVN_ERR(flush_pending(uc, FALSE));
+
+  va_start(ap, fmt);
+  if (uc->pending_head)
+    {
+      queue_text(uc, apr_pvsprintf(uc->pending_pool, fmt, ap));
+      err = SVN_NO_ERROR;
+    }
+  else
+    {
+      err = dav_svn__brigade_vprintf(uc->bb, uc->output, fmt, ap);
+    }
+  va_end(ap);
+
+  return err;
+}
+
+
 /* add PATH to the pathmap HASH with a repository path of LINKPATH.
    if LINKPATH is NULL, PATH will map to itself. */
 static void
@@ -262,10 +482,10 @@ send_vsn_url(item_baton_t *baton, apr_pool_t *pool)
                                 revision, path, FALSE /* add_href */, pool);
     }
 
-  return dav_svn__brigade_printf(baton->uc->bb, baton->uc->output,
-                                 "<D:checked-in><D:href>%s</D:href>"
-                                 "</D:checked-in>" DEBUG_CR,
-                                 apr_xml_quote_string(pool, href, 1));
+  return upd_printf(baton->uc,
+                    "<D:checked-in><D:href>%s</D:href>"
+                    "</D:checked-in>" DEBUG_CR,
+                    apr_xml_quote_string(pool, href, 1));
 }
 
 
@@ -279,8 +499,8 @@ absent_helper(svn_boolean_t is_dir,
 
   if (! uc->resource_walk)
     {
-      SVN_ERR(dav_svn__brigade_printf
-              (uc->bb, uc->output,
+      SVN_ERR(upd_printf
+              (uc,
                "<S:absent-%s name=\"%s\"/>" DEBUG_CR,
                DIR_OR_FILE(is_dir),
                apr_xml_quote_string(pool,
@@ -323,10 +543,8 @@ add_helper(svn_boolean_t is_dir,
 
   if (uc->resource_walk)
     {
-      SVN_ERR(dav_svn__brigade_printf(child->uc->bb, child->uc->output,
-                                      "<S:resource path=\"%s\">" DEBUG_CR,
-                                      apr_xml_quote_string(pool, child->path3,
-                                                           1)));
+      SVN_ERR(upd_printf(child->uc, "<S:resource path=\"%s\">" DEBUG_CR,
+                         apr_xml_quote_string(pool, child->path3, 1)));
     }
   else
     {
@@ -403,14 +621,13 @@ add_helper(svn_boolean_t is_dir,
          placeholders.  For example, "this%20dir" is a valid printf()
          format string that means "this[insert an integer of width 20
          here]ir". */
-      SVN_ERR(dav_svn__brigade_puts(child->uc->bb, child->uc->output, elt));
+      SVN_ERR(upd_puts(child->uc, elt));
     }
 
   SVN_ERR(send_vsn_url(child, pool));
 
   if (uc->resource_walk)
-    SVN_ERR(dav_svn__brigade_puts(child->uc->bb, child->uc->output,
-                                  "</S:resource>" DEBUG_CR));
+    SVN_ERR(upd_puts(child->uc, "</S:resource>" DEBUG_CR));
 
   *child_baton = child;
 
@@ -429,10 +646,10 @@ open_helper(svn_boolean_t is_dir,
   item_baton_t *child = make_child_baton(parent, path, pool);
   const char *qname = apr_xml_quote_string(pool, child->name, 1);
 
-  SVN_ERR(dav_svn__brigade_printf(child->uc->bb, child->uc->output,
-                                  "<S:open-%s name=\"%s\""
-                                  " rev=\"%ld\">" DEBUG_CR,
-                                  DIR_OR_FILE(is_dir), qname, base_revision));
+  SVN_ERR(upd_printf(child->uc,
+                     "<S:open-%s name=\"%s\""
+                     " rev=\"%ld\">" DEBUG_CR,
+                     DIR_OR_FILE(is_dir), qname, base_revision));
   SVN_ERR(send_vsn_url(child, pool));
   *child_baton = child;
   return SVN_NO_ERROR;
@@ -456,21 +673,19 @@ close_helper(svn_boolean_t is_dir, item_baton_t *baton, apr_pool_t *pool)
         {
           qname = APR_ARRAY_IDX(baton->removed_props, i, const char *);
           qname = apr_xml_quote_string(pool, qname, 1);
-          SVN_ERR(dav_svn__brigade_printf(baton->uc->bb, baton->uc->output,
-                                          "<S:remove-prop name=\"%s\"/>"
-                                          DEBUG_CR, qname));
+          SVN_ERR(upd_printf(baton->uc,
+                             "<S:remove-prop name=\"%s\"/>"
+                             DEBUG_CR, qname));
         }
     }
 
   /* Let's tie it off, nurse. */
   if (baton->added)
-    SVN_ERR(dav_svn__brigade_printf(baton->uc->bb, baton->uc->output,
-                                    "</S:add-%s>" DEBUG_CR,
-                                    DIR_OR_FILE(is_dir)));
+    SVN_ERR(upd_printf(baton->uc, "</S:add-%s>" DEBUG_CR,
+                       DIR_OR_FILE(is_dir)));
   else
-    SVN_ERR(dav_svn__brigade_printf(baton->uc->bb, baton->uc->output,
-                                    "</S:open-%s>" DEBUG_CR,
-                                    DIR_OR_FILE(is_dir)));
+    SVN_ERR(upd_printf(baton->uc, "</S:open-%s>" DEBUG_CR,
+                       DIR_OR_FILE(is_dir)));
   return SVN_NO_ERROR;
 }
 
@@ -507,9 +722,9 @@ upd_set_target_revision(void *edit_baton,
   SVN_ERR(maybe_start_update_report(uc));
 
   if (! uc->resource_walk)
-    SVN_ERR(dav_svn__brigade_printf(uc->bb, uc->output,
-                                    "<S:target-revision rev=\"%ld\"/>"
-                                    DEBUG_CR, target_revision));
+    SVN_ERR(upd_printf(uc,
+                       "<S:target-revision rev=\"%ld\"/>"
+                       DEBUG_CR, target_revision));
 
   return SVN_NO_ERROR;
 }
@@ -538,13 +753,12 @@ upd_open_root(void *edit_baton,
   SVN_ERR(maybe_start_update_report(uc));
 
   if (uc->resource_walk)
-    SVN_ERR(dav_svn__brigade_printf(uc->bb, uc->output,
-                                    "<S:resource path=\"%s\">" DEBUG_CR,
-                                    apr_xml_quote_string(pool, b->path3, 1)));
+    SVN_ERR(upd_printf(uc,
+                       "<S:resource path=\"%s\">" DEBUG_CR,
+                       apr_xml_quote_string(pool, b->path3, 1)));
   else
-    SVN_ERR(dav_svn__brigade_printf(uc->bb, uc->output,
-                                    "<S:open-directory rev=\"%ld\">" DEBUG_CR,
-                                    base_revision));
+    SVN_ERR(upd_printf(uc, "<S:open-directory rev=\"%ld\">" DEBUG_CR,
+                       base_revision));
 
   /* Only transmit the root directory's Version Resource URL if
      there's no target. */
@@ -552,8 +766,7 @@ upd_open_root(void *edit_baton,
     SVN_ERR(send_vsn_url(b, pool));
 
   if (uc->resource_walk)
-    SVN_ERR(dav_svn__brigade_puts(uc->bb, uc->output,
-                                  "</S:resource>" DEBUG_CR));
+    SVN_ERR(upd_puts(uc, "</S:resource>" DEBUG_CR));
 
   return SVN_NO_ERROR;
 }
@@ -569,9 +782,9 @@ upd_delete_entry(const char *path,
   const char *qname = apr_xml_quote_string(pool,
                                            svn_relpath_basename(path, NULL),
                                            1);
-  return dav_svn__brigade_printf(parent->uc->bb, parent->uc->output,
-                                 "<S:delete-entry name=\"%s\" rev=\"%ld\"/>"
-                                   DEBUG_CR, qname, revision);
+  return upd_printf(parent->uc,
+                    "<S:delete-entry name=\"%s\" rev=\"%ld\"/>"
+                      DEBUG_CR, qname, revision);
 }
 
 
@@ -621,29 +834,27 @@ send_propchange(item_baton_t *b,
           svn_stringbuf_t *tmp = NULL;
           svn_xml_escape_cdata_string(&tmp, value, pool);
           qval = tmp->data;
-          SVN_ERR(dav_svn__brigade_printf(b->uc->bb, b->uc->output,
-                                          "<S:set-prop name=\"%s\">",
-                                          qname));
+          SVN_ERR(upd_printf(b->uc, "<S:set-prop name=\"%s\">",
+                             qname));
         }
       else
         {
           qval = svn_base64_encode_string2(value, TRUE, pool)->data;
-          SVN_ERR(dav_svn__brigade_printf(b->uc->bb, b->uc->output,
-                                          "<S:set-prop name=\"%s\" "
-                                          "encoding=\"base64\">" DEBUG_CR,
-                                          qname));
+          SVN_ERR(upd_printf(b->uc,
+                             "<S:set-prop name=\"%s\" "
+                             "encoding=\"base64\">" DEBUG_CR,
+                             qname));
         }
 
-      SVN_ERR(dav_svn__brigade_puts(b->uc->bb, b->uc->output, qval));
-      SVN_ERR(dav_svn__brigade_puts(b->uc->bb, b->uc->output,
-                                    "</S:set-prop>" DEBUG_CR));
+      SVN_ERR(upd_puts(b->uc, qval));
+      SVN_ERR(upd_puts(b->uc, "</S:set-prop>" DEBUG_CR));
     }
   else  /* value is null, so this is a prop removal */
     {
-      SVN_ERR(dav_svn__brigade_printf(b->uc->bb, b->uc->output,
-                                      "<S:remove-prop name=\"%s\"/>"
-                                      DEBUG_CR,
-                                      qname));
+      SVN_ERR(upd_printf(b->uc,
+                         "<S:remove-prop name=\"%s\"/>"
+                         DEBUG_CR,
+                         qname));
     }
 
   return SVN_NO_ERROR;
@@ -763,9 +974,77 @@ struct window_handler_baton
   /* The _real_ window handler and baton. */
   svn_txdelta_window_handler_t handler;
   void *handler_baton;
+
+  /* The windows collected for rendering by a worker thread.  NULL if
+     we render them ourselves through HANDLER. */
+  render_baton_t *render;
+
+  /* Pool to allocate the real window handler in. */
+  apr_pool_t *pool;
 };
 
 
+/* Set up the real window handler in WB that sends the svndiff data
+   straight to the response. */
+static void
+init_inline_rendering(struct window_handler_baton *wb)
+{
+  svn_stream_t *base64_stream;
+
+  base64_stream = dav_svn__make_base64_output_stream(wb->uc->bb,
+                                                     wb->uc->output,
+                                                     wb->pool);
+
+  svn_txdelta_to_svndiff3(&(wb->handler), &(wb->handler_baton),
+                          base64_stream, wb->uc->svndiff_version,
+                          wb->uc->compression_level, wb->pool);
+}
+
+
+/* Implements svn_thread_pool__func_t.  Render the complete txdelta
+   element described by the render_baton_t BATON into its RESULT. */
+static svn_error_t *
+render_txdelta(void *baton, apr_pool_t *result_pool)
+{
+  render_baton_t *render = baton;
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+  svn_stringbuf_t *result;
+  svn_stream_t *stream;
+  int i;
+
+  /* Base64 adds a third to the svndiff data, which in turn is usually
+     not larger than the windows. */
+  result = svn_stringbuf_create_ensure(render->size / 3 * 4 + 100,
+                                       result_pool);
+  if (render->base_checksum)
+    svn_stringbuf_appendcstr(result,
+                             apr_psprintf(result_pool,
+                                          "<S:txdelta base-checksum=\"%s\">",
+                                          render->base_checksum));
+  else
+    svn_stringbuf_appendcstr(result, "<S:txdelta>");
+
+  stream = svn_base64_encode2(svn_stream_from_stringbuf(result, result_pool),
+                              FALSE, result_pool);
+  svn_txdelta_to_svndiff3(&handler, &handler_baton, stream,
+                          render->svndiff_version, render->compression_level,
+                          result_pool);
+
+  for (i = 0; i < render->windows->nelts; i++)
+    SVN_ERR(handler(APR_ARRAY_IDX(render->windows, i, svn_txdelta_window_t *),
+                    handler_baton));
+
+  /* This also closes STREAM, flushing the remaining base64 data. */
+  SVN_ERR(handler(NULL, handler_baton));
+
+  svn_stringbuf_appendcstr(result, "</S:txdelta>");
+  render->result = result;
+
+  return SVN_NO_ERROR;
+}
+
+
 /* This implements 'svn_txdelta_window_handler_t'. */
 static svn_error_t *
 window_handler(svn_txdelta_window_t *window, void *baton)
@@ -777,25 +1056,84 @@ window_handler(svn_txdelta_window_t *window, void *baton)
       wb->seen_first_window = TRUE;
 
       if (!wb->base_checksum)
-        SVN_ERR(dav_svn__brigade_puts(wb->uc->bb, wb->uc->output,
-                                      "<S:txdelta>"));
+        SVN_ERR(upd_puts(wb->uc, "<S:txdelta>"));
       else
-        SVN_ERR(dav_svn__brigade_printf(wb->uc->bb, wb->uc->output,
-                                        "<S:txdelta base-checksum=\"%s\">",
-                                        wb->base_checksum));
+        SVN_ERR(upd_printf(wb->uc, "<S:txdelta base-checksum=\"%s\">",
+                           wb->base_checksum));
     }
 
   SVN_ERR(wb->handler(window, wb->handler_baton));
 
   if (window == NULL)
     {
-      SVN_ERR(dav_svn__brigade_puts(wb->uc->bb, wb->uc->output,
-                                    "</S:txdelta>"));
+      SVN_ERR(upd_puts(wb->uc, "</S:txdelta>"));
     }
 
   return SVN_NO_ERROR;
 }
 
+
+/* This implements 'svn_txdelta_window_handler_t'.  Collect the windows
+   for rendering by a worker thread and hand them over after the last one.
+   Revert to rendering inline if the file turns out to be large. */
+static svn_error_t *
+collect_window_handler(svn_txdelta_window_t *window, void *baton)
+{
+  struct window_handler_baton *wb = baton;
+  render_baton_t *render = wb->render;
+  update_ctx_t *uc = wb->uc;
+  pending_output_t *element;
+
+  if (! render)
+    return svn_error_trace(window_handler(window, baton));
+
+  if (window)
+    {
+      int i;
+
+      APR_ARRAY_PUSH(render->windows, svn_txdelta_window_t *)
+        = svn_txdelta_window_dup(window, render->pool);
+      render->size += window->num_ops * sizeof(*window->ops);
+      if (window->new_data)
+        render->size += window->new_data->len;
+
+      if (render->size <= RENDER_MAX_FILE_SIZE)
+        return SVN_NO_ERROR;
+
+      /* Too large to be held in memory.  Send everything before this
+         file's contents and stream the contents through the request
+         thread. */
+      SVN_ERR(flush_pending(uc, TRUE));
+
+      wb->render = NULL;
+      init_inline_rendering(wb);
+      for (i = 0; i < render->windows->nelts; i++)
+        SVN_ERR(window_handler(APR_ARRAY_IDX(render->windows, i,
+                                             svn_txdelta_window_t *),
+                               wb));
+
+      svn_pool_destroy(render->pool);
+
+      return SVN_NO_ERROR;
+    }
+
+  /* All windows have been collected. */
+  element = apr_pcalloc(uc->pending_pool, sizeof(*element));
+  element->render = render;
+  wb->render = NULL;
+
+  SVN_ERR(svn_thread_pool__run(&element->task, uc->render_group,
+                               render_txdelta, render));
+
+  append_pending(uc, element);
+  uc->pending_size += render->size;
+
+  /* Send what we can, but don't let the pending output grow too large. */
+  return svn_error_trace(flush_pending(uc, uc->pending_size
+                                             > RENDER_MAX_PENDING_SIZE));
+}
+
+
 static svn_error_t *
 upd_apply_textdelta(void *file_baton,
                     const char *base_checksum,
@@ -805,7 +1143,6 @@ upd_apply_textdelta(void *file_baton,
 {
   item_baton_t *file = file_baton;
   struct window_handler_baton *wb;
-  svn_stream_t *base64_stream;
 
   /* Store the base checksum and the fact the file's text changed. */
   file->base_checksum = apr_pstrdup(file->pool, base_checksum);
@@ -820,19 +1157,34 @@ upd_apply_textdelta(void *file_baton,
       return SVN_NO_ERROR;
     }
 
-  wb = apr_palloc(file->pool, sizeof(*wb));
+  wb = apr_pcalloc(file->pool, sizeof(*wb));
   wb->seen_first_window = FALSE;
   wb->uc = file->uc;
   wb->base_checksum = file->base_checksum;
-  base64_stream = dav_svn__make_base64_output_stream(wb->uc->bb,
-                                                     wb->uc->output,
-                                                     file->pool);
+  wb->pool = file->pool;
 
-  svn_txdelta_to_svndiff3(&(wb->handler), &(wb->handler_baton),
-                          base64_stream, file->uc->svndiff_version,
-                          file->uc->compression_level, file->pool);
+  if (wb->uc->render_group)
+    {
+      /* The windows must outlive FILE->POOL while being rendered. */
+      apr_pool_t *render_pool = svn_pool_create(wb->uc->pool);
+      render_baton_t *render = apr_pcalloc(render_pool, sizeof(*render));
+
+      render->pool = render_pool;
+      render->base_checksum = apr_pstrdup(render_pool, base_checksum);
+      render->svndiff_version = wb->uc->svndiff_version;
+      render->compression_level = wb->uc->compression_level;
+      render->windows = apr_array_make(render_pool, 16,
+                                       sizeof(svn_txdelta_window_t *));
+      wb->render = render;
+
+      *handler = collect_window_handler;
+    }
+  else
+    {
+      init_inline_rendering(wb);
+      *handler = window_handler;
+    }
 
-  *handler = window_handler;
   *handler_baton = wb;
 
   return SVN_NO_ERROR;
@@ -860,8 +1212,8 @@ upd_close_file(void *file_baton, const char *text_checksum, apr_pool_t *pool)
       if (sha1_checksum)
         sha1_digest = svn_checksum_to_cstring(sha1_checksum, pool);
 
-      SVN_ERR(dav_svn__brigade_printf
-              (file->uc->bb, file->uc->output,
+      SVN_ERR(upd_printf
+              (file->uc,
                "<S:fetch-file%s%s%s%s%s%s/>" DEBUG_CR,
                file->base_checksum ? " base-checksum=\"" : "",
                file->base_checksum ? file->base_checksum : "",
@@ -873,11 +1225,11 @@ upd_close_file(void *file_baton, const char *text_checksum, apr_pool_t *pool)
 
   if (text_checksum)
     {
-      SVN_ERR(dav_svn__brigade_printf(file->uc->bb, file->uc->output,
-                                      "<S:prop>"
-                                      "<V:md5-checksum>%s</V:md5-checksum>"
-                                      "</S:prop>",
-                                      text_checksum));
+      SVN_ERR(upd_printf(file->uc,
+                         "<S:prop>"
+                         "<V:md5-checksum>%s</V:md5-checksum>"
+                         "</S:prop>",
+                         text_checksum));
     }
 
   return close_helper(FALSE /* is_dir */, file, pool);
@@ -889,6 +1241,9 @@ upd_close_edit(void *edit_baton, apr_pool_t *pool)
 {
   update_ctx_t *uc = edit_baton;
 
+  /* Send everything that still waits for txdelta renderings. */
+  SVN_ERR(flush_pending(uc, TRUE));
+
   /* Our driver will unconditionally close the update report... So if
      the report hasn't even been started yet, start it now. */
   return maybe_start_update_report(uc);
@@ -1205,6 +1560,8 @@ dav_svn__update_report(const dav_resource *resource,
   uc.bb = apr_brigade_create(resource->pool,
                              dav_svn__output_get_bucket_alloc(output));
   uc.pathmap = NULL;
+  uc.pool = resource->pool;
+  uc.pending_pool = svn_pool_create(resource->pool);
   uc.enable_v2_response = ((resource->info->restype == DAV_SVN_RESTYPE_ME)
                            && (resource->info->repos->v2_protocol));
 
@@ -1248,6 +1605,25 @@ dav_svn__update_report(const dav_resource *resource,
   if (! uc.send_all)
     text_deltas = FALSE;
 
+  /* In "send-all" mode, let worker threads compress and encode the text
+     deltas while we continue to drive the editor, if so configured. */
+  if (uc.send_all)
+    {
+      int threads = dav_svn__get_update_render_threads(resource->info->r);
+      if (threads > 1)
+        {
+          serr = svn_thread_pool__group_create(&uc.render_group, threads,
+                                               resource->pool);
+          if (serr)
+            return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                        "Could not start the render threads.",
+                                        resource->pool);
+
+          if (! svn_thread_pool__group_is_parallel(uc.render_group))
+            uc.render_group = NULL;
+        }
+    }
+
   /* When we call svn_repos_finish_report, it will ultimately run
      dir_delta() between REPOS_PATH/TARGET and TARGET_PATH.  In the
      case of an update or status, these paths should be identical.  In
@@ -1565,6 +1941,9 @@ dav_svn__update_report(const dav_resource *resource,
   if (derr && rbaton)
     svn_error_clear(svn_repos_abort_report(rbaton, resource->pool));
 
+  /* Don't leave any worker thread behind that still uses our data. */
+  discard_pending(&uc);
+
   /* Destroy our subpool. */
   svn_pool_destroy(subpool);
 
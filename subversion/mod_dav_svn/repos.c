@@ -57,6 +57,7 @@
 #include "private/svn_fspath.h"
 #include "private/svn_repos_private.h"
 #include "private/svn_sorts_private.h"
+#include "private/svn_string_private.h"
 
 #include "dav_svn.h"
 
@@ -3161,12 +3162,85 @@ is_cacheable(request_rec *r, const dav_resource *resource)
       return FALSE;
 }
 
+/* Helper for set_headers().  Return the key under which the GET response
+ * for RESOURCE, requested by R, may be stored in the response cache.
+ * Return NULL, if that response must not be cached.
+ *
+ * The key must cover everything that the response depends on:  The node
+ * in the repository, the delta base and svndiff format and, for non-svn
+ * clients, the MIME type that httpd guessed from the URL.
+ *
+ * The delta base is client-controlled and paths may contain any
+ * character, so every string field is prefixed with its length to keep
+ * distinct requests from mapping to the same key.
+ */
+static const char *
+response_cache_key(request_rec *r, const dav_resource *resource)
+{
+  dav_resource_private *info = resource->info;
+  const char *content_type = "";
+  const char *delta_base = "";
+  int svndiff_version = -1;
+  int compression_level = -1;
+
+  /* Keyword expansion depends on revision properties, which may change. */
+  if (! is_cacheable(r, resource)
+      || info->keyword_subst
+      || ! SVN_IS_VALID_REVNUM(info->root.rev)
+      || ! dav_svn__get_response_cache_flag(r))
+    return NULL;
+
+  if (! info->repos->is_svn_client && r->content_type)
+    content_type = r->content_type;
+
+  if (info->delta_base)
+    {
+      delta_base = info->delta_base;
+      svndiff_version = info->svndiff_version;
+      compression_level = dav_svn__get_compression_level(r);
+    }
+
+  return apr_psprintf(resource->pool,
+                      "%" APR_SIZE_T_FMT ":%s"
+                      "%ld:%d:%d:"
+                      "%" APR_SIZE_T_FMT ":%s"
+                      "%" APR_SIZE_T_FMT ":%s"
+                      "%" APR_SIZE_T_FMT ":%s",
+                      strlen(info->repos->fs_path), info->repos->fs_path,
+                      info->root.rev, svndiff_version, compression_level,
+                      strlen(content_type), content_type,
+                      strlen(delta_base), delta_base,
+                      strlen(info->repos_path), info->repos_path);
+}
+
+/* Helper for set_headers().  Set the response headers of R for RESOURCE
+ * from the cached RESPONSE. */
+static void
+set_cached_headers(request_rec *r,
+                   const dav_resource *resource,
+                   const dav_svn__cached_response_t *response)
+{
+  apr_table_setn(r->headers_out, "ETag", response->etag);
+  apr_table_setn(r->headers_out, "Accept-Ranges", "bytes");
+
+  if (response->is_svndiff)
+    {
+      apr_table_setn(r->headers_out, "Vary", SVN_DAV_DELTA_BASE_HEADER);
+      apr_table_setn(r->headers_out, SVN_DAV_DELTA_BASE_HEADER,
+                     resource->info->delta_base);
+    }
+
+  ap_set_content_length(r, (apr_off_t) response->body->len);
+  ap_set_content_type(r, response->mimetype);
+}
+
 static dav_error *
 set_headers(request_rec *r, const dav_resource *resource)
 {
   svn_error_t *serr;
   svn_filesize_t length;
   const char *mimetype = NULL;
+  dav_svn__cached_response_t *response = NULL;
 
   /* As version resources don't change, encourage caching. */
   if (is_cacheable(r, resource))
@@ -3178,9 +3252,37 @@ set_headers(request_rec *r, const dav_resource *resource)
   if (!resource->exists)
     return NULL;
 
+  /* Serve immutable contents from our response cache, if possible.
+     A cache failure merely means that we have to ask the FS. */
+  resource->info->response_key = response_cache_key(r, resource);
+  if (resource->info->response_key)
+    {
+      serr = dav_svn__response_cache_get(&response,
+                                         resource->info->response_key,
+                                         resource->pool);
+      if (serr)
+        {
+          svn_error_clear(serr);
+          response = NULL;
+        }
+
+      if (response)
+        {
+          resource->info->response = response;
+          set_cached_headers(r, resource, response);
+          return NULL;
+        }
+
+      /* Collect the headers for deliver() to cache along with the body. */
+      response = apr_pcalloc(resource->pool, sizeof(*response));
+      resource->info->response = response;
+    }
+
   /* generate our etag and place it into the output */
   apr_table_setn(r->headers_out, "ETag",
                  dav_svn__getetag(resource, resource->pool));
+  if (response)
+    response->etag = apr_table_get(r->headers_out, "ETag");
 
   /* we accept byte-ranges */
   apr_table_setn(r->headers_out, "Accept-Ranges", "bytes");
@@ -3209,6 +3311,8 @@ set_headers(request_rec *r, const dav_resource *resource)
       if ((serr == NULL) && (info.rev != SVN_INVALID_REVNUM))
         {
           mimetype = SVN_SVNDIFF_MIME_TYPE;
+          if (response)
+            response->is_svndiff = TRUE;
 
           /* Note the base that this svndiff is based on, and tell any
              intermediate caching proxies that this header is
@@ -3290,14 +3394,65 @@ set_headers(request_rec *r, const dav_resource *resource)
   /* set the discovered MIME type */
   /* ### it would be best to do this during the findct phase... */
   ap_set_content_type(r, mimetype);
+  if (response)
+    response->mimetype = mimetype;
 
   return NULL;
 }
 
 
+/* Append the LEN bytes at DATA to the response body *CAPTURE, if it is
+   not NULL.  Stop capturing by setting *CAPTURE to NULL as soon as the
+   body gets too large for the response cache. */
+static void
+capture_response(svn_stringbuf_t **capture,
+                 const char *data,
+                 apr_size_t len)
+{
+  if (*capture == NULL)
+    return;
+
+  if (dav_svn__response_cache_is_cachable((*capture)->len + len))
+    svn_stringbuf_appendbytes(*capture, data, len);
+  else
+    *capture = NULL;
+}
+
+/* Store the complete response body CAPTURE for RESOURCE in the response
+   cache, unless CAPTURE is NULL.  Failing to do so is not an error. */
+static void
+cache_response(const dav_resource *resource,
+               svn_stringbuf_t *capture)
+{
+  dav_svn__cached_response_t *response = resource->info->response;
+
+  if (capture == NULL)
+    return;
+
+  response->body = svn_stringbuf__morph_into_string(capture);
+  svn_error_clear(dav_svn__response_cache_set(resource->info->response_key,
+                                              response, resource->pool));
+}
+
+/* Return a buffer in which deliver() shall capture the response body
+   for RESOURCE, or NULL if the response shall not be cached. */
+static svn_stringbuf_t *
+create_capture(const dav_resource *resource)
+{
+  if (resource->info->response_key == NULL
+      || resource->info->response == NULL
+      || ! dav_svn__response_cache_is_cachable(0))
+    return NULL;
+
+  return svn_stringbuf_create_empty(resource->pool);
+}
+
 typedef struct diff_ctx_t {
   dav_svn__output *output;
   apr_bucket_brigade *bb;
+
+  /* The svndiff data written so far, if it shall be cached. */
+  svn_stringbuf_t *capture;
 } diff_ctx_t;
 
 
@@ -3306,6 +3461,8 @@ write_to_filter(void *baton, const char *buffer, apr_size_t *len)
 {
   diff_ctx_t *dc = baton;
 
+  capture_response(&dc->capture, buffer, *len);
+
   /* take the current data and shove it into the filter */
   SVN_ERR(dav_svn__brigade_write(dc->bb, dc->output, buffer, *len));
 
@@ -3595,6 +3752,30 @@ deliver(const dav_resource *resource, ap_filter_t *unused)
 
   output = dav_svn__output_create(resource->info->r, resource->pool);
 
+  /* The response may have been found in our cache by set_headers(). */
+  if (resource->info->response && resource->info->response->body)
+    {
+      const svn_string_t *body = resource->info->response->body;
+
+      bb = apr_brigade_create(resource->pool,
+                              dav_svn__output_get_bucket_alloc(output));
+      bkt = apr_bucket_pool_create(body->data, body->len, resource->pool,
+                                   dav_svn__output_get_bucket_alloc(output));
+      APR_BRIGADE_INSERT_TAIL(bb, bkt);
+      bkt = apr_bucket_eos_create(dav_svn__output_get_bucket_alloc(output));
+      APR_BRIGADE_INSERT_TAIL(bb, bkt);
+
+      serr = dav_svn__output_pass_brigade(output, bb);
+      apr_brigade_destroy(bb);
+      if (serr != NULL)
+        return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                    "Could not write cached response to "
+                                    "filter.",
+                                    resource->pool);
+
+      return NULL;
+    }
+
   if (resource->collection)
     {
       const int gen_html = !resource->info->repos->xslt_uri;
@@ -3824,6 +4005,7 @@ deliver(const dav_resource *resource, ap_filter_t *unused)
              which will copy it to the network */
           dc.output = output;
           dc.bb = bb;
+          dc.capture = create_capture(resource);
           o_stream = svn_stream_create(&dc, resource->pool);
           svn_stream_set_write(o_stream, write_to_filter);
           svn_stream_set_close(o_stream, close_filter);
@@ -3846,6 +4028,7 @@ deliver(const dav_resource *resource, ap_filter_t *unused)
                                         "could not deliver the txdelta stream",
                                         resource->pool);
 
+          cache_response(resource, dc.capture);
 
           return NULL;
         }
@@ -3859,6 +4042,7 @@ deliver(const dav_resource *resource, ap_filter_t *unused)
     {
       svn_stream_t *stream;
       char *block;
+      svn_stringbuf_t *capture = create_capture(resource);
 
       serr = svn_fs_file_contents(&stream,
                                   resource->info->root.root,
@@ -3964,6 +4148,8 @@ deliver(const dav_resource *resource, ap_filter_t *unused)
         if (bufsize == 0)
           break;
 
+        capture_response(&capture, block, bufsize);
+
         /* write to the filter ... */
         bkt = apr_bucket_transient_create(
           block, bufsize, dav_svn__output_get_bucket_alloc(output));
@@ -3993,6 +4179,7 @@ deliver(const dav_resource *resource, ap_filter_t *unused)
         }
 
       apr_brigade_destroy(bb);
+      cache_response(resource, capture);
       return NULL;
     }
 }
@@ -0,0 +1,206 @@
+/*
+ * response_cache.c: in-process cache of GET responses for immutable
+ *                   resources
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <string.h>
+
+#include <apr_pools.h>
+
+#include "svn_pools.h"
+#include "svn_error.h"
+
+#include "private/svn_atomic.h"
+#include "private/svn_cache.h"
+
+#include "dav_svn.h"
+
+
+/* Fixed-size header of a serialized dav_svn__cached_response_t.  It is
+ * followed by the NUL-terminated ETag, the NUL-terminated MIME type and
+ * the body, in that order. */
+typedef struct serialized_response_t
+{
+  apr_size_t etag_len;
+  apr_size_t mimetype_len;
+  apr_size_t body_len;
+  svn_boolean_t is_svndiff;
+} serialized_response_t;
+
+/* The process-wide response cache.  NULL, if there is no membuffer cache
+ * to back it. */
+static svn_cache__t *response_cache = NULL;
+
+/* Keep track on whether we already tried to create RESPONSE_CACHE. */
+static volatile svn_atomic_t response_cache_initialized = FALSE;
+
+
+/* Implements svn_cache__serialize_func_t for dav_svn__cached_response_t. */
+static svn_error_t *
+serialize_response(void **data,
+                   apr_size_t *data_len,
+                   void *in,
+                   apr_pool_t *result_pool)
+{
+  const dav_svn__cached_response_t *response = in;
+  serialized_response_t header;
+  char *buffer, *p;
+
+  header.etag_len = strlen(response->etag);
+  header.mimetype_len = strlen(response->mimetype);
+  header.body_len = response->body->len;
+  header.is_svndiff = response->is_svndiff;
+
+  *data_len = sizeof(header) + header.etag_len + 1 + header.mimetype_len + 1
+            + header.body_len;
+  buffer = apr_palloc(result_pool, *data_len);
+
+  memcpy(buffer, &header, sizeof(header));
+  p = buffer + sizeof(header);
+  memcpy(p, response->etag, header.etag_len + 1);
+  p += header.etag_len + 1;
+  memcpy(p, response->mimetype, header.mimetype_len + 1);
+  p += header.mimetype_len + 1;
+  memcpy(p, response->body->data, header.body_len);
+
+  *data = buffer;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_cache__deserialize_func_t for dav_svn__cached_response_t.
+ * All strings will point into DATA. */
+static svn_error_t *
+deserialize_response(void **out,
+                     void *data,
+                     apr_size_t data_len,
+                     apr_pool_t *result_pool)
+{
+  dav_svn__cached_response_t *response
+    = apr_pcalloc(result_pool, sizeof(*response));
+  svn_string_t *body = apr_palloc(result_pool, sizeof(*body));
+  serialized_response_t header;
+  const char *p = data;
+
+  memcpy(&header, p, sizeof(header));
+  p += sizeof(header);
+
+  SVN_ERR_ASSERT(data_len == sizeof(header) + header.etag_len + 1
+                             + header.mimetype_len + 1 + header.body_len);
+
+  response->etag = p;
+  p += header.etag_len + 1;
+  response->mimetype = p;
+  p += header.mimetype_len + 1;
+  body->data = p;
+  body->len = header.body_len;
+  response->body = body;
+  response->is_svndiff = header.is_svndiff;
+
+  *out = response;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_atomic__err_init_func_t. */
+static svn_error_t *
+create_response_cache(void *baton,
+                      apr_pool_t *scratch_pool)
+{
+  svn_membuffer_t *membuffer = svn_cache__get_global_membuffer_cache();
+
+  if (membuffer)
+    {
+      /* The cache must live as long as the process does. */
+      apr_pool_t *pool = svn_pool_create(NULL);
+
+      SVN_ERR(svn_cache__create_membuffer_cache(
+                &response_cache, membuffer,
+                serialize_response, deserialize_response,
+                APR_HASH_KEY_STRING, "mod_dav_svn:response:",
+                SVN_CACHE__MEMBUFFER_LOW_PRIORITY,
+                TRUE, FALSE, pool, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *CACHE to the process-wide response cache, creating it on first
+ * use.  *CACHE will be NULL, if response caching is not available. */
+static svn_error_t *
+get_cache(svn_cache__t **cache,
+          apr_pool_t *scratch_pool)
+{
+  SVN_ERR(svn_atomic__init_once(&response_cache_initialized,
+                                create_response_cache, NULL, scratch_pool));
+  *cache = response_cache;
+
+  return SVN_NO_ERROR;
+}
+
+
+svn_error_t *
+dav_svn__response_cache_get(dav_svn__cached_response_t **response,
+                            const char *key,
+                            apr_pool_t *result_pool)
+{
+  svn_cache__t *cache;
+  svn_boolean_t found = FALSE;
+
+  *response = NULL;
+
+  SVN_ERR(get_cache(&cache, result_pool));
+  if (cache)
+    SVN_ERR(svn_cache__get((void **)response, &found, cache, key,
+                           result_pool));
+
+  if (!found)
+    *response = NULL;
+
+  return SVN_NO_ERROR;
+}
+
+
+svn_boolean_t
+dav_svn__response_cache_is_cachable(apr_size_t body_len)
+{
+  /* Leave some room for the header fields and the key. */
+  return response_cache
+      && svn_cache__is_cachable(response_cache,
+                                body_len + sizeof(serialized_response_t)
+                                + 1024);
+}
+
+
+svn_error_t *
+dav_svn__response_cache_set(const char *key,
+                            const dav_svn__cached_response_t *response,
+                            apr_pool_t *scratch_pool)
+{
+  svn_cache__t *cache;
+
+  SVN_ERR(get_cache(&cache, scratch_pool));
+  if (cache && dav_svn__response_cache_is_cachable(response->body->len))
+    SVN_ERR(svn_cache__set(cache, key, (void *)response, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
@@ -153,6 +153,7 @@ get_vsn_options(apr_pool_t *p, apr_text_header *phdr)
   apr_text_append(p, phdr, SVN_DAV_NS_DAV_SVN_INLINE_PROPS);
   apr_text_append(p, phdr, SVN_DAV_NS_DAV_SVN_REVERSE_FILE_REVS);
   apr_text_append(p, phdr, SVN_DAV_NS_DAV_SVN_LIST);
+  apr_text_append(p, phdr, SVN_DAV_NS_DAV_SVN_SERVER_BLAME);
   /* Mergeinfo is a special case: here we merely say that the server
    * knows how to handle mergeinfo -- whether the repository does too
    * is a separate matter.
@@ -1180,6 +1181,10 @@ deliver_report(request_rec *r,
         {
           return dav_svn__list_report(resource, doc, output);
         }
+      else if (strcmp(doc->root->name, "blame-report") == 0)
+        {
+          return dav_svn__blame_report(resource, doc, output);
+        }
       /* NOTE: if you add a report, don't forget to add it to the
        *       dav_svn__reports_list[] array.
        */
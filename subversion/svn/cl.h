@@ -258,6 +258,7 @@ typedef struct svn_cl__opt_state_t
   svn_boolean_t vacuum_pristines; /* remove unreferenced pristines */
   svn_boolean_t drop;             /* drop shelf after successful unshelve */
   svn_boolean_t viewspec;
+  int jobs;                       /* number of files to write in parallel */
 } svn_cl__opt_state_t;
 
 /* Conflict stats for operations such as update and merge. */
@@ -148,6 +148,7 @@ typedef enum svn_cl__longopt_t {
   opt_vacuum_pristines,
   opt_drop,
   opt_viewspec,
+  opt_jobs,
 } svn_cl__longopt_t;
 
 
@@ -225,7 +226,15 @@ const apr_getopt_option_t svn_cl__options[] =
                        "                             "
                        "  -U ARG, --context ARG: Show ARG lines of context\n"
                        "                             "
-                       "  -p, --show-c-function: Show C function name")},
+                       "  -p, --show-c-function: Show C function name\n"
+                       "                             "
+                       "  --histogram: Use the faster, non-minimal\n"
+                       "                             "
+                       "    histogram diff algorithm\n"
+                       "                             "
+                       "  --chunked: Merge large files section by\n"
+                       "                             "
+                       "    section (faster, non-minimal)")},
   {"targets",       opt_targets, 1,
                     N_("pass contents of file ARG as additional args")},
   {"depth",         opt_depth, 1,
@@ -483,6 +492,9 @@ const apr_getopt_option_t svn_cl__options[] =
   {"viewspec", opt_viewspec, 0,
                        N_("print the working copy layout")},
 
+  {"jobs", opt_jobs, 1,
+                       N_("write up to ARG files in parallel")},
+
   /* Long-opt Aliases
    *
    * These have NULL desriptions, but an option code that matches some
@@ -786,7 +798,7 @@ const svn_opt_subcommand_desc3_t svn_cl__cmd_table[] =
      "  looked up.\n"
     )},
     {'r', 'q', 'N', opt_depth, opt_force, opt_native_eol, opt_ignore_externals,
-     opt_ignore_keywords} },
+     opt_ignore_keywords, opt_jobs} },
 
   { "help", svn_cl__help, {"?", "h"}, {N_(
      "Describe the usage of this program or its subcommands.\n"
@@ -2749,6 +2761,16 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
       case opt_viewspec:
         opt_state.viewspec = TRUE;
         break;
+      case opt_jobs:
+        SVN_ERR(svn_utf_cstring_to_utf8(&utf8_opt_arg, opt_arg, pool));
+        err = svn_cstring_atoi(&opt_state.jobs, utf8_opt_arg);
+        if (err)
+          return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, err,
+                                  _("Non-numeric jobs argument given"));
+        if (opt_state.jobs <= 0)
+          return svn_error_create(SVN_ERR_INCORRECT_PARAMS, NULL,
+                                  _("Argument to --jobs must be positive"));
+        break;
       default:
         /* Hmmm. Perhaps this would be a good place to squirrel away
            opts that commands like svn diff might need. Hmmm indeed. */
@@ -2887,6 +2887,90 @@ get_file_revs(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+/* Baton type used by blame_receiver(). */
+typedef struct blame_receiver_baton_t
+{
+  svn_ra_svn_conn_t *conn;
+
+  /* Revisions whose revprops have already been sent. */
+  apr_hash_t *revs_sent;
+} blame_receiver_baton_t;
+
+/* Send a blame entry through the connection in BATON.  The revprops of
+ * each revision are only sent the first time it gets reported.
+ * Implements svn_repos_blame_receiver_t. */
+static svn_error_t *
+blame_receiver(void *baton,
+               apr_int64_t start_line,
+               svn_revnum_t revision,
+               apr_hash_t *rev_props,
+               apr_pool_t *scratch_pool)
+{
+  blame_receiver_baton_t *b = baton;
+  apr_pool_t *hash_pool = apr_hash_pool_get(b->revs_sent);
+
+  if (rev_props
+      && !apr_hash_get(b->revs_sent, &revision, sizeof(revision)))
+    apr_hash_set(b->revs_sent,
+                 apr_pmemdup(hash_pool, &revision, sizeof(revision)),
+                 sizeof(revision), "");
+  else
+    rev_props = NULL;
+
+  SVN_ERR(svn_ra_svn__write_tuple(b->conn, scratch_pool, "n(?r)(!",
+                                  (apr_uint64_t) start_line, revision));
+  if (rev_props)
+    SVN_ERR(svn_ra_svn__write_proplist(b->conn, scratch_pool, rev_props));
+  return svn_error_trace(svn_ra_svn__write_tuple(b->conn, scratch_pool,
+                                                 "!))"));
+}
+
+static svn_error_t *
+get_blame(svn_ra_svn_conn_t *conn,
+          apr_pool_t *pool,
+          svn_ra_svn__list_t *params,
+          void *baton)
+{
+  server_baton_t *b = baton;
+  svn_error_t *err, *write_err;
+  blame_receiver_baton_t rb;
+  svn_revnum_t start_rev, end_rev;
+  const char *path;
+  const char *full_path;
+  authz_baton_t ab;
+
+  ab.server = b;
+  ab.conn = conn;
+
+  /* Parse arguments. */
+  SVN_ERR(svn_ra_svn__parse_tuple(params, "crr", &path, &start_rev,
+                                  &end_rev));
+  path = svn_relpath_canonicalize(path, pool);
+  SVN_ERR(trivial_auth_request(conn, pool, b));
+  full_path = svn_fspath__join(b->repository->fs_path->data, path, pool);
+
+  SVN_ERR(log_command(b, conn, pool, "%s",
+                      svn_log__get_blame(full_path, start_rev, end_rev,
+                                         pool)));
+
+  rb.conn = conn;
+  rb.revs_sent = apr_hash_make(pool);
+
+  err = svn_repos_get_blame(b->repository->repos, full_path, start_rev,
+                            end_rev, authz_check_access_cb_func(b), &ab,
+                            blame_receiver, &rb, NULL, NULL, pool);
+  write_err = svn_ra_svn__write_word(conn, pool, "done");
+  if (write_err)
+    {
+      svn_error_clear(err);
+      return write_err;
+    }
+  SVN_CMD_ERR(err);
+  SVN_ERR(svn_ra_svn__write_cmd_response(conn, pool, ""));
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 lock(svn_ra_svn_conn_t *conn,
      apr_pool_t *pool,
@@ -3708,6 +3792,7 @@ static const svn_ra_svn__cmd_entry_t main_commands[] = {
   { "get-locations",   get_locations },
   { "get-location-segments",   get_location_segments },
   { "get-file-revs",   get_file_revs },
+  { "get-blame",       get_blame },
   { "lock",            lock },
   { "lock-many",       lock_many },
   { "unlock",          unlock },
@@ -4129,7 +4214,7 @@ construct_server_baton(server_baton_t **baton,
    * send an empty mechlist. */
   if (params->compression_level > 0)
     SVN_ERR(svn_ra_svn__write_cmd_response(conn, scratch_pool,
-                                           "nn()(wwwwwwwwwwwww)",
+                                           "nn()(wwwwwwwwwwwwww)",
                                            (apr_uint64_t) 2, (apr_uint64_t) 2,
                                            SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                            SVN_RA_SVN_CAP_SVNDIFF1,
@@ -4143,11 +4228,12 @@ construct_server_baton(server_baton_t **baton,
                                            SVN_RA_SVN_CAP_INHERITED_PROPS,
                                            SVN_RA_SVN_CAP_EPHEMERAL_TXNPROPS,
                                            SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE,
-                                           SVN_RA_SVN_CAP_LIST
+                                           SVN_RA_SVN_CAP_LIST,
+                                           SVN_RA_SVN_CAP_SERVER_BLAME
                                            ));
   else
     SVN_ERR(svn_ra_svn__write_cmd_response(conn, scratch_pool,
-                                           "nn()(wwwwwwwwwww)",
+                                           "nn()(wwwwwwwwwwww)",
                                            (apr_uint64_t) 2, (apr_uint64_t) 2,
                                            SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                            SVN_RA_SVN_CAP_ABSENT_ENTRIES,
@@ -4159,7 +4245,8 @@ construct_server_baton(server_baton_t **baton,
                                            SVN_RA_SVN_CAP_INHERITED_PROPS,
                                            SVN_RA_SVN_CAP_EPHEMERAL_TXNPROPS,
                                            SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE,
-                                           SVN_RA_SVN_CAP_LIST
+                                           SVN_RA_SVN_CAP_LIST,
+                                           SVN_RA_SVN_CAP_SERVER_BLAME
                                            ));
 
   /* Read client response, which we assume to be in version 2 format:
@@ -1059,6 +1059,84 @@ def blame_reverse_no_change(sbox):
                                      'blame', '-r5:3', sbox.ospath('iota'))
 
 
+def blame_cache(sbox):
+  "blame reusing the on-disk blame cache"
+
+  sbox.build()
+  iota = sbox.ospath('iota')
+  cache_dir = sbox.get_tempname('blame-cache')
+  cache_opt = '--config-option=config:miscellany:blame-cache-dir=' + cache_dir
+
+  # Servers compute blames with the default diff options themselves, so
+  # the blames below ask for other options to make the client use its cache.
+
+  sbox.simple_append('iota', 'second line\n')
+  sbox.simple_commit() #r2
+
+  expected_output = [
+    '     1    jrandom This is the file \'iota\'.\n',
+    '     2    jrandom second line\n',
+  ]
+  svntest.actions.run_and_verify_svn(expected_output, [],
+                                     'blame', cache_opt,
+                                     '-x', '--ignore-eol-style', iota)
+  if len(os.listdir(cache_dir)) != 1:
+    raise svntest.Failure("Expected exactly one blame cache entry")
+
+  # Blaming the next revision starts from the cached blame of r2.
+  sbox.simple_append('iota', 'first line\n'
+                             'This is the file \'iota\'.\n'
+                             'second line\n', truncate=True)
+  sbox.simple_commit() #r3
+
+  expected_output = [
+    '     3    jrandom first line\n',
+    '     1    jrandom This is the file \'iota\'.\n',
+    '     2    jrandom second line\n',
+  ]
+  svntest.actions.run_and_verify_svn(expected_output, [],
+                                     'blame', cache_opt,
+                                     '-x', '--ignore-eol-style', iota)
+  svntest.actions.run_and_verify_svn(expected_output, [],
+                                     'blame', iota)
+
+  # Blaming an older revision must not replace the entry for r3.
+  svntest.actions.run_and_verify_svn(None, [],
+                                     'blame', cache_opt, '-r1:2',
+                                     '-x', '--ignore-eol-style', iota)
+  cache_entry = os.path.join(cache_dir, os.listdir(cache_dir)[0])
+  if open(cache_entry).readlines()[1] != '3\n':
+    raise svntest.Failure("Blame cache entry for r3 was replaced")
+
+  # Revision properties are not taken from the cache.
+  svntest.actions.enable_revprop_changes(sbox.repo_dir)
+  svntest.actions.run_and_verify_svn(None, [],
+                                     'propset', '--revprop', '-r1',
+                                     'svn:author', 'somebody', sbox.repo_url)
+  expected_output = [
+    '     3    jrandom first line\n',
+    '     1   somebody This is the file \'iota\'.\n',
+    '     2    jrandom second line\n',
+  ]
+  svntest.actions.run_and_verify_svn(expected_output, [],
+                                     'blame', cache_opt,
+                                     '-x', '--ignore-eol-style', iota)
+
+  # A file replaced at the same path must not reuse the old file's blame.
+  sbox.simple_rm('iota')
+  sbox.simple_commit() #r4
+  svntest.main.file_write(iota, 'replaced\n')
+  sbox.simple_add('iota')
+  sbox.simple_commit() #r5
+
+  expected_output = [
+    '     5    jrandom replaced\n',
+  ]
+  svntest.actions.run_and_verify_svn(expected_output, [],
+                                     'blame', cache_opt,
+                                     '-x', '--ignore-eol-style', iota)
+
+
 ########################################################################
 # Run the tests
 
@@ -1084,6 +1162,7 @@ test_list = [ None,
               blame_eol_handling,
               blame_youngest_to_oldest,
               blame_reverse_no_change,
+              blame_cache,
              ]
 
 if __name__ == '__main__':
@@ -3146,6 +3146,64 @@ def commit_issue4722_checksum(sbox):
   sbox.simple_commit()
 
 
+def commit_with_worker_threads(sbox):
+  "commit many files with worker threads"
+
+  sbox.build()
+  wc_dir = sbox.wc_dir
+
+  expected_output = svntest.wc.State(wc_dir, {})
+  expected_status = svntest.actions.get_virginal_state(wc_dir, 1)
+  expected_disk = svntest.main.greek_state.copy()
+
+  # Modify every file of the greek tree ...
+  for path, item in expected_disk.desc.items():
+    if item.contents is None:
+      continue
+    item.contents += "Modified '%s'.\n" % path
+    svntest.main.file_append(sbox.ospath(path), "Modified '%s'.\n" % path)
+    expected_output.add({ path : Item(verb='Sending') })
+    expected_status.tweak(path, wc_rev=2)
+
+  # ... and add plenty of new ones, some of them translated and some of
+  # them large enough for their deltas to be spooled to disk.
+  sbox.simple_mkdir('new')
+  expected_output.add({ 'new' : Item(verb='Adding') })
+  expected_status.add({ 'new' : Item(status='  ', wc_rev=2) })
+  expected_disk.add({ 'new' : Item() })
+  for i in range(64):
+    path = 'new/file%d' % i
+    if i % 16 == 0:
+      contents = ''.join("Line %d of '%s'.\n" % (j, path)
+                         for j in range(64 * 1024))
+    else:
+      contents = "This is the file '%s'.\n" % path
+    svntest.main.file_write(sbox.ospath(path), contents, 'wb')
+    sbox.simple_add(path)
+    if i % 2:
+      sbox.simple_propset('svn:eol-style', 'LF', path)
+      expected_disk.add({ path : Item(contents,
+                                      props={'svn:eol-style' : 'LF'}) })
+    else:
+      expected_disk.add({ path : Item(contents) })
+    expected_output.add({ path : Item(verb='Adding') })
+    expected_status.add({ path : Item(status='  ', wc_rev=2) })
+
+  svntest.actions.run_and_verify_commit(wc_dir, expected_output,
+                                        expected_status, [],
+                                        '--config-option',
+                                        'config:working-copy:worker-threads=4',
+                                        wc_dir)
+
+  # The repository must have received exactly what we committed.
+  wc2_dir = sbox.add_wc_path('2')
+  expected_output = expected_disk.copy()
+  expected_output.wc_dir = wc2_dir
+  expected_output.tweak(status='A ', contents=None, props={})
+  svntest.actions.run_and_verify_checkout(sbox.repo_url, wc2_dir,
+                                          expected_output, expected_disk)
+
+
 ########################################################################
 # Run the tests
 
@@ -3224,6 +3282,7 @@ test_list = [ None,
               mkdir_conflict_proper_error,
               commit_xml,
               commit_issue4722_checksum,
+              commit_with_worker_threads,
              ]
 
 if __name__ == '__main__':
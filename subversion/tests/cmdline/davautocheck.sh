@@ -76,10 +76,16 @@
 #
 #  make davautocheck USE_HTTPV1=1           # sets SVNAdvertiseV2Protocol off
 #
+#  make davautocheck USE_HTTP2=1            # use HTTP/2 via mod_http2
+#                                           # (implies USE_SSL)
+#
 #  make davautocheck APACHE_MPM=event       # specifies the 2.4 MPM
 #
 #  make davautocheck SVN_PATH_AUTHZ=short_circuit  # SVNPathAuthz short_circuit
 #
+#  make davautocheck UPDATE_RENDER_THREADS=0  # sets SVNUpdateRenderThreads 0
+#                                             # (the default is 4)
+#
 # Passing --no-tests as argv[1] will have the script start a server
 # but not run any tests.  Passing --gdb or --lldb will do the same, and in
 # addition spawn gdb/lldb in the foreground attached to the running server.
@@ -213,6 +219,11 @@ if [ ${USE_HTTPV1:+set} ]; then
  ADVERTISE_V2_PROTOCOL=off
 fi
 
+# Pick up $USE_HTTP2.  Clients negotiate HTTP/2 via TLS only.
+if [ ${USE_HTTP2:+set} ]; then
+  USE_SSL=1
+fi
+
 # Pick up $SVN_PATH_AUTHZ
 SVN_PATH_AUTHZ_LINE=""
 if [ ${SVN_PATH_AUTHZ:+set} ]; then
@@ -229,6 +240,8 @@ if [ ${BLOCK_READ:+set} ]; then
   BLOCK_READ_SETTING=on
 fi
 
+UPDATE_RENDER_THREADS=${UPDATE_RENDER_THREADS:-4}
+
 if [ ${MODULE_PATH:+set} ]; then
     MOD_DAV_SVN="$MODULE_PATH/mod_dav_svn.so"
     MOD_AUTHZ_SVN="$MODULE_PATH/mod_authz_svn.so"
@@ -330,6 +343,10 @@ if [ ${USE_SSL:+set} ]; then
     LOAD_MOD_SSL=$(get_loadmodule_config mod_ssl) \
       || fail "SSL module not found"
 fi
+if [ ${USE_HTTP2:+set} ]; then
+    LOAD_MOD_HTTP2=$(get_loadmodule_config mod_http2) \
+      || fail "HTTP/2 module not found"
+fi
 
 # Stop any previous instances, os we can re-use the port.
 if [ -x $STOPSCRIPT ]; then $STOPSCRIPT ; sleep 1; fi
@@ -421,6 +438,11 @@ __EOF__
   SSL_TEST_ARG="--ssl-cert $SSL_CERTIFICATE_FILE"
 fi
 
+if [ ${USE_HTTP2:+set} ]; then
+  HTTP2_MAKE_VAR="HTTP2=1"
+  HTTP2_TEST_ARG="--http2"
+fi
+
 say "Adding users for lock authentication"
 $HTPASSWD -bc $HTTPD_USERS jrandom   rayjandom
 $HTPASSWD -b  $HTTPD_USERS jconstant rayjandom
@@ -445,6 +467,7 @@ __EOF__
 cat > "$HTTPD_CFG" <<__EOF__
 $LOAD_MOD_MPM
 $LOAD_MOD_SSL
+$LOAD_MOD_HTTP2
 $LOAD_MOD_LOG_CONFIG
 $LOAD_MOD_MIME
 $LOAD_MOD_ALIAS
@@ -501,6 +524,13 @@ SSLCertificateKeyFile $SSL_CERTIFICATE_KEY_FILE
 __EOF__
 fi
 
+if [ ${USE_HTTP2:+set} ]; then
+cat >> "$HTTPD_CFG" <<__EOF__
+Protocols           h2 http/1.1
+H2MaxSessionStreams 100
+__EOF__
+fi
+
 cat >> "$HTTPD_CFG" <<__EOF__
 Listen              $HTTPD_PORT
 ServerName          localhost
@@ -524,6 +554,7 @@ MaxRequestsPerChild 0
 </IfModule>
 MaxClients          32
 HostNameLookups     Off
+SVNUpdateRenderThreads ${UPDATE_RENDER_THREADS}
 LogFormat           "%h %l %u %t \"%r\" %>s %b \"%{Referer}i\" \"%{User-Agent}i\"" format
 CustomLog           "$HTTPD_ROOT/req" format
 CustomLog           "$HTTPD_ROOT/ops" "%t %u %{SVN-REPOS-NAME}e %{SVN-ACTION}e" env=SVN-ACTION
@@ -556,6 +587,7 @@ cat >> "$HTTPD_CFG" <<__EOF__
   AuthUserFile      $HTTPD_USERS
   SVNAdvertiseV2Protocol ${ADVERTISE_V2_PROTOCOL}
   SVNCacheRevProps  ${CACHE_REVPROPS_SETTING}
+  SVNCacheResponses On
   SVNListParentPath On
   SVNBlockRead      ${BLOCK_READ_SETTING}
 __EOF__
@@ -783,13 +815,13 @@ else
 fi
 
 if [ $# = 0 ]; then
-  TIME_CMD "$MAKE" check "BASE_URL=$BASE_URL" "HTTPD_VERSION=$HTTPD_VERSION" $SSL_MAKE_VAR
+  TIME_CMD "$MAKE" check "BASE_URL=$BASE_URL" "HTTPD_VERSION=$HTTPD_VERSION" $SSL_MAKE_VAR $HTTP2_MAKE_VAR
   r=$?
 else
   (cd "$ABS_BUILDDIR/subversion/tests/cmdline/"
   TEST="$1"
   shift
-  TIME_CMD "$ABS_SRCDIR/subversion/tests/cmdline/${TEST}_tests.py" "--url=$BASE_URL" "--httpd-version=$HTTPD_VERSION" $SSL_TEST_ARG "$@")
+  TIME_CMD "$ABS_SRCDIR/subversion/tests/cmdline/${TEST}_tests.py" "--url=$BASE_URL" "--httpd-version=$HTTPD_VERSION" $SSL_TEST_ARG $HTTP2_TEST_ARG "$@")
   r=$?
 fi
 
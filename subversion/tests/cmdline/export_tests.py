@@ -1121,6 +1121,67 @@ def export_revision_with_root_relative_external(sbox):
                                         '-r', 2)
 
 
+def export_with_jobs(sbox):
+  "export writing files on several threads"
+  sbox.build()
+
+  # More files than get written in one batch, with directories in
+  # between and some files that need translation.
+  many_dir = sbox.get_tempname('many')
+  for i in range(8):
+    os.makedirs(os.path.join(many_dir, 'd%d' % i))
+    for j in range(40):
+      svntest.main.file_write(os.path.join(many_dir, 'd%d' % i, 'f%02d' % j),
+                              'This is file %d of directory %d.\n' % (j, i))
+  svntest.main.run_svn(None, 'import', '-m', 'log msg',
+                       many_dir, sbox.repo_url + '/many')
+  svntest.main.run_svn(None, 'up', sbox.wc_dir)
+
+  svntest.main.file_write(sbox.ospath('A/mu'), '$Revision$\n')
+  sbox.simple_propset('svn:keywords', 'Revision', 'A/mu')
+  sbox.simple_propset('svn:eol-style', 'CRLF', 'iota')
+  sbox.simple_commit() #r3
+
+  expected_disk = svntest.main.greek_state.copy()
+  expected_disk.tweak('A/mu', contents='$Revision: 3 $\n')
+  expected_disk.tweak('iota', contents="This is the file 'iota'.\r\n")
+  expected_disk.add({ 'many' : Item() })
+  for i in range(8):
+    expected_disk.add({ 'many/d%d' % i : Item() })
+    for j in range(40):
+      expected_disk.add({
+        'many/d%d/f%02d' % (i, j) :
+          Item('This is file %d of directory %d.\n' % (j, i)),
+        })
+
+  expected_output = expected_disk.copy()
+  expected_output.desc[''] = Item()
+  expected_output.tweak(contents=None, status='A ')
+
+  serial_target = sbox.add_wc_path('export_serial')
+  expected_output.wc_dir = serial_target
+  svntest.actions.run_and_verify_export2(sbox.repo_url, serial_target,
+                                         expected_output, expected_disk,
+                                         True)
+
+  parallel_target = sbox.add_wc_path('export_parallel')
+  expected_output.wc_dir = parallel_target
+  svntest.actions.run_and_verify_export2(sbox.repo_url, parallel_target,
+                                         expected_output, expected_disk,
+                                         True, '--jobs', '4')
+
+  # The notifications come in the same order as without --jobs.
+  exit_code, serial_output, errput = svntest.main.run_svn(
+    None, 'export', sbox.repo_url, sbox.add_wc_path('order_serial'))
+  exit_code, parallel_output, errput = svntest.main.run_svn(
+    None, 'export', '--jobs', '4', sbox.repo_url,
+    sbox.add_wc_path('order_parallel'))
+  serial_output = [line.replace('order_serial', 'order_parallel')
+                   for line in serial_output]
+  if parallel_output != serial_output:
+    raise svntest.Failure("Notifications of 'svn export --jobs 4' "
+                          "differ from those of 'svn export'")
+
 ########################################################################
 # Run the tests
 
@@ -1158,6 +1219,7 @@ test_list = [ None,
               export_file_external,
               export_file_externals2,
               export_revision_with_root_relative_external,
+              export_with_jobs,
              ]
 
 if __name__ == '__main__':
@@ -18530,6 +18530,70 @@ def merge_dir_delete_force(sbox):
                                      'merge', '-c2', '^/', sbox.wc_dir,
                                      '--ignore-ancestry', '--force')
 
+def merge_text_on_worker_threads(sbox):
+  "text merges run by worker threads"
+
+  sbox.build()
+  wc_dir = sbox.wc_dir
+
+  sbox.simple_copy('A', 'A_COPY')
+  sbox.simple_commit() # r2
+
+  sbox.simple_append('A/mu', 'trunk mu\n')
+  sbox.simple_append('A/B/lambda', 'trunk lambda\n')
+  sbox.simple_append('A/D/gamma', 'trunk gamma\n')
+  sbox.simple_append('A/D/G/rho', 'trunk rho\n')
+  sbox.simple_append('A/D/H/psi', 'trunk psi\n')
+  sbox.simple_rm('A/D/G/tau')
+  sbox.simple_commit() # r3
+  sbox.simple_update()
+
+  # A local modification that merges cleanly and one that conflicts.
+  svntest.main.file_write(sbox.ospath('A_COPY/D/H/psi'),
+                          "local psi\nThis is the file 'psi'.\n")
+  sbox.simple_append('A_COPY/D/G/rho', 'branch rho\n')
+
+  exit_code, output, errput = svntest.actions.run_and_verify_svn(
+                                None, [],
+                                'merge', '^/A', sbox.ospath('A_COPY'),
+                                '--config-option',
+                                'config:working-copy:worker-threads=4')
+
+  # Every file is notified once, with the state of its own merge.
+  expected_lines = [
+    "U    %s\n" % sbox.ospath('A_COPY/mu'),
+    "U    %s\n" % sbox.ospath('A_COPY/B/lambda'),
+    "U    %s\n" % sbox.ospath('A_COPY/D/gamma'),
+    "C    %s\n" % sbox.ospath('A_COPY/D/G/rho'),
+    "G    %s\n" % sbox.ospath('A_COPY/D/H/psi'),
+    "D    %s\n" % sbox.ospath('A_COPY/D/G/tau'),
+  ]
+  for line in expected_lines:
+    if output.count(line) != 1:
+      raise svntest.Failure("Expected '%s' once in the merge output"
+                            % line.rstrip())
+
+  expected_status = svntest.actions.get_virginal_state(wc_dir, 3)
+  expected_status.add_state('A_COPY', expected_status.subtree('A'))
+  expected_status.add({
+    'A_COPY' : Item(status=' M', wc_rev=3),
+  })
+  expected_status.remove('A/D/G/tau')
+  expected_status.tweak('A_COPY/mu', 'A_COPY/B/lambda', 'A_COPY/D/gamma',
+                        'A_COPY/D/H/psi', status='M ')
+  expected_status.tweak('A_COPY/D/G/rho', status='C ')
+  expected_status.tweak('A_COPY/D/G/tau', status='D ')
+  svntest.actions.run_and_verify_status(wc_dir, expected_status)
+
+  expected_contents = {
+    'A_COPY/mu'      : "This is the file 'mu'.\ntrunk mu\n",
+    'A_COPY/D/H/psi' : "local psi\nThis is the file 'psi'.\ntrunk psi\n",
+  }
+  for path, contents in expected_contents.items():
+    actual = open(sbox.ospath(path)).read()
+    if actual != contents:
+      raise svntest.Failure("Unexpected contents of '%s': %r" % (path, actual))
+
 ########################################################################
 # Run the tests
 
@@ -18677,6 +18741,7 @@ test_list = [ None,
               merge_to_empty_target_merge_to_infinite_target,
               conflict_naming,
               merge_dir_delete_force,
+              merge_text_on_worker_threads,
              ]
 
 if __name__ == '__main__':
@@ -640,6 +640,52 @@ def propfind_propname(sbox):
   actual_response = r.read()
   verify_xml_response(expected_response, actual_response)
 
+@SkipUnless(svntest.main.is_ra_type_dav)
+def cached_responses(sbox):
+  "GET responses served from the response cache"
+
+  sbox.build(create_wc=True)
+  sbox.simple_mkdir('x:')
+  sbox.simple_add_text('This is the file \'x:/q\'.\n', 'x:/q')
+  sbox.simple_add_text('This is the file \'q\'.\n', 'q')
+  sbox.simple_commit()
+
+  headers = {
+    'Authorization': 'Basic ' + base64.b64encode(b'jconstant:rayjandom').decode(),
+  }
+
+  h = svntest.main.create_http_connection(sbox.repo_url)
+
+  def get(path, delta_base=None):
+    hdrs = dict(headers)
+    if delta_base is not None:
+      hdrs['X-SVN-VR-Base'] = delta_base
+    h.request('GET', sbox.repo_url + '/!svn/rvr/2/' + path, None, hdrs)
+    r = h.getresponse()
+    if r.status != httplib.OK:
+      raise svntest.Failure('Request failed: %d %s' % (r.status, r.reason))
+    return r.read().decode()
+
+  # Fetch the same immutable response twice; with SVNCacheResponses On,
+  # the second one is served from the cache.
+  for i in range(2):
+    svntest.verify.compare_and_display_lines(None, 'iota',
+                                             "This is the file 'iota'.\n",
+                                             get('iota'))
+
+  # A delta base that does not parse as a version resource makes the
+  # server fall back to the fulltext.  Both requests below join to the
+  # same string when the key fields are concatenated with ':', so they
+  # must still get their own file's contents.
+  for i in range(2):
+    svntest.verify.compare_and_display_lines(None, 'x:/q',
+                                             "This is the file 'x:/q'.\n",
+                                             get('x:/q', 'bogus'))
+    svntest.verify.compare_and_display_lines(None, 'q',
+                                             "This is the file 'q'.\n",
+                                             get('q', 'bogus:/x'))
+
+
 ########################################################################
 # Run the tests
 
@@ -652,6 +698,7 @@ test_list = [ None,
               propfind_404,
               propfind_allprop,
               propfind_propname,
+              cached_responses,
              ]
 serial_only = True
 
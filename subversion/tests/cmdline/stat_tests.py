@@ -27,7 +27,9 @@
 # General modules
 import os
 import re
+import sys
 import time
+import subprocess
 import datetime
 import logging
 
@@ -2303,6 +2305,70 @@ def status_missing_conflicts(sbox):
 
 
 
+def is_os_linux():
+  return sys.platform.startswith('linux')
+
+@SkipUnless(is_os_linux)
+def status_with_change_journal(sbox):
+  "status while svn-wc-watch keeps a journal"
+
+  sbox.build()
+  wc_dir = sbox.wc_dir
+  journal = os.path.join(wc_dir, svntest.main.get_admin_name(), 'journal')
+
+  watcher = subprocess.Popen([svntest.main.svn_wc_watch_binary,
+                              os.path.abspath(wc_dir)])
+  try:
+    for i in range(100):
+      if os.path.exists(journal):
+        break
+      time.sleep(0.1)
+    else:
+      raise svntest.Failure("svn-wc-watch did not create a journal")
+
+    # The watcher learns about changes asynchronously.  Every status must
+    # still see the change made right before it, which it wouldn't if it
+    # accepted the sync line of an earlier status run.
+    expected_status = svntest.actions.get_virginal_state(wc_dir, 1)
+    for path in ['iota', 'A/mu', 'A/B/lambda', 'A/B/E/alpha', 'A/D/gamma',
+                 'A/D/G/pi', 'A/D/H/chi']:
+      svntest.main.file_append(sbox.ospath(path), "changed\n")
+      expected_status.tweak(path, status='M ')
+      svntest.actions.run_and_verify_status(wc_dir, expected_status)
+
+    svntest.main.file_write(sbox.ospath('A/C/new'), "new\n")
+    expected_status.add({ 'A/C/new' : Item(status='? ') })
+    svntest.actions.run_and_verify_status(wc_dir, expected_status)
+
+    # Each status run leaves a sync line behind.  The watcher must not let
+    # them pile up in the journal.
+    for i in range(150):
+      svntest.main.run_svn(None, 'status', wc_dir)
+    with open(journal) as f:
+      syncs = [line for line in f if line.startswith('sync ')]
+    if len(syncs) >= 100:
+      raise svntest.Failure("The journal has %d sync lines" % len(syncs))
+
+    # And the compacted journal still lists what changed.
+    svntest.main.file_append(sbox.ospath('A/D/H/omega'), "changed\n")
+    expected_status.tweak('A/D/H/omega', status='M ')
+    svntest.actions.run_and_verify_status(wc_dir, expected_status)
+
+    # Changes that only touch the DB make the disk differ from it, too.
+    rho_path = sbox.ospath('A/D/G/rho')
+    svntest.main.run_svn(None, 'rm', '--keep-local', rho_path)
+    expected_status.tweak('A/D/G/rho', status='D ')
+    svntest.actions.run_and_verify_status(wc_dir, expected_status)
+
+    svntest.main.run_svn(None, 'commit', '-m', 'log msg', rho_path)
+    expected_status.remove('A/D/G/rho')
+    expected_status.add({ 'A/D/G/rho' : Item(status='? ') })
+    svntest.actions.run_and_verify_status(wc_dir, expected_status)
+  finally:
+    watcher.terminate()
+    watcher.wait()
+
+
 ########################################################################
 # Run the tests
 
@@ -2354,6 +2420,7 @@ test_list = [ None,
               status_move_missing_direct,
               status_move_missing_direct_base,
               status_missing_conflicts,
+              status_with_change_journal,
              ]
 
 if __name__ == '__main__':
@@ -195,6 +195,9 @@ svnauthz_validate_binary = os.path.abspath(
     '../../../tools/server-side/svnauthz-validate' + _exe
 )
 svnmover_binary = os.path.abspath('../../../tools/dev/svnmover/svnmover' + _exe)
+svn_wc_watch_binary = os.path.abspath(
+    '../../../tools/client-side/svn-wc-watch/svn-wc-watch' + _exe
+)
 
 # Location to the pristine repository, will be calculated from test_area_url
 # when we know what the user specified for --url.
@@ -669,6 +672,8 @@ exclusive-locking = true
     http_library_str = ""
     if options.http_library:
       http_library_str = "http-library=%s" % (options.http_library)
+    if options.http2:
+      http_library_str += "\nhttp2=yes"
     http_proxy_str = ""
     http_proxy_username_str = ""
     http_proxy_password_str = ""
@@ -1739,6 +1744,8 @@ class TestSpawningThread(threading.Thread):
       args.append('--httpd-whitelist=' + options.httpd_whitelist)
     if options.exclusive_wc_locks:
       args.append('--exclusive-wc-locks')
+    if options.http2:
+      args.append('--http2')
     if options.memcached_server:
       args.append('--memcached-server=' + options.memcached_server)
     if options.fsfs_sharding:
@@ -2165,6 +2172,8 @@ def _create_parser(usage=None):
                     help='Use the svn tools installed in this path')
   parser.add_option('--exclusive-wc-locks', action='store_true',
                     help='Use sqlite exclusive locking for working copies')
+  parser.add_option('--http2', action='store_true',
+                    help='Offer HTTP/2 to https servers')
   parser.add_option('--memcached-server', action='store',
                     help='Use memcached server at specified URL (FSFS only)')
   parser.add_option('--fsfs-compression', action='store', type='str',
@@ -2350,6 +2359,7 @@ def execute_tests(test_list, serial_only = False, test_name = None,
   global svndumpfilter_binary
   global svnversion_binary
   global svnmover_binary
+  global svn_wc_watch_binary
   global svnmucc_binary
   global svnauthz_binary
   global svnauthz_validate_binary
@@ -2454,6 +2464,8 @@ def execute_tests(test_list, serial_only = False, test_name = None,
     svnauthz_validate_binary = os.path.join(options.tools_bin,
                                             'svnauthz-validate' + _exe)
     svnmover_binary = os.path.join(options.tools_bin, 'svnmover' + _exe)
+    svn_wc_watch_binary = os.path.join(options.tools_bin,
+                                       'svn-wc-watch' + _exe)
 
   ######################################################################
 
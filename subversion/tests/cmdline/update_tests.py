@@ -6856,6 +6856,181 @@ def update_add_missing_local_add(sbox):
   
   sbox.simple_update()
 
+def nodes_state(wc_dir):
+  "Return the NODES rows of WC_DIR that don't depend on the working files"
+
+  return sorted(svntest.wc.sqlite_stmt(wc_dir,
+                  "select local_relpath, op_depth, parent_relpath, "
+                  "       repos_path, revision, presence, moved_here, "
+                  "       moved_to, kind, properties, depth, checksum, "
+                  "       symlink_target, changed_revision, changed_date, "
+                  "       changed_author, file_external, inherited_props "
+                  "from nodes"))
+
+def update_crossing_node_batches(sbox):
+  "update adding more nodes than fit into a batch"
+
+  sbox.build()
+  wc_dir = sbox.wc_dir
+
+  # Enough nodes for the update editor to write them to the DB in more than
+  # one batch.
+  big_dir = sbox.get_tempname('big')
+  for i in range(25):
+    os.makedirs(os.path.join(big_dir, 'd%02d' % i))
+    for j in range(45):
+      svntest.main.file_write(os.path.join(big_dir, 'd%02d' % i, 'f%02d' % j),
+                              'This is file %d of directory %d.\n' % (j, i))
+  svntest.actions.run_and_verify_svn(None, [], 'import', '-m', 'log msg',
+                                     big_dir, sbox.repo_url + '/big') #r2
+
+  # Get the nodes with an update, a checkout and in many small edits.
+  svntest.actions.run_and_verify_svn(None, [], 'update', wc_dir)
+
+  checkout_dir = sbox.add_wc_path('checkout')
+  svntest.actions.run_and_verify_svn(None, [], 'checkout',
+                                     sbox.repo_url, checkout_dir)
+
+  step_dir = sbox.add_wc_path('steps')
+  svntest.actions.run_and_verify_svn(None, [], 'checkout',
+                                     '--depth', 'immediates',
+                                     sbox.repo_url, step_dir)
+  svntest.actions.run_and_verify_svn(None, [], 'update',
+                                     '--set-depth', 'immediates',
+                                     os.path.join(step_dir, 'big'))
+  for i in range(25):
+    svntest.actions.run_and_verify_svn(None, [], 'update',
+                                       '--set-depth', 'infinity',
+                                       os.path.join(step_dir, 'big',
+                                                    'd%02d' % i))
+  svntest.actions.run_and_verify_svn(None, [], 'update',
+                                     '--set-depth', 'infinity', step_dir)
+
+  expected = nodes_state(step_dir)
+  if len(expected) < 1150:
+    raise svntest.Failure("Expected at least 1150 nodes, got %d"
+                          % len(expected))
+  for other_dir in [wc_dir, checkout_dir]:
+    actual = nodes_state(other_dir)
+    if actual != expected:
+      logger.warn("Expected nodes in '%s':", other_dir)
+      for row in expected:
+        if row not in actual:
+          logger.warn("  %s", row)
+      logger.warn("Unexpected nodes in '%s':", other_dir)
+      for row in actual:
+        if row not in expected:
+          logger.warn("  %s", row)
+      raise svntest.Failure("Nodes in '%s' differ" % other_dir)
+
+  # Now a single directory receiving a batch worth of files, with an
+  # obstructed file in the middle and sub-directories that the update
+  # doesn't bring in, which have to be marked not-present.
+  sbox.simple_mkdir('flat')
+  sbox.simple_commit() #r3
+  sbox.simple_update()
+
+  flat_dir = sbox.get_tempname('flat')
+  for i in range(1100):
+    svntest.main.file_write(os.path.join(flat_dir, 'f%04d' % i),
+                            'This is flat file %d.\n' % i)
+  for sub in ['sub1', 'sub2']:
+    os.makedirs(os.path.join(flat_dir, sub))
+    svntest.main.file_write(os.path.join(flat_dir, sub, 'file'),
+                            'This is a file in %s.\n' % sub)
+  svntest.actions.run_and_verify_svn(None, [], 'import', '-m', 'log msg',
+                                     flat_dir, sbox.repo_url + '/flat') #r4
+
+  svntest.main.file_write(sbox.ospath('flat/f0500'), 'obstruction\n')
+  svntest.actions.run_and_verify_svn(None, [], 'update', '--depth', 'files',
+                                     '--accept', 'postpone',
+                                     sbox.ospath('flat'))
+
+  rows = svntest.wc.sqlite_stmt(wc_dir,
+                                "select local_relpath, presence, revision "
+                                "from nodes where op_depth = 0 "
+                                "and parent_relpath = 'flat'")
+  expected_rows = [('flat/f%04d' % i, 'normal', 4) for i in range(1100)]
+  expected_rows += [('flat/sub1', 'not-present', 4),
+                    ('flat/sub2', 'not-present', 4)]
+  if sorted(rows) != sorted(expected_rows):
+    raise svntest.Failure("Unexpected nodes below 'flat'")
+
+  rows = svntest.wc.sqlite_stmt(wc_dir,
+                                "select local_relpath from actual_node "
+                                "where conflict_data is not null")
+  if rows != [('flat/f0500',)]:
+    raise svntest.Failure("Expected a tree conflict on 'flat/f0500' only")
+
+  for i in [0, 499, 501, 1099]:
+    path = sbox.ospath('flat/f%04d' % i)
+    if open(path).read() != 'This is flat file %d.\n' % i:
+      raise svntest.Failure("Unexpected contents of '%s'" % path)
+  if open(sbox.ospath('flat/f0500')).read() != 'obstruction\n':
+    raise svntest.Failure("The obstruction was overwritten")
+
+  # The not-present sub-directories arrive with the next update.
+  svntest.actions.run_and_verify_svn(None, [], 'update', wc_dir)
+  for sub in ['sub1', 'sub2']:
+    if not os.path.isfile(sbox.ospath('flat/%s/file' % sub)):
+      raise svntest.Failure("'flat/%s' was not updated" % sub)
+
+def update_bulk_many_texts(sbox):
+  "bulk update with many texts to render"
+
+  # With SVNUpdateRenderThreads > 1, mod_dav_svn renders the texts of a
+  # bulk update on worker threads and must still send the report in order.
+  sbox.build()
+  wc_dir = sbox.wc_dir
+  bulk_config = ['--config-option', 'servers:global:http-bulk-updates=yes']
+
+  def text(i, j, rev):
+    return ''.join('Line %d of file %d in directory %d, r%d.\n'
+                   % (k, j, i, rev) for k in range(50 + 200 * j))
+
+  sbox.simple_mkdir('bulk')
+  for i in range(4):
+    sbox.simple_mkdir('bulk/d%d' % i)
+    for j in range(15):
+      sbox.simple_append('bulk/d%d/f%02d' % (i, j), text(i, j, 2))
+      sbox.simple_add('bulk/d%d/f%02d' % (i, j))
+  sbox.simple_propset('color', 'blue', 'bulk/d1/f03', 'bulk/d2')
+  sbox.simple_commit() #r2
+
+  for i in range(4):
+    for j in range(0, 15, 2):
+      svntest.main.file_write(sbox.ospath('bulk/d%d/f%02d' % (i, j)),
+                              text(i, j, 3))
+  sbox.simple_propset('color', 'red', 'bulk/d1/f03', 'bulk/d2')
+  sbox.simple_commit() #r3
+
+  other_wc = sbox.add_wc_path('other')
+  svntest.actions.run_and_verify_svn(None, [], 'checkout', '-r', '2',
+                                     sbox.repo_url, other_wc, *bulk_config)
+  svntest.actions.run_and_verify_svn(None, [], 'update', other_wc,
+                                     *bulk_config)
+
+  expected_disk = svntest.main.greek_state.copy()
+  expected_disk.add({
+    'bulk'    : Item(),
+    'bulk/d2' : Item(props={'color' : 'red'}),
+    })
+  for i in range(4):
+    if i != 2:
+      expected_disk.add({'bulk/d%d' % i : Item()})
+    for j in range(15):
+      expected_disk.add({
+        'bulk/d%d/f%02d' % (i, j) : Item(text(i, j, 3 if j % 2 == 0 else 2)),
+        })
+  expected_disk.tweak('bulk/d1/f03', props={'color' : 'red'})
+  svntest.actions.verify_disk(other_wc, expected_disk, True)
+
+  expected_status = svntest.actions.get_virginal_state(other_wc, 3)
+  for path in expected_disk.desc:
+    if path.startswith('bulk'):
+      expected_status.add({path : Item(status='  ', wc_rev=3)})
+  svntest.actions.run_and_verify_status(other_wc, expected_status)
+
 #######################################################################
 # Run the tests
 
@@ -6947,6 +7122,8 @@ test_list = [ None,
               missing_tmp_update,
               update_delete_switched,
               update_add_missing_local_add,
+              update_crossing_node_batches,
+              update_bulk_many_texts,
              ]
 
 if __name__ == '__main__':
@@ -2952,6 +2952,286 @@ two_way_issue_3362_v2(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Diff two files that are big enough to be mapped into memory as a whole
+   by ../../libsvn_diff/diff_file.c, with a change in the middle, once as
+   they are and once with normalization, which forces reading in chunks. */
+static svn_error_t *
+test_whole_file_mapping(apr_pool_t *pool)
+{
+  static const char *const eols[] = { "\n", "\r\n" };
+  svn_diff_file_options_t *diff_opts = svn_diff_file_options_create(pool);
+  apr_pool_t *subpool = svn_pool_create(pool);
+  const int lines = 120000;
+  const int changed = 60000;
+  apr_size_t e;
+  int i;
+
+  for (e = 0; e < sizeof(eols) / sizeof(eols[0]); e++)
+    {
+      svn_stringbuf_t *original = svn_stringbuf_create_empty(subpool);
+      svn_stringbuf_t *modified = svn_stringbuf_create_empty(subpool);
+      svn_stringbuf_t *expected = svn_stringbuf_create(
+                                    "--- whole-file-original" NL
+                                    "+++ whole-file-modified" NL,
+                                    subpool);
+      char line[32];
+
+      svn_stringbuf_appendcstr(expected,
+                               apr_psprintf(subpool, "@@ -%d,7 +%d,7 @@" NL,
+                                            changed - 3, changed - 3));
+
+      for (i = 1; i <= lines; i++)
+        {
+          apr_snprintf(line, sizeof(line), "line %06d%s", i, eols[e]);
+          svn_stringbuf_appendcstr(original, line);
+          if (i >= changed - 3 && i <= changed + 3)
+            {
+              svn_stringbuf_appendcstr(expected, i == changed ? "-" : " ");
+              svn_stringbuf_appendcstr(expected, line);
+            }
+
+          if (i == changed)
+            {
+              apr_snprintf(line, sizeof(line), "changed %06d%s", i, eols[e]);
+              svn_stringbuf_appendcstr(expected, "+");
+              svn_stringbuf_appendcstr(expected, line);
+            }
+          svn_stringbuf_appendcstr(modified, line);
+        }
+
+      diff_opts->ignore_eol_style = FALSE;
+      SVN_ERR(two_way_diff("whole-file-original", "whole-file-modified",
+                           original->data, modified->data, expected->data,
+                           diff_opts, subpool));
+
+      diff_opts->ignore_eol_style = TRUE;
+      SVN_ERR(two_way_diff("whole-file-original", "whole-file-modified",
+                           original->data, modified->data, expected->data,
+                           diff_opts, subpool));
+
+      svn_pool_clear(subpool);
+    }
+  svn_pool_destroy(subpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton for the verify_* output functions. */
+typedef struct verify_baton_t
+{
+  /* The lines of both files. */
+  apr_array_header_t *lines[2];
+  /* Where we expect the next range to start in each of the files. */
+  apr_off_t next[2];
+} verify_baton_t;
+
+/* Check that the ranges are adjacent to the previous ones.
+ * Implements svn_diff_output_fns_t.output_diff_modified. */
+static svn_error_t *
+verify_modified(void *baton,
+                apr_off_t original_start, apr_off_t original_length,
+                apr_off_t modified_start, apr_off_t modified_length,
+                apr_off_t latest_start, apr_off_t latest_length)
+{
+  verify_baton_t *vb = baton;
+
+  SVN_TEST_ASSERT(original_start == vb->next[0]);
+  SVN_TEST_ASSERT(modified_start == vb->next[1]);
+  vb->next[0] += original_length;
+  vb->next[1] += modified_length;
+
+  return SVN_NO_ERROR;
+}
+
+/* Check that the ranges are adjacent to the previous ones and that they
+ * really are identical.
+ * Implements svn_diff_output_fns_t.output_common. */
+static svn_error_t *
+verify_common(void *baton,
+              apr_off_t original_start, apr_off_t original_length,
+              apr_off_t modified_start, apr_off_t modified_length,
+              apr_off_t latest_start, apr_off_t latest_length)
+{
+  verify_baton_t *vb = baton;
+  apr_off_t i;
+
+  SVN_TEST_ASSERT(original_length == modified_length);
+  for (i = 0; i < original_length; i++)
+    SVN_TEST_STRING_ASSERT(
+      APR_ARRAY_IDX(vb->lines[0], original_start + i, const char *),
+      APR_ARRAY_IDX(vb->lines[1], modified_start + i, const char *));
+
+  return svn_error_trace(verify_modified(baton,
+                                         original_start, original_length,
+                                         modified_start, modified_length,
+                                         latest_start, latest_length));
+}
+
+/* Diff random files, many of whose lines are repeated, with the histogram
+   algorithm and check that the result describes the two files. */
+static svn_error_t *
+random_histogram_diff(apr_pool_t *pool)
+{
+  static const svn_diff_output_fns_t verify_fns =
+    { verify_common, verify_modified, NULL, NULL, NULL };
+  apr_pool_t *subpool = svn_pool_create(pool);
+  svn_diff_file_options_t *diff_opts = svn_diff_file_options_create(pool);
+  const char *filename[2];
+  int i, j;
+
+  filename[0] = svn_test_data_path("histogram1", pool);
+  filename[1] = svn_test_data_path("histogram2", pool);
+  diff_opts->algorithm = svn_diff_file_algorithm_histogram;
+
+  seed_val();
+
+  for (i = 0; i < 10; ++i)
+    {
+      verify_baton_t vb;
+      svn_diff_t *diff;
+
+      for (j = 0; j < 2; j++)
+        {
+          svn_stringbuf_t *contents;
+
+          /* Few distinct lines in half of the runs, so that the fallback
+             to the LCS algorithm gets exercised as well. */
+          SVN_ERR(make_random_file(filename[j], 500, 1500,
+                                   i % 2 ? 1000 : 20, i % 3 ? 10 : 0,
+                                   TRUE, subpool));
+          SVN_ERR(svn_stringbuf_from_file2(&contents, filename[j], subpool));
+          vb.lines[j] = svn_cstring_split(contents->data, "\n", FALSE,
+                                          subpool);
+          vb.next[j] = 0;
+        }
+
+      SVN_ERR(svn_diff_file_diff_2(&diff, filename[0], filename[1],
+                                   diff_opts, subpool));
+      SVN_ERR(svn_diff_output2(diff, &vb, &verify_fns, NULL, NULL));
+
+      SVN_TEST_ASSERT(vb.next[0] == vb.lines[0]->nelts);
+      SVN_TEST_ASSERT(vb.next[1] == vb.lines[1]->nelts);
+
+      svn_pool_clear(subpool);
+    }
+  svn_pool_destroy(subpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Append line LINE of a random edit of a text of distinct lines to
+   MODIFIED.  Lines get changed, deleted or preceded by new lines.  Use
+   TAG to make new lines unique to this text. */
+static void
+append_edited_line(svn_stringbuf_t *modified,
+                   int line,
+                   const char *tag)
+{
+  switch (range_rand(0, 199))
+    {
+      case 0:
+        svn_stringbuf_appendcstr(modified,
+                                 apr_psprintf(modified->pool, "%s %d\n",
+                                              tag, line));
+        break;
+
+      case 1:
+        break;
+
+      case 2:
+        svn_stringbuf_appendcstr(modified,
+                                 apr_psprintf(modified->pool,
+                                              "%s %d a\n%s %d b\n",
+                                              tag, line, tag, line));
+        /* fall through */
+
+      default:
+        svn_stringbuf_appendcstr(modified,
+                                 apr_psprintf(modified->pool, "line %d\n",
+                                              line));
+    }
+}
+
+static svn_error_t *
+random_parallel_diff3(apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  seed_val();
+
+  for (i = 0; i < 3; ++i)
+    {
+      svn_stringbuf_t *original = svn_stringbuf_create_empty(iterpool);
+      svn_stringbuf_t *modified = svn_stringbuf_create_empty(iterpool);
+      svn_stringbuf_t *latest = svn_stringbuf_create_empty(iterpool);
+      svn_stringbuf_t *expected = svn_stringbuf_create_empty(iterpool);
+      const svn_string_t *texts[3];
+      int num_lines = range_rand(20000, 30000);
+      int line, j;
+
+      /* Both sides edit alternating blocks of 100 lines, keeping away from
+         the block boundaries, so that the merge is free of conflicts. */
+      for (line = 0; line < num_lines; line++)
+        {
+          svn_stringbuf_t *edited = (line / 100) % 2 ? latest : modified;
+          svn_stringbuf_t *unchanged = (line / 100) % 2 ? modified : latest;
+          apr_size_t len = edited->len;
+          const char *text = apr_psprintf(iterpool, "line %d\n", line);
+
+          svn_stringbuf_appendcstr(original, text);
+          svn_stringbuf_appendcstr(unchanged, text);
+          if (line % 100 >= 10 && line % 100 < 90)
+            append_edited_line(edited, line,
+                               edited == modified ? "mod" : "lat");
+          else
+            svn_stringbuf_appendcstr(edited, text);
+
+          svn_stringbuf_appendbytes(expected, edited->data + len,
+                                    edited->len - len);
+        }
+
+      texts[0] = svn_string_create_from_buf(original, iterpool);
+      texts[1] = svn_string_create_from_buf(modified, iterpool);
+      texts[2] = svn_string_create_from_buf(latest, iterpool);
+
+      /* All combinations of threads and chunking give the same result. */
+      for (j = 0; j < 4; j++)
+        {
+          svn_diff_file_options_t *diff_opts
+            = svn_diff_file_options_create(iterpool);
+          svn_stringbuf_t *actual = svn_stringbuf_create_empty(iterpool);
+          svn_diff_t *diff;
+
+          diff_opts->diff3_threads = j % 2 ? 4 : 1;
+          if (j >= 2)
+            {
+              apr_array_header_t *args = apr_array_make(iterpool, 1,
+                                                        sizeof(const char *));
+
+              APR_ARRAY_PUSH(args, const char *) = "--chunked";
+              SVN_ERR(svn_diff_file_options_parse(diff_opts, args, iterpool));
+              SVN_TEST_ASSERT(diff_opts->diff3_chunked);
+            }
+
+          SVN_ERR(svn_diff_mem_string_diff3(&diff, texts[0], texts[1],
+                                            texts[2], diff_opts, iterpool));
+          SVN_TEST_ASSERT(! svn_diff_contains_conflicts(diff));
+          SVN_ERR(svn_diff_mem_string_output_merge3(
+                    svn_stream_from_stringbuf(actual, iterpool), diff,
+                    texts[0], texts[1], texts[2], NULL, NULL, NULL, NULL,
+                    svn_diff_conflict_display_modified_latest,
+                    NULL, NULL, iterpool));
+          SVN_TEST_STRING_ASSERT(actual->data, expected->data);
+        }
+
+      svn_pool_clear(iterpool);
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 three_way_double_add(apr_pool_t *pool)
 {
@@ -3107,6 +3387,12 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "2-way issue #3362 test v1"),
     SVN_TEST_PASS2(two_way_issue_3362_v2,
                    "2-way issue #3362 test v2"),
+    SVN_TEST_PASS2(test_whole_file_mapping,
+                   "diff files mapped into memory as a whole"),
+    SVN_TEST_PASS2(random_histogram_diff,
+                   "random 2-way diff with the histogram algorithm"),
+    SVN_TEST_PASS2(random_parallel_diff3,
+                   "random 3-way merge with threads and chunks"),
     SVN_TEST_XFAIL2(three_way_double_add,
                    "3-way merge, double add"),
     SVN_TEST_NULL
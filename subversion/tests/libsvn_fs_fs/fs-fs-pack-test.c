@@ -29,6 +29,7 @@
 #include "../../libsvn_fs_fs/fs.h"
 #include "../../libsvn_fs_fs/fs_fs.h"
 #include "../../libsvn_fs_fs/low_level.h"
+#include "../../libsvn_fs_fs/mergeinfo-index.h"
 #include "../../libsvn_fs_fs/pack.h"
 #include "../../libsvn_fs_fs/util.h"
 
@@ -36,6 +37,7 @@
 #include "svn_pools.h"
 #include "svn_props.h"
 #include "svn_fs.h"
+#include "svn_mergeinfo.h"
 #include "private/svn_string_private.h"
 
 #include "../svn_test_fs.h"
@@ -1887,6 +1889,172 @@ large_delta_against_plain(const svn_test_opts_t *opts,
 
 #undef REPO_NAME
 
+/* ------------------------------------------------------------------------ */
+
+#define REPO_NAME "test-repo-mergeinfo_index"
+
+/* Implements svn_fs_mergeinfo_receiver_t, collecting the unparsed
+   mergeinfo in the apr_hash_t * BATON. */
+static svn_error_t *
+collect_mergeinfo(const char *path,
+                  svn_mergeinfo_t mergeinfo,
+                  void *baton,
+                  apr_pool_t *scratch_pool)
+{
+  apr_hash_t *catalog = baton;
+  apr_pool_t *result_pool = apr_hash_pool_get(catalog);
+  svn_string_t *mergeinfo_string;
+
+  SVN_ERR(svn_mergeinfo_to_string(&mergeinfo_string, mergeinfo,
+                                  result_pool));
+  svn_hash_sets(catalog, apr_pstrdup(result_pool, path),
+                mergeinfo_string->data);
+
+  return SVN_NO_ERROR;
+}
+
+/* Set the svn:mergeinfo property of PATH in ROOT to VALUE. */
+static svn_error_t *
+set_mergeinfo(svn_fs_root_t *root,
+              const char *path,
+              const char *value,
+              apr_pool_t *pool)
+{
+  return svn_error_trace(svn_fs_change_node_prop(
+                           root, path, SVN_PROP_MERGEINFO,
+                           value ? svn_string_create(value, pool) : NULL,
+                           pool));
+}
+
+static svn_error_t *
+mergeinfo_index(const svn_test_opts_t *opts,
+                apr_pool_t *pool)
+{
+  svn_fs_t *fs, *crawl_fs;
+  fs_fs_data_t *ffd;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *root, *rev_root;
+  svn_revnum_t rev, youngest;
+  apr_hash_t *fs_config;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  const char *paths[] = { "/", "/A", "/A/D", "/A2", "/A2/D", "/A2/B" };
+  apr_size_t i;
+
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL, NULL);
+
+  SVN_ERR(svn_test__create_fs(&fs, REPO_NAME, opts, pool));
+  ffd = fs->fsap_data;
+  if (ffd->format < SVN_FS_FS__MIN_MERGEINFO_FORMAT)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL, NULL);
+
+  /* Revision 1: Greek tree with some mergeinfo, not indexed yet. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(root, pool));
+  SVN_ERR(set_mergeinfo(root, "/A/B", "/branch:1-5", pool));
+  SVN_ERR(set_mergeinfo(root, "/A/D/G", "/x:3", pool));
+  SVN_ERR(set_mergeinfo(root, "/A/D/H/psi", "/y:2*", pool));
+  SVN_ERR(set_mergeinfo(root, "/iota", "/z:4", pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+
+  /* From here on, keep the index up to date.  The next commit will
+     have to index r1 as well. */
+  ffd->mergeinfo_index_enabled = TRUE;
+
+  /* Revision 2: copy a sub-tree, modify the copy and delete another
+     sub-tree with mergeinfo. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, rev, pool));
+  SVN_ERR(svn_fs_copy(rev_root, "/A", root, "/A2", pool));
+  SVN_ERR(set_mergeinfo(root, "/A2/B", "/branch:1-7", pool));
+  SVN_ERR(set_mergeinfo(root, "/A2/D/gamma", "/x:5", pool));
+  SVN_ERR(svn_fs_delete(root, "/A/D/H", pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+
+  /* Revision 3: remove mergeinfo, add invalid mergeinfo, replace a
+     sub-tree and delete a path below the replacement. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, 1, pool));
+  SVN_ERR(set_mergeinfo(root, "/A/B", NULL, pool));
+  SVN_ERR(set_mergeinfo(root, "/A/C", "not mergeinfo", pool));
+  SVN_ERR(svn_fs_delete(root, "/A2/D", pool));
+  SVN_ERR(svn_fs_copy(rev_root, "/A/D", root, "/A2/D", pool));
+  SVN_ERR(svn_fs_delete(root, "/A2/D/G", pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+
+  /* Revision 4: mergeinfo on the root and on a previously deleted path. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, 1, pool));
+  SVN_ERR(set_mergeinfo(root, "/", "/trunk:1-3", pool));
+  SVN_ERR(svn_fs_copy(rev_root, "/A/D/H", root, "/A/D/H", pool));
+  SVN_ERR(set_mergeinfo(root, "/A2/B/E/alpha", "/branch:6", pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &youngest, txn, pool));
+
+  /* Compare with the results of crawling the tree in a separate FS
+     instance that does not use the index. */
+  fs_config = apr_hash_make(pool);
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_NS,
+                           svn_uuid_generate(pool));
+  SVN_ERR(svn_fs_open2(&crawl_fs, REPO_NAME, fs_config, pool, pool));
+  SVN_TEST_ASSERT(!((fs_fs_data_t *)crawl_fs->fsap_data)
+                     ->mergeinfo_index_enabled);
+
+  for (rev = 0; rev <= youngest; ++rev)
+    for (i = 0; i < sizeof(paths) / sizeof(paths[0]); ++i)
+      {
+        apr_hash_t *expected, *actual;
+        apr_array_header_t *query;
+        apr_hash_index_t *hi;
+        svn_node_kind_t kind;
+        svn_boolean_t indexed;
+
+        svn_pool_clear(iterpool);
+
+        SVN_ERR(svn_fs_revision_root(&rev_root, crawl_fs, rev, iterpool));
+        SVN_ERR(svn_fs_check_path(&kind, rev_root, paths[i], iterpool));
+        if (kind == svn_node_none)
+          continue;
+
+        /* Descendants' mergeinfo found by crawling, excluding PATHS[I]. */
+        expected = apr_hash_make(iterpool);
+        query = apr_array_make(iterpool, 1, sizeof(const char *));
+        APR_ARRAY_PUSH(query, const char *) = paths[i];
+        SVN_ERR(svn_fs_get_mergeinfo3(rev_root, query, svn_mergeinfo_explicit,
+                                      TRUE, FALSE, collect_mergeinfo,
+                                      expected, iterpool));
+        svn_hash_sets(expected, paths[i], NULL);
+
+        /* The same from the index. */
+        actual = apr_hash_make(iterpool);
+        SVN_ERR(svn_fs_fs__mergeinfo_index_get_descendants(&indexed, fs,
+                                                           rev, paths[i],
+                                                           collect_mergeinfo,
+                                                           actual, iterpool));
+        SVN_TEST_ASSERT(indexed);
+
+        SVN_TEST_INT_ASSERT(apr_hash_count(actual), apr_hash_count(expected));
+        for (hi = apr_hash_first(iterpool, expected);
+             hi;
+             hi = apr_hash_next(hi))
+          {
+            const char *value = svn_hash_gets(actual, apr_hash_this_key(hi));
+
+            SVN_TEST_ASSERT(value);
+            SVN_TEST_STRING_ASSERT(value, apr_hash_this_val(hi));
+          }
+      }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+
 
 
 /* The test table.  */
@@ -1942,6 +2110,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "pack with limited memory for metadata"),
     SVN_TEST_OPTS_PASS(large_delta_against_plain,
                        "large deltas against PLAIN, issue #4658"),
+    SVN_TEST_OPTS_PASS(mergeinfo_index,
+                       "mergeinfo index matches tree crawl"),
     SVN_TEST_NULL
   };
 
@@ -892,6 +892,9 @@ node_locations2(const svn_test_opts_t *opts,
         { 0 }
       };
     SVN_ERR(check_locations(fs, info, "/bar/baz", youngest_rev, pool));
+
+    /* Again, now with the locations cached, if enabled. */
+    SVN_ERR(check_locations(fs, info, "/bar/baz", youngest_rev, pool));
   }
 
   return SVN_NO_ERROR;
@@ -2991,6 +2994,7 @@ node_location_segments(const svn_test_opts_t *opts,
     },
   };
   const location_segment_test_t *subtest;
+  int i;
 
   /* Bail (with success) on known-untestable scenarios */
   if ((strcmp(opts->fs_type, "bdb") == 0)
@@ -3066,13 +3070,15 @@ node_location_segments(const svn_test_opts_t *opts,
   SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(youngest_rev));
   svn_pool_clear(subpool);
 
-  /*  */
-  for (subtest = subtests; subtest->path; subtest++)
-    {
-      SVN_ERR(check_location_segments(repos, subtest->path, subtest->peg,
-                                      subtest->start, subtest->end,
-                                      subtest->segments, pool));
-    }
+  /* Run all subtests twice, so that the second round gets answered from
+     the location cache, if enabled. */
+  for (i = 0; i < 2; i++)
+    for (subtest = subtests; subtest->path; subtest++)
+      {
+        SVN_ERR(check_location_segments(repos, subtest->path, subtest->peg,
+                                        subtest->start, subtest->end,
+                                        subtest->segments, pool));
+      }
 
   return SVN_NO_ERROR;
 }
@@ -4466,6 +4472,108 @@ test_list(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Baton for blame_receiver(). */
+typedef struct blame_baton_t
+{
+  /* The expected revision of each line, terminated by 0. */
+  const svn_revnum_t *expected;
+  int lines;
+} blame_baton_t;
+
+/* Check the lines of a file reported by svn_repos_get_blame() against
+   BATON, a blame_baton_t, assuming that each chunk covers one line. */
+static svn_error_t *
+blame_receiver(void *baton,
+               apr_int64_t start_line,
+               svn_revnum_t revision,
+               apr_hash_t *rev_props,
+               apr_pool_t *scratch_pool)
+{
+  blame_baton_t *b = baton;
+
+  /* An empty range at the end of the file. */
+  if (b->expected[b->lines] == 0 && start_line == b->lines)
+    return SVN_NO_ERROR;
+
+  SVN_TEST_ASSERT(start_line == b->lines && b->expected[b->lines] != 0);
+  SVN_TEST_ASSERT(revision == b->expected[b->lines]);
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(revision) == (rev_props != NULL));
+  if (rev_props)
+    SVN_TEST_STRING_ASSERT(svn_prop_get_value(rev_props,
+                                              SVN_PROP_REVISION_AUTHOR),
+                           "blamer");
+  b->lines++;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_get_blame(const svn_test_opts_t *opts,
+               apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev;
+  blame_baton_t b;
+  int i;
+  const svn_revnum_t expected_full[] = { 3, 1, 2, 0 };
+  const svn_revnum_t expected_from_2[] = { 3, SVN_INVALID_REVNUM, 2, 0 };
+  const char *contents[] = {
+    "line 1\n",
+    "line 1\nline 2\n",
+    "line 0\nline 1\nline 2\n"
+  };
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-get-blame", opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* r1 adds /iota, r2 appends a line and r3 prepends one. */
+  for (i = 0; i < 3; i++)
+    {
+      apr_hash_t *revprops = apr_hash_make(pool);
+
+      svn_hash_sets(revprops, SVN_PROP_REVISION_AUTHOR,
+                    svn_string_create("blamer", pool));
+      SVN_ERR(svn_repos_fs_begin_txn_for_commit2(&txn, repos, i, revprops,
+                                                 pool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+      if (i == 0)
+        SVN_ERR(svn_fs_make_file(txn_root, "/iota", pool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, "/iota", contents[i],
+                                          pool));
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      pool));
+      SVN_TEST_ASSERT(youngest_rev == i + 1);
+    }
+
+  /* Blame all revisions, twice to hit the cache, if enabled. */
+  for (i = 0; i < 2; i++)
+    {
+      b.expected = expected_full;
+      b.lines = 0;
+      SVN_ERR(svn_repos_get_blame(repos, "/iota", 0, 3, NULL, NULL,
+                                  blame_receiver, &b, NULL, NULL, pool));
+      SVN_TEST_ASSERT(b.lines == 3);
+    }
+
+  /* Lines older than the start revision are not attributed. */
+  b.expected = expected_from_2;
+  b.lines = 0;
+  SVN_ERR(svn_repos_get_blame(repos, "/iota", 2, 3, NULL, NULL,
+                              blame_receiver, &b, NULL, NULL, pool));
+  SVN_TEST_ASSERT(b.lines == 3);
+
+  /* Backward ranges are not supported. */
+  SVN_TEST_ASSERT_ERROR(svn_repos_get_blame(repos, "/iota", 3, 2, NULL, NULL,
+                                            blame_receiver, &b, NULL, NULL,
+                                            pool),
+                        SVN_ERR_INCORRECT_PARAMS);
+
+  return SVN_NO_ERROR;
+}
+
 /* The test table.  */
 
 static int max_threads = 4;
@@ -4537,6 +4645,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "optional authz wildcard performance test"),
     SVN_TEST_OPTS_PASS(test_list,
                        "test svn_repos_list"),
+    SVN_TEST_OPTS_PASS(test_get_blame,
+                       "test svn_repos_get_blame"),
     SVN_TEST_NULL
   };
 
@@ -1147,6 +1147,93 @@ test_apr_trunc_workaround(apr_pool_t *pool)
   return SVN_NO_ERROR;  
 }
 
+static svn_error_t *
+test_file_copy_contents(apr_pool_t *pool)
+{
+  const char *tmp_dir;
+  const char *src_path;
+  const char *dst_path;
+  apr_file_t *src_file;
+  apr_file_t *dst_file;
+  svn_stringbuf_t *contents;
+  svn_stringbuf_t *copied;
+  apr_size_t i;
+  const apr_size_t file_size = 300000;
+
+  /* create a temp folder & schedule it for automatic cleanup */
+  SVN_ERR(svn_test_make_sandbox_dir(&tmp_dir, "test_file_copy_contents",
+                                    pool));
+
+  /* larger than the fallback's chunk size */
+  contents = svn_stringbuf_create_ensure(file_size, pool);
+  for (i = 0; i < file_size; ++i)
+    svn_stringbuf_appendbyte(contents, (char)rand());
+
+  SVN_ERR(svn_io_write_unique(&src_path, tmp_dir, contents->data,
+                              contents->len, svn_io_file_del_none, pool));
+
+  /* copy into a buffered file, as used for install streams */
+  SVN_ERR(svn_io_file_open(&src_file, src_path, APR_READ, APR_OS_DEFAULT,
+                           pool));
+  SVN_ERR(svn_io_open_unique_file3(&dst_file, &dst_path, tmp_dir,
+                                   svn_io_file_del_none, pool, pool));
+  SVN_ERR(svn_io__file_copy_contents(dst_file, src_file, NULL, NULL, pool));
+  SVN_ERR(svn_io_file_close(src_file, pool));
+  SVN_ERR(svn_io_file_close(dst_file, pool));
+
+  SVN_ERR(svn_stringbuf_from_file2(&copied, dst_path, pool));
+  SVN_TEST_ASSERT(svn_stringbuf_compare(contents, copied));
+
+  /* empty source */
+  SVN_ERR(svn_io_write_unique(&src_path, tmp_dir, "", 0,
+                              svn_io_file_del_none, pool));
+  SVN_ERR(svn_io_file_open(&src_file, src_path, APR_READ, APR_OS_DEFAULT,
+                           pool));
+  SVN_ERR(svn_io_open_unique_file3(&dst_file, &dst_path, tmp_dir,
+                                   svn_io_file_del_none, pool, pool));
+  SVN_ERR(svn_io__file_copy_contents(dst_file, src_file, NULL, NULL, pool));
+  SVN_ERR(svn_io_file_close(src_file, pool));
+  SVN_ERR(svn_io_file_close(dst_file, pool));
+
+  SVN_ERR(svn_stringbuf_from_file2(&copied, dst_path, pool));
+  SVN_TEST_ASSERT(copied->len == 0);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_copy_file_size_unknown(apr_pool_t *pool)
+{
+  const char *tmp_dir;
+  const char *src_path = "/proc/version";
+  const char *dst_path;
+  svn_node_kind_t kind;
+  svn_stream_t *stream;
+  svn_stringbuf_t *contents;
+  svn_stringbuf_t *copied;
+
+  /* procfs files claim to be empty, but aren't.  Some kernels make
+     copy_file_range() report them as empty, too. */
+  SVN_ERR(svn_io_check_path(src_path, &kind, pool));
+  if (kind != svn_node_file)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this test needs /proc/version");
+
+  SVN_ERR(svn_test_make_sandbox_dir(&tmp_dir, "test_copy_file_size_unknown",
+                                    pool));
+  dst_path = svn_dirent_join(tmp_dir, "version", pool);
+  SVN_ERR(svn_io_copy_file(src_path, dst_path, FALSE, pool));
+
+  SVN_ERR(svn_stream_open_readonly(&stream, src_path, pool, pool));
+  SVN_ERR(svn_stringbuf_from_stream(&contents, stream, 0, pool));
+  SVN_ERR(svn_stringbuf_from_file2(&copied, dst_path, pool));
+
+  SVN_TEST_ASSERT(contents->len > 0);
+  SVN_TEST_ASSERT(svn_stringbuf_compare(contents, copied));
+
+  return SVN_NO_ERROR;
+}
+
 /* The test table.  */
 
 static int max_threads = 3;
@@ -1184,6 +1271,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test svn_io_open_uniquely_named()"),
     SVN_TEST_PASS2(test_apr_trunc_workaround,
                    "test workaround for APR in svn_io_file_trunc"),
+    SVN_TEST_PASS2(test_file_copy_contents,
+                   "test svn_io__file_copy_contents()"),
+    SVN_TEST_PASS2(test_copy_file_size_unknown,
+                   "test svn_io_copy_file() with files of unknown size"),
     SVN_TEST_NULL
   };
 
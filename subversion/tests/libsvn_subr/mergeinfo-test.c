@@ -30,6 +30,7 @@
 
 #include "svn_hash.h"
 #include "svn_pools.h"
+#include "svn_sorts.h"
 #include "svn_types.h"
 #include "svn_mergeinfo.h"
 #include "private/svn_mergeinfo_private.h"
@@ -1083,6 +1084,127 @@ test_rangelist_intersect_randomly(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Set each element of array REVS[RANDOM_REV_ARRAY_LENGTH] randomly to
+ * 0 (not merged), 1 (merged non-inheritably) or 2 (merged inheritably). */
+static void
+randomly_fill_inheritance_array(int *revs)
+{
+  int i;
+  for (i = 0; i < RANDOM_REV_ARRAY_LENGTH; i++)
+    revs[i] = svn_test_rand(&random_rev_array_seed) % 3;
+}
+
+/* Set *RANGELIST to a rangelist representing the revisions that are marked
+ * with 1 (non-inheritable) or 2 (inheritable) in the array
+ * REVS[RANDOM_REV_ARRAY_LENGTH]. */
+static svn_error_t *
+inheritance_array_to_rangelist(svn_rangelist_t **rangelist,
+                               const int *revs,
+                               apr_pool_t *pool)
+{
+  svn_stringbuf_t *buf = svn_stringbuf_create_empty(pool);
+  int i;
+
+  for (i = 0; i < RANDOM_REV_ARRAY_LENGTH; i++)
+    {
+      if (revs[i])
+        {
+          if (buf->len)
+            svn_stringbuf_appendcstr(buf, ",");
+          svn_stringbuf_appendcstr(buf, apr_psprintf(pool, "%d%s", i,
+                                                     revs[i] == 1 ? "*"
+                                                                  : ""));
+        }
+    }
+
+  SVN_ERR(svn_rangelist__parse(rangelist, buf->data, pool));
+  SVN_ERR(svn_rangelist__canonicalize(*rangelist, pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_rangelist_merge_randomly(apr_pool_t *pool)
+{
+  int i;
+  apr_pool_t *iterpool;
+
+  random_rev_array_seed = (apr_uint32_t) apr_time_now();
+
+  iterpool = svn_pool_create(pool);
+
+  for (i = 0; i < 20; i++)
+    {
+      int first_revs[RANDOM_REV_ARRAY_LENGTH],
+        second_revs[RANDOM_REV_ARRAY_LENGTH],
+        expected_revs[RANDOM_REV_ARRAY_LENGTH];
+      svn_rangelist_t *first_rangelist, *second_rangelist,
+        *expected_rangelist, *actual_rangelist;
+      svn_rangelist__flat_t *flat_merged;
+      svn_string_t *expected_str, *actual_str;
+      svn_mergeinfo_t history;
+      int j;
+
+      svn_pool_clear(iterpool);
+
+      randomly_fill_inheritance_array(first_revs);
+      randomly_fill_inheritance_array(second_revs);
+      /* There is no change numbered "r0" */
+      first_revs[0] = 0;
+      second_revs[0] = 0;
+      /* Where both merged a revision, only a merge that is
+         non-inheritable on both sides is non-inheritable. */
+      for (j = 0; j < RANDOM_REV_ARRAY_LENGTH; j++)
+        expected_revs[j] = MAX(first_revs[j], second_revs[j]);
+
+      SVN_ERR(inheritance_array_to_rangelist(&first_rangelist, first_revs,
+                                             iterpool));
+      SVN_ERR(inheritance_array_to_rangelist(&second_rangelist, second_revs,
+                                             iterpool));
+      SVN_ERR(inheritance_array_to_rangelist(&expected_rangelist,
+                                             expected_revs, iterpool));
+      SVN_ERR(svn_rangelist_to_string(&expected_str, expected_rangelist,
+                                      iterpool));
+
+      /* svn_rangelist_merge2() */
+      actual_rangelist = svn_rangelist_dup(first_rangelist, iterpool);
+      SVN_ERR(svn_rangelist_merge2(actual_rangelist, second_rangelist,
+                                   iterpool, iterpool));
+      SVN_TEST_ASSERT(svn_rangelist__is_canonical(actual_rangelist));
+      SVN_ERR(svn_rangelist_to_string(&actual_str, actual_rangelist,
+                                      iterpool));
+      SVN_TEST_STRING_ASSERT(actual_str->data, expected_str->data);
+
+      /* svn_rangelist__merge_many() */
+      history = apr_hash_make(iterpool);
+      svn_hash_sets(history, "/trunk", first_rangelist);
+      svn_hash_sets(history, "/branch", second_rangelist);
+      actual_rangelist = apr_array_make(iterpool, 0,
+                                        sizeof(svn_merge_range_t *));
+      SVN_ERR(svn_rangelist__merge_many(actual_rangelist, history,
+                                        iterpool, iterpool));
+      SVN_ERR(svn_rangelist_to_string(&actual_str, actual_rangelist,
+                                      iterpool));
+      SVN_TEST_STRING_ASSERT(actual_str->data, expected_str->data);
+
+      /* svn_rangelist__flat_merge() */
+      SVN_ERR(svn_rangelist__flat_merge(
+                &flat_merged,
+                svn_rangelist__flat_import(first_rangelist, iterpool),
+                svn_rangelist__flat_import(second_rangelist, iterpool),
+                iterpool));
+      SVN_ERR(svn_rangelist_to_string(
+                &actual_str,
+                svn_rangelist__flat_export(flat_merged, iterpool),
+                iterpool));
+      SVN_TEST_STRING_ASSERT(actual_str->data, expected_str->data);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 /* ### Share code with test_diff_mergeinfo() and test_remove_rangelist(). */
 static svn_error_t *
 test_remove_mergeinfo(apr_pool_t *pool)
@@ -1811,6 +1933,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "intersection of rangelists"),
     SVN_TEST_PASS2(test_rangelist_intersect_randomly,
                    "test rangelist intersect with random data"),
+    SVN_TEST_PASS2(test_rangelist_merge_randomly,
+                   "test rangelist merge with random data"),
     SVN_TEST_PASS2(test_diff_mergeinfo,
                    "diff of mergeinfo"),
     SVN_TEST_PASS2(test_merge_mergeinfo,
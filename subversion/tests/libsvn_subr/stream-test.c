@@ -26,7 +26,9 @@
 #include "svn_io.h"
 #include "svn_subst.h"
 #include "svn_base64.h"
+#include "svn_sorts.h"
 #include <apr_general.h>
+#include <apr_time.h>
 
 #include "private/svn_io_private.h"
 
@@ -1000,6 +1002,164 @@ test_stream_readline_file_crlf(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Simple reference implementation of base64 encoding.  Encode LEN bytes
+   from DATA without line breaks and return the result in POOL. */
+static const char *
+reference_base64(const unsigned char *data,
+                 apr_size_t len,
+                 apr_pool_t *pool)
+{
+  static const char tab[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                            "abcdefghijklmnopqrstuvwxyz0123456789+/";
+  char *result = apr_palloc(pool, (len + 2) / 3 * 4 + 1);
+  char *out = result;
+  apr_size_t i;
+
+  for (i = 0; i < len; i += 3)
+    {
+      apr_uint32_t v = (apr_uint32_t)data[i] << 16;
+      if (i + 1 < len)
+        v |= (apr_uint32_t)data[i + 1] << 8;
+      if (i + 2 < len)
+        v |= data[i + 2];
+
+      *out++ = tab[(v >> 18) & 0x3f];
+      *out++ = tab[(v >> 12) & 0x3f];
+      *out++ = i + 1 < len ? tab[(v >> 6) & 0x3f] : '=';
+      *out++ = i + 2 < len ? tab[v & 0x3f] : '=';
+    }
+
+  *out = '\0';
+  return result;
+}
+
+/* Return a copy of STR in POOL, with all line breaks removed. */
+static const char *
+strip_newlines(const char *str,
+               apr_pool_t *pool)
+{
+  char *result = apr_pstrdup(pool, str);
+  char *out = result;
+
+  for (; *str; ++str)
+    if (*str != '\n')
+      *out++ = *str;
+
+  *out = '\0';
+  return result;
+}
+
+/* Exercise the whole-line fast paths of the base64 code with data of
+   various lengths and alignments and compare with a reference. */
+static svn_error_t *
+test_base64_lines(apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_uint32_t seed = 0x5eed;
+  unsigned char buffer[1024 + 16];
+  apr_size_t len, offset, i;
+
+  for (i = 0; i < sizeof(buffer); ++i)
+    buffer[i] = (unsigned char)svn_test_rand(&seed);
+
+  for (len = 0; len <= 1024; len += (len < 256 ? 1 : 57))
+    for (offset = 0; offset < 16; offset += 5)
+      {
+        svn_string_t original;
+        const svn_string_t *encoded, *decoded;
+        const char *expected;
+        svn_stringbuf_t *polluted;
+
+        svn_pool_clear(iterpool);
+        original.data = (const char *)buffer + offset;
+        original.len = len;
+        expected = reference_base64(buffer + offset, len, iterpool);
+
+        /* Encoding with and without line breaks. */
+        encoded = svn_base64_encode_string2(&original, FALSE, iterpool);
+        SVN_TEST_STRING_ASSERT(encoded->data, expected);
+
+        encoded = svn_base64_encode_string2(&original, TRUE, iterpool);
+        SVN_TEST_STRING_ASSERT(strip_newlines(encoded->data, iterpool),
+                               expected);
+
+        /* Round trip. */
+        decoded = svn_base64_decode_string(encoded, iterpool);
+        SVN_TEST_ASSERT(svn_string_compare(decoded, &original));
+
+        /* Non-base64 chars anywhere in the input must be ignored. */
+        polluted = svn_stringbuf_create(expected, iterpool);
+        if (polluted->len)
+          svn_stringbuf_insert(polluted,
+                               svn_test_rand(&seed) % polluted->len,
+                               "*\r", 2);
+
+        decoded = svn_base64_decode_string(
+                    svn_string_create_from_buf(polluted, iterpool),
+                    iterpool);
+        SVN_TEST_ASSERT(svn_string_compare(decoded, &original));
+      }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Measure the base64 encoding and decoding throughput.  Print the
+   results in verbose mode. */
+static svn_error_t *
+test_base64_throughput(const svn_test_opts_t *opts,
+                       apr_pool_t *pool)
+{
+  enum { DATA_SIZE = 4 * 1024 * 1024, REPEAT = 8 };
+
+  apr_uint32_t seed = 0x5eed;
+  char *data = apr_palloc(pool, DATA_SIZE);
+  svn_string_t original;
+  const svn_string_t *encoded = NULL, *decoded = NULL;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_time_t start, encode_time, decode_time;
+  int i;
+
+  for (i = 0; i < DATA_SIZE; ++i)
+    data[i] = (char)svn_test_rand(&seed);
+
+  original.data = data;
+  original.len = DATA_SIZE;
+
+  start = apr_time_now();
+  for (i = 0; i < REPEAT; ++i)
+    {
+      svn_pool_clear(iterpool);
+      encoded = svn_base64_encode_string2(&original, TRUE, iterpool);
+    }
+  encode_time = apr_time_now() - start;
+
+  encoded = svn_string_dup(encoded, pool);
+
+  start = apr_time_now();
+  for (i = 0; i < REPEAT; ++i)
+    {
+      svn_pool_clear(iterpool);
+      decoded = svn_base64_decode_string(encoded, iterpool);
+    }
+  decode_time = apr_time_now() - start;
+
+  SVN_TEST_ASSERT(svn_string_compare(decoded, &original));
+  svn_pool_destroy(iterpool);
+
+  if (opts->verbose)
+    {
+      double mbytes = (double)DATA_SIZE * REPEAT / (1024 * 1024);
+      printf("base64 encode: %.1f MB/s\n",
+             mbytes * APR_USEC_PER_SEC / MAX(encode_time, 1));
+      printf("base64 decode: %.1f MB/s\n",
+             mbytes * APR_USEC_PER_SEC / MAX(decode_time, 1));
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* The test table.  */
 
 static int max_threads = 1;
@@ -1037,6 +1197,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test reading LF-terminated lines from file"),
     SVN_TEST_PASS2(test_stream_readline_file_crlf,
                    "test reading CRLF-terminated lines from file"),
+    SVN_TEST_PASS2(test_base64_lines,
+                   "base64 of various lengths and alignments"),
+    SVN_TEST_OPTS_PASS(test_base64_throughput,
+                       "base64 encoding / decoding throughput"),
     SVN_TEST_NULL
   };
 
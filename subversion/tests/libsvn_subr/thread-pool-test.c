@@ -0,0 +1,178 @@
+/*
+ * thread-pool-test.c:  a collection of svn_thread_pool__* tests
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_pools.h>
+
+#include "svn_error.h"
+#include "svn_pools.h"
+#include "private/svn_thread_pool.h"
+
+#include "../svn_test.h"
+
+/* Number of tasks to run per test. */
+#define TASK_COUNT 100
+
+/* Baton type for sum_task. */
+typedef struct sum_baton_t
+{
+  /* Input: sum up all numbers from 1 to LIMIT. */
+  int limit;
+
+  /* Result allocated in the task's pool. */
+  apr_int64_t *sum;
+} sum_baton_t;
+
+/* Implements svn_thread_pool__func_t. */
+static svn_error_t *
+sum_task(void *baton,
+         apr_pool_t *result_pool)
+{
+  sum_baton_t *b = baton;
+  int i;
+
+  b->sum = apr_pcalloc(result_pool, sizeof(*b->sum));
+  for (i = 1; i <= b->limit; ++i)
+    *b->sum += i;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_thread_pool__func_t.  Fail if BATON points to an odd
+ * number. */
+static svn_error_t *
+fail_odd_task(void *baton,
+              apr_pool_t *result_pool)
+{
+  int *value = baton;
+  if (*value & 1)
+    return svn_error_createf(SVN_ERR_TEST_FAILED, NULL, "odd %d", *value);
+
+  return SVN_NO_ERROR;
+}
+
+/* Run TASK_COUNT tasks with handles in a group of CONCURRENCY and verify
+ * their results.  Use POOL for allocations. */
+static svn_error_t *
+run_sum_tasks(int concurrency,
+              apr_pool_t *pool)
+{
+  svn_thread_pool__group_t *group;
+  svn_thread_pool__task_t *tasks[TASK_COUNT];
+  sum_baton_t batons[TASK_COUNT];
+  int i;
+
+  SVN_ERR(svn_thread_pool__group_create(&group, concurrency, pool));
+
+  for (i = 0; i < TASK_COUNT; ++i)
+    {
+      batons[i].limit = i * 1000;
+      batons[i].sum = NULL;
+      SVN_ERR(svn_thread_pool__run(&tasks[i], group, sum_task, &batons[i]));
+    }
+
+  /* Collect the results in submission order. */
+  for (i = 0; i < TASK_COUNT; ++i)
+    {
+      apr_int64_t limit = batons[i].limit;
+      svn_boolean_t done;
+
+      SVN_ERR(svn_thread_pool__task_wait(tasks[i]));
+      SVN_ERR(svn_thread_pool__task_done(&done, tasks[i]));
+      SVN_TEST_ASSERT(done);
+      SVN_TEST_ASSERT(*batons[i].sum == limit * (limit + 1) / 2);
+
+      svn_thread_pool__task_destroy(tasks[i]);
+    }
+
+  SVN_ERR(svn_thread_pool__group_wait(group));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_sequential_tasks(apr_pool_t *pool)
+{
+  svn_thread_pool__group_t *group;
+
+  SVN_ERR(svn_thread_pool__group_create(&group, 1, pool));
+  SVN_TEST_ASSERT(!svn_thread_pool__group_is_parallel(group));
+
+  return svn_error_trace(run_sum_tasks(1, pool));
+}
+
+static svn_error_t *
+test_parallel_tasks(apr_pool_t *pool)
+{
+  return svn_error_trace(run_sum_tasks(8, pool));
+}
+
+static svn_error_t *
+test_group_errors(apr_pool_t *pool)
+{
+  svn_thread_pool__group_t *group;
+  int values[TASK_COUNT];
+  svn_error_t *err, *child;
+  int i, count;
+
+  SVN_ERR(svn_thread_pool__group_create(&group, 4, pool));
+
+  for (i = 0; i < TASK_COUNT; ++i)
+    {
+      values[i] = i;
+      SVN_ERR(svn_thread_pool__run(NULL, group, fail_odd_task, &values[i]));
+    }
+
+  /* All failures must be reported, each exactly once. */
+  err = svn_thread_pool__group_wait(group);
+  SVN_TEST_ASSERT(err);
+
+  err = svn_error_purge_tracing(err);
+  for (count = 0, child = err; child; child = child->child)
+    if (child->apr_err == SVN_ERR_TEST_FAILED)
+      ++count;
+
+  svn_error_clear(err);
+  SVN_TEST_ASSERT(count == TASK_COUNT / 2);
+  SVN_ERR(svn_thread_pool__group_wait(group));
+
+  return SVN_NO_ERROR;
+}
+
+
+/* The test table.  */
+
+static int max_threads = 1;
+
+static struct svn_test_descriptor_t test_funcs[] =
+  {
+    SVN_TEST_NULL,
+    SVN_TEST_PASS2(test_sequential_tasks,
+                   "tasks in a group of concurrency 1"),
+    SVN_TEST_PASS2(test_parallel_tasks,
+                   "tasks executed on worker threads"),
+    SVN_TEST_PASS2(test_group_errors,
+                   "errors of tasks without handle"),
+    SVN_TEST_NULL
+  };
+
+SVN_TEST_MAIN
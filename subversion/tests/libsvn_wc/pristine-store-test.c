@@ -39,6 +39,7 @@
 #include "svn_repos.h"
 #include "svn_wc.h"
 #include "svn_client.h"
+#include "svn_config.h"
 
 #include "utils.h"
 
@@ -307,6 +308,230 @@ reject_mismatching_text(const svn_test_opts_t *opts,
 }
 
 
+/* Install a pristine text through one working copy with a shared pristine
+ * store configured, and check that another working copy finds it there and
+ * that the shared text goes away with the last working copy using it. */
+static svn_error_t *
+shared_pristine_store(const svn_test_opts_t *opts,
+                      apr_pool_t *pool)
+{
+  svn_wc__db_t *db;
+  const char *wc1_abspath, *wc2_abspath;
+  const char *shared_abspath;
+  const char *shared_text_abspath;
+  const char *pristine1_abspath, *pristine2_abspath;
+  svn_config_t *config;
+  svn_wc_context_t *wc_ctx;
+  svn_wc__db_install_data_t *install_data;
+  svn_stream_t *pristine_stream;
+  svn_checksum_t *data_sha1, *data_md5;
+  svn_boolean_t present;
+  svn_node_kind_t kind;
+  apr_size_t sz;
+  const char data[] = "Shared";
+
+  SVN_ERR(create_repos_and_wc(&wc1_abspath, &db,
+                              "shared_pristine_store_1", opts, pool));
+  SVN_ERR(create_repos_and_wc(&wc2_abspath, &db,
+                              "shared_pristine_store_2", opts, pool));
+
+  shared_abspath = svn_test_data_path("shared_pristine_store", pool);
+  SVN_ERR(svn_io_remove_dir2(shared_abspath, TRUE, NULL, NULL, pool));
+  SVN_ERR(svn_io_make_dir_recursively(shared_abspath, pool));
+  svn_test_add_dir_cleanup(shared_abspath);
+
+  SVN_ERR(svn_config_create2(&config, FALSE, FALSE, pool));
+  svn_config_set(config, SVN_CONFIG_SECTION_WORKING_COPY,
+                 SVN_CONFIG_OPTION_WC_SHARED_PRISTINE_STORE, shared_abspath);
+  SVN_ERR(svn_wc_context_create(&wc_ctx, config, pool, pool));
+  db = wc_ctx->db;
+
+  /* Install DATA into the first working copy. */
+  SVN_ERR(svn_wc__db_pristine_prepare_install(&pristine_stream,
+                                              &install_data,
+                                              &data_sha1, &data_md5,
+                                              db, wc1_abspath,
+                                              pool, pool));
+  sz = strlen(data);
+  SVN_ERR(svn_stream_write(pristine_stream, data, &sz));
+  SVN_ERR(svn_stream_close(pristine_stream));
+  SVN_ERR(svn_wc__db_pristine_install(install_data,
+                                      data_sha1, data_md5, pool));
+
+  shared_text_abspath = svn_dirent_join_many(
+                          pool, shared_abspath,
+                          apr_pstrndup(pool,
+                                       svn_checksum_to_cstring(data_sha1,
+                                                               pool),
+                                       2),
+                          apr_pstrcat(pool,
+                                      svn_checksum_to_cstring(data_sha1,
+                                                              pool),
+                                      ".svn-base", SVN_VA_NULL),
+                          SVN_VA_NULL);
+  SVN_ERR(svn_io_check_path(shared_text_abspath, &kind, pool));
+  SVN_TEST_ASSERT(kind == svn_node_file);
+
+  /* The second working copy gets it from the shared store. */
+  SVN_ERR(svn_wc__db_pristine_check(&present, db, wc2_abspath, data_sha1,
+                                    pool));
+  SVN_TEST_ASSERT(present);
+
+  {
+    const svn_checksum_t *looked_up_md5;
+    svn_stream_t *data_read_back;
+    svn_boolean_t same;
+
+    SVN_ERR(svn_wc__db_pristine_get_md5(&looked_up_md5, db, wc2_abspath,
+                                        data_sha1, pool, pool));
+    SVN_TEST_ASSERT(svn_checksum_match(data_md5, looked_up_md5));
+
+    SVN_ERR(svn_wc__db_pristine_read(&data_read_back, NULL, db, wc2_abspath,
+                                     data_sha1, pool, pool));
+    SVN_ERR(svn_stream_contents_same2(&same, data_read_back,
+                                      svn_stream_from_string(
+                                        svn_string_create(data, pool), pool),
+                                      pool));
+    SVN_TEST_ASSERT(same);
+  }
+
+  SVN_ERR(svn_wc__db_pristine_get_path(&pristine1_abspath, db, wc1_abspath,
+                                       data_sha1, pool, pool));
+  SVN_ERR(svn_wc__db_pristine_get_path(&pristine2_abspath, db, wc2_abspath,
+                                       data_sha1, pool, pool));
+#ifndef WIN32
+  {
+    apr_finfo_t finfo;
+
+    /* Both working copies and the shared store use the same file. */
+    SVN_ERR(svn_io_stat(&finfo, shared_text_abspath, APR_FINFO_NLINK, pool));
+    SVN_TEST_ASSERT(finfo.nlink == 3);
+  }
+#endif
+
+  /* The shared text stays as long as any working copy uses it. */
+  SVN_ERR(svn_wc__db_pristine_remove(db, wc1_abspath, data_sha1, pool));
+  SVN_ERR(svn_io_check_path(pristine1_abspath, &kind, pool));
+  SVN_TEST_ASSERT(kind == svn_node_none);
+  SVN_ERR(svn_io_check_path(shared_text_abspath, &kind, pool));
+  SVN_TEST_ASSERT(kind == svn_node_file);
+
+  SVN_ERR(svn_wc__db_pristine_remove(db, wc2_abspath, data_sha1, pool));
+  SVN_ERR(svn_io_check_path(pristine2_abspath, &kind, pool));
+  SVN_TEST_ASSERT(kind == svn_node_none);
+  SVN_ERR(svn_io_check_path(shared_text_abspath, &kind, pool));
+  SVN_TEST_ASSERT(kind == svn_node_none);
+
+  return SVN_NO_ERROR;
+}
+
+
+/* Plant a text in the shared pristine store under the checksums of another
+ * text and check that working copies don't pick it up. */
+static svn_error_t *
+shared_pristine_store_untrusted(const svn_test_opts_t *opts,
+                                apr_pool_t *pool)
+{
+  svn_wc__db_t *db;
+  const char *wc_abspath;
+  const char *shared_abspath;
+  const char *shared_text_abspath;
+  const char *pristine_abspath;
+  svn_config_t *config;
+  svn_wc_context_t *wc_ctx;
+  svn_wc__db_install_data_t *install_data;
+  svn_stream_t *pristine_stream;
+  svn_stream_t *data_read_back;
+  svn_checksum_t *data_sha1, *data_md5;
+  svn_boolean_t present;
+  svn_boolean_t same;
+  svn_node_kind_t kind;
+  apr_size_t sz;
+  const char data[] = "Genuine";
+  const char forged[] = "Forged!";
+
+  SVN_ERR(create_repos_and_wc(&wc_abspath, &db,
+                              "shared_pristine_store_untrusted", opts, pool));
+
+  shared_abspath = svn_test_data_path("shared_pristine_store_untrusted", pool);
+  SVN_ERR(svn_io_remove_dir2(shared_abspath, TRUE, NULL, NULL, pool));
+  svn_test_add_dir_cleanup(shared_abspath);
+
+  SVN_ERR(svn_config_create2(&config, FALSE, FALSE, pool));
+  svn_config_set(config, SVN_CONFIG_SECTION_WORKING_COPY,
+                 SVN_CONFIG_OPTION_WC_SHARED_PRISTINE_STORE, shared_abspath);
+  SVN_ERR(svn_wc_context_create(&wc_ctx, config, pool, pool));
+  db = wc_ctx->db;
+
+  SVN_ERR(svn_checksum(&data_sha1, svn_checksum_sha1, data, strlen(data),
+                       pool));
+  SVN_ERR(svn_checksum(&data_md5, svn_checksum_md5, data, strlen(data),
+                       pool));
+
+  /* Put FORGED where DATA belongs, with DATA's MD-5 next to it. */
+  shared_text_abspath = svn_dirent_join_many(
+                          pool, shared_abspath,
+                          apr_pstrndup(pool,
+                                       svn_checksum_to_cstring(data_sha1,
+                                                               pool),
+                                       2),
+                          apr_pstrcat(pool,
+                                      svn_checksum_to_cstring(data_sha1,
+                                                              pool),
+                                      ".svn-base", SVN_VA_NULL),
+                          SVN_VA_NULL);
+  SVN_ERR(svn_io_make_dir_recursively(svn_dirent_dirname(shared_text_abspath,
+                                                         pool),
+                                      pool));
+  SVN_ERR(svn_io_file_create(shared_text_abspath, forged, pool));
+  SVN_ERR(svn_io_file_create(apr_pstrcat(pool, shared_text_abspath, ".md5",
+                                         SVN_VA_NULL),
+                             svn_checksum_to_cstring(data_md5, pool),
+                             pool));
+
+  /* Looking for DATA must not adopt the forged text ... */
+  SVN_ERR(svn_wc__db_pristine_check(&present, db, wc_abspath, data_sha1,
+                                    pool));
+  SVN_TEST_ASSERT(!present);
+
+  SVN_ERR(svn_wc__db_pristine_get_future_path(&pristine_abspath, wc_abspath,
+                                              data_sha1, pool, pool));
+  SVN_ERR(svn_io_check_path(pristine_abspath, &kind, pool));
+  SVN_TEST_ASSERT(kind == svn_node_none);
+
+  /* ... and installing DATA must not link to it either. */
+  SVN_ERR(svn_wc__db_pristine_prepare_install(&pristine_stream,
+                                              &install_data,
+                                              NULL, NULL,
+                                              db, wc_abspath,
+                                              pool, pool));
+  sz = strlen(data);
+  SVN_ERR(svn_stream_write(pristine_stream, data, &sz));
+  SVN_ERR(svn_stream_close(pristine_stream));
+  SVN_ERR(svn_wc__db_pristine_install(install_data,
+                                      data_sha1, data_md5, pool));
+
+  SVN_ERR(svn_wc__db_pristine_read(&data_read_back, NULL, db, wc_abspath,
+                                   data_sha1, pool, pool));
+  SVN_ERR(svn_stream_contents_same2(&same, data_read_back,
+                                    svn_stream_from_string(
+                                      svn_string_create(data, pool), pool),
+                                    pool));
+  SVN_TEST_ASSERT(same);
+
+  /* A PRISTINE row whose file went missing must not be reported as present
+     just because the shared store has a text under that name. */
+  SVN_ERR(svn_io_remove_file2(pristine_abspath, FALSE, pool));
+  SVN_ERR(svn_wc__db_pristine_check(&present, db, wc_abspath, data_sha1,
+                                    pool));
+  SVN_TEST_ASSERT(!present);
+  SVN_ERR(svn_io_check_path(pristine_abspath, &kind, pool));
+  SVN_TEST_ASSERT(kind == svn_node_none);
+
+  return SVN_NO_ERROR;
+}
+
+
 static int max_threads = -1;
 
 static struct svn_test_descriptor_t test_funcs[] =
@@ -318,6 +543,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "pristine_delete_while_open"),
     SVN_TEST_OPTS_PASS(reject_mismatching_text,
                        "reject_mismatching_text"),
+    SVN_TEST_OPTS_PASS(shared_pristine_store,
+                       "shared pristine store across working copies"),
+    SVN_TEST_OPTS_PASS(shared_pristine_store_untrusted,
+                       "ignore mismatching texts in shared store"),
     SVN_TEST_NULL
   };
 
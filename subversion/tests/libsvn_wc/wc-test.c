@@ -21,6 +21,8 @@
  * ====================================================================
  */
 
+#include <string.h>
+
 #include <apr_pools.h>
 #include <apr_general.h>
 #include <apr_md5.h>
@@ -31,10 +33,12 @@
 #include "svn_io.h"
 #include "svn_dirent_uri.h"
 #include "svn_pools.h"
+#include "svn_props.h"
 #include "svn_repos.h"
 #include "svn_wc.h"
 #include "svn_client.h"
 #include "svn_hash.h"
+#include "svn_config.h"
 
 #include "utils.h"
 
@@ -493,6 +497,310 @@ test_internal_file_modified(const svn_test_opts_t *opts, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_wc_status_func4_t.  Append a line describing STATUS of
+ * LOCAL_ABSPATH to the svn_stringbuf_t BATON. */
+static svn_error_t *
+describe_status(void *baton,
+                const char *local_abspath,
+                const svn_wc_status3_t *status,
+                apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *description = baton;
+
+  svn_stringbuf_appendcstr(description,
+                           apr_psprintf(scratch_pool, "%s %d %d %d\n",
+                                        local_abspath, status->node_status,
+                                        status->text_status,
+                                        status->prop_status));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_parallel_walk_status(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  svn_test__sandbox_t b;
+  svn_wc_context_t *parallel_ctx;
+  svn_config_t *config;
+  svn_stringbuf_t *expected = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *actual = svn_stringbuf_create_empty(pool);
+
+  SVN_ERR(svn_test__sandbox_create(&b, "parallel_walk_status", opts, pool));
+  SVN_ERR(sbox_add_and_commit_greek_tree(&b));
+
+  /* Modified, missing, deleted and unversioned nodes at various depths. */
+  SVN_ERR(sbox_file_write(&b, "A/mu", "modified mu"));
+  SVN_ERR(sbox_file_write(&b, "A/B/E/unversioned", "new"));
+  SVN_ERR(sbox_disk_mkdir(&b, "A/C/unversioned-dir"));
+  SVN_ERR(svn_io_remove_dir2(sbox_wc_path(&b, "A/D/H"), FALSE,
+                             NULL, NULL, pool));
+  SVN_ERR(sbox_wc_delete(&b, "A/D/G"));
+
+  SVN_ERR(svn_wc_walk_status(b.wc_ctx, b.wc_abspath, svn_depth_infinity,
+                             TRUE, FALSE, FALSE, NULL,
+                             describe_status, expected,
+                             NULL, NULL, pool));
+
+  /* The same walk with a context that reads directories in parallel must
+   * report the same statuses in the same order. */
+  SVN_ERR(svn_config_create2(&config, FALSE, FALSE, pool));
+  svn_config_set(config, SVN_CONFIG_SECTION_WORKING_COPY,
+                 SVN_CONFIG_OPTION_WC_WORKER_THREADS, "4");
+  SVN_ERR(svn_wc_context_create(&parallel_ctx, config, pool, pool));
+  SVN_TEST_ASSERT(svn_wc__db_get_worker_threads(parallel_ctx->db) == 4);
+
+  SVN_ERR(svn_wc_walk_status(parallel_ctx, b.wc_abspath, svn_depth_infinity,
+                             TRUE, FALSE, FALSE, NULL,
+                             describe_status, actual,
+                             NULL, NULL, pool));
+  SVN_ERR(svn_wc_context_destroy(parallel_ctx));
+
+  SVN_TEST_STRING_ASSERT(actual->data, expected->data);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_parallel_text_compare(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  svn_test__sandbox_t b;
+  svn_wc_context_t *parallel_ctx;
+  svn_config_t *config;
+  svn_stringbuf_t *expected = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *actual = svn_stringbuf_create_empty(pool);
+  apr_time_t touched = apr_time_now() + apr_time_from_sec(10);
+  int i;
+  struct {
+    const char *path;
+    const char *text;
+  } files[] = {
+    { "iota",          "This is the file 'iota'.\n" },  /* unchanged */
+    { "A/mu",          "This is the file 'MU'.\n" },    /* same size */
+    { "A/B/lambda",    "This is the file 'lambda'.\n\n" },
+    { "A/D/gamma",     "This is the file 'gamma'.\n" }, /* svn:keywords */
+    { "A/D/G/pi",      "This is the file 'PI'.\n" },
+    { "A/D/H/omega",   "This is the file 'omega'.\n" },
+  };
+
+  SVN_ERR(svn_test__sandbox_create(&b, "parallel_text_compare", opts, pool));
+  SVN_ERR(sbox_add_and_commit_greek_tree(&b));
+  SVN_ERR(sbox_wc_propset(&b, "svn:keywords", "Id", "A/D/gamma"));
+  SVN_ERR(sbox_wc_commit(&b, ""));
+
+  /* Force a full text comparison for all of these files. */
+  for (i = 0; i < (int)(sizeof(files) / sizeof(files[0])); i++)
+    {
+      SVN_ERR(sbox_file_write(&b, files[i].path, files[i].text));
+      SVN_ERR(svn_io_set_file_affected_time(touched,
+                                            sbox_wc_path(&b, files[i].path),
+                                            pool));
+    }
+
+  SVN_ERR(svn_wc_walk_status(b.wc_ctx, b.wc_abspath, svn_depth_infinity,
+                             TRUE, FALSE, FALSE, NULL,
+                             describe_status, expected,
+                             NULL, NULL, pool));
+
+  /* Comparing the files on worker threads must yield the same result. */
+  SVN_ERR(svn_config_create2(&config, FALSE, FALSE, pool));
+  svn_config_set(config, SVN_CONFIG_SECTION_WORKING_COPY,
+                 SVN_CONFIG_OPTION_WC_WORKER_THREADS, "4");
+  SVN_ERR(svn_wc_context_create(&parallel_ctx, config, pool, pool));
+
+  SVN_ERR(svn_wc_walk_status(parallel_ctx, b.wc_abspath, svn_depth_infinity,
+                             TRUE, FALSE, FALSE, NULL,
+                             describe_status, actual,
+                             NULL, NULL, pool));
+  SVN_ERR(svn_wc_context_destroy(parallel_ctx));
+
+  SVN_TEST_STRING_ASSERT(actual->data, expected->data);
+
+  /* Also check the files, not just the walk. */
+  SVN_TEST_ASSERT(strstr(expected->data,
+                         apr_psprintf(pool, "%s %d %d",
+                                      sbox_wc_path(&b, "A/mu"),
+                                      svn_wc_status_modified,
+                                      svn_wc_status_modified)));
+  SVN_TEST_ASSERT(strstr(expected->data,
+                         apr_psprintf(pool, "%s %d %d",
+                                      sbox_wc_path(&b, "A/D/gamma"),
+                                      svn_wc_status_normal,
+                                      svn_wc_status_normal)));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_parallel_file_install(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  svn_test__sandbox_t b;
+  svn_wc_context_t *serial_ctx;
+  svn_config_t *config;
+  svn_stringbuf_t *expected = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *actual = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *contents;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  SVN_ERR(svn_test__sandbox_create(&b, "parallel_file_install", opts, pool));
+  SVN_ERR(sbox_add_and_commit_greek_tree(&b));
+
+  /* Enough files to keep the workers busy, some of which need to be
+     translated or made executable when installed. */
+  for (i = 0; i < 40; i++)
+    {
+      const char *path;
+
+      svn_pool_clear(iterpool);
+      path = apr_psprintf(iterpool, "A/file%d", i);
+      SVN_ERR(sbox_file_write(&b, path,
+                              apr_psprintf(iterpool, "line 1 of %d\n"
+                                                     "$Id$\n", i)));
+      SVN_ERR(sbox_wc_add(&b, path));
+      if (i % 3 == 0)
+        SVN_ERR(sbox_wc_propset(&b, SVN_PROP_EOL_STYLE, "CRLF", path));
+      if (i % 3 == 1)
+        SVN_ERR(sbox_wc_propset(&b, SVN_PROP_KEYWORDS, "Id", path));
+      if (i % 5 == 0)
+        SVN_ERR(sbox_wc_propset(&b, SVN_PROP_EXECUTABLE, "*", path));
+    }
+  svn_pool_destroy(iterpool);
+  SVN_ERR(sbox_wc_commit(&b, ""));
+  SVN_ERR(sbox_wc_update(&b, "", 2));
+
+  SVN_ERR(svn_wc_walk_status(b.wc_ctx, b.wc_abspath, svn_depth_infinity,
+                             TRUE, FALSE, FALSE, NULL,
+                             describe_status, expected,
+                             NULL, NULL, pool));
+
+  /* Install all files using a context with worker threads. */
+  serial_ctx = b.wc_ctx;
+  SVN_ERR(svn_config_create2(&config, FALSE, FALSE, pool));
+  svn_config_set(config, SVN_CONFIG_SECTION_WORKING_COPY,
+                 SVN_CONFIG_OPTION_WC_WORKER_THREADS, "4");
+  SVN_ERR(svn_wc_context_create(&b.wc_ctx, config, pool, pool));
+
+  /* Fetch the new files again with an update ... */
+  SVN_ERR(sbox_wc_update(&b, "", 1));
+  SVN_ERR(sbox_wc_update(&b, "", 2));
+
+  /* ... and restore modified ones with a revert. */
+  SVN_ERR(sbox_file_write(&b, "iota", "modified iota\n"));
+  SVN_ERR(sbox_file_write(&b, "A/file3", "modified file3\n"));
+  SVN_ERR(sbox_file_write(&b, "A/file4", "modified file4\n"));
+  SVN_ERR(svn_io_remove_file2(sbox_wc_path(&b, "A/file10"), FALSE, pool));
+  SVN_ERR(sbox_wc_revert(&b, "", svn_depth_infinity));
+
+  SVN_ERR(svn_wc_context_destroy(b.wc_ctx));
+  b.wc_ctx = serial_ctx;
+
+  SVN_ERR(svn_wc_walk_status(b.wc_ctx, b.wc_abspath, svn_depth_infinity,
+                             TRUE, FALSE, FALSE, NULL,
+                             describe_status, actual,
+                             NULL, NULL, pool));
+  SVN_TEST_STRING_ASSERT(actual->data, expected->data);
+
+  /* The installed files were translated. */
+  SVN_ERR(svn_stringbuf_from_file2(&contents, sbox_wc_path(&b, "A/file3"),
+                                   pool));
+  SVN_TEST_STRING_ASSERT(contents->data, "line 1 of 3\r\n$Id$\r\n");
+  SVN_ERR(svn_stringbuf_from_file2(&contents, sbox_wc_path(&b, "A/file4"),
+                                   pool));
+  SVN_TEST_ASSERT(strncmp(contents->data, "line 1 of 4\n$Id: file4 2 ",
+                          strlen("line 1 of 4\n$Id: file4 2 ")) == 0);
+  SVN_ERR(svn_stringbuf_from_file2(&contents, sbox_wc_path(&b, "iota"),
+                                   pool));
+  SVN_TEST_STRING_ASSERT(contents->data, "This is the file 'iota'.\n");
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_session_revalidation(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  svn_test__sandbox_t b;
+  svn_test__sandbox_t b2;
+  svn_wc_session_t *session;
+  svn_wc_context_t *ctx;
+  svn_wc_status3_t *status;
+  const char *moved_abspath;
+
+  SVN_ERR(svn_test__sandbox_create(&b, "session_revalidation", opts, pool));
+  SVN_ERR(sbox_add_and_commit_greek_tree(&b));
+
+  /* Another working copy that differs in the status of iota. */
+  SVN_ERR(svn_test__sandbox_create(&b2, "session_revalidation_2", opts,
+                                   pool));
+  SVN_ERR(sbox_add_and_commit_greek_tree(&b2));
+  SVN_ERR(sbox_wc_delete(&b2, "iota"));
+
+  SVN_ERR(svn_wc_session_create(&session, NULL, pool, pool));
+
+  /* Two contexts in a row share the session's database. */
+  SVN_ERR(svn_wc_session_context_create(&ctx, session, pool));
+  SVN_ERR(svn_wc_status3(&status, ctx, sbox_wc_path(&b, "iota"),
+                         pool, pool));
+  SVN_TEST_ASSERT(status->versioned
+                  && status->node_status == svn_wc_status_normal);
+  SVN_ERR(svn_wc_context_destroy(ctx));
+
+  /* Let the session map an unversioned directory to the working copy
+     containing it. */
+  SVN_ERR(sbox_disk_mkdir(&b, "A/nested"));
+  SVN_ERR(svn_wc_session_context_create(&ctx, session, pool));
+  SVN_ERR(svn_wc_status3(&status, ctx, sbox_wc_path(&b, "A/mu"),
+                         pool, pool));
+  SVN_TEST_ASSERT(status->versioned
+                  && status->node_status == svn_wc_status_normal);
+  SVN_ERR(svn_wc_status3(&status, ctx, sbox_wc_path(&b, "A/nested"),
+                         pool, pool));
+  SVN_TEST_ASSERT(!status->versioned
+                  && status->node_status == svn_wc_status_unversioned);
+  SVN_ERR(svn_wc_context_destroy(ctx));
+
+  /* Make that directory a working copy of its own.  The session must find
+     it rather than keep using the outer one. */
+  SVN_ERR(svn_io_remove_dir2(sbox_wc_path(&b, "A/nested"), FALSE,
+                             NULL, NULL, pool));
+  SVN_ERR(svn_io_file_rename2(b2.wc_abspath, sbox_wc_path(&b, "A/nested"),
+                              FALSE, pool));
+
+  SVN_ERR(svn_wc_session_context_create(&ctx, session, pool));
+  SVN_ERR(svn_wc_status3(&status, ctx, sbox_wc_path(&b, "A/nested/iota"),
+                         pool, pool));
+  SVN_TEST_ASSERT(status->versioned
+                  && status->node_status == svn_wc_status_deleted);
+  SVN_ERR(svn_wc_context_destroy(ctx));
+
+  /* Replace the working copy behind the session's back.  The session
+     must not keep answering from the database it has open. */
+  SVN_ERR(svn_io_file_rename2(sbox_wc_path(&b, "A/nested"), b2.wc_abspath,
+                              FALSE, pool));
+  moved_abspath = apr_pstrcat(pool, b.wc_abspath, ".moved", SVN_VA_NULL);
+  SVN_ERR(svn_io_file_rename2(b.wc_abspath, moved_abspath, FALSE, pool));
+  SVN_ERR(svn_io_file_rename2(b2.wc_abspath, b.wc_abspath, FALSE, pool));
+
+  SVN_ERR(svn_wc_session_context_create(&ctx, session, pool));
+  SVN_ERR(svn_wc_status3(&status, ctx, sbox_wc_path(&b, "iota"),
+                         pool, pool));
+  SVN_TEST_ASSERT(status->versioned
+                  && status->node_status == svn_wc_status_deleted);
+  SVN_ERR(svn_wc_context_destroy(ctx));
+
+  /* And bring the original back. */
+  SVN_ERR(svn_io_file_rename2(b.wc_abspath, b2.wc_abspath, FALSE, pool));
+  SVN_ERR(svn_io_file_rename2(moved_abspath, b.wc_abspath, FALSE, pool));
+
+  SVN_ERR(svn_wc_session_context_create(&ctx, session, pool));
+  SVN_ERR(svn_wc_status3(&status, ctx, sbox_wc_path(&b, "iota"),
+                         pool, pool));
+  SVN_TEST_ASSERT(status->versioned
+                  && status->node_status == svn_wc_status_normal);
+  SVN_ERR(svn_wc_context_destroy(ctx));
+
+  return SVN_NO_ERROR;
+}
+
 /* ---------------------------------------------------------------------- */
 /* The list of test functions */
 
@@ -515,6 +823,14 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test legacy commit2"),
     SVN_TEST_OPTS_PASS(test_internal_file_modified,
                        "test internal_file_modified"),
+    SVN_TEST_OPTS_PASS(test_parallel_walk_status,
+                       "walk status with parallel directory reads"),
+    SVN_TEST_OPTS_PASS(test_parallel_text_compare,
+                       "walk status with parallel text comparisons"),
+    SVN_TEST_OPTS_PASS(test_parallel_file_install,
+                       "install files on worker threads"),
+    SVN_TEST_OPTS_PASS(test_session_revalidation,
+                       "wc session notices replaced working copies"),
     SVN_TEST_NULL
   };
 
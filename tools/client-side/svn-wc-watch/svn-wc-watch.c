@@ -0,0 +1,105 @@
+/* svn-wc-watch.c -- keep a change journal for a working copy
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+/* Watch a working copy for changes on disk until interrupted.  While it
+ * runs, 'svn status', 'svn commit' and everything else that walks the
+ * working copy status will only read the directories that actually
+ * changed:
+ *
+ *   svn-wc-watch WCROOT &
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "svn_cmdline.h"
+#include "svn_dirent_uri.h"
+#include "svn_pools.h"
+#include "svn_utf.h"
+#include "svn_wc.h"
+
+#include "private/svn_wc_private.h"
+#include "private/svn_cmdline_private.h"
+
+#include "svn_private_config.h"
+
+/* Watch the working copy at PATH until CANCEL_FUNC returns an error.
+ * Use POOL for all allocations. */
+static svn_error_t *
+watch(const char *path,
+      svn_cancel_func_t cancel_func,
+      apr_pool_t *pool)
+{
+  svn_wc_context_t *wc_ctx;
+  const char *local_abspath;
+  svn_error_t *err;
+
+  SVN_ERR(svn_utf_cstring_to_utf8(&path, path, pool));
+  SVN_ERR(svn_dirent_get_absolute(&local_abspath,
+                                  svn_dirent_internal_style(path, pool),
+                                  pool));
+  SVN_ERR(svn_wc_context_create(&wc_ctx, NULL, pool, pool));
+
+  err = svn_wc__watch_changes(wc_ctx, local_abspath,
+                              cancel_func, NULL, pool);
+
+  /* Being interrupted is how we are supposed to stop. */
+  if (err && err->apr_err == SVN_ERR_CANCELLED)
+    {
+      svn_error_clear(err);
+      err = SVN_NO_ERROR;
+    }
+
+  return svn_error_compose_create(err, svn_wc_context_destroy(wc_ctx));
+}
+
+int
+main(int argc, const char *argv[])
+{
+  apr_pool_t *pool;
+  svn_cancel_func_t cancel_func;
+  svn_error_t *err;
+
+  if (svn_cmdline_init("svn-wc-watch", stderr) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  if (argc != 2)
+    {
+      printf("Usage: svn-wc-watch WCROOT\n\n"
+             "Record the directories of the working copy at WCROOT that\n"
+             "change on disk until interrupted, so that status walks can\n"
+             "skip all other directories.\n");
+      return EXIT_FAILURE;
+    }
+
+  cancel_func = svn_cmdline__setup_cancellation_handler();
+
+  pool = svn_pool_create(NULL);
+
+  err = watch(argv[1], cancel_func, pool);
+  if (err)
+    return svn_cmdline_handle_exit_error(err, pool, "svn-wc-watch: ");
+
+  svn_pool_destroy(pool);
+
+  return EXIT_SUCCESS;
+}
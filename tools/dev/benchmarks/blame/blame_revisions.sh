@@ -0,0 +1,134 @@
+#!/bin/sh
+
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# Blames a file with REVISIONS revisions, each of which changes one
+# line of a LINES line file, and appends a line every so often.  Times
+# a full blame, a blame that fills the blame cache, and a blame of one
+# more revision which can start from the cached blame.
+#
+# Creating the history takes one commit per revision, so expect the
+# set-up to take several minutes for the default of 10000 revisions.
+#
+# usage: run this script from the root of your working copy
+#        and / or adjust the path settings below as needed
+
+# set SVNPATH to the 'subversion' folder of your SVN source code w/c
+
+SVNPATH="$('pwd')/subversion"
+
+# if using the installed svn, you may need to adapt the following.
+# Uncomment the VALGRIND line to use that tool instead of "time".
+
+SVN=${SVNPATH}/svn/svn
+SVNADMIN=${SVNPATH}/svnadmin/svnadmin
+SVNMUCC=${SVNPATH}/svnmucc/svnmucc
+# VALGRIND="valgrind --tool=callgrind"
+
+# set your data paths here
+
+FILE=/dev/shm/blamed.txt
+CACHE=/dev/shm/blame-cache
+REPOROOT=/dev/shm
+
+# history shape
+
+REVISIONS=10000
+LINES=2000
+
+# use a remote URL here to include network latency
+
+REPONAME=blame
+URL=file://${REPOROOT}/$REPONAME
+
+# from here on, we should be good
+
+TIMEFORMAT='%3R  %3U  %3S'
+
+# construct valgrind parameters
+
+if [ "${VALGRIND}" != "" ] ; then
+  VG_TOOL=$( echo ${VALGRIND} | sed 's/.*\ --tool=\([a-z]*\).*/\1/' )
+  VG_OUTFILE="--${VG_TOOL}-out-file"
+fi
+
+# print header
+
+printf "using "
+${SVN} --version | grep " version"
+echo
+
+# helpers
+
+get_sequence() {
+  # three equivalents...
+  (jot - "$1" "$2" "1" 2>/dev/null || seq -s ' ' "$1" "$2" 2>/dev/null || python -c "for i in range($1,$2+1): print(i)")
+}
+
+# commit a version of FILE that changes line $1 in revision $2
+commit_change() {
+  awk -v n="$1" -v r="$2" 'NR == n { $0 = "line " n " changed in r" r } 1' \
+    $FILE > $FILE.new
+  if [ `expr $2 % 10` -eq 0 ]; then
+    echo "line added in r$2" >> $FILE.new
+  fi
+  mv $FILE.new $FILE
+  ${SVNMUCC} -q -m "" -U $URL put $FILE blamed.txt > /dev/null
+}
+
+run_blame() {
+  if [ "${VALGRIND}" = "" ] ; then
+    time ${SVN} blame $2 $URL/blamed.txt > /dev/null
+  else
+    ${VALGRIND} ${VG_OUTFILE}="${VG_TOOL}.out.blame.$1" ${SVN} blame $2 $URL/blamed.txt > /dev/null
+  fi
+}
+
+# set up the repository
+
+rm -rf $CACHE $REPOROOT/$REPONAME
+${SVNADMIN} create $REPOROOT/$REPONAME
+for l in `get_sequence 1 $LINES`; do
+  echo "line $l"
+done > $FILE
+${SVNMUCC} -q -m "" -U $URL put $FILE blamed.txt > /dev/null
+
+for r in `get_sequence 2 $REVISIONS`; do
+  commit_change `expr $r \* 7919 % $LINES + 1` $r
+done
+
+# main loop
+
+CACHE_OPT="--config-option=config:miscellany:blame-cache-dir=$CACHE"
+
+printf "            \t real   user    sys\n"
+
+printf "full blame  \t"
+run_blame full
+
+printf "fill cache  \t"
+run_blame fill $CACHE_OPT
+
+commit_change 1 `expr $REVISIONS + 1`
+
+printf "next rev    \t"
+run_blame next $CACHE_OPT
+
+# tear down
+
+rm -rf $FILE $CACHE $REPOROOT/$REPONAME
@@ -0,0 +1,126 @@
+#!/bin/sh
+
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# Measures how the time of 'svn checkout' grows with the number of nodes.
+# Every iteration imports a tree of DIRCOUNT directories holding FILECOUNT
+# small files each and checks it out.  Since the file contents are tiny,
+# the result is dominated by the working copy DB and work queue overhead.
+#
+# usage: run this script from the root of your working copy
+#        and / or adjust the path settings below as needed
+
+# set SVNPATH to the 'subversion' folder of your SVN source code w/c
+
+SVNPATH="$('pwd')/subversion"
+
+# if using the installed svn, you may need to adapt the following.
+# Uncomment the VALGRIND line to use that tool instead of "time".
+
+SVN=${SVNPATH}/svn/svn
+SVNADMIN=${SVNPATH}/svnadmin/svnadmin
+# VALGRIND="valgrind --tool=callgrind"
+
+# set your data paths here
+
+WC=/dev/shm/wc
+TREE=/dev/shm/tree
+REPOROOT=/dev/shm
+
+# number of files per directory and number of directories on the first
+# run.  The number of directories will be doubled after every iteration.
+# The test will stop if MAXNODES has been reached or exceeded.
+
+FILECOUNT=100
+DIRCOUNT=10
+MAXNODES=500000
+
+# uncomment to compare with file installs on multiple threads
+
+# CONFIG="--config-option config:working-copy:worker-threads=4"
+
+# from here on, we should be good
+
+TIMEFORMAT='%3R  %3U  %3S'
+REPONAME=nodes
+URL=file://${REPOROOT}/$REPONAME
+
+# construct valgrind parameters
+
+if [ "${VALGRIND}" != "" ] ; then
+  VG_TOOL=$( echo ${VALGRIND} | sed 's/.*\ --tool=\([a-z]*\).*/\1/' )
+  VG_OUTFILE="--${VG_TOOL}-out-file"
+fi
+
+# print header
+
+printf "using "
+${SVN} --version | grep " version"
+echo
+
+# helpers
+
+get_sequence() {
+  # three equivalents...
+  (jot - "$1" "$2" "1" 2>/dev/null || seq -s ' ' "$1" "$2" 2>/dev/null || python -c "for i in range($1,$2+1): print(i)")
+}
+
+create_tree() {
+  rm -rf $TREE
+  mkdir $TREE
+  dirs=`get_sequence 1 $1`
+  files=`get_sequence 1 $2`
+  for d in $dirs; do
+    mkdir $TREE/$d
+    for f in $files; do
+      echo "File number $f" > $TREE/$d/$f
+    done
+  done
+}
+
+run_svn_co() {
+  if [ "${VALGRIND}" = "" ] ; then
+    time ${SVN} co ${CONFIG} $URL $WC -q > /dev/null
+  else
+    ${VALGRIND} ${VG_OUTFILE}="${VG_TOOL}.out.co.$1" ${SVN} co ${CONFIG} $URL $WC -q > /dev/null
+  fi
+}
+
+# main loop
+
+printf "    nodes\t real   user    sys\n"
+
+NODES=`echo $DIRCOUNT \* \( $FILECOUNT + 1 \) | bc`
+while [ $NODES -lt $MAXNODES ]; do
+  rm -rf $WC $REPOROOT/$REPONAME
+  ${SVNADMIN} create $REPOROOT/$REPONAME
+
+  create_tree $DIRCOUNT $FILECOUNT
+  ${SVN} import -q -m "" $TREE $URL > /dev/null
+  rm -rf $TREE
+
+  printf "%9d\t" $NODES
+  run_svn_co $NODES
+
+  DIRCOUNT=`echo 2 \* $DIRCOUNT | bc`
+  NODES=`echo $DIRCOUNT \* \( $FILECOUNT + 1 \) | bc`
+done
+
+# tear down
+
+rm -rf $WC $REPOROOT/$REPONAME
@@ -0,0 +1,132 @@
+#!/bin/sh
+
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# Compares the default LCS diff algorithm with the histogram algorithm
+# ('--histogram') on inputs that are hard for the former:
+#
+#   generated   LINES lines of generated data, every other line changed
+#   repetitive  LINES lines made from a handful of distinct lines, with
+#               random insertions and deletions
+#   moved       LINES distinct lines, with large blocks moved around
+#
+# usage: run this script from the root of your working copy
+#        and / or adjust the path settings below as needed
+
+# set SVNPATH to the 'subversion' folder of your SVN source code w/c
+
+SVNPATH="$('pwd')/subversion"
+
+# the stand-alone diff tool built from tools/diff.
+# Uncomment the VALGRIND line to use that tool instead of "time".
+
+DIFF=${SVNPATH}/../tools/diff/diff
+# VALGRIND="valgrind --tool=callgrind"
+
+# set your data paths here
+
+DATA=/dev/shm/diff-engines
+
+# input size
+
+LINES=200000
+
+# from here on, we should be good
+
+TIMEFORMAT='%3R  %3U  %3S'
+
+# construct valgrind parameters
+
+if [ "${VALGRIND}" != "" ] ; then
+  VG_TOOL=$( echo ${VALGRIND} | sed 's/.*\ --tool=\([a-z]*\).*/\1/' )
+  VG_OUTFILE="--${VG_TOOL}-out-file"
+fi
+
+# helpers
+
+create_inputs() {
+  awk -v n=$LINES 'BEGIN { srand(1);
+    for (i = 0; i < n; i++) {
+      printf "row %d value %d\n", i, int(rand() * 1000000) > "generated.1";
+      if (i % 2)
+        printf "row %d value %d\n", i, int(rand() * 1000000) > "generated.2";
+      else
+        printf "row %d value %d\n", i, i > "generated.2";
+    } }'
+
+  awk -v n=$LINES 'BEGIN { srand(2);
+    split("{|}|  return 0;||  break;|#endif", l, "|");
+    for (i = 0; i < n; i++) {
+      line = l[int(rand() * 6) + 1];
+      print line > "repetitive.1";
+      r = rand();
+      if (r < 0.05)
+        print l[int(rand() * 6) + 1] > "repetitive.2";
+      if (r >= 0.1)
+        print line > "repetitive.2";
+    } }'
+
+  awk -v n=$LINES 'BEGIN {
+    for (i = 0; i < n; i++)
+      printf "line %d\n", i > "moved.1";
+    block = int(n / 20);
+    for (b = 19; b >= 0; b -= 2)
+      for (i = b * block; i < (b + 1) * block && i < n; i++)
+        printf "line %d\n", i > "moved.2";
+    for (b = 0; b < 20; b += 2)
+      for (i = b * block; i < (b + 1) * block; i++)
+        printf "line %d\n", i > "moved.2";
+  }'
+}
+
+run_diff() {
+  if [ "${VALGRIND}" = "" ] ; then
+    time ${DIFF} $2 $1.1 $1.2 > $1.$3.out
+  else
+    ${VALGRIND} ${VG_OUTFILE}="${VG_TOOL}.out.$1.$3" ${DIFF} $2 $1.1 $1.2 > $1.$3.out
+  fi
+}
+
+# print header
+
+printf "diffing %d lines per input\n\n" $LINES
+
+# set up the inputs
+
+rm -rf $DATA
+mkdir $DATA
+cd $DATA
+create_inputs
+
+# main loop
+
+printf "input      algorithm   real   user    sys\n"
+
+for input in generated repetitive moved; do
+  printf "%-10s lcs        " $input
+  run_diff $input "" lcs
+  printf "%-10s histogram  " $input
+  run_diff $input "--histogram" histogram
+  printf "%-10s diff lines: lcs %d, histogram %d\n\n" "" \
+         `wc -l < $input.lcs.out` `wc -l < $input.histogram.out`
+done
+
+# tear down
+
+cd /
+rm -rf $DATA
@@ -0,0 +1,155 @@
+#!/bin/sh
+
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# Compares 'svn export' using different numbers of parallel jobs with
+# 'svnbench null-export', which receives the same data but writes nothing
+# to disk.  The latter is the lower bound for what parallel file writing
+# can achieve.  The tree is a set of DIRCOUNT directories holding FILECOUNT
+# files each, half of which have keywords and eol-style set, so that
+# translation costs show up as well.
+#
+# usage: run this script from the root of your working copy
+#        and / or adjust the path settings below as needed
+
+# set SVNPATH to the 'subversion' folder of your SVN source code w/c
+
+SVNPATH="$('pwd')/subversion"
+
+# if using the installed svn, you may need to adapt the following.
+# Uncomment the VALGRIND line to use that tool instead of "time".
+
+SVN=${SVNPATH}/svn/svn
+SVNADMIN=${SVNPATH}/svnadmin/svnadmin
+SVNBENCH=${SVNPATH}/svnbench/svnbench
+# VALGRIND="valgrind --tool=callgrind"
+
+# set your data paths here
+
+EXPORT=/dev/shm/export
+TREE=/dev/shm/tree
+REPOROOT=/dev/shm
+
+# tree shape and the list of --jobs values to compare
+
+FILECOUNT=200
+DIRCOUNT=100
+FILESIZE=16384
+JOBS="1 2 4 8"
+
+# use a remote URL here to include network latency
+
+REPONAME=export
+URL=file://${REPOROOT}/$REPONAME
+
+# from here on, we should be good
+
+TIMEFORMAT='%3R  %3U  %3S'
+
+# construct valgrind parameters
+
+if [ "${VALGRIND}" != "" ] ; then
+  VG_TOOL=$( echo ${VALGRIND} | sed 's/.*\ --tool=\([a-z]*\).*/\1/' )
+  VG_OUTFILE="--${VG_TOOL}-out-file"
+fi
+
+# print header
+
+printf "using "
+${SVN} --version | grep " version"
+echo
+
+# helpers
+
+get_sequence() {
+  # three equivalents...
+  (jot - "$1" "$2" "1" 2>/dev/null || seq -s ' ' "$1" "$2" 2>/dev/null || python -c "for i in range($1,$2+1): print(i)")
+}
+
+create_tree() {
+  rm -rf $TREE
+  mkdir $TREE
+  dirs=`get_sequence 1 $1`
+  files=`get_sequence 1 $2`
+  for d in $dirs; do
+    mkdir $TREE/$d
+    for f in $files; do
+      head -c $FILESIZE /dev/urandom | od -x > $TREE/$d/$f
+    done
+  done
+}
+
+add_props() {
+  dirs=`get_sequence 1 $1`
+  files=`get_sequence 1 $2`
+  for d in $dirs; do
+    for f in $files; do
+      if [ `expr $f % 2` -eq 0 ]; then
+        echo "$TREE/$d/$f"
+      fi
+    done
+  done > $TREE.targets
+  ${SVN} propset -q svn:eol-style native --targets $TREE.targets
+  ${SVN} propset -q svn:keywords "Id Rev" --targets $TREE.targets
+  rm $TREE.targets
+}
+
+run_export() {
+  rm -rf $EXPORT
+  if [ "${VALGRIND}" = "" ] ; then
+    time ${SVN} export -q --jobs $1 $URL $EXPORT > /dev/null
+  else
+    ${VALGRIND} ${VG_OUTFILE}="${VG_TOOL}.out.export.$1" ${SVN} export -q --jobs $1 $URL $EXPORT > /dev/null
+  fi
+}
+
+run_null_export() {
+  if [ "${VALGRIND}" = "" ] ; then
+    time ${SVNBENCH} null-export -q $URL > /dev/null
+  else
+    ${VALGRIND} ${VG_OUTFILE}="${VG_TOOL}.out.null-export" ${SVNBENCH} null-export -q $URL > /dev/null
+  fi
+}
+
+# set up the repository
+
+rm -rf $EXPORT $REPOROOT/$REPONAME
+${SVNADMIN} create $REPOROOT/$REPONAME
+create_tree $DIRCOUNT $FILECOUNT
+${SVN} co -q $URL $TREE.wc
+mv $TREE.wc/.svn $TREE/
+${SVN} add -q --force $TREE
+add_props $DIRCOUNT $FILECOUNT
+${SVN} ci -q -m "" $TREE > /dev/null
+rm -rf $TREE $TREE.wc
+
+# main loop
+
+printf "       jobs\t real   user    sys\n"
+
+printf "null-export\t"
+run_null_export
+
+for j in $JOBS; do
+  printf "%11d\t" $j
+  run_export $j
+done
+
+# tear down
+
+rm -rf $EXPORT $REPOROOT/$REPONAME
@@ -0,0 +1,182 @@
+/* serf-xml-bench.c -- measure the ra_serf XML parser throughput
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+/* Feed recorded REPORT (or PROPFIND) response bodies through the
+ * ra_serf XML parsing context.  Record a body e.g. with
+ *
+ *   curl -X REPORT -d @log-request.xml http://host/repo/!svn/me > log.xml
+ *
+ * and run
+ *
+ *   serf-xml-bench [-n ITERATIONS] log.xml ...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <apr_general.h>
+#include <apr_time.h>
+
+#include "svn_pools.h"
+#include "svn_string.h"
+#include "svn_io.h"
+#include "svn_cmdline.h"
+#include "svn_error.h"
+
+#include "../../subversion/libsvn_ra_serf/ra_serf.h"
+
+/* The only state besides XML_STATE_INITIAL. */
+#define STATE_ELEMENT 1
+
+/* Enter every element, collect its cdata and a few attributes commonly
+ * found in REPORT responses.  This exercises all the per-element work
+ * that a real report parser would trigger. */
+static const svn_ra_serf__xml_transition_t bench_ttable[] = {
+  { XML_STATE_INITIAL, "", "*", STATE_ELEMENT,
+    TRUE, { "?name", "?rev", "?revision", "?path", NULL }, TRUE },
+
+  { STATE_ELEMENT, "", "*", STATE_ELEMENT,
+    TRUE, { "?name", "?rev", "?revision", "?path", NULL }, TRUE },
+
+  { 0 }
+};
+
+/* Statistics gathered while parsing. */
+typedef struct bench_baton_t
+{
+  apr_int64_t elements;
+  apr_int64_t cdata_bytes;
+} bench_baton_t;
+
+/* Conforms to svn_ra_serf__xml_closed_t. */
+static svn_error_t *
+bench_closed(svn_ra_serf__xml_estate_t *xes,
+             void *baton,
+             int leaving_state,
+             const svn_string_t *cdata,
+             apr_hash_t *attrs,
+             apr_pool_t *scratch_pool)
+{
+  bench_baton_t *b = baton;
+
+  b->elements++;
+  if (cdata)
+    b->cdata_bytes += cdata->len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Parse the contents of the file at PATH ITERATIONS times and print the
+ * results.  Use POOL for temporary allocations. */
+static svn_error_t *
+bench_file(const char *path,
+           int iterations,
+           apr_pool_t *pool)
+{
+  svn_stringbuf_t *contents;
+  bench_baton_t baton = { 0 };
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_time_t start, duration;
+  int i;
+
+  SVN_ERR(svn_stringbuf_from_file2(&contents, path, pool));
+
+  start = apr_time_now();
+  for (i = 0; i < iterations; ++i)
+    {
+      svn_ra_serf__xml_context_t *xmlctx;
+
+      svn_pool_clear(iterpool);
+      baton.elements = 0;
+      baton.cdata_bytes = 0;
+
+      xmlctx = svn_ra_serf__xml_context_create(bench_ttable, NULL,
+                                               bench_closed, NULL,
+                                               &baton, iterpool);
+      SVN_ERR(svn_ra_serf__xml_parse_buffer(xmlctx, contents->data,
+                                            contents->len, iterpool));
+    }
+  duration = apr_time_now() - start;
+  svn_pool_destroy(iterpool);
+
+  if (duration == 0)
+    duration = 1;
+
+  SVN_ERR(svn_cmdline_printf(pool,
+                             "%s: %" APR_INT64_T_FMT " elements, "
+                             "%" APR_INT64_T_FMT " cdata bytes, "
+                             "%.1f MB/s, %.0f elements/s\n",
+                             path, baton.elements, baton.cdata_bytes,
+                             (double)contents->len * iterations
+                               / duration * APR_USEC_PER_SEC
+                               / (1024 * 1024),
+                             (double)baton.elements * iterations
+                               / duration * APR_USEC_PER_SEC));
+
+  return SVN_NO_ERROR;
+}
+
+static void
+print_usage(void)
+{
+  printf("Usage: serf-xml-bench [-n ITERATIONS] FILE...\n\n"
+         "Parse each FILE, e.g. a recorded REPORT response body, using\n"
+         "the ra_serf XML parser and report the parser throughput.\n");
+}
+
+int
+main(int argc, const char *argv[])
+{
+  apr_pool_t *pool;
+  int iterations = 10;
+  int first = 1;
+  int i;
+
+  if (svn_cmdline_init("serf-xml-bench", stderr) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  pool = svn_pool_create(NULL);
+
+  if (argc > 2 && strcmp(argv[1], "-n") == 0)
+    {
+      iterations = atoi(argv[2]);
+      first = 3;
+    }
+
+  if (first >= argc || iterations <= 0)
+    {
+      print_usage();
+      return EXIT_FAILURE;
+    }
+
+  for (i = first; i < argc; ++i)
+    {
+      svn_error_t *err = bench_file(argv[i], iterations, pool);
+      if (err)
+        return svn_cmdline_handle_exit_error(err, pool, "serf-xml-bench: ");
+    }
+
+  svn_pool_destroy(pool);
+
+  return EXIT_SUCCESS;
+}
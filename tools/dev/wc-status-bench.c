@@ -0,0 +1,155 @@
+/* wc-status-bench.c -- measure repeated single-node status calls
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+/* Ask for the status of a single versioned node over and over, the way
+ * an IDE or a shell prompt integration does, once opening a fresh
+ * working copy context for every call and once using a long-lived
+ * working copy session.
+ *
+ *   wc-status-bench [-n ITERATIONS] PATH
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <apr_general.h>
+#include <apr_time.h>
+
+#include "svn_pools.h"
+#include "svn_dirent_uri.h"
+#include "svn_wc.h"
+#include "svn_cmdline.h"
+#include "svn_error.h"
+
+/* Print the number of calls per second achieved in DURATION for
+ * ITERATIONS calls, labelled with WHAT.  Use POOL for temporary
+ * allocations. */
+static svn_error_t *
+print_rate(const char *what,
+           int iterations,
+           apr_time_t duration,
+           apr_pool_t *pool)
+{
+  if (duration == 0)
+    duration = 1;
+
+  return svn_error_trace(
+           svn_cmdline_printf(pool, "%-10s %8d calls, %10.0f calls/s\n",
+                              what, iterations,
+                              (double)iterations / duration
+                                * APR_USEC_PER_SEC));
+}
+
+/* Run ITERATIONS status calls for LOCAL_ABSPATH in both modes and print
+ * the results.  Use POOL for temporary allocations. */
+static svn_error_t *
+bench_status(const char *local_abspath,
+             int iterations,
+             apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_wc_session_t *session;
+  svn_wc_status3_t *status;
+  apr_time_t start;
+  int i;
+
+  start = apr_time_now();
+  for (i = 0; i < iterations; ++i)
+    {
+      svn_wc_context_t *wc_ctx;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_wc_context_create(&wc_ctx, NULL, iterpool, iterpool));
+      SVN_ERR(svn_wc_status3(&status, wc_ctx, local_abspath,
+                             iterpool, iterpool));
+      SVN_ERR(svn_wc_context_destroy(wc_ctx));
+    }
+  SVN_ERR(print_rate("context", iterations, apr_time_now() - start, pool));
+
+  SVN_ERR(svn_wc_session_create(&session, NULL, pool, pool));
+
+  start = apr_time_now();
+  for (i = 0; i < iterations; ++i)
+    {
+      svn_wc_context_t *wc_ctx;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_wc_session_context_create(&wc_ctx, session, iterpool));
+      SVN_ERR(svn_wc_status3(&status, wc_ctx, local_abspath,
+                             iterpool, iterpool));
+      SVN_ERR(svn_wc_context_destroy(wc_ctx));
+    }
+  SVN_ERR(print_rate("session", iterations, apr_time_now() - start, pool));
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+static void
+print_usage(void)
+{
+  printf("Usage: wc-status-bench [-n ITERATIONS] PATH\n\n"
+         "Repeatedly query the status of the versioned node at PATH with\n"
+         "a fresh working copy context per call and with a working copy\n"
+         "session, and report the call rate of both.\n");
+}
+
+int
+main(int argc, const char *argv[])
+{
+  apr_pool_t *pool;
+  int iterations = 1000;
+  int first = 1;
+  const char *local_abspath;
+  svn_error_t *err;
+
+  if (svn_cmdline_init("wc-status-bench", stderr) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  pool = svn_pool_create(NULL);
+
+  if (argc > 2 && strcmp(argv[1], "-n") == 0)
+    {
+      iterations = atoi(argv[2]);
+      first = 3;
+    }
+
+  if (first + 1 != argc || iterations <= 0)
+    {
+      print_usage();
+      return EXIT_FAILURE;
+    }
+
+  err = svn_dirent_get_absolute(&local_abspath,
+                                svn_dirent_internal_style(argv[first], pool),
+                                pool);
+  if (!err)
+    err = bench_status(local_abspath, iterations, pool);
+  if (err)
+    return svn_cmdline_handle_exit_error(err, pool, "wc-status-bench: ");
+
+  svn_pool_destroy(pool);
+
+  return EXIT_SUCCESS;
+}